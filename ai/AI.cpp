@@ -1,14 +1,104 @@
 #include "AI.h"
 #include "RandomAI.h"
 #include "HeuristicAI.h"
+#include "GoMonteCarloAI.h"
+#include "AIWorkerPool.h"
 #include <memory>
+#include <algorithm>
+#include <thread>
 
 namespace chessgame::ai {
 
+void SearchContext::report(const SearchProgress& progress) {
+    {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        latestProgress = progress;
+        hasProgress = true;
+    }
+    if (onProgress) onProgress(progress);
+}
+
+bool SearchContext::getProgress(SearchProgress& progress) const {
+    std::lock_guard<std::mutex> lock(progressMutex);
+    if (!hasProgress) return false;
+    progress = latestProgress;
+    return true;
+}
+
+void SearchContext::setCpuShare(double share) {
+    cpuShare = std::min(1.0, std::max(0.01, share));
+    sliceStarted = false;
+}
+
+bool SearchContext::checkpoint() {
+    if (isCancelled()) return false;
+    if (hasDeadline && std::chrono::steady_clock::now() >= deadline) return false;
+    if (cpuShare >= 1.0) return true;
+    
+    // 每工作一个时间片就休眠 片长*(1-份额)/份额, 使长期占用率接近 cpuShare
+    const auto SLICE = std::chrono::milliseconds(10);
+    auto now = std::chrono::steady_clock::now();
+    if (!sliceStarted) {
+        sliceStart = now;
+        sliceStarted = true;
+        return true;
+    }
+    auto busy = now - sliceStart;
+    if (busy >= SLICE) {
+        std::this_thread::sleep_for(busy * ((1.0 - cpuShare) / cpuShare));
+        sliceStart = std::chrono::steady_clock::now();
+    }
+    return !isCancelled();
+}
+
+Move AIStrategy::calculateMove(
+    const std::shared_ptr<Board>& board,
+    PieceType playerColor,
+    SearchContext& context
+) {
+    (void)context;
+    return calculateMove(board, playerColor);
+}
+
+std::vector<ScoredMove> AIStrategy::analyze(
+    const std::shared_ptr<Board>& board,
+    PieceType playerColor,
+    int topK,
+    SearchContext& context
+) {
+    if (topK <= 0) return {};
+    ScoredMove line;
+    line.move = calculateMove(board, playerColor, context);
+    line.visits = 1;
+    return {line};
+}
+
+bool AIMoveHandle::ready() const {
+    return waitFor(std::chrono::milliseconds(0));
+}
+
+bool AIMoveHandle::waitFor(std::chrono::milliseconds timeout) const {
+    if (!result.valid()) return false;
+    return result.wait_for(timeout) == std::future_status::ready;
+}
+
+void AIMoveHandle::cancel() const {
+    if (context) context->cancel();
+}
+
+bool AIMoveHandle::getProgress(SearchProgress& progress) const {
+    return context && context->getProgress(progress);
+}
+
 AIPlayer::AIPlayer(PieceType color, std::unique_ptr<AIStrategy> strategy) 
     : color(color), strategy(std::move(strategy)) {
 }
 
+AIPlayer::~AIPlayer() {
+    // 搜索持有策略和棋盘的共享指针, 这里只需让它尽快结束
+    pendingSearch.cancel();
+}
+
 void AIPlayer::setColor(PieceType newColor) {
     color = newColor;
 }
@@ -18,6 +108,7 @@ PieceType AIPlayer::getColor() const {
 }
 
 void AIPlayer::setStrategy(std::unique_ptr<AIStrategy> newStrategy) {
+    cancelPendingMove();
     strategy = std::move(newStrategy);
 }
 
@@ -32,8 +123,44 @@ Move AIPlayer::makeMove(const std::shared_ptr<Board>& board) {
     return strategy->calculateMove(board, color);
 }
 
+AIMoveHandle AIPlayer::makeMoveAsync(const std::shared_ptr<Board>& board, ProgressCallback onProgress) {
+    cancelPendingMove();
+    
+    auto context = std::make_shared<SearchContext>(std::move(onProgress));
+    auto task = std::make_shared<std::packaged_task<Move()>>(
+        [searchStrategy = strategy, board, searchColor = color, context]() {
+            if (!searchStrategy) {
+                return Move(-1, -1, searchColor, true, false); // 无策略时返回虚着
+            }
+            return searchStrategy->calculateMove(board, searchColor, *context);
+        });
+    
+    pendingSearch = AIMoveHandle(task->get_future().share(), context);
+    AIWorkerPool::shared().submit([task]() { (*task)(); });
+    return pendingSearch;
+}
+
+void AIPlayer::cancelPendingMove() {
+    if (!pendingSearch.valid()) return;
+    pendingSearch.cancel();
+    pendingSearch.wait();
+    pendingSearch = AIMoveHandle();
+}
+
 // AI工厂实现
 std::unique_ptr<AIStrategy> AIFactory::createStrategy(AIType type, AILevel level) {
+    // 围棋：二级以上使用蒙特卡洛随机对局AI, 级别越高对局次数越多
+    if (type == AIType::GO) {
+        switch (level) {
+            case AILevel::LEVEL2:
+                return std::make_unique<GoMonteCarloAI>(level, 5000);
+            case AILevel::LEVEL3:
+                return std::make_unique<GoMonteCarloAI>(level, 30000);
+            default:
+                return std::make_unique<RandomAI>(type);
+        }
+    }
+    
     switch (level) {
         case AILevel::LEVEL1:
             return std::make_unique<RandomAI>(type);
@@ -57,4 +184,16 @@ std::unique_ptr<AIPlayer> AIFactory::createAIPlayer(
     return std::make_unique<AIPlayer>(color, std::move(strategy));
 }
 
+AIType AIFactory::aiTypeForGame(GameType gameType) {
+    switch (gameType) {
+        case OTHELLO:
+            return AIType::OTHELLO;
+        case GO:
+            return AIType::GO;
+        case GOMOKU:
+        default:
+            return AIType::GOMOKU;
+    }
+}
+
 }
\ No newline at end of file
@@ -3,6 +3,11 @@
 #include "../model/Board.h"
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
 
 namespace chessgame::ai {
 
@@ -19,7 +24,68 @@ enum class AILevel {
 // AI玩家类型
 enum class AIType {
     GOMOKU,
-    OTHELLO
+    OTHELLO,
+    GO
+};
+
+// 带评估的候选着法 (多主变分析的一行)
+struct ScoredMove {
+    chessgame::Move move;
+    double evaluation{0.0};   // 围棋为己方胜率, 其余为评分函数得分
+    int visits{0};            // 搜索次数, 不做统计的策略固定为 1
+};
+
+// 搜索进度: 深度 (迭代次数/随机对局数)、当前最佳着法与评估 (己方胜率或评分)
+struct SearchProgress {
+    int depth{0};
+    chessgame::Move bestMove;
+    double evaluation{0.0};
+    long long nodes{0};
+    std::vector<ScoredMove> topMoves;  // 仅在分析模式下填写
+};
+
+using ProgressCallback = std::function<void(const SearchProgress&)>;
+
+// 搜索上下文: 在调用线程与 AI 工作线程之间传递取消信号和进度
+class SearchContext {
+private:
+    std::atomic<bool> cancelled{false};
+    ProgressCallback onProgress;
+    
+    // CPU 份额限制: 只由搜索线程读写
+    double cpuShare{1.0};
+    std::chrono::steady_clock::time_point sliceStart;
+    bool sliceStarted{false};
+    
+    // 截止时间: 只由搜索线程读写
+    std::chrono::steady_clock::time_point deadline;
+    bool hasDeadline{false};
+    
+    mutable std::mutex progressMutex;
+    SearchProgress latestProgress;
+    bool hasProgress{false};
+    
+public:
+    explicit SearchContext(ProgressCallback callback = nullptr) : onProgress(std::move(callback)) {}
+    
+    // 请求停止搜索: 策略应尽快返回目前为止的最佳着法
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    
+    // 限制搜索最多占用一个核的 share (0, 1] 份额, 在 checkpoint 中按占空比休眠
+    void setCpuShare(double share);
+    
+    // 到达截止时间后 checkpoint 返回 false, 效果与取消相同
+    void setDeadline(std::chrono::steady_clock::time_point time) { deadline = time; hasDeadline = true; }
+    
+    // 搜索循环中定期调用: 按 CPU 份额让出时间片, 返回是否应继续搜索
+    bool checkpoint();
+    
+    // 由搜索线程调用, 记录最新进度并通知回调 (回调在搜索线程上执行)
+    void report(const SearchProgress& progress);
+    
+    // 读取最新进度, 尚无进度时返回 false
+    bool getProgress(SearchProgress& progress) const;
 };
 
 // AI接口 - 策略模式
@@ -33,6 +99,22 @@ public:
         chessgame::PieceType playerColor
     ) = 0;
     
+    // 可取消、可汇报进度的计算; 默认直接调用同步版本, 耗时较长的策略应重写
+    virtual chessgame::Move calculateMove(
+        const std::shared_ptr<Board>& board,
+        chessgame::PieceType playerColor,
+        SearchContext& context
+    );
+    
+    // 多主变分析: 返回评估最高的 topK 个候选着法 (按推荐程度降序).
+    // 默认只给出 calculateMove 的一手; 可以持续搜索的策略应一直搜到 context 被取消
+    virtual std::vector<ScoredMove> analyze(
+        const std::shared_ptr<Board>& board,
+        chessgame::PieceType playerColor,
+        int topK,
+        SearchContext& context
+    );
+    
     // 获取AI级别
     virtual AILevel getLevel() const = 0;
     
@@ -40,15 +122,51 @@ public:
     virtual AIType getType() const = 0;
 };
 
+// 异步计算句柄: 可等待结果、读取进度、取消搜索
+class AIMoveHandle {
+private:
+    std::shared_future<chessgame::Move> result;
+    std::shared_ptr<SearchContext> context;
+    
+public:
+    AIMoveHandle() = default;
+    AIMoveHandle(std::shared_future<chessgame::Move> future, std::shared_ptr<SearchContext> searchContext)
+        : result(std::move(future)), context(std::move(searchContext)) {}
+    
+    bool valid() const { return result.valid(); }
+    
+    // 结果是否已就绪 (不阻塞)
+    bool ready() const;
+    
+    // 最多等待 timeout, 结果就绪时返回 true
+    bool waitFor(std::chrono::milliseconds timeout) const;
+    
+    // 阻塞直到结果就绪
+    void wait() const { result.wait(); }
+    
+    // 阻塞直到得到结果
+    chessgame::Move get() const { return result.get(); }
+    
+    // 取消搜索: 策略会尽快返回目前为止的最佳着法, 是否采用由调用者决定
+    void cancel() const;
+    bool isCancelled() const { return context && context->isCancelled(); }
+    
+    // 最新的搜索进度
+    bool getProgress(SearchProgress& progress) const;
+};
+
 // AI玩家类
 class AIPlayer {
 private:
     chessgame::PieceType color;
-    std::unique_ptr<AIStrategy> strategy;
+    // 策略由进行中的异步搜索共享持有, AIPlayer 先于搜索销毁也是安全的
+    std::shared_ptr<AIStrategy> strategy;
+    // 进行中的异步搜索 (同一策略对象不能被两个搜索同时使用)
+    AIMoveHandle pendingSearch;
     
 public:
     AIPlayer(chessgame::PieceType color, std::unique_ptr<AIStrategy> strategy);
-    ~AIPlayer() = default;
+    ~AIPlayer();
     
     // 设置AI颜色
     void setColor(chessgame::PieceType newColor);
@@ -64,6 +182,13 @@ public:
     
     // 计算下一步移动
     chessgame::Move makeMove(const std::shared_ptr<Board>& board);
+    
+    // 在 AI 工作线程池上异步计算下一步移动.
+    // board 在搜索期间不能被修改, 调用者通常传入一份拷贝; 上一次未完成的搜索会先被取消.
+    AIMoveHandle makeMoveAsync(const std::shared_ptr<Board>& board, ProgressCallback onProgress = nullptr);
+    
+    // 取消进行中的异步搜索并等待其结束
+    void cancelPendingMove();
 };
 
 // AI工厂 - 抽象工厂模式
@@ -78,6 +203,9 @@ public:
         AIType type,
         AILevel level
     );
+    
+    // 根据游戏类型选择AI类型
+    static AIType aiTypeForGame(chessgame::GameType gameType);
 };
 
 }
\ No newline at end of file
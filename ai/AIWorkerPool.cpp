@@ -0,0 +1,52 @@
+#include "AIWorkerPool.h"
+#include <algorithm>
+
+namespace chessgame::ai {
+
+AIWorkerPool::AIWorkerPool(int threadCount) {
+    threadCount = std::max(1, threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&AIWorkerPool::workerLoop, this);
+    }
+}
+
+AIWorkerPool::~AIWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+AIWorkerPool& AIWorkerPool::shared() {
+    static AIWorkerPool pool(static_cast<int>(std::thread::hardware_concurrency()));
+    return pool;
+}
+
+void AIWorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        tasks.push_back(std::move(task));
+    }
+    queueCondition.notify_one();
+}
+
+void AIWorkerPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            // 退出前先把已提交的任务做完, 保证等待中的 future 都能拿到结果
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chessgame::ai {
+
+// AI 工作线程池: 所有异步搜索共用, 避免每次思考都创建线程
+class AIWorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping{false};
+    
+    void workerLoop();
+
+public:
+    explicit AIWorkerPool(int threadCount);
+    ~AIWorkerPool();
+    
+    AIWorkerPool(const AIWorkerPool&) = delete;
+    AIWorkerPool& operator=(const AIWorkerPool&) = delete;
+    
+    // 全局共享线程池, 线程数为 CPU 核数
+    static AIWorkerPool& shared();
+    
+    // 提交任务, 按提交顺序执行
+    void submit(std::function<void()> task);
+    
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+};
+
+}
@@ -0,0 +1,158 @@
+#include "AnalysisService.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+namespace chessgame::ai {
+
+AnalysisService::AnalysisService(AIType aiType, int topMoves, double maxCpuCores)
+    : type(aiType), topK(std::max(1, topMoves)) {
+    maxCpuCores = std::max(0.01, maxCpuCores);
+
+    // 只有围棋的搜索能从多线程中获益
+    int threadCount = 1;
+    if (type == AIType::GO) {
+        int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        threadCount = std::min(cores, static_cast<int>(std::ceil(maxCpuCores)));
+    }
+    cpuShare = std::min(1.0, maxCpuCores / threadCount);
+
+    for (int i = 0; i < threadCount; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->strategy = AIFactory::createStrategy(type, AILevel::LEVEL3);
+        workers.push_back(std::move(worker));
+    }
+    for (auto& worker : workers) {
+        worker->thread = std::thread(&AnalysisService::workerLoop, this, worker.get());
+    }
+}
+
+AnalysisService::~AnalysisService() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+        for (auto& worker : workers) {
+            if (worker->context) worker->context->cancel();
+        }
+    }
+    stateCondition.notify_all();
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+long long AnalysisService::setPosition(const Board& board, chessgame::PieceType player) {
+    long long id;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        position = std::make_shared<Board>(board);
+        playerToMove = player;
+        id = ++positionId;
+        for (auto& worker : workers) {
+            if (worker->context) worker->context->cancel();
+        }
+    }
+    stateCondition.notify_all();
+    return id;
+}
+
+void AnalysisService::clearPosition() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    position.reset();
+    ++positionId;
+    for (auto& worker : workers) {
+        if (worker->context) worker->context->cancel();
+    }
+}
+
+bool AnalysisService::getAnalysis(AnalysisResult& result) const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (!position) return false;
+
+    // 合并各线程的结果: 访问次数相加, 评估按访问次数加权平均
+    std::map<std::pair<int, int>, ScoredMove> merged;
+    long long nodes = 0;
+    bool found = false;
+    for (const auto& worker : workers) {
+        if (worker->positionId != positionId) continue;
+        found = true;
+        nodes += worker->nodes;
+        for (const auto& line : worker->lines) {
+            auto key = std::make_pair(line.move.x, line.move.y);
+            auto it = merged.find(key);
+            if (it == merged.end()) {
+                merged.emplace(key, line);
+                continue;
+            }
+            ScoredMove& total = it->second;
+            int visits = total.visits + line.visits;
+            if (visits > 0) {
+                total.evaluation = (total.evaluation * total.visits + line.evaluation * line.visits) / visits;
+            }
+            total.visits = visits;
+        }
+    }
+    if (!found) return false;
+
+    result.positionId = positionId;
+    result.nodes = nodes;
+    result.lines.clear();
+    for (const auto& entry : merged) result.lines.push_back(entry.second);
+    std::sort(result.lines.begin(), result.lines.end(), [](const ScoredMove& a, const ScoredMove& b) {
+        if (a.visits != b.visits) return a.visits > b.visits;
+        return a.evaluation > b.evaluation;
+    });
+    if (static_cast<int>(result.lines.size()) > topK) result.lines.resize(topK);
+    return true;
+}
+
+void AnalysisService::workerLoop(Worker* worker) {
+    long long analyzedId = 0;
+    while (true) {
+        std::shared_ptr<Board> board;
+        chessgame::PieceType player;
+        long long id;
+        std::shared_ptr<SearchContext> context;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            stateCondition.wait(lock, [&]() {
+                return stopping || (position && positionId != analyzedId);
+            });
+            if (stopping) return;
+
+            // 规则判断会临时改动棋盘, 每个线程搜索自己的拷贝
+            board = std::make_shared<Board>(*position);
+            player = playerToMove;
+            id = positionId;
+
+            // 进度回调在本线程上执行, 只在局面未变时更新结果
+            context = std::make_shared<SearchContext>([this, worker, id](const SearchProgress& progress) {
+                std::lock_guard<std::mutex> progressLock(stateMutex);
+                if (positionId != id) return;
+                worker->positionId = id;
+                worker->nodes = progress.nodes;
+                worker->lines = progress.topMoves;
+            });
+            context->setCpuShare(cpuShare);
+            worker->context = context;
+            worker->nodes = 0;
+        }
+
+        std::vector<ScoredMove> lines = worker->strategy->analyze(board, player, topK, *context);
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        worker->context.reset();
+        analyzedId = id;
+        if (positionId == id) {
+            worker->positionId = id;
+            worker->lines = std::move(lines);
+            // 没有汇报过进度的策略 (一次评分即完成) 以候选数计
+            if (worker->nodes == 0) {
+                for (const auto& line : worker->lines) worker->nodes += line.visits;
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "AI.h"
+#include "../model/Board.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 后台多主变分析服务.
+ *
+ * 设置局面后在后台线程上持续搜索, 随时可以无等待地读取当前的前 K 个候选着法.
+ * CPU 占用以"核"为单位限制: 例如 1.5 表示两个线程各占 75%.
+ * 围棋使用多线程根并行 (各线程独立随机对局后按访问次数合并), 其余游戏评分一次即可, 只用一个线程.
+ * 既供 GameManager 的提示功能使用, 也可脱离界面供分析工具调用.
+ */
+
+namespace chessgame::ai {
+
+// 分析结果快照
+struct AnalysisResult {
+    long long positionId{0};        // setPosition 返回的局面编号
+    long long nodes{0};             // 各线程累计的搜索次数
+    std::vector<ScoredMove> lines;  // 按推荐程度降序
+};
+
+class AnalysisService {
+private:
+    // 单个分析线程的状态
+    struct Worker {
+        std::thread thread;
+        std::unique_ptr<AIStrategy> strategy;
+        std::shared_ptr<SearchContext> context;   // 正在进行的搜索
+        long long positionId{0};                  // lines 对应的局面
+        long long nodes{0};
+        std::vector<ScoredMove> lines;
+    };
+
+    AIType type;
+    int topK;
+    double cpuShare;               // 每个线程的 CPU 份额
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    mutable std::mutex stateMutex;
+    std::condition_variable stateCondition;
+    std::shared_ptr<Board> position;   // 当前局面, 为空表示暂停
+    chessgame::PieceType playerToMove{chessgame::BLACK};
+    long long positionId{0};
+    bool stopping{false};
+
+    void workerLoop(Worker* worker);
+
+public:
+    // maxCpuCores: 最多占用的核数 (可为小数)
+    AnalysisService(AIType aiType, int topMoves = 3, double maxCpuCores = 0.5);
+    ~AnalysisService();
+
+    AnalysisService(const AnalysisService&) = delete;
+    AnalysisService& operator=(const AnalysisService&) = delete;
+
+    // 分析新局面 (立即返回), 旧局面的搜索会被取消; 返回局面编号
+    long long setPosition(const Board& board, chessgame::PieceType player);
+
+    // 暂停分析 (例如关闭提示或轮到 AI 思考时)
+    void clearPosition();
+
+    // 读取当前局面最新的分析结果, 尚无结果时返回 false
+    bool getAnalysis(AnalysisResult& result) const;
+
+    AIType getType() const { return type; }
+    int getTopK() const { return topK; }
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+};
+
+}
@@ -0,0 +1,172 @@
+#include "GoMonteCarloAI.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace chessgame::ai {
+
+namespace {
+
+// UCB 探索系数与棋形先验权重
+const double EXPLORATION = 0.7;
+const double PRIOR_BIAS = 0.5;
+
+// 每隔多少次随机对局汇报一次进度
+const int PROGRESS_INTERVAL = 1000;
+
+// 分析模式下单个局面的随机对局上限, 达到后停止搜索等待新局面
+const int ANALYSIS_MAX_PLAYOUTS = 500000;
+
+struct RootChild {
+    int point;
+    float prior;
+    int visits;
+    double wins;
+};
+
+// 按访问次数降序取前 topK 个候选点
+std::vector<ScoredMove> topChildren(const std::vector<RootChild>& children, const GoPlayoutBoard& root,
+                                    PieceType playerColor, int topK) {
+    std::vector<const RootChild*> order;
+    for (const auto& child : children) order.push_back(&child);
+    int count = std::min(topK, static_cast<int>(order.size()));
+    std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                      [](const RootChild* a, const RootChild* b) { return a->visits > b->visits; });
+
+    std::vector<ScoredMove> lines;
+    for (int i = 0; i < count; ++i) {
+        const RootChild* child = order[i];
+        ScoredMove line;
+        line.move = chessgame::Move(root.pointX(child->point), root.pointY(child->point), playerColor);
+        line.evaluation = child->visits ? child->wins / child->visits : 0.0;
+        line.visits = child->visits;
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+}
+
+GoMonteCarloAI::GoMonteCarloAI(AILevel aiLevel, int playouts, double komiPoints)
+    : level(aiLevel), playoutsPerMove(playouts), komi(komiPoints) {
+    // 使用随机种子初始化随机数生成器
+    rng.seed(std::random_device{}());
+}
+
+std::vector<ScoredMove> GoMonteCarloAI::search(
+    const Board& board,
+    chessgame::PieceType playerColor,
+    int maxPlayouts,
+    int topK,
+    SearchContext& context
+) {
+    GoPlayoutBoard root;
+    root.loadFrom(board, playerColor);
+    uint8_t color = root.getToMove();
+
+    // 候选点: 合法且不是己方眼位, 用 3x3 棋形给出先验
+    const GoPatternTable& patterns = GoPatternTable::instance();
+    std::vector<RootChild> children;
+    for (int i = 0; i < root.getEmptyCount(); ++i) {
+        int pt = root.getEmpty(i);
+        if (root.isEyeLike(pt, color) || !root.isLegal(pt, color)) continue;
+        children.push_back({pt, patterns.prior(root.patternCode(pt, color)), 0, 0.0});
+    }
+
+    // 没有可下的点
+    if (children.empty()) return {};
+
+    float maxPrior = 0.0f;
+    for (const auto& child : children) maxPrior = std::max(maxPrior, child.prior);
+
+    FastRandom fast((static_cast<uint64_t>(rng()) << 32) | rng());
+    for (int n = 1; n <= maxPlayouts; ++n) {
+        // 被取消时直接用已有的统计结果
+        if (!context.checkpoint()) break;
+
+        // 选择: UCB1 + 随访问次数衰减的棋形先验
+        RootChild* best = nullptr;
+        double bestValue = -1e9;
+        double logTotal = std::log(static_cast<double>(n));
+        for (auto& child : children) {
+            double bias = PRIOR_BIAS * (child.prior / maxPrior) / (child.visits + 1);
+            double value = (child.visits == 0)
+                ? 1e6 + bias
+                : child.wins / child.visits + EXPLORATION * std::sqrt(logTotal / child.visits) + bias;
+            if (value > bestValue) {
+                bestValue = value;
+                best = &child;
+            }
+        }
+
+        // 模拟: 从该点开始随机下到终局
+        GoPlayoutBoard game = root;
+        game.play(best->point);
+        game.playout(fast);
+        double result = game.score(komi);
+
+        best->visits++;
+        if ((color == GoPlayoutBoard::CELL_BLACK) ? result > 0 : result < 0) best->wins += 1.0;
+        else if (result == 0) best->wins += 0.5;
+
+        if (n % PROGRESS_INTERVAL == 0 || n == maxPlayouts) {
+            SearchProgress progress;
+            progress.topMoves = topChildren(children, root, playerColor, std::max(1, topK));
+            progress.depth = n;
+            progress.bestMove = progress.topMoves[0].move;
+            progress.evaluation = progress.topMoves[0].evaluation;
+            progress.nodes = n;
+            context.report(progress);
+        }
+    }
+
+    return topChildren(children, root, playerColor, std::max(1, topK));
+}
+
+chessgame::Move GoMonteCarloAI::calculateMove(
+    const std::shared_ptr<Board>& board,
+    chessgame::PieceType playerColor
+) {
+    SearchContext context;
+    return calculateMove(board, playerColor, context);
+}
+
+chessgame::Move GoMonteCarloAI::calculateMove(
+    const std::shared_ptr<Board>& board,
+    chessgame::PieceType playerColor,
+    SearchContext& context
+) {
+    // 选择访问次数最多的点, 没有可下的点时虚着
+    std::vector<ScoredMove> best = search(*board, playerColor, playoutsPerMove, 1, context);
+    if (best.empty()) {
+        return chessgame::Move(-1, -1, playerColor, true, false);
+    }
+    return chessgame::Move(best[0].move.x, best[0].move.y, playerColor, false, false);
+}
+
+std::vector<ScoredMove> GoMonteCarloAI::analyze(
+    const std::shared_ptr<Board>& board,
+    chessgame::PieceType playerColor,
+    int topK,
+    SearchContext& context
+) {
+    if (topK <= 0) return {};
+    std::vector<ScoredMove> lines = search(*board, playerColor, ANALYSIS_MAX_PLAYOUTS, topK, context);
+    if (lines.empty()) {
+        ScoredMove pass;
+        pass.move = chessgame::Move(-1, -1, playerColor, true, false);
+        pass.visits = 1;
+        lines.push_back(pass);
+    }
+    return lines;
+}
+
+AILevel GoMonteCarloAI::getLevel() const {
+    return level;
+}
+
+AIType GoMonteCarloAI::getType() const {
+    return AIType::GO;
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "AI.h"
+#include "GoPlayout.h"
+#include "../model/Board.h"
+#include <random>
+#include <vector>
+
+namespace chessgame::ai {
+
+// using声明
+using model::Board;
+
+// 围棋蒙特卡洛AI - 根节点 UCB1 + 3x3 棋形先验 (progressive bias), 叶子用快速随机对局评估
+class GoMonteCarloAI : public AIStrategy {
+private:
+    AILevel level;
+    int playoutsPerMove;   // 每步的随机对局次数
+    double komi;           // 贴目, 与 GameFacade 的数子规则保持一致默认为 0
+    std::mt19937 rng;
+
+    // 根节点搜索: 最多 maxPlayouts 次随机对局, 返回访问次数最多的 topK 个点 (无处可下时为空)
+    std::vector<ScoredMove> search(
+        const Board& board,
+        chessgame::PieceType playerColor,
+        int maxPlayouts,
+        int topK,
+        SearchContext& context
+    );
+
+public:
+    GoMonteCarloAI(AILevel aiLevel, int playouts, double komiPoints = 0.0);
+    ~GoMonteCarloAI() override = default;
+
+    // 实现策略接口
+    chessgame::Move calculateMove(
+        const std::shared_ptr<Board>& board,
+        chessgame::PieceType playerColor
+    ) override;
+    
+    // 可取消版本: 每隔一段随机对局汇报一次当前最佳点与胜率
+    chessgame::Move calculateMove(
+        const std::shared_ptr<Board>& board,
+        chessgame::PieceType playerColor,
+        SearchContext& context
+    ) override;
+    
+    // 分析模式: 持续搜索直到被取消, 给出胜率最高的 topK 个点
+    std::vector<ScoredMove> analyze(
+        const std::shared_ptr<Board>& board,
+        chessgame::PieceType playerColor,
+        int topK,
+        SearchContext& context
+    ) override;
+
+    AILevel getLevel() const override;
+    AIType getType() const override;
+};
+
+}
@@ -0,0 +1,387 @@
+#include "GoPlayout.h"
+#include <algorithm>
+#include <cstring>
+
+namespace chessgame::ai {
+
+// ==================== GoPlayoutBoard ====================
+
+void GoPlayoutBoard::init(int boardSize) {
+    size = std::clamp(boardSize, 1, MAX_SIZE);
+    stride = size + 2;
+    dirs[0] = -stride; dirs[1] = -1; dirs[2] = 1; dirs[3] = stride;
+    diags[0] = -stride - 1; diags[1] = -stride + 1; diags[2] = stride - 1; diags[3] = stride + 1;
+
+    std::memset(cells, CELL_BORDER, sizeof(cells));
+    emptyCount = 0;
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            int pt = point(x, y);
+            cells[pt] = CELL_EMPTY;
+            addEmpty(pt);
+        }
+    }
+
+    // 四邻计数: 边界之外的点不会被查询, 但仍需有确定的值
+    for (int pt = 0; pt < MAX_POINTS; ++pt) {
+        neighbours[pt] = 0;
+        if (cells[pt] == CELL_BORDER) continue;
+        for (int d = 0; d < 4; ++d) {
+            neighbours[pt] += static_cast<uint16_t>(1 << countShift(cells[pt + dirs[d]]));
+        }
+    }
+
+    koPoint = 0;
+    toMove = CELL_BLACK;
+    passCount = 0;
+    moveCount = 0;
+}
+
+void GoPlayoutBoard::loadFrom(const model::Board& board, PieceType playerToMove) {
+    init(board.getSize());
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            PieceType piece = board.getPiece(x, y);
+            if (piece == EMPTY) continue;
+            int pt = point(x, y);
+            setCell(pt, (piece == BLACK) ? CELL_BLACK : CELL_WHITE);
+            removeEmpty(pt);
+        }
+    }
+    rebuildChains();
+    toMove = (playerToMove == WHITE) ? CELL_WHITE : CELL_BLACK;
+
+    // 带上当前的劫争禁入点, 否则根节点第一手可能直接提回
+    Point ko = board.getKoPoint();
+    if (board.isValidBounds(ko.x, ko.y) && cells[point(ko.x, ko.y)] == CELL_EMPTY) koPoint = point(ko.x, ko.y);
+}
+
+void GoPlayoutBoard::rebuildChains() {
+    // 载入局面时用泛洪重建棋串, 之后全部增量维护
+    for (int pt = 0; pt < MAX_POINTS; ++pt) chainHead[pt] = 0;
+
+    int stack[MAX_POINTS];
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            int start = point(x, y);
+            uint8_t color = cells[start];
+            if (color != CELL_BLACK && color != CELL_WHITE) continue;
+            if (chainHead[start] != 0) continue;
+
+            int top = 0, last = start;
+            stack[top++] = start;
+            chainHead[start] = start;
+            chainNext[start] = start;
+            chainStones[start] = 0;
+            chainLibs[start] = 0;
+
+            while (top > 0) {
+                int pt = stack[--top];
+                chainStones[start]++;
+                for (int d = 0; d < 4; ++d) {
+                    int nb = pt + dirs[d];
+                    if (cells[nb] == CELL_EMPTY) {
+                        chainLibs[start]++;
+                    } else if (cells[nb] == color && chainHead[nb] == 0) {
+                        chainHead[nb] = start;
+                        // 插入循环链表
+                        chainNext[nb] = chainNext[last];
+                        chainNext[last] = nb;
+                        last = nb;
+                        stack[top++] = nb;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void GoPlayoutBoard::setCell(int pt, uint8_t cell) {
+    uint8_t old = cells[pt];
+    cells[pt] = cell;
+    for (int d = 0; d < 4; ++d) {
+        uint16_t& count = neighbours[pt + dirs[d]];
+        count = static_cast<uint16_t>(count - (1 << countShift(old)) + (1 << countShift(cell)));
+    }
+}
+
+void GoPlayoutBoard::addEmpty(int pt) {
+    emptyIndex[pt] = static_cast<uint16_t>(emptyCount);
+    empties[emptyCount++] = static_cast<uint16_t>(pt);
+}
+
+void GoPlayoutBoard::removeEmpty(int pt) {
+    int index = emptyIndex[pt];
+    int lastPt = empties[--emptyCount];
+    empties[index] = static_cast<uint16_t>(lastPt);
+    emptyIndex[lastPt] = static_cast<uint16_t>(index);
+}
+
+void GoPlayoutBoard::mergeChains(int a, int b) {
+    // 把较小的棋串并入较大的棋串
+    if (chainStones[a] < chainStones[b]) std::swap(a, b);
+
+    int pt = b;
+    do {
+        chainHead[pt] = static_cast<uint16_t>(a);
+        pt = chainNext[pt];
+    } while (pt != b);
+
+    std::swap(chainNext[a], chainNext[b]);
+    chainLibs[a] += chainLibs[b];
+    chainStones[a] += chainStones[b];
+}
+
+int GoPlayoutBoard::captureChain(int head) {
+    int captured = 0;
+    int pt = head;
+    do {
+        int next = chainNext[pt];
+        setCell(pt, CELL_EMPTY);
+        addEmpty(pt);
+        captured++;
+        pt = next;
+    } while (pt != head);
+
+    // 提子后相邻棋串每个相邻关系增加一口伪气
+    pt = head;
+    do {
+        for (int d = 0; d < 4; ++d) {
+            int nb = pt + dirs[d];
+            if (cells[nb] == CELL_BLACK || cells[nb] == CELL_WHITE) chainLibs[chainHead[nb]]++;
+        }
+        pt = chainNext[pt];
+    } while (pt != head);
+
+    return captured;
+}
+
+bool GoPlayoutBoard::isLegal(int pt, uint8_t color) const {
+    if (cells[pt] != CELL_EMPTY || pt == koPoint) return false;
+    if (neighbourCount(pt, CELL_EMPTY) > 0) return true;
+
+    int heads[4];
+    for (int d = 0; d < 4; ++d) {
+        int nb = pt + dirs[d];
+        heads[d] = (cells[nb] == CELL_BORDER) ? 0 : chainHead[nb];
+    }
+
+    // 伪气数减去与该点的相邻数, 即为落子后剩余的气
+    for (int d = 0; d < 4; ++d) {
+        if (heads[d] == 0) continue;
+        int adjacency = 0;
+        for (int e = 0; e < 4; ++e)
+            if (heads[e] == heads[d]) adjacency++;
+
+        bool own = cells[pt + dirs[d]] == color;
+        if (own && chainLibs[heads[d]] > adjacency) return true;     // 连上有气的己方棋串
+        if (!own && chainLibs[heads[d]] == adjacency) return true;   // 提掉对方
+    }
+    return false;
+}
+
+bool GoPlayoutBoard::isEyeLike(int pt, uint8_t color) const {
+    if (neighbourCount(pt, color) + neighbourCount(pt, CELL_BORDER) != 4) return false;
+
+    int opponentDiags = 0;
+    bool atEdge = false;
+    for (int d = 0; d < 4; ++d) {
+        uint8_t c = cells[pt + diags[d]];
+        if (c == CELL_BORDER) atEdge = true;
+        else if (c == opponent(color)) opponentDiags++;
+    }
+    return atEdge ? opponentDiags == 0 : opponentDiags <= 1;
+}
+
+int GoPlayoutBoard::play(int pt) {
+    uint8_t color = toMove;
+    uint8_t enemy = opponent(color);
+
+    setCell(pt, color);
+    removeEmpty(pt);
+    chainHead[pt] = static_cast<uint16_t>(pt);
+    chainNext[pt] = static_cast<uint16_t>(pt);
+    chainStones[pt] = 1;
+    chainLibs[pt] = static_cast<uint16_t>(neighbourCount(pt, CELL_EMPTY));
+
+    for (int d = 0; d < 4; ++d) {
+        int nb = pt + dirs[d];
+        if (cells[nb] == CELL_BLACK || cells[nb] == CELL_WHITE) chainLibs[chainHead[nb]]--;
+    }
+
+    int captured = 0, capturedPoint = 0;
+    for (int d = 0; d < 4; ++d) {
+        int nb = pt + dirs[d];
+        if (cells[nb] == color) {
+            if (chainHead[nb] != chainHead[pt]) mergeChains(chainHead[pt], chainHead[nb]);
+        } else if (cells[nb] == enemy && chainLibs[chainHead[nb]] == 0) {
+            captured += captureChain(chainHead[nb]);
+            capturedPoint = nb;
+        }
+    }
+
+    // 单子提单子且落子后只剩一口气: 形成劫
+    int head = chainHead[pt];
+    koPoint = (captured == 1 && chainStones[head] == 1 && chainLibs[head] == 1) ? capturedPoint : 0;
+
+    toMove = enemy;
+    passCount = 0;
+    moveCount++;
+    return captured;
+}
+
+void GoPlayoutBoard::pass() {
+    koPoint = 0;
+    toMove = opponent(toMove);
+    passCount++;
+    moveCount++;
+}
+
+int GoPlayoutBoard::playRandomMove(FastRandom& rng) {
+    if (emptyCount > 0) {
+        int start = static_cast<int>(rng.below(static_cast<uint32_t>(emptyCount)));
+        for (int i = 0; i < emptyCount; ++i) {
+            int index = start + i;
+            if (index >= emptyCount) index -= emptyCount;
+            int pt = empties[index];
+            if (!isEyeLike(pt, toMove) && isLegal(pt, toMove)) {
+                play(pt);
+                return pt;
+            }
+        }
+    }
+    pass();
+    return PASS;
+}
+
+void GoPlayoutBoard::playout(FastRandom& rng) {
+    int maxMoves = moveCount + size * size * 3;
+    while (passCount < 2 && moveCount < maxMoves) {
+        playRandomMove(rng);
+    }
+}
+
+uint8_t GoPlayoutBoard::ownerAt(int pt) const {
+    if (cells[pt] == CELL_BLACK || cells[pt] == CELL_WHITE) return cells[pt];
+    if (cells[pt] != CELL_EMPTY) return CELL_EMPTY;
+
+    bool touchesBlack = neighbourCount(pt, CELL_BLACK) > 0;
+    bool touchesWhite = neighbourCount(pt, CELL_WHITE) > 0;
+    if (touchesBlack && !touchesWhite) return CELL_BLACK;
+    if (touchesWhite && !touchesBlack) return CELL_WHITE;
+    return CELL_EMPTY;
+}
+
+double GoPlayoutBoard::score(double komi) const {
+    int balance = 0;
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            uint8_t owner = ownerAt(point(x, y));
+            if (owner == CELL_BLACK) balance++;
+            else if (owner == CELL_WHITE) balance--;
+        }
+    }
+    return balance - komi;
+}
+
+uint16_t GoPlayoutBoard::patternCode(int pt, uint8_t color) const {
+    // 顺时针: 上、右上、右、右下、下、左下、左、左上
+    const int offsets[8] = {-stride, -stride + 1, 1, stride + 1, stride, stride - 1, -1, -stride - 1};
+    uint16_t code = 0;
+    for (int i = 0; i < 8; ++i) {
+        uint8_t c = cells[pt + offsets[i]];
+        uint16_t v = (c == CELL_EMPTY) ? 0 : (c == color) ? 1 : (c == CELL_BORDER) ? 3 : 2;
+        code |= static_cast<uint16_t>(v << (2 * i));
+    }
+    return code;
+}
+
+// ==================== GoPatternTable ====================
+
+GoPatternTable::GoPatternTable() {
+    for (int code = 0; code < (1 << 16); ++code) {
+        priors[code] = scorePattern(static_cast<uint16_t>(code));
+    }
+}
+
+const GoPatternTable& GoPatternTable::instance() {
+    static const GoPatternTable table;
+    return table;
+}
+
+float GoPatternTable::scorePattern(uint16_t code) {
+    // 邻点取值: 0 空, 1 己, 2 敌, 3 边界; 偶数下标为上下左右, 奇数下标为对角
+    int v[8];
+    for (int i = 0; i < 8; ++i) v[i] = (code >> (2 * i)) & 3;
+
+    int ownOrth = 0, enemyOrth = 0, borderOrth = 0, stones = 0, ownDiag = 0;
+    for (int i = 0; i < 8; i += 2) {
+        if (v[i] == 1) ownOrth++;
+        else if (v[i] == 2) enemyOrth++;
+        else if (v[i] == 3) borderOrth++;
+    }
+    for (int i = 0; i < 8; ++i)
+        if (v[i] == 1 || v[i] == 2) stones++;
+    for (int i = 1; i < 8; i += 2)
+        if (v[i] == 1) ownDiag++;
+
+    // 边界必须成片出现, 否则该编码在棋盘上不存在
+    if (borderOrth > 2) return 0.0f;
+
+    float weight = 1.0f;
+
+    // 己方眼位: 几乎不下
+    if (ownOrth + borderOrth == 4) return 0.02f;
+
+    // 接触战
+    if (enemyOrth > 0) weight *= 2.0f;
+
+    for (int i = 0; i < 8; i += 2) {
+        int a = v[i], b = v[(i + 2) % 8], diag = v[i + 1];
+        // 切断: 两个相邻方向都是对方, 夹角处不是对方
+        if (a == 2 && b == 2 && diag != 2) weight *= 3.0f;
+        // 补断: 两个相邻方向都是己方, 夹角处被对方占据
+        if (a == 1 && b == 1 && diag == 2) weight *= 2.5f;
+        // 空三角: 愚形
+        if (a == 1 && b == 1 && diag == 1) weight *= 0.3f;
+    }
+
+    // 扳: 贴着对方且斜向有己方子
+    if (enemyOrth == 1 && ownOrth == 0 && ownDiag > 0) weight *= 1.5f;
+
+    // 无子的一线、角上
+    if (stones == 0 && borderOrth == 1) weight *= 0.3f;
+    if (stones == 0 && borderOrth == 2) weight *= 0.1f;
+
+    return std::clamp(weight, 0.02f, 20.0f);
+}
+
+// ==================== 形势判断 ====================
+
+std::vector<float> estimateOwnership(const model::Board& board, PieceType playerToMove,
+                                     int playouts, uint64_t seed) {
+    int size = board.getSize();
+    std::vector<float> ownership(size * size, 0.0f);
+    if (playouts <= 0) return ownership;
+
+    GoPlayoutBoard root;
+    root.loadFrom(board, playerToMove);
+    FastRandom rng(seed);
+
+    for (int n = 0; n < playouts; ++n) {
+        GoPlayoutBoard game = root;
+        game.playout(rng);
+        for (int x = 0; x < size; ++x) {
+            for (int y = 0; y < size; ++y) {
+                uint8_t owner = game.ownerAt(game.point(x, y));
+                if (owner == GoPlayoutBoard::CELL_BLACK) ownership[x * size + y] += 1.0f;
+                else if (owner == GoPlayoutBoard::CELL_WHITE) ownership[x * size + y] -= 1.0f;
+            }
+        }
+    }
+
+    for (auto& value : ownership) value /= playouts;
+    return ownership;
+}
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "../utils/Type.h"
+#include "../model/Board.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 围棋快速随机对局 (light playout) 引擎.
+ *
+ * 棋盘采用带一圈边界的一维数组, 棋串用循环链表 + 伪气数增量维护,
+ * 整个对象可平凡拷贝, 每次对局只需一次 memcpy. 供蒙特卡洛 AI 与形势判断共用.
+ */
+
+namespace chessgame::ai {
+
+// 快速随机数 (xorshift64*), 对局中每步都要取随机数, std::mt19937 太慢
+struct FastRandom {
+    uint64_t state;
+
+    explicit FastRandom(uint64_t seed = 0x9E3779B97F4A7C15ULL) : state(seed ? seed : 1) {}
+
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<uint32_t>((state * 0x2545F4914F6CDD1DULL) >> 32);
+    }
+
+    // [0, bound) 内的均匀随机数
+    uint32_t below(uint32_t bound) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(next()) * bound) >> 32);
+    }
+};
+
+class GoPlayoutBoard {
+public:
+    static const int MAX_SIZE = 19;
+    static const int MAX_POINTS = (MAX_SIZE + 2) * (MAX_SIZE + 2);
+    static const int PASS = 0;   // 0 号位置在边界上, 用来表示虚着
+
+    // 格子内容
+    enum Cell : uint8_t { CELL_EMPTY = 0, CELL_BLACK = 1, CELL_WHITE = 2, CELL_BORDER = 3 };
+
+private:
+    int size{0};
+    int stride{0};
+    int dirs[4]{};               // 上、左、右、下
+    int diags[4]{};              // 四个对角
+
+    uint8_t cells[MAX_POINTS];
+    uint16_t chainHead[MAX_POINTS];   // 所在棋串的代表点
+    uint16_t chainNext[MAX_POINTS];   // 棋串循环链表
+    uint16_t chainLibs[MAX_POINTS];   // 伪气数 (只在代表点上有效)
+    uint16_t chainStones[MAX_POINTS]; // 棋子数 (只在代表点上有效)
+    uint16_t neighbours[MAX_POINTS];  // 四邻计数: 每种格子内容占 4 位, 眼位/有气判断只需一次查表
+
+    uint16_t empties[MAX_SIZE * MAX_SIZE];  // 空点列表
+    uint16_t emptyIndex[MAX_POINTS];        // 空点在列表中的下标
+    int emptyCount{0};
+
+    int koPoint{0};
+    uint8_t toMove{CELL_BLACK};
+    int passCount{0};
+    int moveCount{0};
+
+    static int countShift(uint8_t cell) { return cell * 4; }
+    int neighbourCount(int pt, uint8_t cell) const { return (neighbours[pt] >> countShift(cell)) & 0xF; }
+    void setCell(int pt, uint8_t cell);
+
+    void addEmpty(int pt);
+    void removeEmpty(int pt);
+    void mergeChains(int a, int b);
+    int captureChain(int head);
+    void rebuildChains();
+
+public:
+    GoPlayoutBoard() = default;
+    explicit GoPlayoutBoard(int boardSize) { init(boardSize); }
+
+    // 清空为指定大小的空棋盘
+    void init(int boardSize);
+
+    // 从模型棋盘载入局面
+    void loadFrom(const model::Board& board, PieceType playerToMove);
+
+    int getSize() const { return size; }
+    int point(int x, int y) const { return (x + 1) * stride + (y + 1); }
+    int pointX(int pt) const { return pt / stride - 1; }
+    int pointY(int pt) const { return pt % stride - 1; }
+
+    uint8_t cellAt(int pt) const { return cells[pt]; }
+    uint8_t getToMove() const { return toMove; }
+    int getPassCount() const { return passCount; }
+    int getMoveCount() const { return moveCount; }
+    int getEmptyCount() const { return emptyCount; }
+    int getEmpty(int index) const { return empties[index]; }
+
+    static uint8_t opponent(uint8_t color) { return color ^ 3; }
+
+    // 落子是否合法 (非自杀、非打劫)
+    bool isLegal(int pt, uint8_t color) const;
+
+    // 是否是 color 方的眼 (随机对局中不填自己的眼)
+    bool isEyeLike(int pt, uint8_t color) const;
+
+    // 落子 (调用者保证合法), 返回提子数
+    int play(int pt);
+
+    // 虚着
+    void pass();
+
+    // 随机下一步 (跳过非法点和己方眼位), 无处可下时虚着; 返回落子位置
+    int playRandomMove(FastRandom& rng);
+
+    // 从当前局面随机下到终局
+    void playout(FastRandom& rng);
+
+    // 数子法计分: 黑方子数+地 减去 白方, 再减去贴目
+    double score(double komi) const;
+
+    // 终局时某点的归属 (棋子或仅被一方包围的空点)
+    uint8_t ownerAt(int pt) const;
+
+    // 以 color 视角编码 3x3 邻域: 8 个邻点各 2 位 (空/己/敌/边)
+    uint16_t patternCode(int pt, uint8_t color) const;
+};
+
+// 3x3 棋形先验: 以邻域编码直接作为哈希下标
+class GoPatternTable {
+private:
+    float priors[1 << 16];
+
+    GoPatternTable();
+    static float scorePattern(uint16_t code);
+
+public:
+    static const GoPatternTable& instance();
+
+    float prior(uint16_t code) const { return priors[code]; }
+};
+
+// 形势判断: 随机对局多次, 返回每点归属 (+1 黑 / -1 白), 按 board 的 [x][y] 行优先排列
+std::vector<float> estimateOwnership(const model::Board& board, PieceType playerToMove,
+                                     int playouts, uint64_t seed);
+
+}
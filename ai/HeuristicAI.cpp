@@ -32,7 +32,8 @@ chessgame::Move HeuristicAI::calculateMove(
     chessgame::PieceType playerColor
 ) {
     // 获取所有合法移动
-    std::vector<chessgame::Point> validMoves = getValidMoves(board, playerColor);
+    chessgame::MoveList validMoves;
+    getValidMoves(board, playerColor, validMoves);
     
     // 如果没有合法移动，返回虚着
     if (validMoves.empty()) {
@@ -40,7 +41,7 @@ chessgame::Move HeuristicAI::calculateMove(
     }
     
     // 评估每个合法移动
-    std::vector<std::pair<int, chessgame::Point>> evaluatedMoves;
+    chessgame::FixedList<std::pair<int, chessgame::Point>, chessgame::MAX_BOARD_POINTS> evaluatedMoves;
     
     for (const auto& move : validMoves) {
         int score = 0;
@@ -58,7 +59,7 @@ chessgame::Move HeuristicAI::calculateMove(
     
     // 从评分最高的移动中随机选择一个（增加多样性）
     int topScore = evaluatedMoves[0].first;
-    std::vector<chessgame::Point> topMoves;
+    chessgame::PointList topMoves;
     
     for (const auto& evaluatedMove : evaluatedMoves) {
         if (evaluatedMove.first == topScore) {
@@ -68,13 +69,53 @@ chessgame::Move HeuristicAI::calculateMove(
         }
     }
     
-    std::uniform_int_distribution<size_t> dist(0, topMoves.size() - 1);
-    size_t index = dist(rng);
+    std::uniform_int_distribution<int> dist(0, topMoves.size() - 1);
+    int index = dist(rng);
     chessgame::Point selectedMove = topMoves[index];
     
     return chessgame::Move(selectedMove.x, selectedMove.y, playerColor, false, false);
 }
 
+std::vector<ScoredMove> HeuristicAI::analyze(
+    const std::shared_ptr<Board>& board,
+    chessgame::PieceType playerColor,
+    int topK,
+    SearchContext& context
+) {
+    (void)context; // 评分一次即可完成, 无需检查取消
+    if (topK <= 0) return {};
+    
+    chessgame::MoveList validMoves;
+    getValidMoves(board, playerColor, validMoves);
+    
+    std::vector<ScoredMove> lines;
+    if (validMoves.empty()) {
+        ScoredMove pass;
+        pass.move = chessgame::Move(-1, -1, playerColor, true, false);
+        pass.visits = 1;
+        lines.push_back(pass);
+        return lines;
+    }
+    
+    for (const auto& move : validMoves) {
+        ScoredMove line;
+        line.move = chessgame::Move(move.x, move.y, playerColor);
+        line.visits = 1;
+        if (type == AIType::GOMOKU) {
+            line.evaluation = evaluateGomokuMove(board, move.x, move.y, playerColor);
+        } else if (type == AIType::OTHELLO) {
+            line.evaluation = evaluateOthelloMove(board, move.x, move.y, playerColor);
+        }
+        lines.push_back(line);
+    }
+    
+    int count = std::min(topK, static_cast<int>(lines.size()));
+    std::partial_sort(lines.begin(), lines.begin() + count, lines.end(),
+                      [](const ScoredMove& a, const ScoredMove& b) { return a.evaluation > b.evaluation; });
+    lines.resize(count);
+    return lines;
+}
+
 AILevel HeuristicAI::getLevel() const {
     return AILevel::LEVEL2;
 }
@@ -83,11 +124,12 @@ AIType HeuristicAI::getType() const {
     return type;
 }
 
-std::vector<chessgame::Point> HeuristicAI::getValidMoves(
+void HeuristicAI::getValidMoves(
     const std::shared_ptr<Board>& board,
-    chessgame::PieceType playerColor
+    chessgame::PieceType playerColor,
+    chessgame::MoveList& validMoves
 ) {
-    std::vector<chessgame::Point> validMoves;
+    validMoves.clear();
     int size = board->getSize();
     
     if (type == AIType::GOMOKU) {
@@ -139,8 +181,6 @@ std::vector<chessgame::Point> HeuristicAI::getValidMoves(
             }
         }
     }
-    
-    return validMoves;
 }
 
 int HeuristicAI::evaluateGomokuMove(
@@ -300,7 +340,7 @@ int HeuristicAI::countFlippedPieces(
     for (int i = 0; i < 8; i++) {
         int nx = x + dx[i];
         int ny = y + dy[i];
-        std::vector<chessgame::Point> directionFlips;
+        int directionFlips = 0;
         
         while (nx >= 0 && nx < size && ny >= 0 && ny < size) {
             chessgame::PieceType piece = board->getPiece(nx, ny);
@@ -310,13 +350,13 @@ int HeuristicAI::countFlippedPieces(
             }
             
             if (piece == playerColor) {
-                // 找到自己的棋子，将路径上的对手棋子添加到翻转列表
-                count += directionFlips.size();
+                // 找到自己的棋子，路径上的对手棋子都会被翻转
+                count += directionFlips;
                 break;
             }
             
             // 对手的棋子
-            directionFlips.push_back({nx, ny});
+            directionFlips++;
             nx += dx[i];
             ny += dy[i];
         }
@@ -1,6 +1,7 @@
 #pragma once
 #include "AI.h"
 #include "../model/Board.h"
+#include "../utils/MoveList.h"
 #include <random>
 
 namespace chessgame::ai {
@@ -27,14 +28,23 @@ public:
         chessgame::PieceType playerColor
     ) override;
     
+    // 多主变分析: 评分最高的 topK 个合法位置, 评分即评估值
+    std::vector<ScoredMove> analyze(
+        const std::shared_ptr<Board>& board,
+        chessgame::PieceType playerColor,
+        int topK,
+        SearchContext& context
+    ) override;
+    
     AILevel getLevel() const override;
     AIType getType() const override;
     
 private:
-    // 获取所有合法移动
-    std::vector<chessgame::Point> getValidMoves(
+    // 获取所有合法移动 (写入定长列表, 不做堆分配)
+    void getValidMoves(
         const std::shared_ptr<Board>& board,
-        chessgame::PieceType playerColor
+        chessgame::PieceType playerColor,
+        chessgame::MoveList& validMoves
     );
     
     // 五子棋评分函数
@@ -1,5 +1,6 @@
 #include "RandomAI.h"
 #include "../model/Othello.h"
+#include "../model/GoRule.h"
 #include <cstdlib>
 #include <ctime>
 
@@ -15,7 +16,8 @@ chessgame::Move RandomAI::calculateMove(
     chessgame::PieceType playerColor
 ) {
     // 获取所有合法移动
-    std::vector<chessgame::Point> validMoves = getValidMoves(board, playerColor);
+    chessgame::MoveList validMoves;
+    getValidMoves(board, playerColor, validMoves);
     
     // 如果没有合法移动，返回虚着
     if (validMoves.empty()) {
@@ -23,8 +25,8 @@ chessgame::Move RandomAI::calculateMove(
     }
     
     // 随机选择一个合法移动
-    std::uniform_int_distribution<size_t> dist(0, validMoves.size() - 1);
-    size_t index = dist(rng);
+    std::uniform_int_distribution<int> dist(0, validMoves.size() - 1);
+    int index = dist(rng);
     chessgame::Point selectedMove = validMoves[index];
     
     return chessgame::Move(selectedMove.x, selectedMove.y, playerColor, false, false);
@@ -38,11 +40,12 @@ AIType RandomAI::getType() const {
     return type;
 }
 
-std::vector<chessgame::Point> RandomAI::getValidMoves(
+void RandomAI::getValidMoves(
     const std::shared_ptr<chessgame::model::Board>& board,
-    chessgame::PieceType playerColor
+    chessgame::PieceType playerColor,
+    chessgame::MoveList& validMoves
 ) {
-    std::vector<chessgame::Point> validMoves;
+    validMoves.clear();
     int size = board->getSize();
     
     if (type == AIType::GOMOKU) {
@@ -54,6 +57,15 @@ std::vector<chessgame::Point> RandomAI::getValidMoves(
                 }
             }
         }
+    } else if (type == AIType::GO) {
+        // 围棋：空位且不是自杀
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                if (isValidGoMove(board, i, j, playerColor)) {
+                    validMoves.push_back({i, j});
+                }
+            }
+        }
     } else if (type == AIType::OTHELLO) {
         // 黑白棋：只有能翻转对手棋子的位置才是合法移动
         for (int i = 0; i < size; i++) {
@@ -64,8 +76,6 @@ std::vector<chessgame::Point> RandomAI::getValidMoves(
             }
         }
     }
-    
-    return validMoves;
 }
 
 bool RandomAI::isValidGomokuMove(
@@ -76,6 +86,16 @@ bool RandomAI::isValidGomokuMove(
     return board->getPiece(x, y) == chessgame::EMPTY;
 }
 
+bool RandomAI::isValidGoMove(
+    const std::shared_ptr<chessgame::model::Board>& board,
+    int x, int y,
+    chessgame::PieceType playerColor
+) {
+    // 借用围棋规则判断禁入点（规则内部临时落子后会还原棋盘）
+    chessgame::model::GoRule rule(board.get());
+    return rule.isValidMove(x, y, playerColor);
+}
+
 bool RandomAI::isValidOthelloMove(
     const std::shared_ptr<chessgame::model::Board>& board,
     int x, int y,
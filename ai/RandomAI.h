@@ -1,6 +1,7 @@
 #pragma once
 #include "AI.h"
 #include "../model/Board.h"
+#include "../utils/MoveList.h"
 #include <random>
 
 namespace chessgame::ai {
@@ -28,10 +29,11 @@ public:
     AIType getType() const override;
     
 private:
-    // 获取所有合法移动
-    std::vector<chessgame::Point> getValidMoves(
+    // 获取所有合法移动 (写入定长列表, 不做堆分配)
+    void getValidMoves(
         const std::shared_ptr<Board>& board,
-        chessgame::PieceType playerColor
+        chessgame::PieceType playerColor,
+        chessgame::MoveList& validMoves
     );
     
     // 五子棋的合法移动检查
@@ -40,6 +42,13 @@ private:
         int x, int y
     );
     
+    // 围棋的合法移动检查（非自杀）
+    bool isValidGoMove(
+        const std::shared_ptr<Board>& board,
+        int x, int y,
+        chessgame::PieceType playerColor
+    );
+    
     // 黑白棋的合法移动检查
     bool isValidOthelloMove(
         const std::shared_ptr<Board>& board,
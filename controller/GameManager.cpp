@@ -11,6 +11,7 @@
 #include <cmath>
 #include <fstream>
 #include <ctime>
+#include <unistd.h>
 
 using namespace chessgame::controller;
 
@@ -143,133 +144,209 @@ void GameManager::networkGameLoop() {
         startTurnTimer();
     }
     
+    // 标准输入、网络消息和回合计时都在这个线程上处理, 不再阻塞在输入上.
+    // 行缓冲在视图里: 对局结束时没处理的行留给之后的提示 (是否保存录像等)
+    bool skipEndBroadcast = false;
+    auto onInput = [this, &skipEndBroadcast](short) {
+        std::string line;
+        while (isNetworkGame && gameFacade->getGameStatus() == IN_PROGRESS && gameView->pollUserInput(line)) {
+            if (handleNetworkInput(line)) {
+                skipEndBroadcast = true;
+            }
+            needRedraw = true;
+        }
+        // 输入已关闭, 不再监听, 否则 poll 会一直返回可读
+        if (gameView->isInputClosed()) reactor->remove(STDIN_FILENO);
+    };
+    reactor->add(STDIN_FILENO, onInput);
+    // 开局前已经读进缓冲区的行不会再触发可读事件
+    onInput(0);
+    scheduleTurnTick();
+    
+    needRedraw = true;
     while (isNetworkGame && gameFacade->getGameStatus() == IN_PROGRESS) {
-        bool skipEndBroadcast = false;
-        // 更新时间计数
-        timeTick();
-        
-        // 显示当前棋盘状态（包含剩余时间信息）
-        std::string timeInfo = "";
-        if (gameFacade->getCurrentPlayer() == selfPieceType) {
-            timeInfo = "剩余时间: " + std::to_string(restTime) + "秒";
+        if (needRedraw) {
+            needRedraw = false;
+            displayNetworkBoard();
         }
-        
-        gameView->displayBoard(
-            gameFacade->getBoard(),
-            gameFacade->getCurrentPlayer(),
-            gameFacade->getGameType(),
-            timeInfo,
-            getPlayerName(BLACK),
-            getPlayerName(WHITE),
-            getPlayerStats(BLACK),
-            getPlayerStats(WHITE)
-        );
-        
-        // 检查是否轮到当前玩家
-        bool isMyTurn = (gameFacade->getCurrentPlayer() == selfPieceType);
-        
-        if (isMyTurn) {
-            // 获取用户输入
-            std::string input = gameView->getUserInput("请输入坐标 (格式: x,y) 或命令 (undo/quit/pass/resign): ");
-            
-            // 清理输入：去除前后空白字符
-            input.erase(0, input.find_first_not_of(" \t\r\n"));
-            input.erase(input.find_last_not_of(" \t\r\n") + 1);
-            
-            if (input == "quit") {
-                // 发送退出请求
-                network::NotifyInfo quitNotify{network::NotifyType::QUIT};
-                network::NetworkMessage quitMsg(network::MessageType::NOTIFY, quitNotify.serialize());
-                operateNetworkMessage(quitMsg, selfPieceType);
-                continue;
-            } else if (input == "undo") {
-                // 发送悔棋请求
-                if (undoRestTime > 0) {
-                    network::NotifyInfo undoNotify{network::NotifyType::UNDO};
-                    network::NetworkMessage undoMsg(network::MessageType::NOTIFY, undoNotify.serialize());
-                    operateNetworkMessage(undoMsg, selfPieceType);
-                } else {
-                    gameView->showError("悔棋次数已用完！");
-                }
-                continue;
-            }
-            
-            // 解析移动命令
-            std::unique_ptr<Command> command = parseCommand(input);
-            if (command) {
-                // 在执行命令之前提取坐标信息（因为executeCommand会move command）
-                int moveRow = -1, moveCol = -1;
-                bool isMoveCmd = false;
-                bool isPassCmd = false;
-                bool isResignCmd = false;
-                
-                MoveCommand* moveCmd = dynamic_cast<MoveCommand*>(command.get());
-                if (moveCmd) {
-                    moveRow = moveCmd->getX();
-                    moveCol = moveCmd->getY();
-                    isMoveCmd = true;
-                } else {
-                    PassCommand* passCmd = dynamic_cast<PassCommand*>(command.get());
-                    ResignCommand* resignCmd = dynamic_cast<ResignCommand*>(command.get());
-                    if (passCmd) {
-                        isPassCmd = true;
-                    } else if (resignCmd) {
-                        isResignCmd = true;
-                    }
-                }
-                
-                // 执行命令
-                if (executeCommand(std::move(command))) {
-                    // 发送移动信息到网络
-                    if (isMoveCmd) {
-                        sendNetworkMove(moveRow, moveCol);
-                    } else if (isPassCmd) {
-                        network::NetworkMessage passMsg(network::MessageType::PASS, "");
-                        // 发送消息
-                        if (isHost && networkServer) {
-                            networkServer->broadcastMessage(passMsg);
-                        } else if (!isHost && networkClient) {
-                            networkClient->sendMessage(passMsg);
-                        }
-                        // 处理消息
-                        operateNetworkMessage(passMsg, selfPieceType);
-                    } else if (isResignCmd) {
-                        network::NetworkMessage resignMsg(network::MessageType::RESIGN, "");
-                        // 发送消息
-                        if (isHost && networkServer) {
-                            networkServer->broadcastMessage(resignMsg);
-                        } else if (!isHost && networkClient) {
-                            networkClient->sendMessage(resignMsg);
-                        }
-                        // 处理消息
-                        operateNetworkMessage(resignMsg, selfPieceType);
-                        skipEndBroadcast = true;
-                    }
-                }
-            } else {
-                gameView->showError("无效的输入格式! 请使用 x,y 格式或命令");
-            }
+        reactor->runOnce();
+    }
+    reactor->remove(STDIN_FILENO);
+    
+    // 检查游戏状态
+    GameStatus status = gameFacade->getGameStatus();
+    if (status != IN_PROGRESS && !skipEndBroadcast) {
+        network::NetworkMessage endMsg(network::MessageType::GAME_END, std::to_string(static_cast<int>(status)));
+        if (isHost && networkServer) {
+            networkServer->broadcastMessage(endMsg);
+        } else if (!isHost && networkClient) {
+            networkClient->sendMessage(endMsg);
+        }
+        handleGameEnd(status);
+    }
+}
+
+void GameManager::displayNetworkBoard() {
+    // 更新时间计数
+    timeTick();
+    
+    // 显示当前棋盘状态（包含剩余时间信息）
+    std::string timeInfo = "";
+    if (gameFacade->getCurrentPlayer() == selfPieceType) {
+        timeInfo = "剩余时间: " + std::to_string(restTime) + "秒";
+    }
+    
+    gameView->displayBoard(
+        gameFacade->getBoard(),
+        gameFacade->getCurrentPlayer(),
+        gameFacade->getGameType(),
+        timeInfo,
+        getPlayerName(BLACK),
+        getPlayerName(WHITE),
+        getPlayerStats(BLACK),
+        getPlayerStats(WHITE)
+    );
+    
+    // 提示符直接输出, 输入由事件循环在可读时读取
+    if (pendingRequest == network::NotifyType::UNDO) {
+        std::cout << "对手请求悔棋，是否同意？(y/n): " << std::flush;
+    } else if (pendingRequest == network::NotifyType::QUIT) {
+        std::cout << "对手请求退出游戏，是否同意？(y/n): " << std::flush;
+    } else if (gameFacade->getCurrentPlayer() == selfPieceType) {
+        std::cout << "请输入坐标 (格式: x,y) 或命令 (undo/quit/pass/resign): " << std::flush;
+    }
+}
+
+bool GameManager::handleNetworkInput(std::string input) {
+    // 清理输入：去除前后空白字符
+    input.erase(0, input.find_first_not_of(" \t\r\n"));
+    input.erase(input.find_last_not_of(" \t\r\n") + 1);
+    
+    if (reconnecting) {
+        if (!input.empty()) gameView->showError("正在重新连接服务器, 请稍候.");
+        return false;
+    }
+    
+    // 对手的请求优先答复, 轮到谁都可以
+    if (pendingRequest != network::NotifyType::NONE) {
+        replyToRequest(input);
+        return false;
+    }
+    
+    if (input == "quit") {
+        // 发送退出请求 (等待对手落子时也可以)
+        network::NotifyInfo quitNotify{network::NotifyType::QUIT};
+        network::NetworkMessage quitMsg(network::MessageType::NOTIFY, quitNotify.serialize());
+        operateNetworkMessage(quitMsg, selfPieceType);
+        return false;
+    }
+    
+    if (gameFacade->getCurrentPlayer() != selfPieceType) {
+        if (!input.empty()) {
+            gameView->showError("还没轮到你, 等待对手落子时只能输入 quit.");
+        }
+        return false;
+    }
+    
+    if (input == "undo") {
+        // 发送悔棋请求
+        if (undoRestTime > 0) {
+            network::NotifyInfo undoNotify{network::NotifyType::UNDO};
+            network::NetworkMessage undoMsg(network::MessageType::NOTIFY, undoNotify.serialize());
+            operateNetworkMessage(undoMsg, selfPieceType);
         } else {
-            // 不是我的回合，检查并处理网络消息
-            // 注意：消息处理已经在回调函数中完成，这里只需要等待
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            gameView->showError("悔棋次数已用完！");
         }
-        
-        // 检查游戏状态
-        GameStatus status = gameFacade->getGameStatus();
-        if (status != IN_PROGRESS) {
-            if (!skipEndBroadcast) {
-                network::NetworkMessage endMsg(network::MessageType::GAME_END, std::to_string(static_cast<int>(status)));
-                if (isHost && networkServer) {
-                    networkServer->broadcastMessage(endMsg);
-                } else if (!isHost && networkClient) {
-                    networkClient->sendMessage(endMsg);
-                }
-                handleGameEnd(status);
-            }
-            break;
+        return false;
+    }
+    
+    // 解析移动命令
+    std::unique_ptr<Command> command = parseCommand(input);
+    if (!command) {
+        gameView->showError("无效的输入格式! 请使用 x,y 格式或命令");
+        return false;
+    }
+    
+    // 在执行命令之前提取坐标信息（因为executeCommand会move command）
+    int moveRow = -1, moveCol = -1;
+    bool isMoveCmd = false;
+    bool isPassCmd = false;
+    bool isResignCmd = false;
+    
+    MoveCommand* moveCmd = dynamic_cast<MoveCommand*>(command.get());
+    if (moveCmd) {
+        moveRow = moveCmd->getX();
+        moveCol = moveCmd->getY();
+        isMoveCmd = true;
+    } else {
+        PassCommand* passCmd = dynamic_cast<PassCommand*>(command.get());
+        ResignCommand* resignCmd = dynamic_cast<ResignCommand*>(command.get());
+        if (passCmd) {
+            isPassCmd = true;
+        } else if (resignCmd) {
+            isResignCmd = true;
         }
     }
+    
+    // 执行命令
+    if (!executeCommand(std::move(command))) {
+        return false;
+    }
+    
+    // 发送移动信息到网络
+    if (isMoveCmd) {
+        sendNetworkMove(moveRow, moveCol);
+    } else if (isPassCmd) {
+        network::NetworkMessage passMsg(network::MessageType::PASS, "");
+        // 发送消息
+        if (isHost && networkServer) {
+            networkServer->broadcastMessage(passMsg);
+        } else if (!isHost && networkClient) {
+            networkClient->sendMessage(passMsg);
+        }
+        // 处理消息
+        operateNetworkMessage(passMsg, selfPieceType);
+    } else if (isResignCmd) {
+        network::NetworkMessage resignMsg(network::MessageType::RESIGN, "");
+        // 发送消息
+        if (isHost && networkServer) {
+            networkServer->broadcastMessage(resignMsg);
+        } else if (!isHost && networkClient) {
+            networkClient->sendMessage(resignMsg);
+        }
+        // 处理消息
+        operateNetworkMessage(resignMsg, selfPieceType);
+        return true;
+    }
+    return false;
+}
+
+void GameManager::replyToRequest(const std::string& input) {
+    network::NotifyType request = pendingRequest;
+    pendingRequest = network::NotifyType::NONE;
+    
+    bool agreed = (input == "y" || input == "Y");
+    network::NotifyInfo reply{agreed ? network::NotifyType::YES : network::NotifyType::NO};
+    network::NetworkMessage replyMsg(network::MessageType::NOTIFY, reply.serialize());
+    operateNetworkMessage(replyMsg, selfPieceType);
+    
+    // 同意对手退出后等待对手断开连接
+    if (request == network::NotifyType::QUIT && agreed) {
+        readyToQuit = true;
+    }
+}
+
+void GameManager::scheduleTurnTick() {
+    // 回合计时由定时器驱动, 玩家不输入时超时也能按时触发
+    reactor->runAfter(std::chrono::milliseconds(TURN_TICK_MS), [this]() {
+        if (!isNetworkGame) return;
+        PieceType before = gameFacade->getCurrentPlayer();
+        timeTick();
+        if (gameFacade->getCurrentPlayer() != before) {
+            needRedraw = true;
+        }
+        scheduleTurnTick();
+    });
 }
 
 void GameManager::showAccountMenu() {
@@ -539,10 +616,24 @@ std::unique_ptr<Command> GameManager::parseCommand(const std::string& input) {
     } else if (cmd == "restart") {
         return std::make_unique<RestartCommand>(gameFacade.get());
     } else if (cmd == "hint") {
-        // 切换提示显示
+        // 切换提示显示, 关闭提示时同时停止后台分析
         bool showHints = gameView->getShowHints();
         gameView->setShowHints(!showHints);
         gameView->showHint(showHints ? "提示已隐藏" : "提示已显示");
+        if (showHints) {
+            stopAnalysis();
+        } else {
+            updateAnalysis();
+        }
+        return nullptr;
+    } else if (cmd == "best") {
+        // 显示后台分析的推荐着法
+        if (!gameView->getShowHints()) {
+            gameView->showError("提示已关闭, 输入 'hint' 开启后台分析.");
+        } else {
+            updateAnalysis();
+            showAnalysisHint();
+        }
         return nullptr;
     } else {
         // 尝试解析为坐标
@@ -640,6 +731,7 @@ void GameManager::gameLoop() {
         // 检查游戏是否结束
         GameStatus status = gameFacade->getGameStatus();
         if (status != IN_PROGRESS) {
+            stopAnalysis();
             gameView->showGameResult(status);
             handleGameEnd(status);
             break;
@@ -658,6 +750,12 @@ void GameManager::gameLoop() {
             }
         } else {
             // 玩家回合
+            // 提示开启时在玩家思考期间分析局面
+            if (gameView->getShowHints()) {
+                updateAnalysis();
+                showAnalysisHint();
+            }
+            
             // 获取用户输入
             std::string input = gameView->getUserInput("请输入指令 > ");
             
@@ -694,6 +792,7 @@ void GameManager::gameLoop() {
                 getPlayerStats(BLACK),
                 getPlayerStats(WHITE)
             );
+            stopAnalysis();
             gameView->showGameResult(newStatus);
             handleGameEnd(newStatus);
             break;
@@ -864,19 +963,7 @@ void GameManager::initializeAIPlayers() {
     if (gameMode == GameMode::PVAI || gameMode == GameMode::AIVAI) {
         // 获取游戏类型
         GameType gameType = gameFacade->getGameType();
-        ai::AIType aiType;
-        switch (gameType) {
-            case GOMOKU: 
-            case GO:
-                aiType = ai::AIType::GOMOKU; // GO 使用 GOMOKU 的 AI
-                break;
-            case OTHELLO:
-                aiType = ai::AIType::OTHELLO;
-                break;
-            default:
-                aiType = ai::AIType::GOMOKU;
-                break;
-        }
+        ai::AIType aiType = ai::AIFactory::aiTypeForGame(gameType);
         
         // 选择AI级别
         ai::AILevel aiLevel = ai::AILevel::LEVEL1; // 默认为一级AI
@@ -1001,12 +1088,67 @@ void GameManager::aiTurn() {
         return;
     }
     
+    // AI思考时暂停分析, 把CPU留给AI
+    if (analysisService) {
+        analysisService->clearPosition();
+        analyzedPosition.clear();
+    }
+    
     // 显示AI思考信息
-    gameView->showHint("AI正在思考...");
+    gameView->showHint("AI正在思考... (stop: 立即落子, undo: 悔棋, quit/resign: 认输)");
+    
+    // 在棋盘拷贝上异步计算, 思考期间主循环仍然响应玩家输入
+    auto boardCopy = std::make_shared<model::Board>(gameFacade->getBoard());
+    ai::AIMoveHandle pendingMove = currentAI->makeMoveAsync(boardCopy);
+    
+    auto lastReport = std::chrono::steady_clock::now();
+    int lastReportedDepth = 0;
+    while (!pendingMove.waitFor(std::chrono::milliseconds(AI_POLL_INTERVAL_MS))) {
+        // 每秒显示一次搜索进度
+        ai::SearchProgress progress;
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(1) && pendingMove.getProgress(progress) &&
+            progress.depth != lastReportedDepth) {
+            std::ostringstream oss;
+            oss << "AI思考中: 已搜索 " << progress.depth << " 次, 当前最佳 ("
+                << progress.bestMove.x + 1 << ", " << progress.bestMove.y + 1 << "), 评估 "
+                << std::fixed << std::setprecision(1) << progress.evaluation * 100 << "%";
+            gameView->showMessage(oss.str());
+            lastReport = now;
+            lastReportedDepth = progress.depth;
+        }
+        
+        // 经视图的行缓冲取输入: 一次读到的多行 (例如连续输入的 stop) 都能及时处理
+        std::string input;
+        if (!gameView->pollUserInput(input)) continue;
+        
+        std::string cmd;
+        std::istringstream(input) >> cmd;
+        std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+        
+        if (cmd.empty()) {
+            continue;
+        } else if (cmd == "stop") {
+            // 停止搜索, 采用目前为止的最佳着法
+            pendingMove.cancel();
+        } else if (cmd == "undo" || cmd == "quit" || cmd == "resign") {
+            if (cmd != "undo") {
+                std::string confirm = gameView->getUserInput("确认认输/退出吗? (y/n): ");
+                if (confirm != "y" && confirm != "Y") continue;
+            }
+            // 放弃本次搜索结果, 执行玩家的指令
+            currentAI->cancelPendingMove();
+            auto command = parseCommand(cmd);
+            if (command && !executeCommand(std::move(command))) {
+                gameView->showError("操作失败, 请重试.");
+            }
+            return;
+        } else {
+            gameView->showError("AI思考中, 只能输入 stop/undo/quit/resign.");
+        }
+    }
     
-    // 获取AI的移动
-    auto boardPtr = std::shared_ptr<model::Board>(&gameFacade->getBoard(), [](model::Board*){});
-    Move aiMove = currentAI->makeMove(boardPtr);
+    Move aiMove = pendingMove.get();
     
     // 执行AI的移动
     if (aiMove.isPass) {
@@ -1020,6 +1162,57 @@ void GameManager::aiTurn() {
     }
 }
 
+void GameManager::updateAnalysis() {
+    if (!gameView->getShowHints() || gameFacade->getGameStatus() != IN_PROGRESS) return;
+    
+    ai::AIType type = ai::AIFactory::aiTypeForGame(gameFacade->getGameType());
+    if (!analysisService || analysisService->getType() != type) {
+        analysisService = std::make_unique<ai::AnalysisService>(type, ANALYSIS_TOP_K, ANALYSIS_CPU_CORES);
+        analyzedPosition.clear();
+    }
+    
+    // 局面 (含劫争禁入点) 未变时继续之前的搜索
+    PieceType player = gameFacade->getCurrentPlayer();
+    Point ko = gameFacade->getBoard().getKoPoint();
+    std::string key = gameFacade->getBoard().serialize() + ";" + std::to_string(player) +
+                      ";" + std::to_string(ko.x) + "," + std::to_string(ko.y);
+    if (key == analyzedPosition) return;
+    analyzedPosition = key;
+    analysisService->setPosition(gameFacade->getBoard(), player);
+}
+
+void GameManager::stopAnalysis() {
+    analysisService.reset();
+    analyzedPosition.clear();
+}
+
+void GameManager::showAnalysisHint() {
+    ai::AnalysisResult result;
+    if (!analysisService || !analysisService->getAnalysis(result) || result.lines.empty()) {
+        gameView->showHint("正在分析局面, 稍后输入 'best' 查看推荐着法.");
+        return;
+    }
+    
+    bool isGo = analysisService->getType() == ai::AIType::GO;
+    std::ostringstream oss;
+    oss << "推荐着法 (已搜索 " << result.nodes << " 次):";
+    for (size_t i = 0; i < result.lines.size(); ++i) {
+        const ai::ScoredMove& line = result.lines[i];
+        oss << "  " << i + 1 << ". ";
+        if (line.move.isPass) {
+            oss << "pass";
+        } else {
+            oss << "(" << line.move.x + 1 << ", " << line.move.y + 1 << ")";
+        }
+        if (isGo) {
+            oss << " 胜率 " << std::fixed << std::setprecision(1) << line.evaluation * 100 << "%";
+        } else {
+            oss << " 评分 " << static_cast<int>(line.evaluation);
+        }
+    }
+    gameView->showHint(oss.str());
+}
+
 void GameManager::startRecording() {
     if (isRecording) {
         gameView->showError("已经在录像中!");
@@ -1341,29 +1534,40 @@ void GameManager::handleGameEnd(GameStatus status) {
 
 // 网络相关方法实现
 void GameManager::startNetworkServer() {
-    networkServer = std::make_unique<network::NetworkServer>();
+    networkServer = std::make_unique<network::NetworkServer>(network::NetworkConfig::MAX_CONNECTIONS);
+    gameStateReceived = false;
+    pendingRequest = network::NotifyType::NONE;
     
     // 设置消息回调
+    reactor = std::make_unique<network::ClientReactor>();
+    
+    // 回调在服务器的 I/O 线程上调用, 只把事件转交给主线程的事件循环处理
     networkServer->setMessageCallback([this](int clientSocket, const network::NetworkMessage& message) {
-        handleNetworkMessage(clientSocket, message);
+        reactor->post([this, clientSocket, message]() {
+            handleNetworkMessage(clientSocket, message);
+            needRedraw = true;
+        });
     });
     
     networkServer->setConnectCallback([this](int clientSocket) {
-        std::cout << "玩家已连接，准备开始游戏" << std::endl;
-        // 等待一小段时间，确保客户端接收线程已启动
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        // 发送游戏开始消息（告知客户端是白棋）
-        network::NetworkMessage startMsg(network::MessageType::GAME_START, "WHITE");
-        networkServer->sendToClient(clientSocket, startMsg);
-        
-        // 发送当前游戏状态（包含游戏类型、棋盘大小和棋盘状态）
-        sendGameState();
+        reactor->post([this, clientSocket]() {
+            std::cout << "玩家已连接，准备开始游戏" << std::endl;
+            
+            // 发送游戏开始消息（告知客户端是白棋）
+            network::NetworkMessage startMsg(network::MessageType::GAME_START, "WHITE");
+            networkServer->sendToClient(clientSocket, startMsg);
+            
+            // 发送当前游戏状态（包含游戏类型、棋盘大小和棋盘状态）
+            sendGameState();
+            gameStateReceived = true;   // 主机: 开局局面已发出
+        });
     });
     
     networkServer->setDisconnectCallback([this](int clientSocket) {
-        std::cout << "玩家 " << clientSocket << " 断开连接" << std::endl;
-        handleNetworkDisconnection();
+        reactor->post([this, clientSocket]() {
+            std::cout << "玩家 " << clientSocket << " 断开连接" << std::endl;
+            handleNetworkDisconnection();
+        });
     });
     
     if (networkServer->start()) {
@@ -1391,19 +1595,39 @@ void GameManager::startNetworkServer() {
 
 void GameManager::connectToServer(const std::string& serverIP) {
     networkClient = std::make_unique<network::NetworkClient>();
+    syncSequence = NO_SYNC_SEQUENCE;
+    gameStateReceived = false;
+    pendingRequest = network::NotifyType::NONE;
+    serverAddress = serverIP;
+    sessionToken.clear();
+    reconnecting = false;
+    unconfirmedMove.reset();
     
-    // 设置消息回调
+    reactor = std::make_unique<network::ClientReactor>();
+    
+    // 设置消息回调: 在接收线程上调用, 只把消息转交给主线程的事件循环处理
     networkClient->setMessageCallback([this](const network::NetworkMessage& message) {
-        handleClientMessage(message);
+        reactor->post([this, message]() {
+            handleClientMessage(message);
+            needRedraw = true;
+        });
     });
     
     networkClient->setConnectCallback([this]() {
         std::cout << "成功连接到服务器" << std::endl;
     });
     
+    // 同样转交给主线程; 这里不释放 networkClient, 由主线程退出循环后释放
     networkClient->setDisconnectCallback([this]() {
-        std::cout << "与服务器断开连接" << std::endl;
-        handleNetworkDisconnection();
+        reactor->post([this]() {
+            std::cout << "与服务器断开连接" << std::endl;
+            // 服务器为对局保留着座位, 先尝试重连
+            if (!sessionToken.empty() && gameStateReceived && gameFacade->getGameStatus() == IN_PROGRESS) {
+                beginReconnect();
+                return;
+            }
+            isNetworkGame = false;
+        });
     });
     
     if (networkClient->connect(serverIP)) {
@@ -1447,19 +1671,49 @@ void GameManager::handleNetworkMessage(int clientSocket, const network::NetworkM
 }
 
 void GameManager::handleClientMessage(const network::NetworkMessage& message) {
-    std::cerr << "[DEBUG CLIENT] handleClientMessage: msgType=" << static_cast<int>(message.type) << ", data=" << message.data.substr(0, 50) << std::endl;
+    std::cerr << "[DEBUG CLIENT] handleClientMessage: msgType=" << static_cast<int>(message.type) << ", data=" << message.text().substr(0, 50) << std::endl;
     // #region agent log
     {
         std::ofstream logFile("/mnt/data/wgl/.cursor/debug.log", std::ios::app);
         if (logFile.is_open()) {
-            logFile << "{\"id\":\"log_" << std::time(nullptr) << "_clientmsg\",\"timestamp\":" << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() << ",\"location\":\"GameManager.cpp:handleClientMessage\",\"message\":\"handleClientMessage called\",\"data\":{\"msgType\":" << static_cast<int>(message.type) << ",\"data\":\"" << message.data.substr(0, 50) << "\"},\"sessionId\":\"debug-session\",\"runId\":\"run1\",\"hypothesisId\":\"C\"}\n";
+            logFile << "{\"id\":\"log_" << std::time(nullptr) << "_clientmsg\",\"timestamp\":" << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() << ",\"location\":\"GameManager.cpp:handleClientMessage\",\"message\":\"handleClientMessage called\",\"data\":{\"msgType\":" << static_cast<int>(message.type) << ",\"data\":\"" << message.text().substr(0, 50) << "\"},\"sessionId\":\"debug-session\",\"runId\":\"run1\",\"hypothesisId\":\"C\"}\n";
             logFile.flush();
             logFile.close();
         }
     }
     // #endregion
     
+    // 重连后收到错误说明会话已失效 (例如超过了保留时间), 对局无法继续
+    if (reconnecting && message.type == network::MessageType::ERROR) {
+        gameView->showError("无法恢复对局: " + message.data);
+        reconnecting = false;
+        isNetworkGame = false;
+        return;
+    }
+    
+    // 自己的落子被拒绝: 本地已执行的结果作废, 以服务器的完整局面为准
+    if (message.type == network::MessageType::ERROR && unconfirmedMove) {
+        unconfirmedMove.reset();
+        syncSequence = NO_SYNC_SEQUENCE;
+        networkClient->sendMessage(network::NetworkMessage(network::MessageType::SYNC_REQUEST, ""));
+    }
+    
     switch (message.type) {
+        case network::MessageType::SESSION_TOKEN:
+            sessionToken = message.data;
+            break;
+        
+        case network::MessageType::SESSION_RESUME:
+            // 断线期间错过的增量已补发完毕, 按当前局面继续; 补发的增量中没有自己最后的落子,
+            // 说明服务器没有收到它 (本地已经执行过), 重发一次
+            reconnecting = false;
+            if (unconfirmedMove) {
+                networkClient->sendMessage(unconfirmedMove->toMessage());
+            }
+            gameView->showMessage("已重新连接，继续对局");
+            onOpponentMoveApplied();
+            break;
+        
         case network::MessageType::GAME_START: {
             // 确定自己的棋子颜色
             if (message.data == "WHITE") {
@@ -1479,8 +1733,37 @@ void GameManager::handleClientMessage(const network::NetworkMessage& message) {
         }
         
         case network::MessageType::BOARD_SYNC: {
-            network::GameStateInfo stateInfo = network::GameStateInfo::deserialize(message.data);
+            network::GameStateInfo stateInfo{GOMOKU, BLACK, IN_PROGRESS, 0, {}};
+            if (!network::GameStateInfo::parse(message, stateInfo)) {
+                std::cerr << "收到无效的棋盘同步消息" << std::endl;
+                break;
+            }
             syncGameState(stateInfo);
+            gameStateReceived = true;
+            break;
+        }
+        
+        case network::MessageType::BOARD_SNAPSHOT: {
+            // 完整局面只在开局和序号断档时收到, 之后靠增量同步
+            network::BoardSnapshotInfo snapshot{0, network::GameStateInfo{GOMOKU, BLACK, IN_PROGRESS, 0, {}}};
+            if (!network::BoardSnapshotInfo::parse(message, snapshot)) {
+                std::cerr << "收到无效的棋盘快照消息" << std::endl;
+                break;
+            }
+            syncGameState(snapshot.state);
+            syncSequence = snapshot.sequence;
+            unconfirmedMove.reset();
+            gameStateReceived = true;
+            break;
+        }
+        
+        case network::MessageType::BOARD_DELTA: {
+            network::BoardDeltaInfo delta{0, EMPTY, EMPTY, IN_PROGRESS, {}};
+            if (!network::BoardDeltaInfo::parse(message, delta)) {
+                std::cerr << "收到无效的棋盘增量消息" << std::endl;
+                break;
+            }
+            applyBoardDelta(delta);
             break;
         }
         
@@ -1501,7 +1784,7 @@ void GameManager::handleClientMessage(const network::NetworkMessage& message) {
 }
 
 void GameManager::sendNetworkMove(int row, int col) {
-    if (!isNetworkGame) {
+    if (!isNetworkGame || reconnecting) {
         return;
     }
     
@@ -1509,7 +1792,7 @@ void GameManager::sendNetworkMove(int row, int col) {
     PieceType movingPlayer = selfPieceType;
     
     network::MoveInfo moveInfo{row, col, movingPlayer};
-    network::NetworkMessage moveMsg(network::MessageType::MOVE, moveInfo.serialize());
+    network::NetworkMessage moveMsg = moveInfo.toMessage();
     
     // 发送消息到网络
     bool sendSuccess = false;
@@ -1518,6 +1801,8 @@ void GameManager::sendNetworkMove(int row, int col) {
         sendSuccess = true;
     } else if (!isHost && networkClient) {
         sendSuccess = networkClient->sendMessage(moveMsg);
+        // 独立服务器以增量确认落子; 发送失败或确认之前断线时, 重连后重发
+        if (!sessionToken.empty()) unconfirmedMove = moveInfo;
     }
     
     // 处理消息（切换回合等）
@@ -1527,28 +1812,25 @@ void GameManager::sendNetworkMove(int row, int col) {
 void GameManager::sendGameState() {
     if (!isNetworkGame) return;
     
-    // 序列化棋盘状态
-    std::ostringstream boardStream;
+    // 当前局面, 直接按格编码
     const auto& board = gameFacade->getBoard();
     int size = board.getSize();
     
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            boardStream << static_cast<int>(board.getPiece(i, j));
-            if (i < size - 1 || j < size - 1) {
-                boardStream << ",";
-            }
-        }
-    }
-    
     network::GameStateInfo stateInfo{
         gameFacade->getGameType(),
         gameFacade->getCurrentPlayer(),
         gameFacade->getGameStatus(),
-        boardStream.str()
+        size,
+        {}
     };
+    stateInfo.cells.reserve(size * size);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            stateInfo.cells.push_back(board.getPiece(i, j));
+        }
+    }
     
-    network::NetworkMessage stateMsg(network::MessageType::BOARD_SYNC, stateInfo.serialize());
+    network::NetworkMessage stateMsg = stateInfo.toMessage();
     
     if (isHost && networkServer) {
         networkServer->broadcastMessage(stateMsg);
@@ -1557,43 +1839,83 @@ void GameManager::sendGameState() {
     }
 }
 
-void GameManager::syncGameState(const network::GameStateInfo& stateInfo) {
-    // 恢复游戏类型
-    gameFacade->setGameType(stateInfo.gameType);
+void GameManager::onOpponentMoveApplied() {
+    // 显示更新后的棋盘
+    gameView->displayBoard(
+        gameFacade->getBoard(),
+        gameFacade->getCurrentPlayer(),
+        gameFacade->getGameType(),
+        "",
+        getPlayerName(BLACK),
+        getPlayerName(WHITE),
+        getPlayerStats(BLACK),
+        getPlayerStats(WHITE)
+    );
     
-    // 计算棋盘大小（从序列化的棋盘状态推断）
-    std::istringstream boardStream(stateInfo.boardState);
-    std::string cell;
-    int boardSize = 0;
+    // 检查游戏是否结束
+    GameStatus status = gameFacade->getGameStatus();
+    if (status != IN_PROGRESS) {
+        handleGameEnd(status);
+    } else {
+        // makeMove已经切换了当前玩家，这里只需要重置悔棋次数和计时器
+        undoRestTime = 2;
+        restTime = TURN_MAX_TIME;
+        // 如果是自己的回合，开始计时
+        if (gameFacade->getCurrentPlayer() == selfPieceType) {
+            startTurnTimer();
+        }
+    }
+}
+
+void GameManager::applyBoardDelta(const network::BoardDeltaInfo& delta) {
+    // 尚未收到快照, 或是重复的增量
+    if (syncSequence == NO_SYNC_SEQUENCE || delta.sequence <= syncSequence) return;
+    
+    // 序号断档: 丢弃本地状态, 向服务器请求完整局面
+    if (delta.sequence != syncSequence + 1) {
+        std::cerr << "棋盘同步序号断档 (期望 " << syncSequence + 1 << ", 收到 " << delta.sequence << ")，请求完整局面" << std::endl;
+        syncSequence = NO_SYNC_SEQUENCE;
+        if (networkClient) {
+            networkClient->sendMessage(network::NetworkMessage(network::MessageType::SYNC_REQUEST, ""));
+        }
+        return;
+    }
     
-    // 计算行数来确定棋盘大小
-    std::string tempLine = stateInfo.boardState;
-    size_t pos = 0;
-    while ((pos = tempLine.find(',')) != std::string::npos) {
-        boardSize++;
-        tempLine.erase(0, pos + 1);
+    auto& board = gameFacade->getBoard();
+    for (const network::CellChange& change : delta.changes) {
+        board.setPiece(change.row, change.col, change.piece);
     }
-    boardSize++; // 最后一项没有逗号
+    // 对手的着法没有经过本地规则, 劫争由服务器判断
+    if (delta.player != selfPieceType) board.setKoPoint(-1, -1);
+    gameFacade->setCurrentPlayer(delta.currentPlayer);
+    gameFacade->setGameStatus(delta.gameStatus);
+    syncSequence = delta.sequence;
+    if (delta.player == selfPieceType && !delta.changes.empty()) unconfirmedMove.reset();
     
-    // 计算实际棋盘大小（平方根）
-    int size = static_cast<int>(std::sqrt(boardSize));
+    // 自己的落子已经在本地执行过, 服务器的结果只用来校正 (例如提子);
+    // 不含变化格的增量 (虚着、认输、超时) 之前已经收到原消息处理过
+    if (delta.player != selfPieceType && !delta.changes.empty()) {
+        onOpponentMoveApplied();
+    }
+}
+
+void GameManager::syncGameState(const network::GameStateInfo& stateInfo) {
+    // 恢复游戏类型
+    gameFacade->setGameType(stateInfo.gameType);
     
-    // 重新初始化棋盘以确保大小正确
+    // 重新初始化棋盘以确保大小正确 (解析时已检查格数与边长相符)
+    int size = stateInfo.boardSize;
     gameFacade->initGame(stateInfo.gameType, size);
     
     // 恢复棋盘状态
-    boardStream.clear();
-    boardStream.str(stateInfo.boardState);
     auto& board = gameFacade->getBoard();
-    
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
-            if (std::getline(boardStream, cell, ',')) {
-                PieceType piece = static_cast<PieceType>(std::stoi(cell));
-                board.setPiece(i, j, piece);
-            }
+            board.setPiece(i, j, stateInfo.cells[i * size + j]);
         }
     }
+    gameFacade->setCurrentPlayer(stateInfo.currentPlayer);
+    gameFacade->setGameStatus(stateInfo.gameStatus);
     
     // 显示同步后的棋盘
     gameView->displayBoard(
@@ -1608,13 +1930,43 @@ void GameManager::syncGameState(const network::GameStateInfo& stateInfo) {
     );
 }
 
+void GameManager::beginReconnect() {
+    if (!reconnecting) {
+        reconnecting = true;
+        reconnectDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(network::NetworkConfig::SESSION_GRACE_PERIOD);
+        gameView->showMessage("与服务器的连接中断，正在重新连接...");
+    }
+    tryReconnect();
+}
+
+void GameManager::tryReconnect() {
+    if (!reconnecting || !isNetworkGame || !networkClient) return;
+    
+    // 回收旧连接 (接收线程已经退出) 后用同一个客户端重新连接
+    networkClient->disconnect();
+    if (networkClient->connect(serverAddress)) {
+        // 服务器补发已确认序号之后的增量, 完成后回复 SESSION_RESUME
+        std::string request = sessionToken + "," + std::to_string(syncSequence);
+        networkClient->sendMessage(network::NetworkMessage(network::MessageType::SESSION_RESUME, request));
+        return;
+    }
+    
+    if (std::chrono::steady_clock::now() >= reconnectDeadline) {
+        gameView->showError("重新连接失败，对局结束");
+        reconnecting = false;
+        isNetworkGame = false;
+        return;
+    }
+    reactor->runAfter(std::chrono::milliseconds(RECONNECT_INTERVAL_MS), [this]() { tryReconnect(); });
+}
+
 void GameManager::handleNetworkDisconnection() {
     isNetworkGame = false;
     
     // 只有当服务器主动停止时才停止服务器，而不是因为某个客户端断开连接
+    // 只停止不释放, 由网络对战菜单在网络游戏结束后释放
     if (isHost && networkServer) {
         networkServer->stop();
-        networkServer.reset();
     }
     
     if (networkClient) {
@@ -1651,37 +2003,17 @@ void GameManager::operateNetworkMessage(const network::NetworkMessage& message,
     // 处理消息
     switch (message.type) {
         case network::MessageType::MOVE: {
-            network::MoveInfo moveInfo = network::MoveInfo::deserialize(message.data);
+            network::MoveInfo moveInfo{-1, -1, EMPTY};
+            if (!network::MoveInfo::parse(message, moveInfo)) {
+                std::cerr << "收到无效的落子消息" << std::endl;
+                break;
+            }
             
             // 只有对手的消息才需要执行移动（自己的移动已经在executeCommand中执行了）
             if (playerState != selfPieceType) {
                 // 执行对手的移动（makeMove会自动切换当前玩家）
                 if (gameFacade->makeMove(moveInfo.row, moveInfo.col, moveInfo.player)) {
-                    // 显示更新后的棋盘
-                    gameView->displayBoard(
-                        gameFacade->getBoard(),
-                        gameFacade->getCurrentPlayer(),
-                        gameFacade->getGameType(),
-                        "",
-                        getPlayerName(BLACK),
-                        getPlayerName(WHITE),
-                        getPlayerStats(BLACK),
-                        getPlayerStats(WHITE)
-                    );
-                    
-                    // 检查游戏是否结束
-                    GameStatus status = gameFacade->getGameStatus();
-                    if (status != IN_PROGRESS) {
-                        handleGameEnd(status);
-                    } else {
-                        // makeMove已经切换了当前玩家，这里只需要重置悔棋次数和计时器
-                        undoRestTime = 2;
-                        restTime = TURN_MAX_TIME;
-                        // 如果是自己的回合，开始计时
-                        if (gameFacade->getCurrentPlayer() == selfPieceType) {
-                            startTurnTimer();
-                        }
-                    }
+                    onOpponentMoveApplied();
                 }
             } else {
                 // 自己的移动已经在executeCommand中执行，makeMove已经切换了当前玩家
@@ -1697,13 +2029,21 @@ void GameManager::operateNetworkMessage(const network::NetworkMessage& message,
         }
         
         case network::MessageType::NOTIFY: {
-            network::NotifyInfo notifyInfo = network::NotifyInfo::deserialize(message.data);
+            network::NotifyInfo notifyInfo{network::NotifyType::NONE};
+            if (!network::NotifyInfo::parse(message.data, notifyInfo)) {
+                std::cerr << "收到无效的通知消息" << std::endl;
+                break;
+            }
             notifyMessageHandler(notifyInfo, playerState);
             break;
         }
         
         case network::MessageType::TIMECOUNT: {
-            network::TimeCountInfo timeInfo = network::TimeCountInfo::deserialize(message.data);
+            network::TimeCountInfo timeInfo{0};
+            if (!network::TimeCountInfo::parse(message.data, timeInfo)) {
+                std::cerr << "收到无效的计时消息" << std::endl;
+                break;
+            }
             if (playerState == selfPieceType) {
                 selfTotalTimeUsed += timeInfo.timeCount;
             } else {
@@ -1746,17 +2086,8 @@ void GameManager::notifyMessageHandler(const network::NotifyInfo& notifyInfo, Pi
             }
             readyToUndo = true;
             if (playerState != selfPieceType) {
-                // 对手请求悔棋，询问是否同意
-                std::string response = gameView->getUserInput("对手请求悔棋，是否同意？(y/n): ");
-                if (response == "y" || response == "Y") {
-                    network::NotifyInfo yesNotify{network::NotifyType::YES};
-                    network::NetworkMessage yesMsg(network::MessageType::NOTIFY, yesNotify.serialize());
-                    operateNetworkMessage(yesMsg, selfPieceType);
-                } else {
-                    network::NotifyInfo noNotify{network::NotifyType::NO};
-                    network::NetworkMessage noMsg(network::MessageType::NOTIFY, noNotify.serialize());
-                    operateNetworkMessage(noMsg, selfPieceType);
-                }
+                // 对手请求悔棋: 显示棋盘时询问, 由下一行输入答复 (replyToRequest)
+                pendingRequest = network::NotifyType::UNDO;
             } else {
                 // 自己请求悔棋，等待响应
                 gameView->showMessage("等待对手响应悔棋请求...");
@@ -1765,22 +2096,13 @@ void GameManager::notifyMessageHandler(const network::NotifyInfo& notifyInfo, Pi
             
         case network::NotifyType::QUIT:
             if (playerState != selfPieceType) {
-                // 对手请求退出
-                std::string response = gameView->getUserInput("对手请求退出游戏，是否同意？(y/n): ");
-                if (response == "y" || response == "Y") {
-                    network::NotifyInfo yesNotify{network::NotifyType::YES};
-                    network::NetworkMessage yesMsg(network::MessageType::NOTIFY, yesNotify.serialize());
-                    operateNetworkMessage(yesMsg, selfPieceType);
-                } else {
-                    network::NotifyInfo noNotify{network::NotifyType::NO};
-                    network::NetworkMessage noMsg(network::MessageType::NOTIFY, noNotify.serialize());
-                    operateNetworkMessage(noMsg, selfPieceType);
-                }
+                // 对手请求退出: 同 UNDO, 答复后才进入等待退出状态
+                pendingRequest = network::NotifyType::QUIT;
             } else {
                 // 自己请求退出，等待响应
                 gameView->showMessage("等待对手响应退出请求...");
+                readyToQuit = true;
             }
-            readyToQuit = true;
             break;
             
         case network::NotifyType::YES:
@@ -1863,6 +2185,8 @@ void GameManager::checkTimeout() {
 }
 
 void GameManager::timeTick() {
+    // 重连期间不判超时, 由服务器的回合计时兜底
+    if (reconnecting) return;
     if (gameFacade->getCurrentPlayer() == selfPieceType) {
         auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - turnStartTime).count();
@@ -1900,9 +2224,9 @@ void GameManager::showNetworkMenu() {
                                     " (" + std::to_string(gameFacade->getBoard().getSize()) + "x" + 
                                     std::to_string(gameFacade->getBoard().getSize()) + ")");
                 
-                // 简单的等待循环，实际应用中可以添加超时机制
-                while (isNetworkGame && networkServer && networkServer->getConnectedClientCount() == 0) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                // 等待玩家连接, 连接事件在事件循环中处理 (发出开局局面)
+                while (isNetworkGame && !gameStateReceived) {
+                    reactor->runOnce();
                 }
                 
                 if (isNetworkGame && networkServer && networkServer->getConnectedClientCount() > 0) {
@@ -1910,6 +2234,11 @@ void GameManager::showNetworkMenu() {
                     networkGameLoop();
                 }
             }
+            if (networkServer) {
+                networkServer->stop();
+                networkServer.reset();
+            }
+            reactor.reset();
         } else if (choice == "2") {
             // 加入游戏房间
             std::string serverIP = gameView->getUserInput("请输入服务器IP地址: ");
@@ -1919,14 +2248,19 @@ void GameManager::showNetworkMenu() {
                     // 等待游戏开始
                     gameView->showMessage("等待游戏开始...");
                     
-                    // 等待主机发送游戏状态
-                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                    // 等待主机 (或服务器配对后) 发送开局局面
+                    while (isNetworkGame && !gameStateReceived) {
+                        reactor->runOnce();
+                    }
                     
                     if (isNetworkGame) {
                         // 网络游戏主循环
                         networkGameLoop();
                     }
                 }
+                // 连接意外断开时只结束了网络游戏, 在这里释放; 事件循环在网络线程结束后释放
+                networkClient.reset();
+                reactor.reset();
             }
         } else if (choice == "3") {
             break;
@@ -5,12 +5,15 @@
 #include "../view/GameView.h"
 #include "Command.h"
 #include "../ai/AI.h"
+#include "../ai/AnalysisService.h"
 #include "../recording/GameRecorder.h"
 #include "../account/AccountManager.h"
 #include "../network/NetworkServer.h"
 #include "../network/NetworkClient.h"
 #include "../network/NetworkProtocol.h"
+#include "../network/ClientReactor.h"
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace chessgame::controller {
@@ -33,6 +36,12 @@ private:
     std::unique_ptr<ai::AIPlayer> blackAI;
     std::unique_ptr<ai::AIPlayer> whiteAI;
     
+    // 提示开启时在后台分析当前局面
+    std::unique_ptr<ai::AnalysisService> analysisService;
+    std::string analyzedPosition;   // 正在分析的局面 (序列化棋盘 + 行棋方), 避免重复提交
+    static const int ANALYSIS_TOP_K = 3;
+    static constexpr double ANALYSIS_CPU_CORES = 1.0;  // 分析最多占用的核数
+    
     // 游戏模式
     GameMode gameMode;
     
@@ -46,6 +55,9 @@ private:
     account::LeaderboardManager leaderboardManager;
     
     // 网络相关
+    // 网络对局期间的事件循环: 网络线程只把消息转交给它, 输入、消息和回合计时都在主线程处理.
+    // 声明在 networkServer/networkClient 之前, 析构时网络线程先于它结束
+    std::unique_ptr<network::ClientReactor> reactor;
     std::unique_ptr<network::NetworkServer> networkServer;
     std::unique_ptr<network::NetworkClient> networkClient;
     bool isHost;
@@ -53,6 +65,23 @@ private:
     int networkPlayerType; // 1: 黑棋, 2: 白棋
     bool gameInitialized = false;
     
+    // 增量同步: 已应用的最后一个增量序号 (尚未收到快照时为 NO_SYNC_SEQUENCE)
+    static constexpr uint64_t NO_SYNC_SEQUENCE = UINT64_MAX;
+    uint64_t syncSequence = NO_SYNC_SEQUENCE;
+    bool gameStateReceived = false;   // 开局局面已同步 (客户端收到 BOARD_SYNC / BOARD_SNAPSHOT, 主机已发出)
+    
+    // 断线重连 (独立服务器): 开局时收到会话令牌, 断线后在座位保留期内重试连接并补发错过的增量
+    std::string serverAddress;
+    std::string sessionToken;
+    bool reconnecting = false;   // 重连中不接受输入、不计时
+    std::optional<network::MoveInfo> unconfirmedMove; // 已在本地执行、尚未收到服务器增量确认的自己的落子, 重连后重发
+    std::chrono::steady_clock::time_point reconnectDeadline;
+    static const int RECONNECT_INTERVAL_MS = 1000;
+    
+    bool needRedraw = false;   // 处理完事件后需要重新显示棋盘
+    // 对手的悔棋/退出请求, 等待玩家输入 y/n 答复 (NONE 表示没有)
+    network::NotifyType pendingRequest = network::NotifyType::NONE;
+    
     // 网络游戏回合管理（参考 GoBang）
     PieceType selfPieceType;  // 自己的棋子类型
     int restTime;             // 剩余时间（秒）
@@ -60,6 +89,8 @@ private:
     int opponentTotalTimeUsed;// 对手总用时
     int undoRestTime;         // 剩余悔棋次数
     static const int TURN_MAX_TIME = 30;  // 每回合最大时间
+    static const int AI_POLL_INTERVAL_MS = 20;  // AI思考时检查输入和进度的间隔
+    static const int TURN_TICK_MS = 1000;       // 网络对局回合计时的检查间隔
     std::chrono::steady_clock::time_point turnStartTime;  // 回合开始时间
     
     // 通知消息处理状态
@@ -90,6 +121,15 @@ private:
     // AI回合
     void aiTurn();
     
+    // 提示开启时开始分析当前局面
+    void updateAnalysis();
+    
+    // 停止后台分析
+    void stopAnalysis();
+    
+    // 显示当前局面的推荐着法 (不等待搜索)
+    void showAnalysisHint();
+    
     // 检查当前玩家是否是AI
     bool isCurrentPlayerAI() const;
     
@@ -135,6 +175,11 @@ private:
     
     // 网络游戏主循环
     void networkGameLoop();
+    void displayNetworkBoard();
+    // 处理网络对局中的一行输入, 返回 true 表示已自行处理了对局结束 (认输)
+    bool handleNetworkInput(std::string input);
+    void replyToRequest(const std::string& input);
+    void scheduleTurnTick();
     
     // 网络相关方法
     void startNetworkServer();
@@ -146,7 +191,11 @@ private:
     void sendNetworkMove(int row, int col);
     void sendGameState();
     void syncGameState(const network::GameStateInfo& state);
+    void applyBoardDelta(const network::BoardDeltaInfo& delta);
+    void onOpponentMoveApplied();
     void handleNetworkDisconnection();
+    void beginReconnect();
+    void tryReconnect();
     std::string getGameTypeName(GameType type);
     
     // 网络消息处理（参考 GoBang 的 Operate 方法）
@@ -100,6 +100,9 @@ bool GameFacade::passMove(PieceType player) {
     // 保存当前状态
     saveStateToMemento();
     
+    // 虚着后劫争禁入失效
+    board->setKoPoint(-1, -1);
+
     // 增加虚着计数
     passCount++;
     
@@ -87,6 +87,9 @@ public:
     
     // 减少虚着计数
     void decrementPassCount() { if (passCount > 0) passCount--; }
+
+    // 设置连续虚着次数 (恢复对局时使用)
+    void setPassCount(int count) { passCount = count; }
     
     // 设置游戏状态
     void setGameStatus(GameStatus status) { gameStatus = status; }
@@ -10,7 +10,7 @@ Board::Board(int s) : size(s) {
 }
 
 // 拷贝构造函数: 用于备忘录模式保存状态
-Board::Board(const Board& other) : size(other.size), grid(other.grid) {}
+Board::Board(const Board& other) : size(other.size), grid(other.grid), koPoint(other.koPoint) {}
 
 int Board::getSize() const { 
     return size; 
@@ -31,6 +31,15 @@ void Board::setPiece(int x, int y, chessgame::PieceType p) {
 
 void Board::clear() {
     for (auto& row : grid) std::fill(row.begin(), row.end(), chessgame::PieceType::EMPTY);
+    koPoint = {-1, -1};
+}
+
+chessgame::Point Board::getKoPoint() const {
+    return koPoint;
+}
+
+void Board::setKoPoint(int x, int y) {
+    koPoint = {x, y};
 }
 
 // 序列化用于存档
@@ -45,6 +54,8 @@ std::string Board::serialize() const {
 
 // 反序列化用于读档
 void Board::deserialize(std::stringstream& ss) {
+    // 存档不含劫争信息, 读档/悔棋后不再禁止提回
+    koPoint = {-1, -1};
     ss >> size;
     grid.resize(size, std::vector<chessgame::PieceType>(size));
     int temp;
@@ -8,6 +8,7 @@ class Board {
 private:
     int size;
     std::vector<std::vector<PieceType>> grid;
+    Point koPoint{-1, -1};   // 围棋劫争禁入点, 只约束下一手; 没有时为 (-1, -1)
 
 public:
     Board(int s);
@@ -19,6 +20,10 @@ public:
     PieceType getPiece(int x, int y) const;
     void setPiece(int x, int y, PieceType p);
     void clear();
+
+    // 打劫禁入点: 由围棋规则在落子后设置, 副本 (AI 搜索用) 随棋盘一起拷贝
+    Point getKoPoint() const;
+    void setKoPoint(int x, int y);
     
     // 序列化用于存档
     std::string serialize() const;
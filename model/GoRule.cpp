@@ -4,7 +4,7 @@
 
 using namespace chessgame::model;
 
-int GoRule::getLiberties(int x, int y, PieceType color, std::vector<Point>& group) const {
+int GoRule::getLiberties(int x, int y, PieceType color, PointList& group) const {
     // 重置访问标记
     for(int i=0; i<board->getSize(); ++i)
         for(int j=0; j<board->getSize(); ++j) visited[i][j] = false;
@@ -12,7 +12,7 @@ int GoRule::getLiberties(int x, int y, PieceType color, std::vector<Point>& grou
     return countLibertiesDFS(x, y, color, group);
 }
 
-int GoRule::countLibertiesDFS(int x, int y, PieceType color, std::vector<Point>& group) const {
+int GoRule::countLibertiesDFS(int x, int y, PieceType color, PointList& group) const {
     if (!board->isValidBounds(x, y)) return 0;
     if (visited[x][y]) return 0;
     
@@ -34,29 +34,36 @@ int GoRule::countLibertiesDFS(int x, int y, PieceType color, std::vector<Point>&
     return liberties;
 }
 
-void GoRule::capture(int x, int y, PieceType opponent) {
+int GoRule::capture(int x, int y, PieceType opponent, Point& lastCaptured) {
     int dx[] = {0, 0, 1, -1};
     int dy[] = {1, -1, 0, 0};
+    int captured = 0;
 
     for (int i = 0; i < 4; ++i) {
         int nx = x + dx[i];
         int ny = y + dy[i];
         if (board->isValidBounds(nx, ny) && board->getPiece(nx, ny) == opponent) {
-            std::vector<Point> group;
+            PointList group;
             if (getLiberties(nx, ny, opponent, group) == 0) {
                 // 气为0，提子
                 for (auto& p : group) {
                     board->setPiece(p.x, p.y, EMPTY);
+                    lastCaptured = p;
+                    captured++;
                 }
             }
         }
     }
+    return captured;
 }
 
 bool GoRule::isValidMove(int x, int y, PieceType player) const {
     if (!board->isValidBounds(x, y)) return false;
     if (board->getPiece(x, y) != EMPTY) return false;
 
+    // 劫争禁入: 上一手单提形成的劫, 不能马上提回
+    if (board->getKoPoint() == Point{x, y}) return false;
+
     // 临时落子测试
     board->setPiece(x, y, player);
     
@@ -71,7 +78,7 @@ bool GoRule::isValidMove(int x, int y, PieceType player) const {
         int nx = x + dx[i];
         int ny = y + dy[i];
         if (board->isValidBounds(nx, ny) && board->getPiece(nx, ny) == opponent) {
-            std::vector<Point> group;
+            PointList group;
             if (getLiberties(nx, ny, opponent, group) == 0) {
                 captures = true;
             }
@@ -81,7 +88,7 @@ bool GoRule::isValidMove(int x, int y, PieceType player) const {
     // 2. 如果没提子，检查自己是否有气 (禁入点判断)
     bool suicide = false;
     if (!captures) {
-        std::vector<Point> selfGroup;
+        PointList selfGroup;
         if (getLiberties(x, y, player, selfGroup) == 0) {
             suicide = true;
         }
@@ -90,17 +97,25 @@ bool GoRule::isValidMove(int x, int y, PieceType player) const {
     // 撤销临时落子
     board->setPiece(x, y, EMPTY);
 
-    // 简单劫禁入：避免立即打劫（上一手被吃点不能马上打回）。
-    // 这里省略更复杂的劫判断，实际规则需保留历史棋形对比。
-
     return !suicide;
 }
 
 void GoRule::makeMove(int x, int y, PieceType player) {
+    board->setKoPoint(-1, -1);
     if (x == -1 && y == -1) return; // 虚着
 
     board->setPiece(x, y, player);
-    capture(x, y, (player == BLACK) ? WHITE : BLACK);
+    Point lastCaptured{-1, -1};
+    int captured = capture(x, y, (player == BLACK) ? WHITE : BLACK, lastCaptured);
+
+    // 单子提单子且落子后只剩一口气: 形成劫, 对方下一手不能提回
+    // (只判断简单劫, 循环劫等需要比较历史棋形的情况不处理)
+    if (captured == 1) {
+        PointList group;
+        if (getLiberties(x, y, player, group) == 1 && group.size() == 1) {
+            board->setKoPoint(lastCaptured.x, lastCaptured.y);
+        }
+    }
 }
 
 chessgame::GameStatus GoRule::checkWin(int lastX, int lastY) {
@@ -1,5 +1,5 @@
 #include "Rule.h"
-#include <vector>
+#include "../utils/MoveList.h"
 
 namespace chessgame::model {
 class GoRule : public Rule {
@@ -7,13 +7,13 @@ private:
     mutable bool visited[19][19]; // 用于 dfs 计算棋子的气
 
     // 获取某个棋子所在群组的气
-    int getLiberties(int x, int y, PieceType color, std::vector<Point>& group) const;
+    int getLiberties(int x, int y, PieceType color, PointList& group) const;
     
     // DFS计算气
-    int countLibertiesDFS(int x, int y, PieceType color, std::vector<Point>& group) const;
+    int countLibertiesDFS(int x, int y, PieceType color, PointList& group) const;
 
-    // 提子
-    void capture(int x, int y, PieceType opponent);
+    // 提子: 返回提掉的子数, lastCaptured 为最后提掉的一子
+    int capture(int x, int y, PieceType opponent, Point& lastCaptured);
 
 public:
     GoRule(Board* b) : Rule(b) {}
@@ -46,7 +46,8 @@ bool Othello::makeMove(int x, int y) {
     }
     
     // 获取将被翻转的棋子
-    std::vector<Point> flipped = getFlippedPieces(x, y, currentPlayer);
+    PointList flipped;
+    getFlippedPieces(x, y, currentPlayer, flipped);
     
     // 放置棋子
     board->setPiece(x, y, currentPlayer);
@@ -293,19 +294,17 @@ bool Othello::isValidMove(int x, int y, PieceType player) const {
     return false;
 }
 
-std::vector<Point> Othello::getValidMoves(PieceType player) const {
-    std::vector<Point> validMoves;
+void Othello::getValidMoves(PieceType player, MoveList& moves) const {
+    moves.clear();
     int size = board->getSize();
     
     for (int i = 0; i < size; i++) {
         for (int j = 0; j < size; j++) {
             if (isValidMove(i, j, player)) {
-                validMoves.push_back({i, j});
+                moves.push_back({i, j});
             }
         }
     }
-    
-    return validMoves;
 }
 
 int Othello::countPieces(PieceType player) const {
@@ -348,15 +347,17 @@ bool Othello::checkDirection(int x, int y, int dx, int dy, PieceType player) con
     return false;
 }
 
-std::vector<Point> Othello::getFlippedPieces(int x, int y, PieceType player) const {
-    std::vector<Point> flippedPieces;
+void Othello::getFlippedPieces(int x, int y, PieceType player, PointList& flipped) const {
+    flipped.clear();
     int dx[] = {0, 1, 1, 1, 0, -1, -1, -1};
     int dy[] = {1, 1, 0, -1, -1, -1, 0, 1};
     
     for (int i = 0; i < 8; i++) {
-        std::vector<Point> directionFlips;
+        // 先记下本方向列表的起点, 没有以己方棋子收尾时回退
+        int start = flipped.size();
         int nx = x + dx[i];
         int ny = y + dy[i];
+        bool closed = false;
         
         while (nx >= 0 && nx < board->getSize() && ny >= 0 && ny < board->getSize()) {
             PieceType piece = board->getPiece(nx, ny);
@@ -366,29 +367,35 @@ std::vector<Point> Othello::getFlippedPieces(int x, int y, PieceType player) con
             }
             
             if (piece == player) {
-                // 找到自己的棋子，将路径上的对手棋子添加到翻转列表
-                flippedPieces.insert(flippedPieces.end(), directionFlips.begin(), directionFlips.end());
+                // 找到自己的棋子，路径上的对手棋子保留在翻转列表中
+                closed = true;
                 break;
             }
             
             // 对手的棋子
-            directionFlips.push_back({nx, ny});
+            flipped.push_back({nx, ny});
             nx += dx[i];
             ny += dy[i];
         }
+        
+        while (!closed && flipped.size() > start) flipped.pop_back();
     }
-    
-    return flippedPieces;
 }
 
-void Othello::flipPieces(const std::vector<Point>& pieces) {
+void Othello::flipPieces(const PointList& pieces) {
     for (const auto& p : pieces) {
         board->setPiece(p.x, p.y, currentPlayer);
     }
 }
 
 bool Othello::hasValidMoves(PieceType player) const {
-    return !getValidMoves(player).empty();
+    int size = board->getSize();
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            if (isValidMove(i, j, player)) return true;
+        }
+    }
+    return false;
 }
 
 void Othello::updateGameStatus() {
@@ -1,6 +1,7 @@
 #pragma once
 #include "AbstractGame.h"
 #include "../utils/Type.h"
+#include "../utils/MoveList.h"
 #include <memory>
 
 namespace chessgame::model {
@@ -12,8 +13,8 @@ private:
     
     // 黑白棋特有辅助方法
     bool checkDirection(int x, int y, int dx, int dy, PieceType player) const;
-    std::vector<Point> getFlippedPieces(int x, int y, PieceType player) const;
-    void flipPieces(const std::vector<Point>& pieces);
+    void getFlippedPieces(int x, int y, PieceType player, PointList& flipped) const;
+    void flipPieces(const PointList& pieces);
     bool hasValidMoves(PieceType player) const;
     void updateGameStatus();
 
@@ -38,7 +39,7 @@ public:
     
     // 黑白棋特有方法
     bool isValidMove(int x, int y, PieceType player) const;
-    std::vector<Point> getValidMoves(PieceType player) const;
+    void getValidMoves(PieceType player, MoveList& moves) const;
     int countPieces(PieceType player) const;
 };
 
@@ -18,34 +18,33 @@ bool OthelloRule::isValidMove(int x, int y, PieceType player) const {
     if (board->getPiece(x, y) != EMPTY) return false;
     
     // 检查是否能翻转对手的棋子
-    return !getFlippedPieces(x, y, player).empty();
+    for (int i = 0; i < 8; ++i) {
+        if (checkDirection(x, y, dx[i], dy[i], player)) return true;
+    }
+    return false;
 }
 
-std::vector<chessgame::Point> OthelloRule::getFlippedPieces(int x, int y, PieceType player) const {
-    std::vector<Point> flipped;
+void OthelloRule::getFlippedPieces(int x, int y, PieceType player, PointList& flipped) const {
+    flipped.clear();
     
     // 检查8个方向
     for (int i = 0; i < 8; ++i) {
-        std::vector<Point> directionFlipped;
         int nx = x + dx[i];
         int ny = y + dy[i];
         
-        // 寻找对手棋子
-        bool foundOpponent = false;
+        // 寻找对手棋子, 只记录数量, 确认可翻转后再回写坐标
+        int count = 0;
         while (board->isValidBounds(nx, ny) && board->getPiece(nx, ny) == getOpponent(player)) {
-            directionFlipped.push_back({nx, ny});
-            foundOpponent = true;
+            count++;
             nx += dx[i];
             ny += dy[i];
         }
         
         // 检查是否以自己的棋子结束
-        if (foundOpponent && board->isValidBounds(nx, ny) && board->getPiece(nx, ny) == player) {
-            flipped.insert(flipped.end(), directionFlipped.begin(), directionFlipped.end());
+        if (count > 0 && board->isValidBounds(nx, ny) && board->getPiece(nx, ny) == player) {
+            for (int k = 1; k <= count; ++k) flipped.push_back({x + k * dx[i], y + k * dy[i]});
         }
     }
-    
-    return flipped;
 }
 
 void OthelloRule::makeMove(int x, int y, PieceType player) {
@@ -76,22 +75,17 @@ bool OthelloRule::checkDirection(int x, int y, int dirX, int dirY, PieceType pla
 }
 
 void OthelloRule::flipDirection(int x, int y, int dirX, int dirY, PieceType player) {
-    std::vector<Point> toFlip;
+    // 检查是否以自己的棋子结束
+    if (!checkDirection(x, y, dirX, dirY, player)) return;
+    
+    // 翻转路径上的对手棋子
     int nx = x + dirX;
     int ny = y + dirY;
-    
-    // 收集需要翻转的对手棋子
-    while (board->isValidBounds(nx, ny) && board->getPiece(nx, ny) == getOpponent(player)) {
-        toFlip.push_back({nx, ny});
+    while (board->getPiece(nx, ny) == getOpponent(player)) {
+        board->setPiece(nx, ny, player);
         nx += dirX;
         ny += dirY;
     }
-    
-    // 检查是否以自己的棋子结束
-    if (!toFlip.empty() && board->isValidBounds(nx, ny) && board->getPiece(nx, ny) == player) {
-        // 翻转棋子
-        for (const auto& pos : toFlip) board->setPiece(pos.x, pos.y, player);
-    }
 }
 
 chessgame::GameStatus OthelloRule::checkWin(int lastX, int lastY) {
@@ -123,15 +117,13 @@ chessgame::GameStatus OthelloRule::checkWin(int lastX, int lastY) {
     return IN_PROGRESS;
 }
 
-std::vector<chessgame::Point> OthelloRule::getValidMoves(PieceType player) const {
-    std::vector<Point> moves;
+void OthelloRule::getValidMoves(PieceType player, MoveList& moves) const {
+    moves.clear();
     int size = board->getSize();
     
     for (int i = 0; i < size; ++i)
         for (int j = 0; j < size; ++j)
             if (isValidMove(i, j, player)) moves.push_back({i, j});
-    
-    return moves;
 }
 
 bool OthelloRule::hasValidMoves(PieceType player) const {
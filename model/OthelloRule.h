@@ -1,6 +1,6 @@
 #pragma once
 #include "Rule.h"
-#include <vector>
+#include "../utils/MoveList.h"
 
 namespace chessgame::model {
 
@@ -15,9 +15,6 @@ private:
     
     // 翻转某个方向的棋子
     void flipDirection(int x, int y, int dirX, int dirY, PieceType player);
-    
-    // 获取所有被翻转的棋子位置
-    std::vector<Point> getFlippedPieces(int x, int y, PieceType player) const;
 
 public:
     OthelloRule(Board* b);
@@ -35,8 +32,11 @@ public:
     // 支持虚着
     bool supportsPass() const override { return true; }
     
-    // 获取当前玩家的所有合法移动
-    std::vector<Point> getValidMoves(PieceType player) const;
+    // 获取当前玩家的所有合法移动 (写入定长列表)
+    void getValidMoves(PieceType player, MoveList& moves) const;
+    
+    // 获取落子后所有被翻转的棋子位置 (写入定长列表)
+    void getFlippedPieces(int x, int y, PieceType player, PointList& flipped) const;
     
     // 检查玩家是否有合法移动
     bool hasValidMoves(PieceType player) const;
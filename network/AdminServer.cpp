@@ -0,0 +1,110 @@
+#include "AdminServer.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace chessgame::network {
+
+namespace {
+// 查询方迟迟不读时放弃, 不让一个卡住的查询挡住后面的
+constexpr int SEND_TIMEOUT_SECONDS = 1;
+}
+
+bool AdminServer::start(const std::string& path, std::function<std::string()> renderer) {
+    if (listenFd >= 0) return true;
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "管理接口路径无效: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "创建管理接口socket失败: " << strerror(errno) << std::endl;
+        return false;
+    }
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(fd, 16) < 0) {
+        std::cerr << "管理接口监听失败: " << strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    wakeupFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeupFd < 0) {
+        std::cerr << "创建管理接口失败: " << strerror(errno) << std::endl;
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+
+    struct stat info;
+    listenFd = fd;
+    socketPath = path;
+    socketInode = stat(path.c_str(), &info) == 0 ? info.st_ino : 0;
+    render = std::move(renderer);
+    thread = std::thread(&AdminServer::run, this);
+    std::cout << "管理接口: " << socketPath << std::endl;
+    return true;
+}
+
+void AdminServer::stop() {
+    if (listenFd < 0) return;
+
+    uint64_t one = 1;
+    ssize_t written = write(wakeupFd, &one, sizeof(one));
+    (void)written;
+    if (thread.joinable()) thread.join();
+
+    close(listenFd);
+    close(wakeupFd);
+    // 路径已被其他进程重新绑定时不删除
+    struct stat info;
+    if (stat(socketPath.c_str(), &info) == 0 && info.st_ino == socketInode) unlink(socketPath.c_str());
+    listenFd = -1;
+    wakeupFd = -1;
+}
+
+void AdminServer::run() {
+    pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakeupFd, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "管理接口 poll 失败: " << strerror(errno) << std::endl;
+            return;
+        }
+        if (fds[1].revents) return;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientFd < 0) continue;
+        serve(clientFd);
+        close(clientFd);
+    }
+}
+
+void AdminServer::serve(int clientFd) {
+    timeval timeout{SEND_TIMEOUT_SECONDS, 0};
+    setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string text = render();
+    size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t n = send(clientFd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+} // namespace chessgame::network
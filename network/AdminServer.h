@@ -0,0 +1,40 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+
+namespace chessgame::network {
+
+/**
+ * @brief 本地管理接口: 在 Unix 域 socket 上输出运行指标.
+ *
+ * 每接受一个连接就调用 render 生成一份文本, 写完即关闭 (例如 `socat - UNIX-CONNECT:路径`).
+ * 使用单独的线程阻塞在 poll 上, 不占用 I/O 线程; 指标只在有人查询时才汇总.
+ */
+class AdminServer {
+private:
+    std::string socketPath;
+    ino_t socketInode{0};   // 绑定时 socket 文件的 inode: 平滑升级后新进程会在同一路径上重新监听
+    int listenFd{-1};
+    int wakeupFd{-1};   // stop 时写入, 唤醒 poll
+    std::thread thread;
+    std::function<std::string()> render;
+
+    void run();
+    void serve(int clientFd);
+
+public:
+    AdminServer() = default;
+    ~AdminServer() { stop(); }
+
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    // 在 path 上监听 (已存在的 socket 文件会被替换); 失败时返回 false
+    bool start(const std::string& path, std::function<std::string()> renderer);
+    void stop();
+    bool isRunning() const { return listenFd >= 0; }
+};
+
+} // namespace chessgame::network
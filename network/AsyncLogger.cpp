@@ -0,0 +1,112 @@
+#include "AsyncLogger.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace chessgame::network {
+
+namespace {
+// 没有新记录时后台线程的检查间隔: 生产者不做唤醒, 以免在热路径上调用 notify
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(20);
+}
+
+AsyncLogger& AsyncLogger::instance() {
+    static AsyncLogger logger;
+    return logger;
+}
+
+AsyncLogger::AsyncLogger() : slots(new Slot[CAPACITY]) {
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer = std::thread(&AsyncLogger::run, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    if (writer.joinable()) writer.join();
+}
+
+AsyncLogger::Slot* AsyncLogger::claim(uint64_t& position) {
+    position = enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot* slot = &slots[position & (CAPACITY - 1)];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return slot;
+            }
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t AsyncLogger::drain() {
+    // 连续同级别的记录合并成一次写出; 级别切换时先写出前一段, 保持两个输出流之间的先后顺序
+    std::string batch;
+    Level batchLevel = INFO;
+    auto emit = [&]() {
+        if (batch.empty()) return;
+        std::ostream& stream = batchLevel == WARNING ? std::cerr : std::cout;
+        stream.write(batch.data(), static_cast<std::streamsize>(batch.size())).flush();
+        batch.clear();
+    };
+
+    size_t count = 0;
+    while (true) {
+        Slot& slot = slots[dequeuePos & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+
+        if (slot.level != batchLevel) {
+            emit();
+            batchLevel = slot.level;
+        }
+        batch.append(slot.text, slot.length);
+        batch.push_back('\n');
+
+        slot.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+        ++dequeuePos;
+        ++count;
+    }
+    emit();
+
+    if (count > 0) {
+        written.fetch_add(count, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(waitMutex);
+        drained.notify_all();
+    }
+    return count;
+}
+
+void AsyncLogger::run() {
+    while (true) {
+        if (drain() > 0) continue;
+
+        std::unique_lock<std::mutex> lock(waitMutex);
+        if (stopping) break;
+        wakeup.wait_for(lock, POLL_INTERVAL);
+    }
+    drain();
+}
+
+void AsyncLogger::flush() {
+    // 丢弃的记录不占位置, 所以已申请的位置数就是要等到的输出数
+    uint64_t target = enqueuePos.load(std::memory_order_relaxed);
+
+    std::unique_lock<std::mutex> lock(waitMutex);
+    wakeup.notify_one();
+    drained.wait_for(lock, std::chrono::seconds(1), [&] {
+        return written.load(std::memory_order_acquire) >= target;
+    });
+}
+
+} // namespace chessgame::network
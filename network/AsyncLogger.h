@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace chessgame::network {
+
+/**
+ * @brief 异步日志: 固定容量的环形缓冲区 (多生产者单消费者) 加一个后台写出线程.
+ *
+ * 记录在调用线程上直接格式化进缓冲区的槽位, 不分配内存也不加锁; 后台线程批量写到标准输出 (info)
+ * 或标准错误 (warn). 缓冲区满时丢弃新记录并计数, 热路径不会因为终端或管道写得慢而阻塞.
+ * 参数可以是字符串或整数, 超出槽位长度的部分被截断. 启动、绑定失败等一次性的信息仍直接写 std::cout/cerr.
+ */
+class AsyncLogger {
+public:
+    enum Level { INFO, WARNING };
+
+    static AsyncLogger& instance();
+
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    template <typename... Args>
+    void info(const Args&... args) { write(INFO, args...); }
+
+    template <typename... Args>
+    void warn(const Args&... args) { write(WARNING, args...); }
+
+    // 等待此前写入的记录全部输出
+    void flush();
+
+    // 因缓冲区满而丢弃的记录数
+    uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t CAPACITY = 4096;   // 2 的幂
+    static constexpr size_t TEXT_SIZE = 238;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence;   // 等于写入位置时可写, 等于写入位置 + 1 时可读
+        Level level;
+        uint16_t length;
+        char text[TEXT_SIZE];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<uint64_t> enqueuePos{0};
+    alignas(64) uint64_t dequeuePos{0};          // 只由后台线程访问
+    alignas(64) std::atomic<uint64_t> written{0};   // 已输出的记录数 (flush 用)
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex waitMutex;
+    std::condition_variable wakeup;
+    std::condition_variable drained;
+    bool stopping{false};
+    std::thread writer;
+
+    AsyncLogger();
+
+    // 申请一个槽位, 缓冲区满时返回 nullptr
+    Slot* claim(uint64_t& position);
+    void publish(Slot* slot, uint64_t position) { slot->sequence.store(position + 1, std::memory_order_release); }
+
+    void run();
+    size_t drain();
+
+    static void append(char* text, size_t& length, std::string_view value) {
+        size_t count = value.size() < TEXT_SIZE - length ? value.size() : TEXT_SIZE - length;
+        std::memcpy(text + length, value.data(), count);
+        length += count;
+    }
+
+    template <typename T>
+    static std::enable_if_t<std::is_integral_v<T>> append(char* text, size_t& length, T value) {
+        auto result = std::to_chars(text + length, text + TEXT_SIZE, value);
+        if (result.ec == std::errc()) length = static_cast<size_t>(result.ptr - text);
+    }
+
+    template <typename... Args>
+    void write(Level level, const Args&... args) {
+        uint64_t position;
+        Slot* slot = claim(position);
+        if (!slot) return;
+        size_t length = 0;
+        (append(slot->text, length, args), ...);
+        slot->level = level;
+        slot->length = static_cast<uint16_t>(length);
+        publish(slot, position);
+    }
+};
+
+} // namespace chessgame::network
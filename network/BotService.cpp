@@ -0,0 +1,110 @@
+#include "BotService.h"
+#include "Metrics.h"
+#include <algorithm>
+
+namespace chessgame::network {
+
+BotService::BotService(int threadCount) {
+    if (threadCount <= 0) threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&BotService::workerLoop, this);
+    }
+}
+
+BotService::~BotService() {
+    stop();
+}
+
+void BotService::submit(Request request) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stopping) return;
+        std::deque<Pending>& pending = roomQueues[request.roomId];
+        if (pending.empty()) readyRooms.push_back(request.roomId);
+        pending.push_back(Pending{std::move(request), Clock::now()});
+        queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    wakeup.notify_one();
+}
+
+void BotService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stopping) return;
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& thread : threads) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+void BotService::takeBatch(std::vector<Pending>& batch) {
+    // 按线程数均分排队的房间, 一个线程不会把别的线程本可以并行算的请求都拿走;
+    // 每轮只取 readyRooms 现有的房间数, 同一房间在一批里至多出现一次
+    size_t share = (readyRooms.size() + threads.size() - 1) / threads.size();
+    size_t count = std::min({share, readyRooms.size(), MAX_BATCH});
+    for (size_t i = 0; i < count; ++i) {
+        int roomId = readyRooms.front();
+        readyRooms.pop_front();
+        auto it = roomQueues.find(roomId);
+        batch.push_back(std::move(it->second.front()));
+        it->second.pop_front();
+        if (it->second.empty()) {
+            roomQueues.erase(it);
+        } else {
+            readyRooms.push_back(roomId);
+        }
+    }
+    queued.fetch_sub(count, std::memory_order_relaxed);
+}
+
+void BotService::workerLoop() {
+    // 按 (类型, 级别) 缓存的策略, 只在本线程使用
+    std::unordered_map<int, std::unique_ptr<ai::AIStrategy>> strategies;
+    std::vector<Pending> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            wakeup.wait(lock, [&]() { return stopping || !readyRooms.empty(); });
+            if (stopping) return;
+            takeBatch(batch);
+        }
+        // 一次取了多个时, 让其他空闲线程也来取剩下的
+        if (batch.size() > 1) wakeup.notify_one();
+
+        for (Pending& pending : batch) {
+            Request& request = pending.request;
+            if (request.abandoned && request.abandoned()) continue;
+            Move move = compute(pending, strategies);
+            Metrics::add(Metrics::BOT_MOVES);
+            request.done(move);
+        }
+        batch.clear();
+    }
+}
+
+Move BotService::compute(Pending& pending,
+                         std::unordered_map<int, std::unique_ptr<ai::AIStrategy>>& strategies) {
+    Request& request = pending.request;
+    ai::AIType type = ai::AIFactory::aiTypeForGame(request.gameType);
+    int key = static_cast<int>(type) * 4 + static_cast<int>(request.level);
+    std::unique_ptr<ai::AIStrategy>& strategy = strategies[key];
+    if (!strategy) strategy = ai::AIFactory::createStrategy(type, request.level);
+
+    Clock::time_point start = Clock::now();
+    Metrics::record(Metrics::BOT_QUEUE, start - pending.submitted);
+    // 滑动平均只用于准入判断, 多个线程同时更新时丢掉一次也无妨
+    int64_t waited = std::chrono::duration_cast<std::chrono::microseconds>(start - pending.submitted).count();
+    int64_t average = queueDelayMicros.load(std::memory_order_relaxed);
+    queueDelayMicros.store(average + (waited - average) / 8, std::memory_order_relaxed);
+
+    ai::SearchContext context;
+    context.setDeadline(std::max(pending.submitted + request.budget, start + MIN_BUDGET));
+    Move move = strategy->calculateMove(request.board, request.color, context);
+    Metrics::record(Metrics::BOT_THINK, Clock::now() - start);
+    return move;
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,92 @@
+#pragma once
+#include "../ai/AI.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 服务器托管的机器人: 所有人机房间共用的一组计算线程.
+ *
+ * 轮到机器人时房间提交一个"算一步"的请求 (棋盘拷贝、执子颜色、级别和时间预算), 结果通过回调交回.
+ * 调度按房间公平: 每个房间一条队列, 有请求的房间排成一圈轮流取, 积压再多的房间每轮也只算一步;
+ * 计算线程每次加锁取走一批 (每个房间至多一个, 按线程数均分), 减少加锁和唤醒的次数.
+ * 时间预算从提交时算起, 排队的时间也计入; 到期后搜索返回目前为止的最佳着法,
+ * 排队已超过预算的请求只给 MIN_BUDGET, 负载高时每步变快而不是越积越多.
+ * 策略对象有状态, 每个计算线程各有一份, 互不共享.
+ * 准入控制: 计算线程记录近期请求的排队时间 (指数滑动平均), 仍有请求排队且平均排队时间超过调用方给出的上限时
+ * isSaturated() 为真, 由调用方拒绝新的人机对局; 队列排空后自动恢复.
+ */
+class BotService {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        int roomId{0};
+        std::shared_ptr<model::Board> board;   // 局面拷贝, 计算期间不会被修改
+        PieceType color{EMPTY};
+        GameType gameType{GOMOKU};
+        ai::AILevel level{ai::AILevel::LEVEL2};
+        std::chrono::milliseconds budget{0};
+        std::function<bool()> abandoned;        // 返回 true 时不再计算 (可为空)
+        std::function<void(const Move&)> done;  // 在计算线程上调用
+    };
+
+    // 排队超过预算的请求至少还能算这么久
+    static constexpr std::chrono::milliseconds MIN_BUDGET{5};
+
+    // 一个计算线程一次最多取走的请求数
+    static constexpr size_t MAX_BATCH = 16;
+
+private:
+    struct Pending {
+        Request request;
+        Clock::time_point submitted;
+    };
+
+    std::mutex queueMutex;
+    std::condition_variable wakeup;
+    std::unordered_map<int, std::deque<Pending>> roomQueues;   // 房间编号 -> 尚未计算的请求
+    std::deque<int> readyRooms;                                // 有请求的房间, 轮流取
+    bool stopping{false};
+    std::atomic<size_t> queued{0};
+    std::atomic<int64_t> queueDelayMicros{0};   // 排队时间的滑动平均
+    std::vector<std::thread> threads;
+
+    void workerLoop();
+    void takeBatch(std::vector<Pending>& batch);
+    Move compute(Pending& pending,
+                 std::unordered_map<int, std::unique_ptr<ai::AIStrategy>>& strategies);
+
+public:
+    // threadCount <= 0 时使用 CPU 核数
+    explicit BotService(int threadCount = 0);
+    ~BotService();
+
+    BotService(const BotService&) = delete;
+    BotService& operator=(const BotService&) = delete;
+
+    // 提交请求 (线程安全)
+    void submit(Request request);
+
+    // 停止并等待计算线程退出, 尚未计算的请求被丢弃
+    void stop();
+
+    bool isSaturated(std::chrono::milliseconds maxDelay) const {
+        return queued.load(std::memory_order_relaxed) > 0 &&
+               queueDelayMicros.load(std::memory_order_relaxed) >=
+                   std::chrono::duration_cast<std::chrono::microseconds>(maxDelay).count();
+    }
+    size_t getQueuedCount() const { return queued.load(std::memory_order_relaxed); }
+    int getThreadCount() const { return static_cast<int>(threads.size()); }
+};
+
+} // namespace chessgame::network
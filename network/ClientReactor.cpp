@@ -0,0 +1,117 @@
+#include "ClientReactor.h"
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace chessgame::network {
+
+ClientReactor::ClientReactor() {
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (!isValid()) {
+        std::cerr << "创建客户端事件循环失败: " << strerror(errno) << std::endl;
+    }
+}
+
+ClientReactor::~ClientReactor() {
+    if (timerFd >= 0) close(timerFd);
+    if (wakeupFd >= 0) close(wakeupFd);
+}
+
+void ClientReactor::add(int fd, Handler handler) {
+    handlers[fd] = std::make_shared<Handler>(std::move(handler));
+}
+
+void ClientReactor::remove(int fd) {
+    handlers.erase(fd);
+}
+
+void ClientReactor::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        pendingTasks.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    ssize_t written = write(wakeupFd, &one, sizeof(one));
+    (void)written;
+}
+
+void ClientReactor::runAfter(std::chrono::milliseconds delay, Task task) {
+    timers.emplace(Clock::now() + delay, std::move(task));
+    armTimer();
+}
+
+bool ClientReactor::runOnce(int timeoutMs) {
+    // 前两项固定是 eventfd 和 timerfd, 其余按注册顺序排列
+    std::vector<struct pollfd> fds;
+    fds.reserve(handlers.size() + 2);
+    fds.push_back({wakeupFd, POLLIN, 0});
+    fds.push_back({timerFd, POLLIN, 0});
+    for (const auto& entry : handlers) {
+        fds.push_back({entry.first, POLLIN, 0});
+    }
+
+    int count = ::poll(fds.data(), fds.size(), timeoutMs);
+    if (count < 0) {
+        if (errno != EINTR) std::cerr << "poll 失败: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (count == 0) return false;
+
+    // 先处理网络消息和定时器, 再处理输入: 输入总是基于最新的局面
+    if (fds[0].revents) handleWakeup();
+    if (fds[1].revents) handleTimers();
+    for (size_t i = 2; i < fds.size(); ++i) {
+        if (!fds[i].revents) continue;
+        auto it = handlers.find(fds[i].fd);
+        if (it == handlers.end()) continue;
+        // 先持有回调, 回调中移除自身时不会被提前析构
+        std::shared_ptr<Handler> handler = it->second;
+        (*handler)(fds[i].revents);
+    }
+    return true;
+}
+
+void ClientReactor::handleWakeup() {
+    uint64_t value;
+    while (read(wakeupFd, &value, sizeof(value)) > 0) {}
+
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        tasks.swap(pendingTasks);
+    }
+    for (auto& task : tasks) task();
+}
+
+void ClientReactor::handleTimers() {
+    uint64_t expirations;
+    while (read(timerFd, &expirations, sizeof(expirations)) > 0) {}
+
+    auto now = Clock::now();
+    while (!timers.empty() && timers.begin()->first <= now) {
+        Task task = std::move(timers.begin()->second);
+        timers.erase(timers.begin());
+        task();
+    }
+    armTimer();
+}
+
+void ClientReactor::armTimer() {
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (!timers.empty()) {
+        auto delay = timers.begin()->first - Clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+        if (ns < 1) ns = 1;   // 全零会解除定时器
+        spec.it_value.tv_sec = ns / 1000000000;
+        spec.it_value.tv_nsec = ns % 1000000000;
+    }
+    timerfd_settime(timerFd, 0, &spec, nullptr);
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 客户端用的基于 poll 的单线程反应器.
+ *
+ * 标准输入、网络消息和定时器都在调用 runOnce() 的线程上处理. 用 poll 而不是 epoll,
+ * 标准输入被重定向为普通文件时也能注册; post() 可以在任意线程调用, 网络线程收到的
+ * 消息借此交给主线程处理, 通过 eventfd 唤醒; 定时任务由 timerfd 按时触发.
+ */
+class ClientReactor {
+public:
+    using Handler = std::function<void(short revents)>;
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+private:
+    int wakeupFd;    // eventfd: 跨线程任务
+    int timerFd;     // timerfd: 最早到期的定时任务
+
+    // 回调用 shared_ptr 保存, 回调里移除自身也是安全的
+    std::map<int, std::shared_ptr<Handler>> handlers;
+
+    std::mutex taskMutex;
+    std::vector<Task> pendingTasks;
+
+    std::multimap<Clock::time_point, Task> timers;
+
+    void handleWakeup();
+    void handleTimers();
+    void armTimer();
+
+public:
+    ClientReactor();
+    ~ClientReactor();
+
+    ClientReactor(const ClientReactor&) = delete;
+    ClientReactor& operator=(const ClientReactor&) = delete;
+
+    bool isValid() const { return wakeupFd >= 0 && timerFd >= 0; }
+
+    // 注册/移除可读事件的文件描述符 (只能在反应器线程上调用)
+    void add(int fd, Handler handler);
+    void remove(int fd);
+
+    // 在反应器线程上执行任务 (线程安全)
+    void post(Task task);
+
+    // 延迟执行 (只能在反应器线程上调用)
+    void runAfter(std::chrono::milliseconds delay, Task task);
+
+    // 等待一批事件并处理, timeoutMs < 0 时一直等待; 超时返回 false
+    bool runOnce(int timeoutMs = -1);
+};
+
+} // namespace chessgame::network
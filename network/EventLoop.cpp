@@ -0,0 +1,161 @@
+#include "EventLoop.h"
+#include "Metrics.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace chessgame::network {
+
+namespace {
+
+// 每次 epoll_wait 最多取回的事件数
+const int MAX_EVENTS = 256;
+
+}
+
+EventLoop::EventLoop() : timers(std::chrono::milliseconds(TIMER_TICK_MS)) {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (!isValid()) {
+        std::cerr << "创建事件循环失败: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    add(wakeupFd, EPOLLIN, [this](uint32_t) { handleWakeup(); });
+    add(timerFd, EPOLLIN, [this](uint32_t) { handleTimers(); });
+}
+
+EventLoop::~EventLoop() {
+    if (timerFd >= 0) close(timerFd);
+    if (wakeupFd >= 0) close(wakeupFd);
+    if (epollFd >= 0) close(epollFd);
+}
+
+bool EventLoop::add(int fd, uint32_t events, Handler handler) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        return false;
+    }
+    handlers[fd] = std::make_shared<Handler>(std::move(handler));
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    return epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EventLoop::remove(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    handlers.erase(fd);
+}
+
+void EventLoop::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        pendingTasks.push_back(std::move(task));
+    }
+    wakeup();
+}
+
+void EventLoop::wakeup() {
+    uint64_t one = 1;
+    ssize_t written = write(wakeupFd, &one, sizeof(one));
+    (void)written;
+    Metrics::add(Metrics::IO_SYSCALLS);
+}
+
+EventLoop::TimerId EventLoop::runAfter(std::chrono::milliseconds delay, Task task) {
+    Clock::time_point deadline = Clock::now() + delay;
+    TimerId id = timers.schedule(deadline, std::move(task));
+    // 只有比已设置的唤醒时刻更早时才需要重设 timerfd
+    if (!timerArmed || deadline < armedWakeup) armTimer();
+    return id;
+}
+
+bool EventLoop::cancelTimer(TimerId id) {
+    // 提前唤醒时时间轮没有到期的任务, 重新设置即可, 不必在这里重设 timerfd
+    return timers.cancel(id);
+}
+
+void EventLoop::run() {
+    loopThreadId = std::this_thread::get_id();
+    running = true;
+
+    struct epoll_event events[MAX_EVENTS];
+    while (running.load()) {
+        if (beforeWait) beforeWait();
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        Metrics::add(Metrics::IO_SYSCALLS);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait 失败: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            auto it = handlers.find(events[i].data.fd);
+            if (it == handlers.end()) continue;
+            // 先持有回调, 回调中移除自身时不会被提前析构
+            std::shared_ptr<Handler> handler = it->second;
+            (*handler)(events[i].events);
+        }
+    }
+}
+
+void EventLoop::stop() {
+    running = false;
+    uint64_t one = 1;
+    ssize_t written = write(wakeupFd, &one, sizeof(one));
+    (void)written;
+}
+
+void EventLoop::handleWakeup() {
+    uint64_t value;
+    while (read(wakeupFd, &value, sizeof(value)) > 0) {}
+
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        tasks.swap(pendingTasks);
+    }
+    for (auto& task : tasks) task();
+}
+
+void EventLoop::handleTimers() {
+    uint64_t expirations;
+    while (read(timerFd, &expirations, sizeof(expirations)) > 0) {}
+
+    timerArmed = false;
+    timers.advance(Clock::now());
+    armTimer();
+}
+
+void EventLoop::armTimer() {
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    Clock::time_point wakeup;
+    timerArmed = timers.nextWakeup(wakeup);
+    if (timerArmed) {
+        armedWakeup = wakeup;
+        auto delay = wakeup - Clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+        if (ns < 1) ns = 1;   // 全零会解除定时器
+        spec.it_value.tv_sec = ns / 1000000000;
+        spec.it_value.tv_nsec = ns % 1000000000;
+    }
+    timerfd_settime(timerFd, 0, &spec, nullptr);
+}
+
+} // namespace chessgame::network
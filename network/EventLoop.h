@@ -0,0 +1,88 @@
+#pragma once
+#include "TimerWheel.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 基于 epoll 的单线程事件循环.
+ *
+ * 所有文件描述符的回调都在调用 run() 的线程上执行;
+ * post() 和 stop() 可以在任意线程调用, 通过 eventfd 唤醒循环.
+ * 定时任务放在分层时间轮中 (精度 TIMER_TICK_MS), 添加和取消都是 O(1), timerfd 只按最早的唤醒时刻设置.
+ */
+class EventLoop {
+public:
+    using Handler = std::function<void(uint32_t events)>;
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+    using TimerId = TimerWheel::TimerId;
+
+    static constexpr int TIMER_TICK_MS = 10;
+
+private:
+    int epollFd;
+    int wakeupFd;    // eventfd: 跨线程任务和停止请求
+    int timerFd;     // timerfd: 最早到期的定时任务
+    std::atomic<bool> running{false};
+    std::thread::id loopThreadId;
+
+    // 回调用 shared_ptr 保存, 回调里移除自身也是安全的
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers;
+
+    std::mutex taskMutex;
+    std::vector<Task> pendingTasks;
+    Task beforeWait;   // 每次等待之前执行 (例如批量提交 io_uring 请求)
+
+    TimerWheel timers;
+    bool timerArmed{false};
+    Clock::time_point armedWakeup;   // timerfd 当前设置的唤醒时刻
+
+    void handleWakeup();
+    void handleTimers();
+    void armTimer();
+
+public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool isValid() const { return epollFd >= 0 && wakeupFd >= 0 && timerFd >= 0; }
+
+    // 注册/修改/移除文件描述符 (events 为 EPOLLIN 等标志); modify 可在任意线程调用
+    bool add(int fd, uint32_t events, Handler handler);
+    bool modify(int fd, uint32_t events);
+    void remove(int fd);
+
+    // 在循环线程上执行任务 (线程安全)
+    void post(Task task);
+
+    // 只唤醒循环 (线程安全), 醒来后照常执行 beforeWait
+    void wakeup();
+
+    // 每次进入等待之前在循环线程上执行 (需在 run 之前设置)
+    void setBeforeWait(Task task) { beforeWait = std::move(task); }
+
+    // 延迟执行, 返回的编号可用于取消 (只能在循环线程上调用)
+    TimerId runAfter(std::chrono::milliseconds delay, Task task);
+    bool cancelTimer(TimerId id);
+    size_t getTimerCount() const { return timers.size(); }
+
+    // 运行直到 stop()
+    void run();
+    void stop();
+
+    bool isInLoopThread() const { return std::this_thread::get_id() == loopThreadId; }
+};
+
+} // namespace chessgame::network
@@ -0,0 +1,404 @@
+#include "GameJournal.h"
+#include "AsyncLogger.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chessgame::network {
+
+namespace {
+
+// 记录头: 正文长度和正文的 CRC32
+const size_t RECORD_HEADER_SIZE = JournalRecord::HEADER_SIZE;
+
+// 正文上限: 最大的 SNAPSHOT (19x19 棋盘加两个令牌) 也远小于它, 超过说明长度已损坏
+const uint32_t MAX_RECORD_SIZE = 4096;
+
+const char SEGMENT_PREFIX[] = "journal-";
+const char SEGMENT_SUFFIX[] = ".log";
+
+uint32_t crc32(const char* data, size_t size) {
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> result{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            result[i] = value;
+        }
+        return result;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendToken(std::string& out, const std::string& token) {
+    appendValue(out, static_cast<uint8_t>(std::min<size_t>(token.size(), 255)));
+    out.append(token, 0, 255);
+}
+
+// 顺序读取正文, 越界时 ok 变为 false, 之后的读取都返回 0
+struct Reader {
+    const char* cursor;
+    const char* end;
+    bool ok{true};
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!ok || static_cast<size_t>(end - cursor) < sizeof(T)) {
+            ok = false;
+            return value;
+        }
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+
+    std::string readToken() {
+        size_t length = read<uint8_t>();
+        if (!ok || static_cast<size_t>(end - cursor) < length) {
+            ok = false;
+            return "";
+        }
+        std::string token(cursor, length);
+        cursor += length;
+        return token;
+    }
+};
+
+bool writeAll(int fd, const std::string& bytes) {
+    size_t written = 0;
+    while (written < bytes.size()) {
+        ssize_t result = write(fd, bytes.data() + written, bytes.size() - written);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) return false;
+        written += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+}
+
+void JournalRecord::encode(std::string& out) const {
+    size_t start = out.size();
+    out.resize(start + RECORD_HEADER_SIZE);
+
+    appendValue(out, static_cast<uint8_t>(type));
+    appendValue(out, static_cast<int32_t>(roomId));
+    switch (type) {
+        case OPEN:
+        case SNAPSHOT:
+            appendValue(out, static_cast<uint8_t>(gameType));
+            appendValue(out, static_cast<uint8_t>(boardSize));
+            appendValue(out, static_cast<uint8_t>(botColor));
+            appendValue(out, static_cast<uint8_t>(botLevel));
+            appendToken(out, blackToken);
+            appendToken(out, whiteToken);
+            if (type == SNAPSHOT) {
+                appendValue(out, sequence);
+                appendValue(out, static_cast<uint8_t>(currentPlayer));
+                appendValue(out, static_cast<uint8_t>(status));
+                appendValue(out, static_cast<uint8_t>(passCount));
+                out.append(reinterpret_cast<const char*>(cells.data()), cells.size());
+            }
+            break;
+        case MOVE:
+            appendValue(out, static_cast<uint8_t>(row));
+            appendValue(out, static_cast<uint8_t>(col));
+            appendValue(out, static_cast<uint8_t>(player));
+            break;
+        case STATE:
+            appendValue(out, static_cast<uint8_t>(player));
+            appendValue(out, static_cast<uint8_t>(currentPlayer));
+            appendValue(out, static_cast<uint8_t>(status));
+            appendValue(out, static_cast<uint8_t>(passCount));
+            break;
+        case CLOSE:
+            break;
+    }
+
+    uint32_t length = static_cast<uint32_t>(out.size() - start - RECORD_HEADER_SIZE);
+    uint32_t checksum = crc32(out.data() + start + RECORD_HEADER_SIZE, length);
+    memcpy(&out[start], &length, sizeof(length));
+    memcpy(&out[start + sizeof(length)], &checksum, sizeof(checksum));
+}
+
+bool JournalRecord::decode(const char* data, size_t size, JournalRecord& record) {
+    Reader reader{data, data + size};
+    uint8_t type = reader.read<uint8_t>();
+    record.roomId = reader.read<int32_t>();
+    if (type < OPEN || type > SNAPSHOT) return false;
+    record.type = static_cast<Type>(type);
+
+    switch (record.type) {
+        case OPEN:
+        case SNAPSHOT:
+            record.gameType = static_cast<GameType>(reader.read<uint8_t>());
+            record.boardSize = reader.read<uint8_t>();
+            record.botColor = static_cast<PieceType>(reader.read<uint8_t>());
+            record.botLevel = reader.read<uint8_t>();
+            record.blackToken = reader.readToken();
+            record.whiteToken = reader.readToken();
+            if (record.type == SNAPSHOT) {
+                record.sequence = reader.read<uint64_t>();
+                record.currentPlayer = static_cast<PieceType>(reader.read<uint8_t>());
+                record.status = static_cast<GameStatus>(reader.read<uint8_t>());
+                record.passCount = reader.read<uint8_t>();
+                size_t points = static_cast<size_t>(record.boardSize) * record.boardSize;
+                if (!reader.ok || static_cast<size_t>(reader.end - reader.cursor) != points) return false;
+                record.cells.assign(reader.cursor, reader.end);
+                reader.cursor = reader.end;
+            }
+            break;
+        case MOVE:
+            record.row = reader.read<uint8_t>();
+            record.col = reader.read<uint8_t>();
+            record.player = static_cast<PieceType>(reader.read<uint8_t>());
+            break;
+        case STATE:
+            record.player = static_cast<PieceType>(reader.read<uint8_t>());
+            record.currentPlayer = static_cast<PieceType>(reader.read<uint8_t>());
+            record.status = static_cast<GameStatus>(reader.read<uint8_t>());
+            record.passCount = reader.read<uint8_t>();
+            break;
+        case CLOSE:
+            break;
+    }
+    return reader.ok && reader.cursor == reader.end;
+}
+
+GameJournal::~GameJournal() {
+    close();
+}
+
+std::string GameJournal::segmentPath(uint64_t segment) const {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%010llu%s", SEGMENT_PREFIX, static_cast<unsigned long long>(segment),
+             SEGMENT_SUFFIX);
+    return directory + "/" + name;
+}
+
+std::vector<uint64_t> GameJournal::listSegments() const {
+    std::vector<uint64_t> segments;
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return segments;
+    while (dirent* entry = readdir(dir)) {
+        unsigned long long segment;
+        char suffix[8] = {};
+        if (sscanf(entry->d_name, "journal-%llu%7s", &segment, suffix) == 2 && strcmp(suffix, SEGMENT_SUFFIX) == 0) {
+            segments.push_back(segment);
+        }
+    }
+    closedir(dir);
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+bool GameJournal::readSegment(uint64_t segment, std::vector<JournalRecord>& records) const {
+    int fd = ::open(segmentPath(segment).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    std::string contents;
+    char chunk[64 * 1024];
+    ssize_t count;
+    while ((count = read(fd, chunk, sizeof(chunk))) > 0 || (count < 0 && errno == EINTR)) {
+        if (count > 0) contents.append(chunk, static_cast<size_t>(count));
+    }
+    ::close(fd);
+
+    size_t offset = 0;
+    while (offset + RECORD_HEADER_SIZE <= contents.size()) {
+        uint32_t length;
+        uint32_t checksum;
+        memcpy(&length, contents.data() + offset, sizeof(length));
+        memcpy(&checksum, contents.data() + offset + sizeof(length), sizeof(checksum));
+        const char* body = contents.data() + offset + RECORD_HEADER_SIZE;
+        JournalRecord record;
+        if (length > MAX_RECORD_SIZE || contents.size() - offset - RECORD_HEADER_SIZE < length ||
+            crc32(body, length) != checksum || !JournalRecord::decode(body, length, record)) {
+            break;
+        }
+        records.push_back(std::move(record));
+        offset += RECORD_HEADER_SIZE + length;
+    }
+    if (offset < contents.size()) {
+        // 崩溃时写了一半的记录: 之后的内容都不可信
+        AsyncLogger::instance().warn("日志段 ", segment, " 在偏移 ", offset, " 处截断, 丢弃其后 ",
+                                     contents.size() - offset, " 字节");
+    }
+    return true;
+}
+
+bool GameJournal::open(const std::string& path, std::vector<JournalRecord>& records) {
+    directory = path;
+    if (mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        AsyncLogger::instance().warn("无法创建日志目录 ", directory, ": ", strerror(errno));
+        return false;
+    }
+    directoryFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd < 0) {
+        AsyncLogger::instance().warn("无法打开日志目录 ", directory, ": ", strerror(errno));
+        return false;
+    }
+
+    std::vector<uint64_t> segments = listSegments();
+    for (uint64_t segment : segments) {
+        if (!readSegment(segment, records)) {
+            AsyncLogger::instance().warn("无法读取日志段 ", segmentPath(segment), ": ", strerror(errno));
+            return false;
+        }
+    }
+
+    // 已有的段 (可能以半条记录结尾) 不再追加, 由下一次压缩删除
+    currentSegment = segments.empty() ? 1 : segments.back() + 1;
+    stopping = false;
+    writer = std::thread(&GameJournal::writerLoop, this);
+    return true;
+}
+
+void GameJournal::close() {
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (!writer.joinable()) return;
+        stopping = true;
+    }
+    wakeup.notify_one();
+    writer.join();
+    if (directoryFd >= 0) {
+        ::close(directoryFd);
+        directoryFd = -1;
+    }
+}
+
+void GameJournal::append(const JournalRecord& record) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (buffer.empty() || buffer.back().segment != currentSegment) {
+            buffer.push_back(Chunk{currentSegment, std::string()});
+        }
+        std::string& bytes = buffer.back().bytes;
+        size_t before = bytes.size();
+        record.encode(bytes);
+        // 第一条记录唤醒写入线程开始计时, 攒满时再唤醒一次提前提交; 其余的不打扰等待中的写入线程
+        size_t previous = bufferedBytes;
+        bufferedBytes += bytes.size() - before;
+        wake = previous == 0 || (previous < COMMIT_BYTES && bufferedBytes >= COMMIT_BYTES);
+    }
+    Metrics::add(Metrics::JOURNAL_RECORDS);
+    if (wake) wakeup.notify_one();
+}
+
+uint64_t GameJournal::rotate() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return ++currentSegment;
+}
+
+void GameJournal::retireBefore(uint64_t segment) {
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        retireRequest = std::max(retireRequest, segment);
+        // 没有待写的记录时也要唤醒写入线程执行删除
+        if (buffer.empty()) buffer.push_back(Chunk{currentSegment, std::string()});
+    }
+    wakeup.notify_one();
+}
+
+void GameJournal::writerLoop() {
+    std::vector<Chunk> writing;
+    uint64_t openSegment = 0;
+    uint64_t failedSegment = 0;   // 最近一次写入失败的段, 之后的记录不再写入不大于它的段
+    int fd = -1;
+
+    while (true) {
+        uint64_t retiring;
+        bool exiting;
+        {
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            wakeup.wait(lock, [this]() { return stopping || !buffer.empty(); });
+            // 成组提交: 等待同一时间窗口内的其他记录
+            if (!stopping && bufferedBytes < COMMIT_BYTES) {
+                wakeup.wait_for(lock, std::chrono::milliseconds(COMMIT_INTERVAL_MS),
+                                [this]() { return stopping || bufferedBytes >= COMMIT_BYTES; });
+            }
+            writing.swap(buffer);
+            bufferedBytes = 0;
+            retiring = retireRequest;
+            retireRequest = 0;
+            exiting = stopping;
+        }
+
+        if (!writing.empty()) {
+            Metrics::StageTimer timer(Metrics::JOURNAL_COMMIT);
+            for (Chunk& chunk : writing) {
+                if (chunk.segment <= failedSegment) chunk.segment = failedSegment + 1;
+                if (chunk.segment != openSegment) {
+                    // 上一段在切换前落盘, 新段创建后同步目录, 保证崩溃后能看到它
+                    if (fd >= 0) {
+                        fdatasync(fd);
+                        ::close(fd);
+                    }
+                    openSegment = chunk.segment;
+                    fd = ::open(segmentPath(openSegment).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+                    if (fd < 0) {
+                        AsyncLogger::instance().warn("无法创建日志段 ", segmentPath(openSegment), ": ",
+                                                     strerror(errno));
+                    }
+                    fsync(directoryFd);
+                    segmentBytes.store(0, std::memory_order_relaxed);
+                }
+                if (fd >= 0 && !chunk.bytes.empty()) {
+                    if (writeAll(fd, chunk.bytes)) {
+                        segmentBytes.fetch_add(chunk.bytes.size(), std::memory_order_relaxed);
+                        continue;
+                    }
+                    // 读取会停在写了一半的记录处: 不再追加到这一段, 之后的记录 (包括随后追加的) 写入新段
+                    AsyncLogger::instance().warn("写日志段 ", openSegment, " 失败: ", strerror(errno), ", 改写新段");
+                    Metrics::add(Metrics::JOURNAL_WRITE_ERRORS);
+                    ::close(fd);
+                    fd = -1;
+                    failedSegment = openSegment;
+                    {
+                        std::lock_guard<std::mutex> lock(bufferMutex);
+                        currentSegment = std::max(currentSegment, failedSegment + 1);
+                    }
+                    writeFailed = true;
+                }
+            }
+            if (fd >= 0) fdatasync(fd);
+            writing.clear();
+        }
+
+        // 压缩写入的完整状态可能正缺在失败处: 保留旧段, 等下一次压缩
+        if (retiring > 0 && failedSegment >= retiring) {
+            AsyncLogger::instance().warn("压缩期间写日志失败, 保留旧段");
+        } else if (retiring > 0) {
+            for (uint64_t segment : listSegments()) {
+                if (segment >= retiring) break;
+                unlink(segmentPath(segment).c_str());
+            }
+            fsync(directoryFd);
+        }
+        if (exiting) break;
+    }
+    if (fd >= 0) ::close(fd);
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,131 @@
+#pragma once
+#include "../utils/Type.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 对局日志中的一条记录.
+ *
+ * OPEN      开局: 房间设置、机器人座位和双方的会话令牌
+ * MOVE      落子 (row, col, player)
+ * STATE     虚着、认输、超时: 行棋者 player, 之后的 currentPlayer、status、passCount
+ * CLOSE     房间解散
+ * SNAPSHOT  压缩时写入的完整状态: OPEN 的全部字段, 加上序号、行棋方、状态、虚着数和棋盘
+ * 每种记录推进序号的方式与房间相同 (MOVE 和 STATE 各一次), 重放后的序号与崩溃前一致, 重连的玩家可以照常补发.
+ */
+struct JournalRecord {
+    enum Type : uint8_t { OPEN = 1, MOVE, STATE, CLOSE, SNAPSHOT };
+
+    Type type{OPEN};
+    int roomId{0};
+
+    // OPEN, SNAPSHOT
+    GameType gameType{GOMOKU};
+    int boardSize{0};
+    PieceType botColor{EMPTY};
+    int botLevel{0};
+    std::string blackToken;
+    std::string whiteToken;
+
+    // MOVE, STATE
+    int row{0};
+    int col{0};
+    PieceType player{EMPTY};
+
+    // STATE, SNAPSHOT
+    PieceType currentPlayer{EMPTY};
+    GameStatus status{IN_PROGRESS};
+    int passCount{0};
+
+    // SNAPSHOT
+    uint64_t sequence{0};
+    std::vector<int8_t> cells;   // 按行排列, 每格一个 PieceType
+
+    // encode 写出的记录以记录头 (正文长度和 CRC32) 开始, decode 只接受其后的正文
+    static constexpr size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+
+    void encode(std::string& out) const;
+    static bool decode(const char* data, size_t size, JournalRecord& record);
+};
+
+/**
+ * @brief 对局的预写日志: 只追加, 成组提交.
+ *
+ * 任意线程调用 append 只是把编码后的记录放进内存缓冲区; 写入线程在第一条记录到达后再等待至多
+ * COMMIT_INTERVAL_MS (或缓冲区攒满 COMMIT_BYTES), 把这期间的全部记录一次写出并 fdatasync.
+ * 落子不等待落盘: 崩溃时最多丢失最后一个提交间隔内的记录, 日志本身总是完整记录的前缀.
+ * 每条记录带长度和 CRC32, 读取时遇到写了一半或校验不对的记录即停止读该段.
+ * 日志按段存放 (目录下的 journal-<段号>.log), 每次启动和每次压缩 (rotate) 都开始新的一段;
+ * 压缩时调用方把所有对局的 SNAPSHOT 写入新段, 再调用 retireBefore, 写入线程在这些记录落盘后删除旧段.
+ * 旧段删除之前崩溃时, 重放旧段再重放新段, 结果相同.
+ * 写入失败的段留下了读不过去的半条记录: 之后的记录改写到新的一段, 由调用方 (takeWriteFailure) 尽快压缩补齐.
+ */
+class GameJournal {
+public:
+    // 成组提交的等待时间和提前提交的缓冲区大小
+    static constexpr int COMMIT_INTERVAL_MS = 5;
+    static constexpr size_t COMMIT_BYTES = 256 * 1024;
+
+private:
+    struct Chunk {
+        uint64_t segment;
+        std::string bytes;
+    };
+
+    std::string directory;
+    int directoryFd{-1};
+    uint64_t currentSegment{0};
+
+    std::mutex bufferMutex;
+    std::condition_variable wakeup;
+    std::vector<Chunk> buffer;           // 尚未写出的记录, 按段分块
+    size_t bufferedBytes{0};
+    uint64_t retireRequest{0};           // 非 0 时: 之前的记录落盘后删除段号小于它的段
+    bool stopping{false};
+    std::thread writer;
+
+    std::atomic<uint64_t> segmentBytes{0};   // 当前段已写出的字节数
+    std::atomic<bool> writeFailed{false};    // 上次 takeWriteFailure 之后有记录未能写出
+
+    void writerLoop();
+    std::string segmentPath(uint64_t segment) const;
+    std::vector<uint64_t> listSegments() const;
+    bool readSegment(uint64_t segment, std::vector<JournalRecord>& records) const;
+
+public:
+    GameJournal() = default;
+    ~GameJournal();
+
+    GameJournal(const GameJournal&) = delete;
+    GameJournal& operator=(const GameJournal&) = delete;
+
+    // 打开 (必要时创建) 日志目录, 读出已有的全部记录, 之后的记录写入新的一段
+    bool open(const std::string& path, std::vector<JournalRecord>& records);
+
+    // 写出缓冲区中的全部记录并停止写入线程
+    void close();
+
+    // 追加一条记录 (线程安全, 不等待写出)
+    void append(const JournalRecord& record);
+
+    // 之后的记录写入新的一段, 返回新段的段号 (线程安全)
+    uint64_t rotate();
+
+    // 段号小于 segment 的段在当前已追加的记录落盘后删除 (线程安全)
+    void retireBefore(uint64_t segment);
+
+    uint64_t getSegmentBytes() const { return segmentBytes.load(std::memory_order_relaxed); }
+
+    // 有记录未能写出时返回 true 并清除标记: 日志已缺了这些记录, 调用方应压缩, 重新写入全部对局的完整状态
+    bool takeWriteFailure() { return writeFailed.exchange(false); }
+    bool isOpen() const { return writer.joinable(); }
+};
+
+} // namespace chessgame::network
@@ -0,0 +1,348 @@
+#include "GameRoom.h"
+#include "../utils/MoveList.h"
+#include <algorithm>
+#include <array>
+
+namespace chessgame::network {
+
+GameRoom::GameRoom(int id, GameType type, int size)
+    : roomId(id), gameType(type), boardSize(size), gameFacade(std::make_unique<facade::GameFacade>()) {
+    valid = isValidSetting(type, size) && gameFacade->initGame(type, size);
+}
+
+bool GameRoom::isValidSetting(GameType type, int size) {
+    if (size < 8 || size > MAX_BOARD_SIZE) return false;
+    return type != OTHELLO || size == 8;
+}
+
+PieceType GameRoom::addPlayer(int clientId) {
+    if (blackPlayer < 0 && botColor != BLACK) {
+        blackPlayer = clientId;
+        return BLACK;
+    }
+    if (whitePlayer < 0 && botColor != WHITE) {
+        whitePlayer = clientId;
+        return WHITE;
+    }
+    return EMPTY;
+}
+
+PieceType GameRoom::removePlayer(int clientId) {
+    if (blackPlayer == clientId) {
+        blackPlayer = -1;
+        return BLACK;
+    }
+    if (whitePlayer == clientId) {
+        whitePlayer = -1;
+        return WHITE;
+    }
+    return EMPTY;
+}
+
+PieceType GameRoom::replacePlayer(int clientId, int newClientId) {
+    if (blackPlayer == clientId) {
+        blackPlayer = newClientId;
+        return BLACK;
+    }
+    if (whitePlayer == clientId) {
+        whitePlayer = newClientId;
+        return WHITE;
+    }
+    return EMPTY;
+}
+
+PieceType GameRoom::getPlayerColor(int clientId) const {
+    if (clientId == blackPlayer) return BLACK;
+    if (clientId == whitePlayer) return WHITE;
+    return EMPTY;
+}
+
+int GameRoom::getOpponent(int clientId) const {
+    if (clientId == blackPlayer) return whitePlayer;
+    if (clientId == whitePlayer) return blackPlayer;
+    return -1;
+}
+
+bool GameRoom::addSpectator(int clientId) {
+    if (getPlayerColor(clientId) != EMPTY || isSpectator(clientId)) return false;
+    spectators.push_back(clientId);
+    return true;
+}
+
+bool GameRoom::removeSpectator(int clientId) {
+    auto it = std::find(spectators.begin(), spectators.end(), clientId);
+    if (it == spectators.end()) return false;
+    spectators.erase(it);
+    return true;
+}
+
+bool GameRoom::isSpectator(int clientId) const {
+    return std::find(spectators.begin(), spectators.end(), clientId) != spectators.end();
+}
+
+void GameRoom::removeAudience(int clientId) {
+    auto it = std::find(audience.begin(), audience.end(), clientId);
+    if (it != audience.end()) audience.erase(it);
+}
+
+RoomInfo GameRoom::getInfo() const {
+    return RoomInfo{roomId, getGameType(), boardSize, getPlayerCount(), getSpectatorCount()};
+}
+
+GameStateInfo GameRoom::getStateInfo() const {
+    const auto& board = gameFacade->getBoard();
+    int size = board.getSize();
+
+    GameStateInfo state{gameFacade->getGameType(), gameFacade->getCurrentPlayer(), gameFacade->getGameStatus(), size, {}};
+    state.cells.reserve(size * size);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            state.cells.push_back(board.getPiece(i, j));
+        }
+    }
+    return state;
+}
+
+SharedMessage GameRoom::applyMove(int row, int col, PieceType player) {
+    const auto& board = gameFacade->getBoard();
+    int size = board.getSize();
+
+    // 记下落子前的棋盘, 落子后逐格比较
+    std::array<PieceType, MAX_BOARD_POINTS> before;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            before[i * size + j] = board.getPiece(i, j);
+        }
+    }
+
+    if (!gameFacade->makeMove(row, col, player)) return nullptr;
+    restartTurnClock();
+
+    BoardDeltaInfo delta;
+    delta.sequence = ++sequence;
+    delta.player = player;
+    delta.currentPlayer = gameFacade->getCurrentPlayer();
+    delta.gameStatus = gameFacade->getGameStatus();
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            PieceType piece = board.getPiece(i, j);
+            if (piece != before[i * size + j]) {
+                delta.changes.push_back(CellChange{i, j, piece});
+            }
+        }
+    }
+
+    auto message = std::make_shared<const EncodedMessage>(delta.toMessage());
+    appendEvent(message);
+    if (keyframeDeltas.size() + 1 >= KEYFRAME_INTERVAL) {
+        refreshKeyframe();
+    } else {
+        keyframeDeltas.push_back(message);
+    }
+    return message;
+}
+
+SharedMessage GameRoom::recordStateChange(PieceType player) {
+    BoardDeltaInfo delta{++sequence, player, gameFacade->getCurrentPlayer(), gameFacade->getGameStatus(), {}};
+    auto message = std::make_shared<const EncodedMessage>(delta.toMessage());
+    appendEvent(message);
+    refreshKeyframe();
+    return message;
+}
+
+void GameRoom::appendEvent(const SharedMessage& delta) {
+    eventLog.push_back(delta);
+    if (eventLog.size() > EVENT_LOG_SIZE) eventLog.pop_front();
+}
+
+bool GameRoom::getEventsAfter(uint64_t acknowledged, std::vector<SharedMessage>& events) const {
+    // 日志中第一个增量的序号为 sequence - size + 1
+    if (acknowledged > sequence || sequence - acknowledged > eventLog.size()) return false;
+    events.assign(eventLog.end() - static_cast<std::ptrdiff_t>(sequence - acknowledged), eventLog.end());
+    return true;
+}
+
+void GameRoom::refreshKeyframe() {
+    keyframe = std::make_shared<const EncodedMessage>(getSnapshot().toMessage());
+    keyframeDeltas.clear();
+}
+
+void GameRoom::restoreState(uint64_t restoredSequence, PieceType currentPlayer, GameStatus status, int passCount,
+                            const std::vector<int8_t>& cells) {
+    model::Board& board = gameFacade->getBoard();
+    int size = board.getSize();
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            board.setPiece(i, j, static_cast<PieceType>(cells[i * size + j]));
+        }
+    }
+    gameFacade->setCurrentPlayer(currentPlayer);
+    gameFacade->setGameStatus(status);
+    gameFacade->setPassCount(passCount);
+
+    sequence = restoredSequence;
+    eventLog.clear();
+    refreshKeyframe();
+    restartTurnClock();
+}
+
+std::vector<SharedMessage> GameRoom::getCatchUp() const {
+    std::vector<SharedMessage> result;
+    if (!keyframe) return result;
+    result.reserve(keyframeDeltas.size() + 1);
+    result.push_back(keyframe);
+    result.insert(result.end(), keyframeDeltas.begin(), keyframeDeltas.end());
+    return result;
+}
+
+GameRoom* RoomManager::createRoom(GameType type, int boardSize) {
+    auto room = std::make_shared<GameRoom>(nextRoomId, type, boardSize);
+    if (!room->isValid()) return nullptr;
+
+    GameRoom* result = room.get();
+    rooms[nextRoomId] = std::move(room);
+    openRooms.insert(nextRoomId);
+    nextRoomId += roomIdStride;
+    return result;
+}
+
+GameRoom* RoomManager::restoreRoom(int roomId, GameType type, int boardSize, PieceType botColor, int botLevel,
+                                   int black, int white, bool started) {
+    if (rooms.count(roomId)) return nullptr;
+    auto room = std::make_shared<GameRoom>(roomId, type, boardSize);
+    if (!room->isValid()) return nullptr;
+
+    if (botColor != EMPTY) room->seatBot(botColor, botLevel);
+    for (int clientId : {black, white}) {
+        if (clientId < 0) continue;
+        room->addPlayer(clientId);
+        clientRooms[clientId] = roomId;
+    }
+    if (started) room->markStarted();
+    else if (!room->isFull()) openRooms.insert(roomId);
+    reserveIds(roomId);
+
+    GameRoom* result = room.get();
+    rooms[roomId] = std::move(room);
+    return result;
+}
+
+void RoomManager::reserveIds(int roomId) {
+    while (nextRoomId <= roomId) nextRoomId += roomIdStride;
+}
+
+GameRoom* RoomManager::findRoom(int roomId) {
+    auto it = rooms.find(roomId);
+    return it == rooms.end() ? nullptr : it->second.get();
+}
+
+std::shared_ptr<GameRoom> RoomManager::shareRoom(int roomId) const {
+    auto it = rooms.find(roomId);
+    return it == rooms.end() ? nullptr : it->second;
+}
+
+GameRoom* RoomManager::findRoomOf(int clientId) {
+    auto it = clientRooms.find(clientId);
+    return it == clientRooms.end() ? nullptr : findRoom(it->second);
+}
+
+PieceType RoomManager::joinRoom(GameRoom* room, int clientId) {
+    if (!room || room->hasStarted() || clientRooms.count(clientId)) return EMPTY;
+
+    PieceType color = room->addPlayer(clientId);
+    if (color == EMPTY) return EMPTY;
+
+    clientRooms[clientId] = room->getId();
+    if (room->isFull()) openRooms.erase(room->getId());
+    return color;
+}
+
+bool RoomManager::watchRoom(GameRoom* room, int clientId) {
+    if (!room || clientRooms.count(clientId) || !room->addSpectator(clientId)) return false;
+    clientRooms[clientId] = room->getId();
+    return true;
+}
+
+GameRoom* RoomManager::replacePlayer(int clientId, int newClientId) {
+    auto it = clientRooms.find(clientId);
+    if (it == clientRooms.end() || clientRooms.count(newClientId)) return nullptr;
+
+    GameRoom* room = findRoom(it->second);
+    if (room->replacePlayer(clientId, newClientId) == EMPTY) return nullptr;
+    clientRooms.erase(it);
+    clientRooms[newClientId] = room->getId();
+    return room;
+}
+
+std::vector<int> RoomManager::leaveRoom(int clientId) {
+    std::vector<int> evicted;
+    auto it = clientRooms.find(clientId);
+    if (it == clientRooms.end()) return evicted;
+
+    int roomId = it->second;
+    clientRooms.erase(it);
+    GameRoom* room = findRoom(roomId);
+
+    // 观众离开不影响对局
+    if (room->removeSpectator(clientId)) return evicted;
+
+    int opponent = room->getOpponent(clientId);
+    room->removePlayer(clientId);
+
+    // 已开局的房间不再接受新玩家, 直接解散
+    if (room->hasStarted() && opponent >= 0) {
+        room->removePlayer(opponent);
+        clientRooms.erase(opponent);
+        evicted.push_back(opponent);
+    }
+
+    if (room->getHumanCount() == 0) {
+        // 房间随最后一名玩家解散, 观众一起移出
+        for (int spectator : room->getSpectators()) {
+            clientRooms.erase(spectator);
+            evicted.push_back(spectator);
+        }
+        openRooms.erase(roomId);
+        room->markClosed();
+        rooms.erase(roomId);
+    } else {
+        openRooms.insert(roomId);
+    }
+    return evicted;
+}
+
+std::vector<RoomInfo> RoomManager::listOpenRooms() const {
+    std::vector<RoomInfo> result;
+    result.reserve(openRooms.size());
+    for (int roomId : openRooms) {
+        result.push_back(rooms.at(roomId)->getInfo());
+    }
+    return result;
+}
+
+std::vector<RoomInfo> RoomManager::listLiveRooms() const {
+    std::vector<RoomInfo> result;
+    for (const auto& entry : rooms) {
+        if (entry.second->hasStarted()) result.push_back(entry.second->getInfo());
+    }
+    return result;
+}
+
+std::vector<GameRoom*> RoomManager::getLiveRooms() {
+    std::vector<GameRoom*> result;
+    for (const auto& entry : rooms) {
+        if (entry.second->hasStarted()) result.push_back(entry.second.get());
+    }
+    return result;
+}
+
+std::vector<GameRoom*> RoomManager::getRooms() {
+    std::vector<GameRoom*> result;
+    result.reserve(rooms.size());
+    for (const auto& entry : rooms) {
+        result.push_back(entry.second.get());
+    }
+    return result;
+}
+
+} // namespace chessgame::network
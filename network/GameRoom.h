@@ -0,0 +1,221 @@
+#pragma once
+#include "NetworkProtocol.h"
+#include "TimerWheel.h"
+#include "../facade/GameFacade.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 独立服务器上的一个对局房间.
+ *
+ * 房间持有权威的 GameFacade, 两名玩家以连接编号记录: 先进入的执黑, 后进入的执白.
+ * 观众只接收对局事件. 每个事件在房间内只编码一次 (SharedMessage), 再由 GameServer 发给所有人;
+ * 房间保留最近一次完整局面 (关键帧) 和其后的增量, 中途加入的观众收到这些即可追上当前局面;
+ * 另外保留最近 EVENT_LOG_SIZE 个带序号的增量 (事件日志), 断线重连的玩家只需补发其确认序号之后的部分.
+ * 一方可以是服务器托管的机器人 (见 BotService): 机器人座位在创建房间后设置, 不占连接编号.
+ * 房间不做任何 I/O. 成员 (玩家、观众名单) 由 I/O 线程上的 RoomManager 维护;
+ * 对局状态只在房间所属的工作线程上访问 (见 RoomWorkerPool), 工作线程另有一份观众名单用于转发.
+ */
+class GameRoom : public std::enable_shared_from_this<GameRoom> {
+private:
+    const int roomId;
+    const GameType gameType;
+    const int boardSize;
+    bool valid;
+
+    // 成员 (只在 I/O 线程访问)
+    int blackPlayer{-1};
+    int whitePlayer{-1};
+    bool started{false};
+    std::vector<int> spectators;
+    TimerWheel::TimerId turnTimer{TimerWheel::INVALID_TIMER};   // 回合计时的检查定时器
+
+    // 机器人座位和是否写入对局日志: 开局前在 I/O 线程上设置, 之后只读
+    PieceType botColor{EMPTY};
+    int botLevel{0};
+    bool journaled{false};
+    std::atomic<bool> closed{false};   // 房间已解散, 机器人线程据此放弃尚未计算的请求
+
+    // 对局状态 (创建后只在工作线程访问)
+    std::unique_ptr<facade::GameFacade> gameFacade;
+    uint64_t sequence{0};   // 已产生的增量数
+    std::vector<int> audience;                  // 接收对局事件的观众
+    SharedMessage keyframe;                     // 最近一次的完整局面 (BOARD_SNAPSHOT), 开局前为空
+    std::vector<SharedMessage> keyframeDeltas;  // 关键帧之后的增量 (BOARD_DELTA)
+    std::chrono::steady_clock::time_point turnStart;  // 当前回合开始的时间
+    std::deque<SharedMessage> eventLog;         // 最近的增量, 最后一个的序号为 sequence
+    bool botThinking{false};                    // 已向机器人请求着法, 尚未收到结果
+
+    // 积累这么多增量后重新生成关键帧, 限制中途加入时的追赶量
+    static constexpr size_t KEYFRAME_INTERVAL = 64;
+
+    // 事件日志的容量: 断线期间超过这么多步时改为发送完整局面
+    static constexpr size_t EVENT_LOG_SIZE = 256;
+
+    void appendEvent(const SharedMessage& delta);
+
+public:
+    GameRoom(int id, GameType type, int size);
+
+    // 规则是否接受该设置 (黑白棋只有 8x8 有标准开局)
+    static bool isValidSetting(GameType type, int size);
+
+    // 参数不被规则接受时无效 (例如棋盘大小越界)
+    bool isValid() const { return valid; }
+
+    int getId() const { return roomId; }
+    GameType getGameType() const { return gameType; }
+    int getBoardSize() const { return boardSize; }
+
+    // ---- 以下在 I/O 线程上调用 ----
+    int getHumanCount() const { return (blackPlayer >= 0) + (whitePlayer >= 0); }
+    int getPlayerCount() const { return getHumanCount() + (botColor != EMPTY); }
+    bool isFull() const { return getPlayerCount() == 2; }
+    bool hasStarted() const { return started; }
+    void markStarted() { started = true; }
+    TimerWheel::TimerId getTurnTimer() const { return turnTimer; }
+    void setTurnTimer(TimerWheel::TimerId id) { turnTimer = id; }
+
+    // 由机器人执 color 方 (开局前调用一次); 之后加入的玩家执另一方
+    void seatBot(PieceType color, int level) { botColor = color; botLevel = level; }
+    void markClosed() { closed.store(true, std::memory_order_relaxed); }
+    void markJournaled() { journaled = true; }
+
+    // 加入玩家, 返回分配的颜色 (房间已满时为 EMPTY)
+    PieceType addPlayer(int clientId);
+
+    // 移除玩家, 返回其颜色 (不在房间内时为 EMPTY)
+    PieceType removePlayer(int clientId);
+
+    // 断线重连后换成新的连接编号, 返回其颜色 (不是玩家时为 EMPTY)
+    PieceType replacePlayer(int clientId, int newClientId);
+
+    PieceType getPlayerColor(int clientId) const;
+    int getPlayer(PieceType color) const { return color == BLACK ? blackPlayer : (color == WHITE ? whitePlayer : -1); }
+    int getOpponent(int clientId) const;
+
+    bool addSpectator(int clientId);
+    bool removeSpectator(int clientId);
+    bool isSpectator(int clientId) const;
+    const std::vector<int>& getSpectators() const { return spectators; }
+    int getSpectatorCount() const { return static_cast<int>(spectators.size()); }
+
+    RoomInfo getInfo() const;
+
+    // ---- 以下在任意线程上调用 ----
+    bool hasBot() const { return botColor != EMPTY; }
+    PieceType getBotColor() const { return botColor; }
+    int getBotLevel() const { return botLevel; }
+    bool isClosed() const { return closed.load(std::memory_order_relaxed); }
+    bool isJournaled() const { return journaled; }
+
+    // ---- 以下在房间所属的工作线程上调用 ----
+    facade::GameFacade& getFacade() { return *gameFacade; }
+    const facade::GameFacade& getFacade() const { return *gameFacade; }
+
+    // 开局: 生成第一个关键帧, 开始第一回合计时
+    void beginGame() { refreshKeyframe(); restartTurnClock(); }
+    bool isLive() const { return keyframe != nullptr; }
+    uint64_t getSequence() const { return sequence; }
+
+    bool isBotThinking() const { return botThinking; }
+    void setBotThinking(bool thinking) { botThinking = thinking; }
+
+    // 轮到另一方时重新计时 (落子时自动调用)
+    void restartTurnClock() { turnStart = std::chrono::steady_clock::now(); }
+    std::chrono::steady_clock::time_point getTurnStart() const { return turnStart; }
+
+    void addAudience(int clientId) { audience.push_back(clientId); }
+    void removeAudience(int clientId);
+    const std::vector<int>& getAudience() const { return audience; }
+
+    // 当前局面 (BOARD_SYNC 的格式)
+    GameStateInfo getStateInfo() const;
+
+    // 带序号的当前局面
+    BoardSnapshotInfo getSnapshot() const { return BoardSnapshotInfo{sequence, getStateInfo()}; }
+
+    // 执行落子, 成功时返回编码好的 BOARD_DELTA (带新序号的全部变化格, 含提子、翻转), 失败时返回 nullptr
+    SharedMessage applyMove(int row, int col, PieceType player);
+
+    // 虚着、认输、超时之后调用: 记录不含变化格的增量 (推进序号), 并以当前局面重新生成关键帧
+    SharedMessage recordStateChange(PieceType player);
+
+    // 以当前局面重新生成关键帧
+    void refreshKeyframe();
+
+    // 从日志的快照恢复局面和序号 (cells 按行排列); 之前的事件日志作废, 重连的玩家改收完整局面
+    void restoreState(uint64_t restoredSequence, PieceType currentPlayer, GameStatus status, int passCount,
+                      const std::vector<int8_t>& cells);
+
+    // 追上当前局面所需的消息: 关键帧及其后的全部增量
+    std::vector<SharedMessage> getCatchUp() const;
+
+    // 序号 acknowledged 之后的全部增量; 已不在事件日志中 (或序号无效) 时返回 false
+    bool getEventsAfter(uint64_t acknowledged, std::vector<SharedMessage>& events) const;
+};
+
+/**
+ * @brief 房间表: 房间编号到房间, 连接编号到所在房间.
+ *
+ * 不加锁, 只能在 I/O 线程上使用.
+ */
+class RoomManager {
+private:
+    std::unordered_map<int, std::shared_ptr<GameRoom>> rooms;   // 工作线程上的任务也持有房间
+    std::unordered_map<int, int> clientRooms;   // 连接编号 -> 房间编号 (玩家和观众)
+    std::set<int> openRooms;                    // 尚未开始、还有空位的房间
+    int nextRoomId{1};
+    int roomIdStride{1};
+
+public:
+    // 房间编号从 first 开始, 每次加 stride (多进程分片时各分片的编号互不重叠, 按余数即可找到所在分片)
+    void setIdSpace(int first, int stride) { nextRoomId = first; roomIdStride = stride; }
+
+    // 创建房间, 参数无效时返回 nullptr
+    GameRoom* createRoom(GameType type, int boardSize);
+
+    // 按原编号恢复一局对局, 座位直接交给 black、white (空位和机器人一方为 -1); 编号已存在或参数无效时返回 nullptr.
+    // started 为 false 时恢复的是等待对手的房间 (平滑升级时交来的), 有空位时照常可以加入
+    GameRoom* restoreRoom(int roomId, GameType type, int boardSize, PieceType botColor, int botLevel,
+                          int black, int white, bool started = true);
+
+    // 之后新建的房间编号都大于 roomId (恢复对局时跳过日志中出现过的编号)
+    void reserveIds(int roomId);
+    int getNextRoomId() const { return nextRoomId; }
+
+    GameRoom* findRoom(int roomId);
+    std::shared_ptr<GameRoom> shareRoom(int roomId) const;
+    GameRoom* findRoomOf(int clientId);
+
+    // 把连接加入房间, 返回分配的颜色 (失败时为 EMPTY)
+    PieceType joinRoom(GameRoom* room, int clientId);
+
+    // 以观众身份进入房间
+    bool watchRoom(GameRoom* room, int clientId);
+
+    // 玩家断线重连: 把其座位和所在房间转给新的连接, 返回所在房间 (不是玩家时为 nullptr)
+    GameRoom* replacePlayer(int clientId, int newClientId);
+
+    // 连接离开所在房间 (玩家或观众); 已开局的房间随之解散, 对手和观众也被移出.
+    // 对手是机器人时房间随玩家离开解散.
+    // 返回被一起移出的连接编号
+    std::vector<int> leaveRoom(int clientId);
+
+    // 正在进行的对局 (可观战)
+    std::vector<RoomInfo> listLiveRooms() const;
+    std::vector<GameRoom*> getLiveRooms();
+    std::vector<GameRoom*> getRooms();
+
+    std::vector<RoomInfo> listOpenRooms() const;
+    size_t getRoomCount() const { return rooms.size(); }
+};
+
+} // namespace chessgame::network
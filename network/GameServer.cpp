@@ -0,0 +1,1391 @@
+#include "GameServer.h"
+#include "AsyncLogger.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+
+namespace chessgame::network {
+
+namespace {
+
+// 解析 "type,size" 形式的游戏设置, 之后可选第三项 (等级分或机器人级别)
+bool parseGameSetting(std::string_view data, GameType& type, int& boardSize, int* option = nullptr) {
+    size_t first = data.find(',');
+    if (first == std::string_view::npos) return false;
+    size_t second = data.find(',', first + 1);
+    
+    int typeValue;
+    int size;
+    if (!parseInt(data.substr(0, first), typeValue) || typeValue < GOMOKU || typeValue > OTHELLO) return false;
+    if (!parseInt(data.substr(first + 1, second - first - 1), size)) return false;   // 没有第二个逗号时取到末尾
+    if (second != std::string_view::npos && option && !parseInt(data.substr(second + 1), *option)) return false;
+    type = static_cast<GameType>(typeValue);
+    boardSize = size;
+    return true;
+}
+
+}
+
+GameServer::GameServer(GameType gameType, int boardSize, int maxConnections, int workerThreads, int botThreads)
+    : server(maxConnections), workers(workerThreads), bots(botThreads),
+      defaultGameType(gameType), defaultBoardSize(boardSize),
+      tokenGenerator(std::random_device{}()) {
+    server.setConnectCallback([this](int clientId) { onConnect(clientId); });
+    server.setDisconnectCallback([this](int clientId) { onDisconnect(clientId); });
+    server.setMessageCallback([this](int clientId, const NetworkMessage& message) {
+        onMessage(clientId, message);
+    });
+}
+
+GameServer::~GameServer() {
+    stop();
+}
+
+void GameServer::setShards(ShardMesh* mesh) {
+    shards = mesh;
+    server.setReusePort(true);
+    roomManager.setIdSpace(mesh->getShardIndex() + 1, mesh->getShardCount());
+}
+
+bool GameServer::start(int port) {
+    std::vector<int> recovered;
+    if (!takeoverPath.empty()) {
+        if (!takeOver(recovered)) return false;
+    } else if (!journalDirectory.empty() && !recoverRooms(recovered)) {
+        return false;
+    }
+    // 接管时先连上旧进程再在同一路径上监听, 供下一次升级
+    if (!upgradeSocketPath.empty() && !handover.listen(upgradeSocketPath)) return false;
+    if (!server.start(port)) return false;
+    server.post([this]() { scheduleMatchTick(); });
+    if (shards) {
+        server.post([this]() { server.watchReadable(shards->getInboxFd(), [this]() { receiveHandoffs(); }); });
+    }
+    if (!upgradeSocketPath.empty()) {
+        server.post([this]() { server.watchReadable(handover.getListenFd(), [this]() { beginHandover(); }); });
+    }
+    if (!takeoverPath.empty()) {
+        // 交来的连接都接手之后才接受新连接, 新连接不会先于原来的玩家进入交来的房间
+        server.post([this]() {
+            adoptHandedClients();
+            server.startAccepting();
+        });
+    }
+    if (journal || !takeoverPath.empty()) {
+        server.post([this, recovered]() {
+            resumeRecoveredRooms(recovered);
+            if (journal) scheduleJournalCheck();
+        });
+    }
+    return true;
+}
+
+void GameServer::stop() {
+    // 先停 I/O 线程, 不再有新的对局消息投递到工作线程; 机器人的结果经 I/O 线程投递, 随后可以直接停止.
+    // 对局日志最后关闭, 写出工作线程追加的全部记录; 停止时进行中的对局不写 CLOSE, 下次启动时恢复
+    server.stop();
+    bots.stop();
+    workers.stop();
+    if (journal) journal->close();
+}
+
+std::string GameServer::renderMetrics() const {
+    std::string out;
+    auto gauge = [&out](const char* name, uint64_t value) {
+        out += std::string("# TYPE chess_server_") + name + " gauge\nchess_server_" + name + " " +
+               std::to_string(value) + "\n";
+    };
+    gauge("connections", static_cast<uint64_t>(getConnectionCount()));
+    gauge("rooms", static_cast<uint64_t>(getRoomCount()));
+    gauge("queued_players", static_cast<uint64_t>(getQueuedCount()));
+    gauge("bot_games", static_cast<uint64_t>(getBotGameCount()));
+    gauge("bot_requests_queued", bots.getQueuedCount());
+    gauge("journal_segment_bytes", journal ? journal->getSegmentBytes() : 0);
+    gauge("log_records_dropped", AsyncLogger::instance().getDropped());
+    Metrics::render(Metrics::snapshot(), out);
+    return out;
+}
+
+void GameServer::onConnect(int clientId) {
+    lobby.insert(clientId);
+    autoMatchPending.insert(clientId);
+
+    // 旧版客户端不会发送房间命令, 等待片刻后自动匹配
+    server.runAfter(std::chrono::milliseconds(AUTO_MATCH_DELAY_MS), [this, clientId]() {
+        if (!handingOver && autoMatchPending.erase(clientId) && lobby.count(clientId)) {
+            quickMatch(clientId, defaultGameType, defaultBoardSize);
+        }
+    });
+}
+
+void GameServer::onDisconnect(int clientId) {
+    // 交接中被对端关闭的连接不会再交出
+    if (handingOver && handoverPending.erase(clientId) && handoverPending.empty()) {
+        server.post([this]() { detachForHandover(); });
+    }
+    cancelMatch(clientId);
+    lobby.erase(clientId);
+    autoMatchPending.erase(clientId);
+    // 持有会话的玩家断线后保留座位, 等待重连
+    if (suspendSession(clientId)) return;
+    leaveRoom(clientId);
+}
+
+void GameServer::onMessage(int clientId, const NetworkMessage& message) {
+    switch (message.type) {
+        case MessageType::ROOM_CREATE:
+        case MessageType::ROOM_JOIN:
+        case MessageType::ROOM_LEAVE:
+        case MessageType::ROOM_INFO:
+        case MessageType::ROOM_WATCH:
+        case MessageType::ROOM_BOT:
+        case MessageType::SESSION_RESUME:
+            // 支持房间命令的客户端自行选择房间
+            autoMatchPending.erase(clientId);
+            break;
+        default:
+            break;
+    }
+
+    switch (message.type) {
+        case MessageType::ROOM_CREATE:
+            handleRoomCreate(clientId, message.data);
+            return;
+        case MessageType::ROOM_JOIN:
+            handleRoomJoin(clientId, message);
+            return;
+        case MessageType::ROOM_LEAVE:
+            cancelMatch(clientId);
+            leaveRoom(clientId);
+            lobby.insert(clientId);
+            return;
+        case MessageType::ROOM_INFO:
+            handleRoomList(clientId);
+            return;
+        case MessageType::ROOM_WATCH:
+            handleRoomWatch(clientId, message);
+            return;
+        case MessageType::ROOM_BOT:
+            handleRoomBot(clientId, message.data);
+            return;
+        case MessageType::SESSION_RESUME:
+            handleSessionResume(clientId, message);
+            return;
+        default:
+            break;
+    }
+
+    GameRoom* room = roomManager.findRoomOf(clientId);
+    if (!room) {
+        if (message.type != MessageType::DISCONNECT) sendError(clientId, "尚未加入房间");
+        return;
+    }
+    dispatchGameMessage(clientId, *room, message);
+}
+
+void GameServer::handleRoomCreate(int clientId, const std::string& data) {
+    if (roomManager.findRoomOf(clientId)) {
+        sendError(clientId, "已在房间中");
+        return;
+    }
+
+    GameType type;
+    int boardSize;
+    GameRoom* room = parseGameSetting(data, type, boardSize) ? roomManager.createRoom(type, boardSize) : nullptr;
+    if (!room) {
+        sendError(clientId, "无效的游戏设置");
+        return;
+    }
+    enterRoom(clientId, *room);
+}
+
+void GameServer::handleRoomJoin(int clientId, const NetworkMessage& message) {
+    const std::string& data = message.data;
+    if (roomManager.findRoomOf(clientId)) {
+        sendError(clientId, "已在房间中");
+        return;
+    }
+
+    // 空数据或 "type,size[,rating]" 为排队匹配
+    GameType type = defaultGameType;
+    int boardSize = defaultBoardSize;
+    int rating = Matchmaker::DEFAULT_RATING;
+    if (data.empty() || parseGameSetting(data, type, boardSize, &rating)) {
+        quickMatch(clientId, type, boardSize, rating);
+        return;
+    }
+
+    int roomId;
+    if (!parseInt(data, roomId)) {
+        sendError(clientId, "无效的房间号");
+        return;
+    }
+    if (routeToShard(clientId, shardOfRoom(roomId), message)) return;
+
+    GameRoom* room = roomManager.findRoom(roomId);
+    if (!room || room->isFull() || room->hasStarted()) {
+        sendError(clientId, "房间不存在或已满");
+        return;
+    }
+    enterRoom(clientId, *room);
+}
+
+void GameServer::handleRoomList(int clientId) {
+    std::string data;
+    for (const RoomInfo& info : roomManager.listOpenRooms()) {
+        if (!data.empty()) data += ";";
+        data += info.serialize();
+    }
+    server.sendToClient(clientId, NetworkMessage(MessageType::ROOM_INFO, data));
+}
+
+void GameServer::handleRoomWatch(int clientId, const NetworkMessage& message) {
+    const std::string& data = message.data;
+    if (data.empty()) {
+        std::string list;
+        for (const RoomInfo& info : roomManager.listLiveRooms()) {
+            if (!list.empty()) list += ";";
+            list += info.serialize();
+        }
+        server.sendToClient(clientId, NetworkMessage(MessageType::ROOM_INFO, list));
+        return;
+    }
+    if (roomManager.findRoomOf(clientId)) {
+        sendError(clientId, "已在房间中");
+        return;
+    }
+
+    int roomId;
+    if (!parseInt(data, roomId)) {
+        sendError(clientId, "无效的房间号");
+        return;
+    }
+    if (routeToShard(clientId, shardOfRoom(roomId), message)) return;
+
+    GameRoom* room = roomManager.findRoom(roomId);
+    if (!roomManager.watchRoom(room, clientId)) {
+        sendError(clientId, "房间不存在");
+        return;
+    }
+    cancelMatch(clientId);
+    lobby.erase(clientId);
+
+    server.sendToClient(clientId, NetworkMessage(MessageType::ROOM_INFO, room->getInfo().serialize()));
+    submitToRoom(*room, [this, clientId](GameRoom& target) {
+        target.addAudience(clientId);
+        // 未开局的房间在开局时统一发送局面
+        if (target.isLive()) sendSnapshot(clientId, target);
+    });
+}
+
+void GameServer::handleRoomBot(int clientId, const std::string& data) {
+    if (roomManager.findRoomOf(clientId)) {
+        sendError(clientId, "已在房间中");
+        return;
+    }
+
+    GameType type = defaultGameType;
+    int boardSize = defaultBoardSize;
+    int level = DEFAULT_BOT_LEVEL;
+    if (!data.empty() && !parseGameSetting(data, type, boardSize, &level)) {
+        sendError(clientId, "无效的游戏设置");
+        return;
+    }
+    if (level < 1 || level > 3 || !GameRoom::isValidSetting(type, boardSize)) {
+        sendError(clientId, "无效的游戏设置");
+        return;
+    }
+
+    // 准入控制: 请求平均要排队半个预算以上时机器人已跟不上, 只拒绝新对局, 已开始的对局照常计算
+    if (botGameCount.load() >= maxBotGames || bots.isSaturated(botBudget / 2)) {
+        Metrics::add(Metrics::BOT_GAMES_REJECTED);
+        sendError(clientId, "机器人繁忙, 请稍后再试");
+        return;
+    }
+
+    GameRoom* room = roomManager.createRoom(type, boardSize);
+    if (!room) {
+        sendError(clientId, "无效的游戏设置");
+        return;
+    }
+    room->seatBot(WHITE, level);
+    botGameCount++;
+    enterRoom(clientId, *room);
+}
+
+void GameServer::quickMatch(int clientId, GameType type, int boardSize, int rating) {
+    if (!GameRoom::isValidSetting(type, boardSize)) {
+        sendError(clientId, "无效的游戏设置");
+        return;
+    }
+
+    // 重复请求时按新的设置重新排队
+    cancelMatch(clientId);
+    Matchmaker::Match match;
+    if (matchmaker.enqueue(clientId, type, boardSize, rating, match)) {
+        startMatch(match);
+    }
+    queuedCount = static_cast<int>(matchmaker.getQueuedCount());
+}
+
+void GameServer::cancelMatch(int clientId) {
+    if (matchmaker.cancel(clientId)) {
+        queuedCount = static_cast<int>(matchmaker.getQueuedCount());
+    }
+}
+
+void GameServer::startMatch(const Matchmaker::Match& match) {
+    // 配对成功后才建房, 先排队的执黑
+    GameRoom* room = roomManager.createRoom(match.gameType, match.boardSize);
+    if (!room) return;
+    enterRoom(match.first, *room);
+    enterRoom(match.second, *room);
+}
+
+void GameServer::scheduleMatchTick() {
+    server.runAfter(std::chrono::milliseconds(MATCH_TICK_MS), [this]() {
+        // 交接开始后不再配对, 排队中的玩家到新进程中重新排队
+        if (handingOver) return;
+        for (const Matchmaker::Match& match : matchmaker.tick()) {
+            startMatch(match);
+        }
+        queuedCount = static_cast<int>(matchmaker.getQueuedCount());
+        scheduleMatchTick();
+    });
+}
+
+void GameServer::enterRoom(int clientId, GameRoom& room) {
+    cancelMatch(clientId);
+    if (roomManager.joinRoom(&room, clientId) == EMPTY) {
+        sendError(clientId, "加入房间失败");
+        return;
+    }
+    lobby.erase(clientId);
+    roomCount = static_cast<int>(roomManager.getRoomCount());
+
+    server.sendToClient(clientId, NetworkMessage(MessageType::ROOM_INFO, room.getInfo().serialize()));
+    if (room.isFull()) startGame(room);
+}
+
+void GameServer::leaveRoom(int clientId) {
+    // 观众离开时工作线程上的名单也要同步移除
+    GameRoom* room = roomManager.findRoomOf(clientId);
+    if (room && room->isSpectator(clientId)) {
+        submitToRoom(*room, [clientId](GameRoom& target) { target.removeAudience(clientId); });
+    }
+    int roomId = room ? room->getId() : -1;
+    bool botRoom = room && room->hasBot();
+    bool journaled = room && room->isJournaled();
+    TimerWheel::TimerId turnTimer = room ? room->getTurnTimer() : TimerWheel::INVALID_TIMER;
+
+    std::vector<int> evicted = roomManager.leaveRoom(clientId);
+    roomCount = static_cast<int>(roomManager.getRoomCount());
+    // 房间解散后不再需要回合计时
+    if (roomId >= 0 && !roomManager.findRoom(roomId)) {
+        server.cancelTimer(turnTimer);
+        if (botRoom) botGameCount--;
+        if (journaled) {
+            JournalRecord record;
+            record.type = JournalRecord::CLOSE;
+            record.roomId = roomId;
+            journal->append(record);
+        }
+    }
+
+    // 对局中离开: 房间解散, 通知对手和观众并让其回到大厅; 断线保留中的玩家已没有连接, 会话随房间结束
+    endSession(clientId);
+    evicted.erase(std::remove_if(evicted.begin(), evicted.end(), [this](int id) { return endSession(id); }),
+                  evicted.end());
+    lobby.insert(evicted.begin(), evicted.end());
+    server.multicastMessage(evicted, EncodedMessage(NetworkMessage(MessageType::DISCONNECT, "")));
+}
+
+void GameServer::startGame(GameRoom& room) {
+    room.markStarted();
+    AsyncLogger::instance().info("房间 ", room.getId(), " 开始对局");
+
+    int black = room.getPlayer(BLACK);
+    int white = room.getPlayer(WHITE);
+    // 先发会话令牌: 开局记录要带上双方的令牌, 并且必须先于工作线程上的第一条落子记录
+    issueSession(black, room.getId());
+    issueSession(white, room.getId());
+    JournalRecord record;
+    if (journal && describeRoom(room, record)) {
+        record.type = JournalRecord::OPEN;
+        room.markJournaled();
+        journal->append(record);
+    }
+    submitToRoom(room, [this, black, white](GameRoom& target) { beginGame(target, black, white); });
+    if (turnTimeout.count() > 0) armTurnClock(room.getId(), turnTimeout);
+}
+
+void GameServer::armTurnClock(int roomId, std::chrono::milliseconds delay) {
+    GameRoom* room = roomManager.findRoom(roomId);
+    if (!room || !room->hasStarted()) return;
+    server.cancelTimer(room->getTurnTimer());
+    room->setTurnTimer(server.runAfter(delay, [this, roomId]() { onTurnClock(roomId); }));
+}
+
+void GameServer::onTurnClock(int roomId) {
+    GameRoom* room = roomManager.findRoom(roomId);
+    if (!room || handingOver) return;
+    room->setTurnTimer(TimerWheel::INVALID_TIMER);
+
+    int black = room->getPlayer(BLACK);
+    int white = room->getPlayer(WHITE);
+    submitToRoom(*room, [this, black, white](GameRoom& target) { checkTurnClock(target, black, white); });
+}
+
+void GameServer::issueSession(int clientId, int roomId) {
+    // 只有支持增量同步的客户端能按序号补发
+    if (sessionGrace.count() <= 0 ||
+        server.getProtocolVersion(clientId) < NetworkConfig::DELTA_SYNC_PROTOCOL_VERSION) {
+        return;
+    }
+
+    // 分片时令牌的前两位是所在分片, 重连的连接落在别的分片上时据此转交
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    if (shards) {
+        oss << std::setw(2) << shards->getShardIndex() << std::setw(14) << (tokenGenerator() >> 8);
+    } else {
+        oss << std::setw(16) << tokenGenerator();
+    }
+    oss << std::setw(16) << tokenGenerator();
+    std::string token = oss.str();
+    sessions[token] = Session{clientId, roomId};
+    clientSessions[clientId] = token;
+    server.sendToClient(clientId, NetworkMessage(MessageType::SESSION_TOKEN, token));
+}
+
+bool GameServer::suspendSession(int clientId) {
+    auto it = clientSessions.find(clientId);
+    if (it == clientSessions.end()) return false;
+    Session& session = sessions.at(it->second);
+    if (!session.connected) return false;
+
+    // 座位和房间成员不变, 期间发给该连接的消息都会丢弃, 重连时从事件日志补发
+    session.connected = false;
+    std::string token = it->second;
+    session.graceTimer = server.runAfter(sessionGrace, [this, token]() { expireSession(token); });
+    AsyncLogger::instance().info("玩家断线, 保留房间 ", session.roomId, " 的座位 (连接号: ", clientId, ")");
+    return true;
+}
+
+void GameServer::expireSession(const std::string& token) {
+    auto it = sessions.find(token);
+    if (it == sessions.end() || it->second.connected || handingOver) return;
+    it->second.graceTimer = TimerWheel::INVALID_TIMER;
+
+    AsyncLogger::instance().info("玩家未在保留时间内重连 (连接号: ", it->second.clientId, ")");
+    leaveRoom(it->second.clientId);
+}
+
+bool GameServer::endSession(int clientId) {
+    auto it = clientSessions.find(clientId);
+    if (it == clientSessions.end()) return false;
+
+    auto session = sessions.find(it->second);
+    bool suspended = !session->second.connected;
+    server.cancelTimer(session->second.graceTimer);
+    sessions.erase(session);
+    clientSessions.erase(it);
+    return suspended;
+}
+
+void GameServer::handleSessionResume(int clientId, const NetworkMessage& message) {
+    const std::string& data = message.data;
+    if (roomManager.findRoomOf(clientId)) {
+        sendError(clientId, "已在房间中");
+        return;
+    }
+
+    // "令牌,已确认序号"
+    size_t comma = data.find(',');
+    uint64_t acknowledged = 0;
+    if (comma == std::string::npos || !parseInt(std::string_view(data).substr(comma + 1), acknowledged)) {
+        sendError(clientId, "无效的重连请求");
+        return;
+    }
+
+    int shard;
+    auto parsed = std::from_chars(data.data(), data.data() + std::min<size_t>(comma, 2), shard, 16);
+    if (shards && parsed.ec == std::errc() && comma >= 2 && routeToShard(clientId, shard, message)) return;
+
+    auto it = sessions.find(data.substr(0, comma));
+    GameRoom* room = it == sessions.end() ? nullptr : roomManager.replacePlayer(it->second.clientId, clientId);
+    if (!room) {
+        sendError(clientId, "会话已失效");
+        return;
+    }
+    cancelMatch(clientId);
+    lobby.erase(clientId);
+
+    // 旧连接可能还没被发现断开 (例如网络切换后立即重连): 座位已经转走, 直接断开它
+    Session& session = it->second;
+    int previous = session.clientId;
+    if (session.connected) server.disconnectClient(previous);
+    server.cancelTimer(session.graceTimer);
+    session.graceTimer = TimerWheel::INVALID_TIMER;
+    session.clientId = clientId;
+    session.connected = true;
+    clientSessions.erase(previous);
+    clientSessions[clientId] = it->first;
+    AsyncLogger::instance().info("玩家重连, 回到房间 ", room->getId(), " (连接号: ", previous, " -> ", clientId, ")");
+
+    PieceType color = room->getPlayerColor(clientId);
+    submitToRoom(*room, [this, clientId, color, acknowledged](GameRoom& target) {
+        resumeSession(target, clientId, color, acknowledged);
+    });
+}
+
+void GameServer::onBotMove(int roomId, uint64_t sequence, const Move& move) {
+    // 房间可能已经解散; 玩家可能已断线重连, 按当前的连接编号投递.
+    // 交接开始后房间状态已经取走, 由新进程重新请求着法
+    GameRoom* room = roomManager.findRoom(roomId);
+    if (!room || !room->hasBot() || handingOver) return;
+    int opponent = room->getPlayer(room->getBotColor() == BLACK ? WHITE : BLACK);
+    submitToRoom(*room, [this, opponent, sequence, move](GameRoom& target) {
+        applyBotMove(target, opponent, sequence, move);
+    });
+}
+
+int GameServer::shardOfRoom(int roomId) const {
+    // 编号无效时留在本分片, 照常回复房间不存在
+    if (!shards || roomId <= 0) return shards ? shards->getShardIndex() : 0;
+    return (roomId - 1) % shards->getShardCount();
+}
+
+bool GameServer::routeToShard(int clientId, int shard, const NetworkMessage& message) {
+    if (!shards || shard == shards->getShardIndex() || shard < 0 || shard >= shards->getShardCount()) {
+        return false;
+    }
+
+    // 本分片不再记得这个连接; 交给对方的数据里, 触发转交的命令排在最前面, 由对方重新处理
+    cancelMatch(clientId);
+    lobby.erase(clientId);
+    autoMatchPending.erase(clientId);
+    server.detachClient(clientId, [this, shard, message](NetworkServer::Handoff& handoff) {
+        handoff.pending.insert(0, message.encodeFrame(handoff.protocolVersion));
+        shards->send(shard, handoff);   // 失败时连接随本进程的一份描述符关闭
+        close(handoff.fd);
+    });
+    return true;
+}
+
+void GameServer::receiveHandoffs() {
+    NetworkServer::Handoff handoff;
+    while (shards->receive(handoff)) {
+        server.adoptClient(handoff);
+    }
+}
+
+bool GameServer::describeRoom(const GameRoom& room, JournalRecord& record) const {
+    record.roomId = room.getId();
+    record.gameType = room.getGameType();
+    record.boardSize = room.getBoardSize();
+    record.botColor = room.getBotColor();
+    record.botLevel = room.getBotLevel();
+    // 没有令牌的玩家断线即离开, 这样的对局无法恢复, 不必记录 (返回 false, 已有的令牌照常填写)
+    bool complete = true;
+    for (PieceType color : {BLACK, WHITE}) {
+        if (color == record.botColor) continue;
+        auto it = clientSessions.find(room.getPlayer(color));
+        if (it == clientSessions.end()) {
+            complete = false;
+            continue;
+        }
+        (color == BLACK ? record.blackToken : record.whiteToken) = it->second;
+    }
+    return complete;
+}
+
+bool GameServer::recoverRooms(std::vector<int>& roomIds) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<JournalRecord> records;
+    journal = std::make_unique<GameJournal>();
+    if (!journal->open(journalDirectory, records)) {
+        journal.reset();
+        return false;
+    }
+
+    // 按房间分组, 每个房间从最近的完整状态开始重放; 房间解散之后的记录
+    // (压缩与解散同时发生时写入的完整状态) 一律忽略
+    std::unordered_map<int, std::vector<JournalRecord>> histories;
+    std::unordered_set<int> closedRooms;
+    int lastRoomId = 0;
+    for (JournalRecord& record : records) {
+        lastRoomId = std::max(lastRoomId, record.roomId);
+        if (closedRooms.count(record.roomId)) continue;
+        if (record.type == JournalRecord::CLOSE) {
+            closedRooms.insert(record.roomId);
+            histories.erase(record.roomId);
+            continue;
+        }
+        std::vector<JournalRecord>& history = histories[record.roomId];
+        if (record.type == JournalRecord::SNAPSHOT) history.clear();
+        history.push_back(std::move(record));
+    }
+    roomManager.reserveIds(lastRoomId);
+
+    // 房间、座位和会话在本线程上建好; 尚未重连的座位用不会分配给连接的编号占住
+    std::vector<std::pair<GameRoom*, const std::vector<JournalRecord>*>> restored;
+    for (const auto& [roomId, history] : histories) {
+        const JournalRecord& first = history.front();
+        bool seated = first.type == JournalRecord::OPEN || first.type == JournalRecord::SNAPSHOT;
+        if (!seated || (first.botColor != BLACK && first.blackToken.empty()) ||
+            (first.botColor != WHITE && first.whiteToken.empty())) {
+            continue;
+        }
+        int black = first.botColor == BLACK ? -1 : server.reserveClientId();
+        int white = first.botColor == WHITE ? -1 : server.reserveClientId();
+        GameRoom* room = roomManager.restoreRoom(roomId, first.gameType, first.boardSize, first.botColor,
+                                                 first.botLevel, black, white);
+        if (!room) continue;
+        room->markJournaled();
+        if (room->hasBot()) botGameCount++;
+        for (int clientId : {black, white}) {
+            if (clientId < 0) continue;
+            const std::string& token = clientId == black ? first.blackToken : first.whiteToken;
+            sessions[token] = Session{clientId, roomId, false};
+            clientSessions[clientId] = token;
+        }
+        restored.emplace_back(room, &history);
+        roomIds.push_back(roomId);
+    }
+    roomCount = static_cast<int>(roomManager.getRoomCount());
+    replayRooms(restored);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    AsyncLogger::instance().info("从对局日志恢复 ", restored.size(), " 局 (", records.size(), " 条记录), 用时 ",
+                                 elapsed.count(), " 毫秒");
+    return true;
+}
+
+void GameServer::replayRooms(const std::vector<std::pair<GameRoom*, const std::vector<JournalRecord>*>>& rooms) {
+    // 各房间在自己的工作线程上重放, 房间之间并行
+    std::mutex doneMutex;
+    std::condition_variable allDone;
+    size_t remaining = rooms.size();
+    for (const auto& [room, history] : rooms) {
+        submitToRoom(*room, [this, history = history, &doneMutex, &allDone, &remaining](GameRoom& target) {
+            replayRoom(target, *history);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) allDone.notify_one();
+        });
+    }
+    std::unique_lock<std::mutex> lock(doneMutex);
+    allDone.wait(lock, [&remaining]() { return remaining == 0; });
+}
+
+void GameServer::resumeRecoveredRooms(const std::vector<int>& roomIds) {
+    // 恢复出的玩家都处于断线保留状态 (已经重连的除外), 从现在开始计算保留时间
+    for (auto& [token, session] : sessions) {
+        if (session.connected || session.graceTimer != TimerWheel::INVALID_TIMER) continue;
+        std::string key = token;
+        session.graceTimer = server.runAfter(sessionGrace, [this, key]() { expireSession(key); });
+    }
+    for (int roomId : roomIds) {
+        GameRoom* room = roomManager.findRoom(roomId);
+        if (!room) continue;
+        if (turnTimeout.count() > 0) armTurnClock(roomId, turnTimeout);
+        if (room->hasBot()) submitToRoom(*room, [this](GameRoom& target) { requestBotMove(target); });
+    }
+    // 恢复后立即压缩: 已恢复的对局写入新段, 旧段 (可能以半条记录结尾, 或是旧进程写的) 随之删除
+    if (journal) compactJournal();
+}
+
+void GameServer::scheduleJournalCheck() {
+    server.runAfter(std::chrono::milliseconds(JOURNAL_CHECK_MS), [this]() {
+        if (handingOver) return;
+        // 有记录未能写出时也压缩: 完整状态补上缺失的记录
+        if (!compacting && (journal->getSegmentBytes() >= JOURNAL_COMPACT_BYTES || journal->takeWriteFailure())) {
+            compactJournal();
+        }
+        scheduleJournalCheck();
+    });
+}
+
+void GameServer::compactJournal() {
+    if (compacting) return;
+    compacting = true;
+
+    // 之后的记录都写入新段; 每个房间在自己的工作线程上写入完整状态, 在此之前的落子记录仍在旧段中,
+    // 之后的落子记录在完整状态之后. 全部写完并落盘后旧段才删除
+    uint64_t segment = journal->rotate();
+    std::vector<GameRoom*> rooms = roomManager.getLiveRooms();
+    auto remaining = std::make_shared<std::atomic<size_t>>(rooms.size() + 1);
+    auto finish = [this, segment, remaining]() {
+        if (remaining->fetch_sub(1) != 1) return;
+        server.post([this, segment]() {
+            journal->retireBefore(segment);
+            compacting = false;
+        });
+    };
+
+    for (GameRoom* room : rooms) {
+        JournalRecord record;
+        if (!room->isJournaled() || !describeRoom(*room, record)) {
+            finish();
+            continue;
+        }
+        record.type = JournalRecord::SNAPSHOT;
+        submitToRoom(*room, [this, record, finish](GameRoom& target) mutable {
+            // 已解散的房间不再写入; 解散记录已在新段中时, 重放也会忽略之后的记录
+            if (!target.isClosed()) {
+                captureState(target, record);
+                journal->append(record);
+            }
+            finish();
+        });
+    }
+    finish();
+}
+
+void GameServer::beginHandover() {
+    if (handingOver || !handover.acceptPeer()) return;
+
+    // 先交出监听 socket, 等对方确认收下: 在此之前失败时什么都没有改变, 照常运行并等待下一个接替者
+    HandoverLink::Message reply;
+    if (!handover.sendListeners(server.getListenFds()) || !handover.receive(reply) ||
+        reply.kind != HandoverLink::READY) {
+        AsyncLogger::instance().warn("新进程没有接过监听 socket, 取消升级");
+        handover.closePeer();
+        return;
+    }
+    AsyncLogger::instance().info("新进程已接过监听 socket, 开始交出房间和连接");
+    handingOver = true;
+    server.unwatch(handover.getListenFd());
+    server.releaseListeners();
+    server.suspendInput();
+
+    // 各房间在自己的工作线程上取得状态: 排在前面的对局消息都已处理完, 发出的消息已进入连接的发送队列,
+    // 随连接一起交出. 此后不再处理消息, 计时和机器人的着法也已停止, 房间状态不再变化
+    std::vector<GameRoom*> rooms = roomManager.getRooms();
+    auto states = std::make_shared<std::vector<JournalRecord>>(rooms.size());
+    auto remaining = std::make_shared<std::atomic<size_t>>(rooms.size() + 1);
+    auto finish = [this, states, remaining]() {
+        if (remaining->fetch_sub(1) != 1) return;
+        server.post([this, states]() {
+            for (JournalRecord& state : *states) {
+                int roomId = state.roomId;
+                handoverStates[roomId] = std::move(state);
+            }
+            detachForHandover();
+        });
+    };
+    for (size_t i = 0; i < rooms.size(); ++i) {
+        JournalRecord* state = &(*states)[i];
+        state->type = JournalRecord::SNAPSHOT;
+        state->roomId = rooms[i]->getId();
+        submitToRoom(*rooms[i], [this, state, finish](GameRoom& target) {
+            captureState(target, *state);
+            finish();
+        });
+    }
+    finish();
+}
+
+void GameServer::detachForHandover() {
+    if (handedOver) return;
+    // 取消之前完成的 accept 和其他分片转交来的连接仍可能在交接期间登记: 反复摘下, 直到没有剩下的
+    for (int clientId : server.getConnectedClients()) {
+        if (handoverPending.count(clientId)) continue;
+        bool detaching = server.detachClient(clientId, [this, clientId](NetworkServer::Handoff& handoff) {
+            ClientHandover client;
+            client.clientId = clientId;
+            client.handoff = std::move(handoff);
+            // 通道的描述符随连接释放, 而连接要等全部摘下后才发送: 先复制一份
+            for (int& fd : client.handoff.channelFds) {
+                if (fd >= 0) fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+            }
+            handoverClients.push_back(std::move(client));
+            if (handoverPending.erase(clientId) && handoverPending.empty()) detachForHandover();
+        });
+        if (detaching) handoverPending.insert(clientId);
+    }
+    if (handoverPending.empty()) finishHandover();
+}
+
+void GameServer::finishHandover() {
+    if (handedOver) return;
+    handedOver = true;
+
+    // 连接全部摘下之后才确定各自的位置; 交接期间解散的房间不再交出
+    bool ok = true;
+    size_t roomsSent = 0;
+    for (auto& [roomId, state] : handoverStates) {
+        GameRoom* room = roomManager.findRoom(roomId);
+        if (!room) continue;
+        RoomHandover transfer;
+        transfer.state = std::move(state);
+        describeRoom(*room, transfer.state);
+        transfer.started = room->hasStarted();
+        transfer.black = room->getPlayer(BLACK);
+        transfer.white = room->getPlayer(WHITE);
+        ok = ok && handover.sendRoom(transfer);
+        roomsSent++;
+    }
+    for (ClientHandover& client : handoverClients) {
+        describeClient(client);
+        // 发送失败时连接随本进程的一份描述符关闭
+        ok = ok && handover.sendClient(client);
+        close(client.handoff.fd);
+        for (int fd : client.handoff.channelFds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+    // 对局日志由新进程接着写: 先写出全部记录再通知对方
+    if (journal) journal->close();
+    ok = ok && handover.sendDone(roomManager.getNextRoomId());
+    handover.closePeer();
+    if (ok) {
+        AsyncLogger::instance().info("已交给新进程: 房间 ", roomsSent, " 个, 连接 ", handoverClients.size(), " 个");
+    } else {
+        AsyncLogger::instance().warn("交接未完成, 未交出的连接已关闭");
+    }
+    handoverClients.clear();
+    handoverStates.clear();
+    server.stop();
+}
+
+void GameServer::describeClient(ClientHandover& client) {
+    int clientId = client.clientId;
+    if (GameRoom* room = roomManager.findRoomOf(clientId)) {
+        client.place = room->isSpectator(clientId) ? ClientHandover::SPECTATOR : ClientHandover::PLAYER;
+        client.roomId = room->getId();
+    } else if (matchmaker.getTicket(clientId, client.gameType, client.boardSize, client.rating)) {
+        client.place = ClientHandover::QUEUED;
+    } else if (autoMatchPending.count(clientId)) {
+        client.place = ClientHandover::AUTO_MATCH;
+    } else {
+        client.place = ClientHandover::LOBBY;
+    }
+}
+
+bool GameServer::takeOver(std::vector<int>& roomIds) {
+    auto start = std::chrono::steady_clock::now();
+    if (!handover.connect(takeoverPath)) return false;
+
+    // 收下监听 socket 并确认, 旧进程随即停止接受新连接; 之后收齐房间和连接, 直到 DONE
+    HandoverLink::Message message;
+    if (!handover.receive(message) || message.kind != HandoverLink::LISTENERS || !handover.sendReady()) {
+        std::cerr << "旧进程没有交出监听 socket" << std::endl;
+        handover.closePeer();
+        return false;
+    }
+    server.setListeners(message.listeners[0], message.listeners.size() > 1 ? message.listeners[1] : -1);
+
+    std::vector<RoomHandover> rooms;
+    int nextRoomId = 0;
+    bool complete = false;
+    while (!complete && handover.receive(message)) {
+        switch (message.kind) {
+            case HandoverLink::ROOM:
+                rooms.push_back(std::move(message.room));
+                break;
+            case HandoverLink::CLIENT:
+                handoverClients.push_back(std::move(message.client));
+                break;
+            case HandoverLink::DONE:
+                nextRoomId = message.nextRoomId;
+                complete = true;
+                break;
+            default:
+                break;
+        }
+    }
+    handover.closePeer();
+    // 监听 socket 已经交来, 旧进程不再服务: 没有收齐时只接管已收到的部分
+    if (!complete) AsyncLogger::instance().warn("旧进程没有发完交接消息, 只接管已收到的房间和连接");
+
+    // 日志中的对局都在交来的房间里 (旧进程已写完并关闭): 只跳过出现过的房间编号, 旧段随恢复后的压缩删除
+    if (!journalDirectory.empty()) {
+        std::vector<JournalRecord> records;
+        journal = std::make_unique<GameJournal>();
+        if (journal->open(journalDirectory, records)) {
+            for (const JournalRecord& record : records) roomManager.reserveIds(record.roomId);
+        } else {
+            AsyncLogger::instance().warn("打开对局日志失败, 本进程不再记录对局");
+            journal.reset();
+        }
+    }
+    if (nextRoomId > 0) roomManager.reserveIds(nextRoomId - 1);
+
+    // 与从日志恢复相同, 座位先用占位编号占住, 交来的连接接手后换回; 开局前的房间照常等待加入
+    std::vector<std::vector<JournalRecord>> histories;
+    histories.reserve(rooms.size());
+    std::vector<std::pair<GameRoom*, const std::vector<JournalRecord>*>> restored;
+    for (RoomHandover& transfer : rooms) {
+        const JournalRecord& state = transfer.state;
+        int black = transfer.black >= 0 ? server.reserveClientId() : -1;
+        int white = transfer.white >= 0 ? server.reserveClientId() : -1;
+        GameRoom* room = roomManager.restoreRoom(state.roomId, state.gameType, state.boardSize, state.botColor,
+                                                 state.botLevel, black, white, transfer.started);
+        if (!room) continue;
+        if (room->hasBot()) botGameCount++;
+        for (PieceType color : {BLACK, WHITE}) {
+            int placeholder = color == BLACK ? black : white;
+            if (placeholder < 0) continue;
+            handoverSeats[color == BLACK ? transfer.black : transfer.white] = placeholder;
+            const std::string& token = color == BLACK ? state.blackToken : state.whiteToken;
+            if (token.empty()) continue;
+            sessions[token] = Session{placeholder, state.roomId, false};
+            clientSessions[placeholder] = token;
+        }
+        if (!transfer.started) continue;
+        JournalRecord record;
+        if (journal && describeRoom(*room, record)) room->markJournaled();
+        roomIds.push_back(state.roomId);
+        histories.push_back({std::move(transfer.state)});
+        restored.emplace_back(room, &histories.back());
+    }
+    roomCount = static_cast<int>(roomManager.getRoomCount());
+    replayRooms(restored);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    AsyncLogger::instance().info("从旧进程接管房间 ", rooms.size(), " 个、连接 ", handoverClients.size(), " 个, 用时 ",
+                                 elapsed.count(), " 毫秒");
+    return true;
+}
+
+void GameServer::adoptHandedClients() {
+    size_t adopted = 0;
+    for (ClientHandover& client : handoverClients) {
+        int clientId = server.adoptClient(client.handoff, [this, &client](int id) { placeHandedClient(id, client); });
+        if (clientId >= 0) adopted++;
+    }
+    // 没有换回连接的座位: 持有会话的照常等待重连, 其余的 (旧版客户端在交接期间断开) 按离开处理
+    for (const auto& [previous, placeholder] : handoverSeats) {
+        if (!clientSessions.count(placeholder)) leaveRoom(placeholder);
+    }
+    if (adopted < handoverClients.size()) {
+        AsyncLogger::instance().warn("交来的连接中有 ", handoverClients.size() - adopted, " 个无法接手");
+    }
+    handoverClients.clear();
+    handoverSeats.clear();
+}
+
+void GameServer::placeHandedClient(int clientId, const ClientHandover& client) {
+    switch (client.place) {
+        case ClientHandover::PLAYER: {
+            auto seat = handoverSeats.find(client.clientId);
+            if (seat == handoverSeats.end() || !roomManager.replacePlayer(seat->second, clientId)) break;
+            auto token = clientSessions.find(seat->second);
+            if (token != clientSessions.end()) {
+                std::string key = token->second;
+                clientSessions.erase(token);
+                clientSessions[clientId] = key;
+                Session& session = sessions.at(key);
+                session.clientId = clientId;
+                session.connected = true;
+            }
+            handoverSeats.erase(seat);
+            return;
+        }
+        case ClientHandover::SPECTATOR: {
+            GameRoom* room = roomManager.findRoom(client.roomId);
+            if (!roomManager.watchRoom(room, clientId)) break;
+            submitToRoom(*room, [clientId](GameRoom& target) { target.addAudience(clientId); });
+            return;
+        }
+        case ClientHandover::QUEUED:
+            lobby.insert(clientId);
+            quickMatch(clientId, client.gameType, client.boardSize, client.rating);
+            return;
+        case ClientHandover::AUTO_MATCH:
+            onConnect(clientId);
+            return;
+        case ClientHandover::LOBBY:
+            lobby.insert(clientId);
+            return;
+    }
+    // 所在的房间没能接管: 与房间解散时相同, 回到大厅
+    lobby.insert(clientId);
+    server.sendToClient(clientId, NetworkMessage(MessageType::DISCONNECT, ""));
+}
+
+void GameServer::submitToRoom(const GameRoom& room, std::function<void(GameRoom&)> task) {
+    // 任务持有房间, 房间在 I/O 线程上解散后排队中的任务仍可安全执行
+    std::shared_ptr<GameRoom> shared = roomManager.shareRoom(room.getId());
+    workers.submit(room.getId(), [shared, task = std::move(task)]() { task(*shared); });
+}
+
+void GameServer::dispatchGameMessage(int clientId, GameRoom& room, const NetworkMessage& message) {
+    if (message.type == MessageType::DISCONNECT) {
+        leaveRoom(clientId);
+        lobby.insert(clientId);
+        return;
+    }
+    if (!room.hasStarted()) {
+        sendError(clientId, "对局尚未开始");
+        return;
+    }
+
+    PieceType color = room.getPlayerColor(clientId);
+    if (color == EMPTY && message.type != MessageType::SYNC_REQUEST) {
+        // 观众只能请求同步
+        sendError(clientId, "观战中不能操作");
+        return;
+    }
+    int opponent = room.getOpponent(clientId);
+    submitToRoom(room, [this, clientId, color, opponent, message](GameRoom& target) {
+        handleGameMessage(target, clientId, color, opponent, message);
+    });
+}
+
+void GameServer::beginGame(GameRoom& room, int black, int white) {
+    room.beginGame();
+    // 机器人的座位没有连接 (编号为 -1)
+    if (black >= 0) {
+        server.sendToClient(black, NetworkMessage(MessageType::GAME_START, "BLACK"));
+        sendSnapshot(black, room);
+    }
+    if (white >= 0) {
+        server.sendToClient(white, NetworkMessage(MessageType::GAME_START, "WHITE"));
+        sendSnapshot(white, room);
+    }
+    for (int spectator : room.getAudience()) {
+        sendSnapshot(spectator, room);
+    }
+    requestBotMove(room);
+}
+
+void GameServer::sendSnapshot(int clientId, const GameRoom& room) {
+    if (server.getProtocolVersion(clientId) >= NetworkConfig::DELTA_SYNC_PROTOCOL_VERSION) {
+        // 关键帧和其后的增量都已编码, 直接共享
+        for (const SharedMessage& message : room.getCatchUp()) {
+            server.sendToClient(clientId, *message);
+        }
+    } else {
+        server.sendToClient(clientId, room.getStateInfo().toMessage());
+    }
+}
+
+void GameServer::publishMove(GameRoom& room, int moverId, int opponent, const SharedMessage& delta,
+                             const NetworkMessage& move) {
+    Metrics::StageTimer timer(Metrics::BROADCAST);
+
+    // 支持增量同步的连接 (包括落子方) 收到带序号的变化格, 旧客户端收到原样转发的落子
+    std::vector<int> deltaTargets;
+    std::vector<int> moveTargets;
+    auto addTarget = [&](int clientId, bool spectator) {
+        if (server.getProtocolVersion(clientId) >= NetworkConfig::DELTA_SYNC_PROTOCOL_VERSION) {
+            // 积压的观众可以补发: 跳过这一步, 对方发现断档后会请求完整局面
+            if (!spectator || !server.isBackpressured(clientId)) deltaTargets.push_back(clientId);
+        } else if (clientId != moverId) {
+            moveTargets.push_back(clientId);
+        }
+    };
+
+    if (moverId >= 0) addTarget(moverId, false);
+    if (opponent >= 0) addTarget(opponent, false);
+    for (int spectator : room.getAudience()) {
+        addTarget(spectator, true);
+    }
+
+    server.multicastMessage(deltaTargets, *delta);
+    if (!moveTargets.empty()) server.multicastMessage(moveTargets, EncodedMessage(move));
+    requestBotMove(room);
+}
+
+void GameServer::publishStateChange(GameRoom& room, PieceType player, int moverId, int opponent,
+                                    const NetworkMessage& message, bool echoToMover) {
+    // 虚着、认输、超时记作不含变化格的增量: 推进序号并写入事件日志, 断线重连时可以补发
+    SharedMessage delta = room.recordStateChange(player);
+    if (room.isJournaled()) {
+        const facade::GameFacade& game = room.getFacade();
+        JournalRecord record;
+        record.type = JournalRecord::STATE;
+        record.roomId = room.getId();
+        record.player = player;
+        record.currentPlayer = game.getCurrentPlayer();
+        record.status = game.getGameStatus();
+        record.passCount = game.getPassCount();
+        journal->append(record);
+    }
+    Metrics::StageTimer timer(Metrics::BROADCAST);
+
+    // 玩家照常收到原消息 (客户端据此提示、切换回合), 支持增量同步的随后再收到增量, 以服务器的结果为准
+    if (opponent >= 0) server.sendToClient(opponent, message);
+    if (echoToMover && moverId >= 0) server.sendToClient(moverId, message);
+
+    std::vector<int> deltaTargets;
+    std::vector<int> legacySpectators;
+    for (int playerId : {moverId, opponent}) {
+        if (playerId >= 0 && server.getProtocolVersion(playerId) >= NetworkConfig::DELTA_SYNC_PROTOCOL_VERSION) {
+            deltaTargets.push_back(playerId);
+        }
+    }
+    for (int spectator : room.getAudience()) {
+        if (server.getProtocolVersion(spectator) < NetworkConfig::DELTA_SYNC_PROTOCOL_VERSION) {
+            legacySpectators.push_back(spectator);
+        } else if (!server.isBackpressured(spectator)) {
+            // 与落子相同, 积压的观众跳过, 发现断档后自行重新同步
+            deltaTargets.push_back(spectator);
+        }
+    }
+    server.multicastMessage(deltaTargets, *delta);
+    if (!legacySpectators.empty()) server.multicastMessage(legacySpectators, EncodedMessage(message));
+    requestBotMove(room);
+}
+
+void GameServer::checkTurnClock(GameRoom& room, int black, int white) {
+    facade::GameFacade& game = room.getFacade();
+    if (game.getGameStatus() != IN_PROGRESS) return;
+
+    // 定时器只在到期时检查: 期间有过落子就按新的回合开始时间顺延
+    auto now = std::chrono::steady_clock::now();
+    auto deadline = room.getTurnStart() + turnTimeout;
+    if (now >= deadline) {
+        PieceType current = game.getCurrentPlayer();
+        game.setCurrentPlayer(current == BLACK ? WHITE : BLACK);
+        room.restartTurnClock();
+
+        // 超时的一方也要收到通知
+        NetworkMessage timeoutMsg(MessageType::NOTIFY, NotifyInfo{NotifyType::TIMEOUT}.serialize());
+        int mover = current == BLACK ? black : white;
+        publishStateChange(room, current, mover, current == BLACK ? white : black, timeoutMsg, true);
+        deadline = now + turnTimeout;
+    }
+
+    // 定时器属于 I/O 线程, 回到 I/O 线程重新设置
+    int roomId = room.getId();
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now) + std::chrono::milliseconds(1);
+    server.post([this, roomId, delay]() { armTurnClock(roomId, delay); });
+}
+
+void GameServer::resumeSession(GameRoom& room, int clientId, PieceType color, uint64_t acknowledged) {
+    // 只补发断线期间错过的增量; 落后太多或序号无效时发送完整局面
+    std::vector<SharedMessage> events;
+    if (server.getProtocolVersion(clientId) >= NetworkConfig::DELTA_SYNC_PROTOCOL_VERSION &&
+        room.getEventsAfter(acknowledged, events)) {
+        for (const SharedMessage& event : events) {
+            server.sendToClient(clientId, *event);
+        }
+    } else {
+        sendSnapshot(clientId, room);
+    }
+    server.sendToClient(clientId, NetworkMessage(MessageType::SESSION_RESUME, color == BLACK ? "BLACK" : "WHITE"));
+}
+
+void GameServer::requestBotMove(GameRoom& room) {
+    PieceType color = room.getBotColor();
+    const facade::GameFacade& game = room.getFacade();
+    if (color == EMPTY || room.isBotThinking() ||
+        game.getGameStatus() != IN_PROGRESS || game.getCurrentPlayer() != color) {
+        return;
+    }
+    room.setBotThinking(true);
+
+    BotService::Request request;
+    request.roomId = room.getId();
+    request.board = std::make_shared<model::Board>(game.getBoard());
+    request.color = color;
+    request.gameType = room.getGameType();
+    request.level = static_cast<ai::AILevel>(room.getBotLevel() - 1);
+    request.budget = botBudget;
+    // 请求持有房间: 房间解散后不再计算
+    std::shared_ptr<GameRoom> shared = room.shared_from_this();
+    request.abandoned = [shared]() { return shared->isClosed(); };
+
+    // 结果先回到 I/O 线程取得玩家当前的连接编号, 再投递回本房间的工作线程
+    int roomId = room.getId();
+    uint64_t sequence = room.getSequence();
+    request.done = [this, roomId, sequence](const Move& move) {
+        server.post([this, roomId, sequence, move]() { onBotMove(roomId, sequence, move); });
+    };
+    bots.submit(std::move(request));
+}
+
+void GameServer::applyBotMove(GameRoom& room, int opponent, uint64_t sequence, const Move& move) {
+    room.setBotThinking(false);
+    facade::GameFacade& game = room.getFacade();
+    PieceType color = room.getBotColor();
+    if (game.getGameStatus() != IN_PROGRESS || game.getCurrentPlayer() != color) return;
+    if (room.getSequence() != sequence) {
+        // 计算期间局面变了 (例如服务器判定超时后又轮回机器人), 按新局面重算
+        requestBotMove(room);
+        return;
+    }
+
+    if (!move.isPass && !move.isResign) {
+        SharedMessage delta;
+        {
+            Metrics::StageTimer timer(Metrics::APPLY);
+            delta = room.applyMove(move.x, move.y, color);
+        }
+        if (delta) {
+            Metrics::add(Metrics::MOVES_APPLIED);
+            journalMove(room, move.x, move.y, color);
+            publishMove(room, -1, opponent, delta,
+                        MoveInfo{move.x, move.y, color}.toMessage());
+            return;
+        }
+        Metrics::add(Metrics::MOVES_REJECTED);
+        AsyncLogger::instance().warn("房间 ", room.getId(), " 的机器人给出非法落子 (", move.x, ",", move.y, ")");
+    }
+
+    // 无子可下 (或着法非法) 时虚着, 规则不允许虚着时认输, 保证对局总能继续
+    if (!move.isResign && game.passMove(color)) {
+        room.restartTurnClock();
+        publishStateChange(room, color, -1, opponent, NetworkMessage(MessageType::PASS, ""));
+        return;
+    }
+    game.resign(color);
+    publishStateChange(room, color, -1, opponent, NetworkMessage(MessageType::RESIGN, ""));
+}
+
+void GameServer::journalMove(const GameRoom& room, int row, int col, PieceType player) {
+    if (!room.isJournaled()) return;
+    JournalRecord record;
+    record.type = JournalRecord::MOVE;
+    record.roomId = room.getId();
+    record.row = row;
+    record.col = col;
+    record.player = player;
+    journal->append(record);
+}
+
+void GameServer::captureState(const GameRoom& room, JournalRecord& record) const {
+    const facade::GameFacade& game = room.getFacade();
+    const model::Board& board = game.getBoard();
+    record.sequence = room.getSequence();
+    record.currentPlayer = game.getCurrentPlayer();
+    record.status = game.getGameStatus();
+    record.passCount = game.getPassCount();
+    record.cells.clear();
+    record.cells.reserve(static_cast<size_t>(board.getSize()) * board.getSize());
+    for (int i = 0; i < board.getSize(); ++i) {
+        for (int j = 0; j < board.getSize(); ++j) {
+            record.cells.push_back(static_cast<int8_t>(board.getPiece(i, j)));
+        }
+    }
+}
+
+void GameServer::replayRoom(GameRoom& room, const std::vector<JournalRecord>& records) {
+    facade::GameFacade& game = room.getFacade();
+    for (const JournalRecord& record : records) {
+        switch (record.type) {
+            case JournalRecord::OPEN:
+                room.beginGame();
+                break;
+            case JournalRecord::SNAPSHOT:
+                room.restoreState(record.sequence, record.currentPlayer, record.status, record.passCount,
+                                  record.cells);
+                break;
+            case JournalRecord::MOVE:
+                if (!room.applyMove(record.row, record.col, record.player)) {
+                    AsyncLogger::instance().warn("重放房间 ", room.getId(), " 的落子 (", record.row, ",", record.col,
+                                                 ") 失败");
+                }
+                break;
+            case JournalRecord::STATE:
+                game.setCurrentPlayer(record.currentPlayer);
+                game.setGameStatus(record.status);
+                game.setPassCount(record.passCount);
+                room.recordStateChange(record.player);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void GameServer::handleGameMessage(GameRoom& room, int clientId, PieceType color, int opponent,
+                                   const NetworkMessage& message) {
+    if (message.type == MessageType::SYNC_REQUEST) {
+        sendSnapshot(clientId, room);
+        return;
+    }
+
+    facade::GameFacade& game = room.getFacade();
+    PieceType opponentColor = (color == BLACK) ? WHITE : BLACK;
+
+    switch (message.type) {
+        case MessageType::MOVE: {
+            auto validateStart = Metrics::Clock::now();
+            MoveInfo moveInfo{-1, -1, EMPTY};
+            if (!MoveInfo::parse(message, moveInfo)) {
+                Metrics::add(Metrics::MOVES_REJECTED);
+                sendError(clientId, "无效的落子消息");
+                return;
+            }
+            bool ownTurn = moveInfo.player == color && game.getCurrentPlayer() == color;
+            Metrics::record(Metrics::VALIDATE, Metrics::Clock::now() - validateStart);
+            if (!ownTurn) {
+                Metrics::add(Metrics::MOVES_REJECTED);
+                sendError(clientId, "不是你的回合");
+                return;
+            }
+
+            SharedMessage delta;
+            {
+                Metrics::StageTimer timer(Metrics::APPLY);
+                delta = room.applyMove(moveInfo.row, moveInfo.col, color);
+            }
+            if (!delta) {
+                Metrics::add(Metrics::MOVES_REJECTED);
+                sendError(clientId, "非法落子");
+                return;
+            }
+            Metrics::add(Metrics::MOVES_APPLIED);
+            journalMove(room, moveInfo.row, moveInfo.col, color);
+            publishMove(room, clientId, opponent, delta, message);
+            return;
+        }
+
+        case MessageType::PASS:
+            if (game.getCurrentPlayer() != color || !game.passMove(color)) {
+                sendError(clientId, "不能虚着");
+                return;
+            }
+            room.restartTurnClock();
+            publishStateChange(room, color, clientId, opponent, message);
+            return;
+
+        case MessageType::RESIGN:
+            if (game.getGameStatus() == IN_PROGRESS) game.resign(color);
+            publishStateChange(room, color, clientId, opponent, message);
+            return;
+
+        case MessageType::NOTIFY: {
+            NotifyInfo notifyInfo{NotifyType::NONE};
+            if (!NotifyInfo::parse(message.data, notifyInfo)) {
+                sendError(clientId, "无效的通知消息");
+                return;
+            }
+            // 超时由当前行棋方报告, 轮到对手
+            if (notifyInfo.notifyType == NotifyType::TIMEOUT) {
+                if (game.getCurrentPlayer() != color) return;
+                game.setCurrentPlayer(opponentColor);
+                room.restartTurnClock();
+                publishStateChange(room, color, clientId, opponent, message);
+                return;
+            }
+            break;
+        }
+
+        case MessageType::BOARD_SYNC:
+        case MessageType::LOAD:
+            // 服务器的棋盘为准, 不接受客户端改写局面
+            sendError(clientId, "不支持该操作");
+            return;
+
+        default:
+            break;
+    }
+
+    if (opponent >= 0) server.sendToClient(opponent, message);
+}
+
+void GameServer::sendError(int clientId, const std::string& reason) {
+    server.sendToClient(clientId, NetworkMessage(MessageType::ERROR, reason));
+}
+
+} // namespace chessgame::network
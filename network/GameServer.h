@@ -0,0 +1,231 @@
+#pragma once
+#include "NetworkServer.h"
+#include "BotService.h"
+#include "GameJournal.h"
+#include "GameRoom.h"
+#include "HandoverLink.h"
+#include "Matchmaker.h"
+#include "RoomWorkerPool.h"
+#include "ShardMesh.h"
+#include <atomic>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace chessgame::network {
+
+/**
+ * @brief 多房间对战服务器: 大厅、排队匹配、房间、观战、断线重连和人机对局.
+ *
+ * 连接、大厅、排队和房间成员在 NetworkServer 的 I/O 线程上管理; 开局后的对局逻辑在房间所属的工作线程上执行
+ * (RoomWorkerPool), I/O 线程只把消息连同查到的身份 (颜色、对手) 投递过去, 房间状态不需要加锁.
+ */
+class GameServer {
+private:
+    NetworkServer server;
+    ShardMesh* shards{nullptr};   // 为空时不分片
+    RoomManager roomManager;
+    Matchmaker matchmaker;
+    RoomWorkerPool workers;
+    BotService bots;
+    GameType defaultGameType;
+    int defaultBoardSize;
+
+    std::unordered_set<int> lobby;             // 已连接但尚未进入房间的连接
+    std::unordered_set<int> autoMatchPending;  // 还没发送过房间命令的连接
+    std::atomic<int> roomCount{0};
+    std::atomic<int> queuedCount{0};
+    std::atomic<int> botGameCount{0};
+
+    // 旧版客户端自动匹配前的等待时间 (毫秒)
+    static constexpr int AUTO_MATCH_DELAY_MS = 300;
+
+    // 放宽匹配范围、重新配对的间隔 (毫秒)
+    static constexpr int MATCH_TICK_MS = 500;
+
+    // 默认回合超时: 比客户端的 30 秒多留 5 秒, 正常客户端总是先自己报告超时
+    static constexpr int DEFAULT_TURN_TIMEOUT_MS = 35000;
+    std::chrono::milliseconds turnTimeout{DEFAULT_TURN_TIMEOUT_MS};
+
+    // 人机对局数上限, 以及机器人每步的时间预算 (从提交请求时算起)
+    static constexpr int DEFAULT_MAX_BOT_GAMES = 10000;
+    static constexpr int DEFAULT_BOT_BUDGET_MS = 500;
+    static constexpr int DEFAULT_BOT_LEVEL = 2;
+    int maxBotGames{DEFAULT_MAX_BOT_GAMES};
+    std::chrono::milliseconds botBudget{DEFAULT_BOT_BUDGET_MS};
+
+    // 可恢复的会话 (只在 I/O 线程访问): 开局时给支持增量同步的玩家发送 SESSION_TOKEN, 断线后座位保留 sessionGrace;
+    // 期间用新连接发送 SESSION_RESUME "令牌,已确认序号" 接回座位, 补发该序号之后的增量后回复 SESSION_RESUME
+    struct Session {
+        int clientId;           // 当前的连接编号, 断线时为断线前的编号
+        int roomId;
+        bool connected{true};
+        TimerWheel::TimerId graceTimer{TimerWheel::INVALID_TIMER};   // 断线后的保留期限
+    };
+    std::unordered_map<std::string, Session> sessions;    // 令牌 -> 会话
+    std::unordered_map<int, std::string> clientSessions;  // 连接编号 -> 令牌 (含断线保留中的)
+    std::mt19937_64 tokenGenerator;
+    std::chrono::milliseconds sessionGrace{NetworkConfig::SESSION_GRACE_PERIOD * 1000};
+
+    // 对局日志 (为空时不记录); 当前段超过 JOURNAL_COMPACT_BYTES 或有记录未能写出时压缩
+    std::string journalDirectory;
+    std::unique_ptr<GameJournal> journal;
+    bool compacting{false};
+    static constexpr uint64_t JOURNAL_COMPACT_BYTES = 64ull << 20;
+    static constexpr int JOURNAL_CHECK_MS = 10000;
+
+    // 平滑升级: 旧进程在 upgradeSocketPath 上等待接替者, 新进程从 takeoverPath 接管 (只在 I/O 线程访问, 另有说明的除外)
+    std::string upgradeSocketPath;
+    std::string takeoverPath;
+    HandoverLink handover;
+    bool handingOver{false};                        // 正在交给新进程
+    std::atomic<bool> handedOver{false};            // 已交给新进程 (线程安全)
+    std::unordered_map<int, JournalRecord> handoverStates;   // 旧进程: 在工作线程上取得的房间状态
+    std::unordered_set<int> handoverPending;        // 旧进程: 正在摘下的连接
+    std::vector<ClientHandover> handoverClients;    // 旧进程: 已摘下的连接; 新进程: 待接手的连接
+    std::unordered_map<int, int> handoverSeats;     // 新进程: 座位在旧进程中的连接编号 -> 占位编号
+
+    // 以下方法在 I/O 线程上执行
+    // 房间命令:
+    //   ROOM_CREATE "type,size"      创建房间并以黑棋加入, 回复 ROOM_INFO
+    //   ROOM_JOIN   "id"             加入指定房间
+    //   ROOM_JOIN   "" / "type,size[,rating]"
+    //                                排队匹配 (缺省为服务器默认设置和默认等级分), 配对成功后建房开局
+    //   ROOM_LEAVE                   离开房间
+    //   ROOM_INFO   ""               列出等待中的房间 (以 ';' 分隔)
+    //   ROOM_WATCH  "id"             观战指定房间; 空数据时列出正在进行的对局
+    //   ROOM_BOT    "" / "type,size[,level]"
+    //                                与服务器托管的机器人对局 (玩家执黑, 级别 1-3, 缺省为 2), 立即开局
+    // 连接后 AUTO_MATCH_DELAY_MS 内没有发送房间命令的客户端 (旧版局域网客户端) 以默认等级分自动排队
+    void onConnect(int clientId);
+    void onDisconnect(int clientId);
+    void onMessage(int clientId, const NetworkMessage& message);
+
+    void handleRoomCreate(int clientId, const std::string& data);
+    void handleRoomJoin(int clientId, const NetworkMessage& message);
+    void handleRoomList(int clientId);
+    void handleRoomWatch(int clientId, const NetworkMessage& message);
+    void handleRoomBot(int clientId, const std::string& data);
+    void dispatchGameMessage(int clientId, GameRoom& room, const NetworkMessage& message);
+
+    // 按等级分排队, 可接受的分差随等待时间放宽 (见 Matchmaker); 离开或进入房间时取消排队
+    void quickMatch(int clientId, GameType type, int boardSize, int rating = Matchmaker::DEFAULT_RATING);
+    void cancelMatch(int clientId);
+    void startMatch(const Matchmaker::Match& match);
+    void scheduleMatchTick();
+    void enterRoom(int clientId, GameRoom& room);
+    void leaveRoom(int clientId);
+    void startGame(GameRoom& room);
+    void submitToRoom(const GameRoom& room, std::function<void(GameRoom&)> task);
+    void armTurnClock(int roomId, std::chrono::milliseconds delay);
+    void onTurnClock(int roomId);
+    void issueSession(int clientId, int roomId);
+    bool suspendSession(int clientId);
+    void expireSession(const std::string& token);
+    bool endSession(int clientId);
+    void handleSessionResume(int clientId, const NetworkMessage& message);
+    int shardOfRoom(int roomId) const;
+    bool routeToShard(int clientId, int shard, const NetworkMessage& message);
+    void receiveHandoffs();
+    void onBotMove(int roomId, uint64_t sequence, const Move& move);
+    bool describeRoom(const GameRoom& room, JournalRecord& record) const;
+    void resumeRecoveredRooms(const std::vector<int>& roomIds);
+    void scheduleJournalCheck();
+    void compactJournal();
+    void beginHandover();
+    void detachForHandover();
+    void finishHandover();
+    void describeClient(ClientHandover& client);
+    void adoptHandedClients();
+    void placeHandedClient(int clientId, const ClientHandover& client);
+
+    // 启动前在调用线程上执行: 读出日志并重放, 或从旧进程接管 (都等待各工作线程重放完毕)
+    bool recoverRooms(std::vector<int>& roomIds);
+    bool takeOver(std::vector<int>& roomIds);
+    void replayRooms(const std::vector<std::pair<GameRoom*, const std::vector<JournalRecord>*>>& rooms);
+
+    // 以下方法在房间所属的工作线程上执行. 落子、虚着等由房间内的 GameFacade 校验, 非法操作只回复 ERROR;
+    // 结果以 BOARD_DELTA 发给双方和观众 (同一份编码), 发送队列积压的观众跳过增量, 发现断档后自行重新同步
+    void beginGame(GameRoom& room, int black, int white);
+    void handleGameMessage(GameRoom& room, int clientId, PieceType color, int opponent,
+                           const NetworkMessage& message);
+    void sendSnapshot(int clientId, const GameRoom& room);
+    void publishMove(GameRoom& room, int moverId, int opponent, const SharedMessage& delta,
+                     const NetworkMessage& move);
+    void publishStateChange(GameRoom& room, PieceType player, int moverId, int opponent,
+                            const NetworkMessage& message, bool echoToMover = false);
+    void checkTurnClock(GameRoom& room, int black, int white);
+    void resumeSession(GameRoom& room, int clientId, PieceType color, uint64_t acknowledged);
+    void requestBotMove(GameRoom& room);
+    void applyBotMove(GameRoom& room, int opponent, uint64_t sequence, const Move& move);
+    void journalMove(const GameRoom& room, int row, int col, PieceType player);
+    void replayRoom(GameRoom& room, const std::vector<JournalRecord>& records);
+    void captureState(const GameRoom& room, JournalRecord& record) const;
+
+    // 线程安全
+    void sendError(int clientId, const std::string& reason);
+
+public:
+    // workerThreads, botThreads <= 0 时使用 CPU 核数
+    GameServer(GameType gameType = GOMOKU, int boardSize = 15,
+               int maxConnections = NetworkConfig::MAX_SERVER_CONNECTIONS, int workerThreads = 0,
+               int botThreads = 0);
+    ~GameServer();
+
+    // 回合超时和空闲连接超时, 0 表示不检查 (需在 start 之前设置). 行棋方超过回合超时仍无动作时服务器代为超时,
+    // 向双方发送 NOTIFY TIMEOUT 并轮到对手
+    void setTurnTimeout(std::chrono::milliseconds timeout) { turnTimeout = timeout; }
+    void setIdleTimeout(std::chrono::seconds timeout) { server.setIdleTimeout(timeout); }
+
+    // 传输后端, io_uring 不可用时回退到 epoll (需在 start 之前设置)
+    void setBackend(NetworkServer::Backend backend) { server.setBackend(backend); }
+    NetworkServer::Backend getBackend() const { return server.getBackend(); }
+
+    // 另外监听 Unix socket, 供同机的机器人等客户端连接, 可进一步改用共享内存通道 (需在 start 之前设置)
+    void setLocalSocket(const std::string& path) { server.setLocalSocket(path); }
+
+    // 断线玩家的座位保留时间, 0 表示断线即离开 (需在 start 之前设置)
+    void setSessionGrace(std::chrono::milliseconds grace) { sessionGrace = grace; }
+
+    // 作为 mesh 中的一个分片运行 (需在 start 之前设置): 各分片用 SO_REUSEPORT 共享端口, 房间只存在于创建它的分片上,
+    // 编号和会话令牌都带有所在分片. 按编号加入、观战或重连时, 连接先整个转交给房间所在的分片再重新处理这条命令,
+    // 一局的玩家和观众总在同一个进程中; 排队匹配、人机对局和房间列表只在本分片内进行
+    void setShards(ShardMesh* mesh);
+
+    // 在该目录记录对局日志, start 时先从中恢复对局 (需在 start 之前设置). 只记录双方都持有会话令牌的对局:
+    // 开局写 OPEN, 每次落子、虚着、认输、超时各写一条, 解散时写 CLOSE. 恢复出的对局双方都处于断线保留状态,
+    // 用原来的令牌重连即可回到对局
+    void setJournal(const std::string& directory) { journalDirectory = directory; }
+
+    // 在该路径上等待新版本的进程接管 (需在 start 之前设置): 交出监听 socket、房间、连接和各连接所处的位置
+    // (大厅、排队、座位、观战) 后退出, 客户端的连接不断开, 只是交接期间的消息晚一些处理
+    void setUpgradeSocket(const std::string& path) { upgradeSocketPath = path; }
+
+    // start 时连接旧进程的升级 socket, 接管其监听 socket、房间和连接, 不再读取对局日志中的对局 (需在 start 之前设置).
+    // 排队中的玩家按原设置重新排队, 回合计时从接管时重新开始
+    void setTakeover(const std::string& path) { takeoverPath = path; }
+
+    // 已把服务交给新进程 (随后 isRunning 变为 false)
+    bool hasHandedOver() const { return handedOver.load(); }
+
+    // 人机对局数上限和机器人每步的时间预算 (需在 start 之前设置). 对局数达到上限, 或机器人请求的平均排队时间
+    // 超过半个预算时拒绝新的人机对局, 已开始的对局不受影响
+    void setMaxBotGames(int count) { maxBotGames = count; }
+    void setBotBudget(std::chrono::milliseconds budget) { botBudget = budget; }
+
+    bool start(int port = NetworkConfig::DEFAULT_PORT);
+    void stop();
+    bool isRunning() const { return server.isRunning(); }
+    int getPort() const { return server.getPort(); }
+
+    int getConnectionCount() const { return server.getConnectedClientCount(); }
+    int getRoomCount() const { return roomCount.load(); }
+    int getQueuedCount() const { return queuedCount.load(); }
+    int getBotGameCount() const { return botGameCount.load(); }
+
+    // 运行指标的文本 (连接数等当前值, 加上 Metrics 的计数器和各阶段延迟), 线程安全
+    std::string renderMetrics() const;
+};
+
+} // namespace chessgame::network
@@ -0,0 +1,333 @@
+#include "HandoverLink.h"
+#include "AsyncLogger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace chessgame::network {
+
+namespace {
+
+// 消息头: 正文长度, 再是类型
+const size_t MESSAGE_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+
+// 一条消息携带的描述符上限: 连接本身加共享内存通道的三个
+const size_t MAX_MESSAGE_FDS = 4;
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendField(std::string& out, const std::string& field) {
+    appendValue(out, static_cast<uint32_t>(field.size()));
+    out.append(field);
+}
+
+// 顺序读取正文, 越界时 ok 变为 false, 之后的读取都返回 0
+struct Reader {
+    const char* cursor;
+    const char* end;
+    bool ok{true};
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!ok || static_cast<size_t>(end - cursor) < sizeof(T)) {
+            ok = false;
+            return value;
+        }
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+
+    std::string readField() {
+        size_t length = read<uint32_t>();
+        if (!ok || static_cast<size_t>(end - cursor) < length) {
+            ok = false;
+            return "";
+        }
+        std::string field(cursor, length);
+        cursor += length;
+        return field;
+    }
+};
+
+bool sockaddrOf(const std::string& path, sockaddr_un& address) {
+    address = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "升级 socket 路径无效: " << path << std::endl;
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+}
+
+HandoverLink::~HandoverLink() {
+    closePeer();
+    if (listenFd < 0) return;
+    close(listenFd);
+    // 接替者可能已在同一路径上重新监听: 路径仍是自己绑定的那个时才删除
+    struct stat info;
+    if (stat(listenPath.c_str(), &info) == 0 && info.st_ino == listenInode) unlink(listenPath.c_str());
+}
+
+bool HandoverLink::listen(const std::string& path) {
+    sockaddr_un address;
+    if (!sockaddrOf(path, address)) return false;
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "创建升级 socket 失败: " << strerror(errno) << std::endl;
+        return false;
+    }
+    unlink(path.c_str());
+    struct stat info;
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listenFd, 1) < 0 ||
+        stat(path.c_str(), &info) < 0) {
+        std::cerr << "升级 socket 监听失败: " << strerror(errno) << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    listenPath = path;
+    listenInode = info.st_ino;
+    std::cout << "升级 socket: " << listenPath << std::endl;
+    return true;
+}
+
+bool HandoverLink::acceptPeer() {
+    int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) return false;
+    // 同一时间只接待一个接替者
+    if (peerFd >= 0) {
+        close(fd);
+        return false;
+    }
+    peerFd = fd;
+    setTimeouts();
+    return true;
+}
+
+bool HandoverLink::connect(const std::string& path) {
+    sockaddr_un address;
+    if (!sockaddrOf(path, address)) return false;
+
+    closePeer();
+    peerFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (peerFd < 0 || ::connect(peerFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::cerr << "连接旧进程的升级 socket 失败: " << strerror(errno) << std::endl;
+        closePeer();
+        return false;
+    }
+    setTimeouts();
+    return true;
+}
+
+void HandoverLink::closePeer() {
+    if (peerFd >= 0) close(peerFd);
+    peerFd = -1;
+}
+
+void HandoverLink::setTimeouts() {
+    timeval timeout{IO_TIMEOUT_MS / 1000, (IO_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(peerFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    setsockopt(peerFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+bool HandoverLink::sendMessage(Kind kind, const std::string& body, const int* fds, size_t fdCount) {
+    if (peerFd < 0) return false;
+    std::string message;
+    message.reserve(MESSAGE_HEADER_SIZE + body.size());
+    appendValue(message, static_cast<uint32_t>(body.size()));
+    appendValue(message, static_cast<uint8_t>(kind));
+    message.append(body);
+
+    // 描述符随第一次 sendmsg 附在消息开头; 超时等原因只写出一部分时, 其余部分接着写
+    size_t sent = 0;
+    while (sent < message.size()) {
+        iovec iov{const_cast<char*>(message.data() + sent), message.size() - sent};
+        alignas(cmsghdr) char control[CMSG_SPACE(MAX_MESSAGE_FDS * sizeof(int))];
+        msghdr header{};
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        if (sent == 0 && fdCount > 0) {
+            header.msg_control = control;
+            header.msg_controllen = CMSG_SPACE(fdCount * sizeof(int));
+            cmsghdr* rights = CMSG_FIRSTHDR(&header);
+            rights->cmsg_level = SOL_SOCKET;
+            rights->cmsg_type = SCM_RIGHTS;
+            rights->cmsg_len = CMSG_LEN(fdCount * sizeof(int));
+            memcpy(CMSG_DATA(rights), fds, fdCount * sizeof(int));
+        }
+        ssize_t written = sendmsg(peerFd, &header, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) {
+            AsyncLogger::instance().warn("向新进程发送交接消息失败: ", strerror(errno));
+            return false;
+        }
+        sent += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool HandoverLink::sendListeners(const std::vector<int>& fds) {
+    return sendMessage(LISTENERS, std::string(), fds.data(), std::min(fds.size(), MAX_MESSAGE_FDS));
+}
+
+bool HandoverLink::sendRoom(const RoomHandover& room) {
+    std::string body;
+    appendValue(body, static_cast<int32_t>(room.black));
+    appendValue(body, static_cast<int32_t>(room.white));
+    appendValue(body, static_cast<uint8_t>(room.started));
+    room.state.encode(body);
+    return sendMessage(ROOM, body);
+}
+
+bool HandoverLink::sendClient(const ClientHandover& client) {
+    const NetworkServer::Handoff& handoff = client.handoff;
+    std::string body;
+    appendValue(body, static_cast<int32_t>(client.clientId));
+    appendValue(body, static_cast<uint8_t>(client.place));
+    appendValue(body, static_cast<int32_t>(client.roomId));
+    appendValue(body, static_cast<uint8_t>(client.gameType));
+    appendValue(body, static_cast<uint8_t>(client.boardSize));
+    appendValue(body, static_cast<int32_t>(client.rating));
+    appendValue(body, static_cast<uint32_t>(handoff.protocolVersion));
+    appendField(body, handoff.peerAddress);
+    appendField(body, handoff.unsent);
+    appendField(body, handoff.pending);
+
+    int fds[MAX_MESSAGE_FDS] = {handoff.fd, handoff.channelFds[0], handoff.channelFds[1], handoff.channelFds[2]};
+    return sendMessage(CLIENT, body, fds, handoff.channelFds[0] >= 0 ? MAX_MESSAGE_FDS : 1);
+}
+
+bool HandoverLink::sendDone(int nextRoomId) {
+    std::string body;
+    appendValue(body, static_cast<int32_t>(nextRoomId));
+    return sendMessage(DONE, body);
+}
+
+bool HandoverLink::sendReady() {
+    return sendMessage(READY, std::string());
+}
+
+bool HandoverLink::receiveExactly(char* buffer, size_t size) {
+    size_t received = 0;
+    while (received < size) {
+        ssize_t count = recv(peerFd, buffer + received, size - received, 0);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        received += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+bool HandoverLink::receive(Message& message) {
+    if (peerFd < 0) return false;
+
+    // 先读消息头: 描述符附在消息开头, 随这次 recvmsg 取得
+    char header[MESSAGE_HEADER_SIZE];
+    iovec iov{header, sizeof(header)};
+    alignas(cmsghdr) char control[CMSG_SPACE(MAX_MESSAGE_FDS * sizeof(int))];
+    msghdr request{};
+    request.msg_iov = &iov;
+    request.msg_iovlen = 1;
+    request.msg_control = control;
+    request.msg_controllen = sizeof(control);
+    ssize_t received;
+    do {
+        received = recvmsg(peerFd, &request, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) return false;
+
+    int fds[MAX_MESSAGE_FDS] = {-1, -1, -1, -1};
+    size_t fdCount = 0;
+    cmsghdr* rights = CMSG_FIRSTHDR(&request);
+    if (rights && rights->cmsg_level == SOL_SOCKET && rights->cmsg_type == SCM_RIGHTS) {
+        fdCount = std::min((rights->cmsg_len - CMSG_LEN(0)) / sizeof(int), MAX_MESSAGE_FDS);
+        memcpy(fds, CMSG_DATA(rights), fdCount * sizeof(int));
+    }
+    auto discard = [&fds, fdCount]() {
+        for (size_t i = 0; i < fdCount; ++i) close(fds[i]);
+        return false;
+    };
+
+    uint32_t length = 0;
+    if ((request.msg_flags & MSG_CTRUNC) ||
+        !receiveExactly(header + received, sizeof(header) - static_cast<size_t>(received))) {
+        return discard();
+    }
+    memcpy(&length, header, sizeof(length));
+    uint8_t kind = static_cast<uint8_t>(header[sizeof(length)]);
+    if (length > MAX_MESSAGE_SIZE || kind < LISTENERS || kind > READY) return discard();
+    receiveBuffer.resize(length);
+    if (!receiveExactly(receiveBuffer.data(), length)) return discard();
+
+    Reader reader{receiveBuffer.data(), receiveBuffer.data() + length};
+    message.kind = static_cast<Kind>(kind);
+    bool ok = false;
+    switch (message.kind) {
+        case LISTENERS:
+            ok = fdCount >= 1 && fdCount <= 2;
+            if (ok) message.listeners.assign(fds, fds + fdCount);
+            break;
+        case ROOM: {
+            RoomHandover& room = message.room;
+            room.black = reader.read<int32_t>();
+            room.white = reader.read<int32_t>();
+            room.started = reader.read<uint8_t>() != 0;
+            size_t rest = static_cast<size_t>(reader.end - reader.cursor);
+            ok = fdCount == 0 && reader.ok && rest > JournalRecord::HEADER_SIZE &&
+                 JournalRecord::decode(reader.cursor + JournalRecord::HEADER_SIZE, rest - JournalRecord::HEADER_SIZE,
+                                       room.state) &&
+                 room.state.type == JournalRecord::SNAPSHOT;
+            break;
+        }
+        case CLIENT: {
+            ClientHandover& client = message.client;
+            NetworkServer::Handoff& handoff = client.handoff;
+            client.clientId = reader.read<int32_t>();
+            client.place = static_cast<ClientHandover::Place>(reader.read<uint8_t>());
+            client.roomId = reader.read<int32_t>();
+            client.gameType = static_cast<GameType>(reader.read<uint8_t>());
+            client.boardSize = reader.read<uint8_t>();
+            client.rating = reader.read<int32_t>();
+            handoff.protocolVersion = static_cast<int>(reader.read<uint32_t>());
+            handoff.peerAddress = reader.readField();
+            handoff.unsent = reader.readField();
+            handoff.pending = reader.readField();
+            // 只有一个描述符时是普通连接, 四个时后三个是共享内存通道
+            ok = reader.ok && reader.cursor == reader.end && (fdCount == 1 || fdCount == MAX_MESSAGE_FDS) &&
+                 client.place <= ClientHandover::SPECTATOR;
+            if (ok) {
+                handoff.fd = fds[0];
+                for (size_t i = 1; i < MAX_MESSAGE_FDS; ++i) handoff.channelFds[i - 1] = fds[i];
+            }
+            break;
+        }
+        case DONE:
+            message.nextRoomId = reader.read<int32_t>();
+            ok = fdCount == 0 && reader.ok;
+            break;
+        case READY:
+            ok = fdCount == 0 && length == 0;
+            break;
+    }
+    if (!ok) {
+        AsyncLogger::instance().warn("收到无效的交接消息 (类型 ", static_cast<int>(kind), ")");
+        return discard();
+    }
+    return true;
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,99 @@
+#pragma once
+#include "GameJournal.h"
+#include "NetworkServer.h"
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace chessgame::network {
+
+// 交接中的一个房间
+struct RoomHandover {
+    JournalRecord state;      // SNAPSHOT 记录: 设置、会话令牌、序号和局面 (开局前的局面为空棋盘)
+    bool started{false};
+    int black{-1};            // 座位上的玩家在旧进程中的连接编号, 空位和机器人为 -1
+    int white{-1};
+};
+
+// 交接中的一个连接: 在旧进程中的编号、所处的位置和连接本身
+struct ClientHandover {
+    enum Place : uint8_t { LOBBY, AUTO_MATCH, QUEUED, PLAYER, SPECTATOR };
+
+    int clientId{-1};
+    Place place{LOBBY};
+    int roomId{0};            // PLAYER, SPECTATOR
+    GameType gameType{GOMOKU};   // QUEUED: 排队的设置和等级分
+    int boardSize{0};
+    int rating{0};
+    NetworkServer::Handoff handoff;
+};
+
+/**
+ * @brief 平滑升级时新旧两个进程之间的交接通道.
+ *
+ * 旧进程在 Unix 域 socket 上等待接替者, 新进程连上即表示请求接管, 同一时间只接待一个.
+ * 每条消息以正文长度和类型开头, 整条用一次 sendmsg 发出, 描述符由 SCM_RIGHTS 附在消息的开头;
+ * 接收方先读消息头 (同时取得描述符), 再按长度读完正文, 不会读进下一条消息. 旧进程依次发送:
+ *   LISTENERS  监听 socket (TCP, 开启了同机连接时还有 Unix socket); 新进程收下后回复 READY,
+ *              旧进程收到 READY 才停止接受新连接, 在此之前任一方失败, 旧进程都照常运行
+ *   ROOM       一个房间 (RoomHandover), 局面按对局日志的 SNAPSHOT 格式编码
+ *   CLIENT     一个连接 (ClientHandover), 描述符与 ShardMesh 相同: 连接本身, 有共享内存通道时再加三个
+ *   DONE       全部发送完毕, 附带下一个房间编号; 旧进程随后退出
+ * 收发都是阻塞的, 每次最多等待 IO_TIMEOUT_MS: 对方卡死时放弃, 而不是一直挂起.
+ */
+class HandoverLink {
+public:
+    enum Kind : uint8_t { LISTENERS = 1, ROOM, CLIENT, DONE, READY };
+
+    struct Message {
+        Kind kind{DONE};
+        std::vector<int> listeners;   // LISTENERS
+        RoomHandover room;            // ROOM
+        ClientHandover client;        // CLIENT
+        int nextRoomId{0};            // DONE
+    };
+
+    // 正文长度的上限, 只用来识别损坏的长度 (交来的连接附带的数据远小于它)
+    static constexpr uint32_t MAX_MESSAGE_SIZE = 16u << 20;
+    static constexpr int IO_TIMEOUT_MS = 5000;
+
+private:
+    std::string listenPath;
+    ino_t listenInode{0};
+    int listenFd{-1};
+    int peerFd{-1};
+    std::string receiveBuffer;
+
+    bool sendMessage(Kind kind, const std::string& body, const int* fds = nullptr, size_t fdCount = 0);
+    bool receiveExactly(char* buffer, size_t size);
+    void setTimeouts();
+
+public:
+    HandoverLink() = default;
+    ~HandoverLink();
+
+    HandoverLink(const HandoverLink&) = delete;
+    HandoverLink& operator=(const HandoverLink&) = delete;
+
+    // 旧进程: 在 path 上等待接替者
+    bool listen(const std::string& path);
+    int getListenFd() const { return listenFd; }
+
+    // 接受等待中的接替者 (非阻塞), 没有时返回 false
+    bool acceptPeer();
+
+    // 新进程: 连接旧进程, 即请求接管
+    bool connect(const std::string& path);
+    void closePeer();
+
+    bool sendListeners(const std::vector<int>& fds);
+    bool sendRoom(const RoomHandover& room);
+    bool sendClient(const ClientHandover& client);
+    bool sendDone(int nextRoomId);
+    bool sendReady();
+
+    // 取下一条消息 (阻塞), 收到的描述符归调用方所有; 对方关闭、超时或格式不对时返回 false
+    bool receive(Message& message);
+};
+
+} // namespace chessgame::network
@@ -0,0 +1,196 @@
+#include "IoUring.h"
+#include "Metrics.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace chessgame::network {
+
+namespace {
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+template <typename T>
+T* at(void* base, unsigned offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+}
+
+IoUring::~IoUring() {
+    release();
+}
+
+bool IoUring::init(unsigned entries, unsigned count, unsigned size) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // 完成队列放大到 4 倍: 每个多次触发的 recv 会陆续产生多个完成事件
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL;
+    params.cq_entries = entries * 4;
+
+    ringFd = ioUringSetup(entries, &params);
+    if (ringFd < 0) return false;
+
+    // 需要: 一次映射两个队列, 完成队列溢出不丢事件, 以及 provided buffer 环 (同样是 5.19 以后的特性)
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP)) {
+        release();
+        errno = ENOTSUP;
+        return false;
+    }
+
+    size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqRingSize = sqSize > cqSize ? sqSize : cqSize;
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        release();
+        return false;
+    }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqeMemory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqeMemory == MAP_FAILED) {
+        release();
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqeMemory);
+
+    sqHeadPtr = at<unsigned>(sqRing, params.sq_off.head);
+    sqTailPtr = at<unsigned>(sqRing, params.sq_off.tail);
+    sqFlags = at<unsigned>(sqRing, params.sq_off.flags);
+    sqMask = *at<unsigned>(sqRing, params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+    // 提交队列的下标数组固定为恒等映射, 之后只需移动尾部
+    unsigned* array = at<unsigned>(sqRing, params.sq_off.array);
+    for (unsigned i = 0; i < sqEntries; ++i) array[i] = i;
+    sqTail = submittedTail = *sqTailPtr;
+
+    cqHead = at<unsigned>(sqRing, params.cq_off.head);
+    cqTail = at<unsigned>(sqRing, params.cq_off.tail);
+    cqMask = *at<unsigned>(sqRing, params.cq_off.ring_mask);
+    cqes = at<io_uring_cqe>(sqRing, params.cq_off.cqes);
+
+    // provided buffer 环: 环本身需要按页对齐, 缓冲区是普通内存
+    bufferCount = count;
+    bufferSize = size;
+    bufferRingSize = count * sizeof(io_uring_buf);
+    void* ringMemory = mmap(nullptr, bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ringMemory == MAP_FAILED) {
+        release();
+        return false;
+    }
+    bufferRing = static_cast<io_uring_buf*>(ringMemory);
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+    reg.ring_entries = count;
+    reg.bgid = BUFFER_GROUP;
+    if (ioUringRegister(ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        release();
+        return false;
+    }
+
+    bufferMemory.reset(new char[static_cast<size_t>(count) * size]);
+    for (unsigned i = 0; i < count; ++i) recycleBuffer(static_cast<uint16_t>(i));
+    return true;
+}
+
+void IoUring::release() {
+    if (bufferRing) munmap(bufferRing, bufferRingSize);
+    if (sqes) munmap(sqes, sqesSize);
+    if (sqRing) munmap(sqRing, sqRingSize);
+    if (ringFd >= 0) close(ringFd);
+    bufferRing = nullptr;
+    sqes = nullptr;
+    sqRing = nullptr;
+    ringFd = -1;
+    bufferMemory.reset();
+}
+
+io_uring_sqe* IoUring::nextSqe() {
+    // 提交队列满时先提交已有的请求
+    if (sqTail - __atomic_load_n(sqHeadPtr, __ATOMIC_ACQUIRE) >= sqEntries) submit();
+    io_uring_sqe* sqe = &sqes[sqTail & sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    ++sqTail;
+    return sqe;
+}
+
+void IoUring::prepareMultishotAccept(int listenFd, int acceptFlags, uint64_t userData) {
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenFd;
+    sqe->accept_flags = static_cast<uint32_t>(acceptFlags);
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = userData;
+}
+
+void IoUring::prepareMultishotRecv(int fd, uint64_t userData) {
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = userData;
+}
+
+void IoUring::prepareSend(int fd, const void* data, size_t length, uint64_t userData, bool link) {
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(length);
+    sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+    if (link) sqe->flags = IOSQE_IO_LINK;
+    sqe->user_data = userData;
+}
+
+void IoUring::prepareCancel(uint64_t targetUserData, uint64_t userData) {
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = targetUserData;
+    sqe->user_data = userData;
+}
+
+bool IoUring::submit() {
+    unsigned toSubmit = sqTail - submittedTail;
+    // 完成队列溢出时内核把事件暂存在别处, 需要进入内核才能取回
+    bool overflow = __atomic_load_n(sqFlags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW;
+    if (toSubmit == 0 && !overflow) return true;
+
+    __atomic_store_n(sqTailPtr, sqTail, __ATOMIC_RELEASE);
+    while (true) {
+        int submitted = ioUringEnter(ringFd, toSubmit, 0, overflow ? IORING_ENTER_GETEVENTS : 0);
+        Metrics::add(Metrics::IO_SYSCALLS);
+        if (submitted < 0 && errno == EINTR) continue;
+        if (submitted < 0) return false;
+        submittedTail += static_cast<unsigned>(submitted);
+        return true;
+    }
+}
+
+void IoUring::recycleBuffer(uint16_t id) {
+    io_uring_buf& buffer = bufferRing[bufferTail & (bufferCount - 1)];
+    buffer.addr = reinterpret_cast<uint64_t>(bufferMemory.get() + static_cast<size_t>(id) * bufferSize);
+    buffer.len = bufferSize;
+    buffer.bid = id;
+    ++bufferTail;
+    __atomic_store_n(&bufferRing[0].resv, bufferTail, __ATOMIC_RELEASE);
+}
+
+} // namespace chessgame::network
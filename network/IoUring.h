@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <linux/io_uring.h>
+
+namespace chessgame::network {
+
+/**
+ * @brief io_uring 的最小封装 (直接使用系统调用, 不依赖 liburing).
+ *
+ * 只提供服务器用到的几种请求: 多次触发的 accept 和 recv (接收缓冲区由内核从 provided buffer 环中挑选)、
+ * 可链接的 send、按 user_data 取消. 准备好的请求先积在提交队列里, 由 submit() 一次提交;
+ * 完成事件用 forEachCompletion 取出. 不加锁, 只能在一个线程上使用.
+ * 内核不支持 (或容器禁止) io_uring 及所需特性时 init() 返回 false, 由调用方回退到 epoll.
+ */
+class IoUring {
+public:
+    // provided buffer 环的组号 (本环只有一组)
+    static constexpr uint16_t BUFFER_GROUP = 0;
+
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // entries: 提交队列长度; bufferCount (2 的幂) 个 bufferSize 字节的接收缓冲区
+    bool init(unsigned entries, unsigned bufferCount, unsigned bufferSize);
+    bool isValid() const { return ringFd >= 0; }
+    int getFd() const { return ringFd; }
+
+    void prepareMultishotAccept(int listenFd, int acceptFlags, uint64_t userData);
+    void prepareMultishotRecv(int fd, uint64_t userData);
+    // link 为 true 时下一个请求要等这个完成后才开始 (保证顺序); MSG_WAITALL 保证全部写完或报错
+    void prepareSend(int fd, const void* data, size_t length, uint64_t userData, bool link);
+    void prepareCancel(uint64_t targetUserData, uint64_t userData);
+
+    // 提交积压的请求; 没有请求时不进入内核. 返回 false 表示 io_uring_enter 出错
+    bool submit();
+    unsigned getPendingCount() const { return sqTail - submittedTail; }
+
+    // 依次处理已完成的事件, 返回处理的数量
+    template <typename Handler>
+    size_t forEachCompletion(Handler&& handler) {
+        size_t count = 0;
+        unsigned head = *cqHead;
+        while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            handler(cqe.user_data, cqe.res, cqe.flags);
+            ++head;
+            ++count;
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+        return count;
+    }
+
+    // provided buffer: 完成事件带 IORING_CQE_F_BUFFER 时数据在 getBuffer(编号) 中, 用完后必须归还
+    static bool hasBuffer(uint32_t flags) { return flags & IORING_CQE_F_BUFFER; }
+    static uint16_t bufferId(uint32_t flags) { return static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT); }
+    const char* getBuffer(uint16_t id) const { return bufferMemory.get() + static_cast<size_t>(id) * bufferSize; }
+    void recycleBuffer(uint16_t id);
+
+private:
+    int ringFd{-1};
+
+    // 提交队列
+    void* sqRing{nullptr};
+    size_t sqRingSize{0};
+    unsigned* sqHeadPtr{nullptr};
+    unsigned* sqTailPtr{nullptr};
+    unsigned* sqFlags{nullptr};
+    unsigned sqMask{0};
+    unsigned sqEntries{0};
+    io_uring_sqe* sqes{nullptr};
+    size_t sqesSize{0};
+    unsigned sqTail{0};           // 本地维护的尾部, submit 时发布
+    unsigned submittedTail{0};
+
+    // 完成队列 (与提交队列共用一次映射)
+    unsigned* cqHead{nullptr};
+    unsigned* cqTail{nullptr};
+    unsigned cqMask{0};
+    io_uring_cqe* cqes{nullptr};
+
+    // provided buffer 环: 按 io_uring_buf 数组访问, 尾部与第一项的 resv 字段重叠.
+    // (头文件中的 io_uring_buf_ring 在 C++ 下因空结构体占 1 字节, bufs 的偏移与内核不一致, 不能直接使用)
+    io_uring_buf* bufferRing{nullptr};
+    size_t bufferRingSize{0};
+    unsigned bufferCount{0};
+    unsigned bufferSize{0};
+    std::unique_ptr<char[]> bufferMemory;
+    uint16_t bufferTail{0};
+
+    io_uring_sqe* nextSqe();
+    void release();
+};
+
+} // namespace chessgame::network
@@ -0,0 +1,147 @@
+#include "Matchmaker.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace chessgame::network {
+
+int Matchmaker::clampRating(int rating) {
+    return std::max(0, std::min(rating, MAX_RATING - 1));
+}
+
+int Matchmaker::windowAt(const Ticket& ticket, Clock::time_point now) {
+    auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(now - ticket.enqueued).count();
+    long long window = INITIAL_WINDOW + waited * WINDOW_GROWTH_PER_SECOND / 1000;
+    return static_cast<int>(std::min<long long>(window, MAX_WINDOW));
+}
+
+bool Matchmaker::tryMatch(const QueueKey& key, Queue& queue, int clientId, int rating, int window,
+                          Clock::time_point now, int& opponent) {
+    // 对方等得更久时范围更宽: 任一方接受即可配对, 因此搜索到 MAX_WINDOW 为止
+    int center = bucketOf(rating);
+    int lowest = bucketOf(clampRating(rating - MAX_WINDOW));
+    int highest = bucketOf(clampRating(rating + MAX_WINDOW));
+
+    // 由近及远逐圈查看两侧的桶, 同一圈内取等级分最接近的
+    for (int distance = 0; center - distance >= lowest || center + distance <= highest; ++distance) {
+        const Ticket* best = nullptr;
+        int bestBucket = -1;
+        Bucket::iterator bestIt;
+
+        for (int bucket : {center - distance, center + distance}) {
+            if (bucket < lowest || bucket > highest) continue;
+            if (distance == 0 && bucket != center) continue;
+            Bucket& tickets = queue.buckets[bucket];
+
+            // 该桶与自己的最小分差; 桶内越靠后的等待越短、范围越窄, 都不接受时可以提前结束
+            int bucketLow = bucket * BUCKET_WIDTH;
+            int minDiff = std::max({0, bucketLow - rating, rating - (bucketLow + BUCKET_WIDTH - 1)});
+
+            for (auto it = tickets.begin(); it != tickets.end(); ++it) {
+                int theirWindow = windowAt(*it, now);
+                if (window < minDiff && theirWindow < minDiff) break;
+                if (it->clientId == clientId) continue;
+
+                int diff = std::abs(it->rating - rating);
+                if (diff > std::max(window, theirWindow)) continue;
+                if (!best || diff < std::abs(best->rating - rating)) {
+                    best = &*it;
+                    bestBucket = bucket;
+                    bestIt = it;
+                }
+                break;
+            }
+            if (distance == 0) break;
+        }
+
+        if (best) {
+            opponent = best->clientId;
+            erase(Location{key, bestBucket, bestIt});
+            return true;
+        }
+    }
+    return false;
+}
+
+void Matchmaker::erase(const Location& location) {
+    auto queueIt = queues.find(location.key);
+    locations.erase(location.ticket->clientId);
+    queueIt->second.buckets[location.bucket].erase(location.ticket);
+    if (--queueIt->second.size == 0) queues.erase(queueIt);
+}
+
+bool Matchmaker::enqueue(int clientId, GameType type, int boardSize, int rating, Match& match,
+                         Clock::time_point now) {
+    if (isQueued(clientId)) return false;
+
+    rating = clampRating(rating);
+    QueueKey key{static_cast<int>(type), boardSize};
+    Queue& queue = queues[key];
+
+    int opponent;
+    if (queue.size > 0 && tryMatch(key, queue, clientId, rating, INITIAL_WINDOW, now, opponent)) {
+        match = Match{type, boardSize, opponent, clientId};
+        return true;
+    }
+
+    // 没有合适的对手: 排到对应的桶末尾
+    int bucket = bucketOf(rating);
+    Bucket& tickets = queue.buckets[bucket];
+    tickets.push_back(Ticket{clientId, rating, now, INITIAL_WINDOW});
+    queue.size++;
+    locations[clientId] = Location{key, bucket, std::prev(tickets.end())};
+    return false;
+}
+
+bool Matchmaker::cancel(int clientId) {
+    auto it = locations.find(clientId);
+    if (it == locations.end()) return false;
+    erase(it->second);
+    return true;
+}
+
+bool Matchmaker::getTicket(int clientId, GameType& type, int& boardSize, int& rating) const {
+    auto it = locations.find(clientId);
+    if (it == locations.end()) return false;
+    type = static_cast<GameType>(it->second.key.first);
+    boardSize = it->second.key.second;
+    rating = it->second.ticket->rating;
+    return true;
+}
+
+std::vector<Matchmaker::Match> Matchmaker::tick(Clock::time_point now) {
+    // 找出范围放宽了的等待者, 先等的先配对
+    std::vector<std::pair<Clock::time_point, int>> widened;
+    for (auto& entry : queues) {
+        for (Bucket& tickets : entry.second.buckets) {
+            for (Ticket& ticket : tickets) {
+                int window = windowAt(ticket, now);
+                if (window > ticket.window) {
+                    ticket.window = window;
+                    widened.emplace_back(ticket.enqueued, ticket.clientId);
+                }
+            }
+        }
+    }
+    std::sort(widened.begin(), widened.end());
+
+    std::vector<Match> matches;
+    for (const auto& entry : widened) {
+        auto it = locations.find(entry.second);
+        if (it == locations.end()) continue;   // 已被更早的等待者配走
+
+        Location location = it->second;
+        QueueKey key = location.key;
+        int rating = location.ticket->rating;
+        int window = location.ticket->window;
+        Queue& queue = queues[key];
+
+        int opponent;
+        if (tryMatch(key, queue, entry.second, rating, window, now, opponent)) {
+            erase(location);
+            matches.push_back(Match{static_cast<GameType>(key.first), key.second, entry.second, opponent});
+        }
+    }
+    return matches;
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,94 @@
+#pragma once
+#include "../utils/Type.h"
+#include <chrono>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 按等级分配对的匹配队列.
+ *
+ * 每种 (游戏类型, 棋盘大小) 一个队列, 队列内按等级分划分为固定宽度的桶, 桶内按排队先后排列.
+ * 配对时只查看自己可接受范围内的桶, 由近及远, 不扫描整个队列;
+ * 可接受范围从 INITIAL_WINDOW 开始, 随等待时间每秒放宽 WINDOW_GROWTH_PER_SECOND, 最多到 MAX_WINDOW.
+ * 不加锁, 只能在一个线程上使用; 不做 I/O, 配对结果由调用方建房.
+ */
+class Matchmaker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int DEFAULT_RATING = 1500;
+    static constexpr int MAX_RATING = 4000;
+    static constexpr int BUCKET_WIDTH = 50;
+    static constexpr int INITIAL_WINDOW = 100;
+    static constexpr int WINDOW_GROWTH_PER_SECOND = 50;
+    static constexpr int MAX_WINDOW = 1000;
+
+    // 一次配对: first 先入队 (执黑)
+    struct Match {
+        GameType gameType;
+        int boardSize;
+        int first;
+        int second;
+    };
+
+private:
+    struct Ticket {
+        int clientId;
+        int rating;
+        Clock::time_point enqueued;
+        int window;   // 上次尝试配对时的可接受范围
+    };
+
+    using Bucket = std::list<Ticket>;
+    using QueueKey = std::pair<int, int>;   // (游戏类型, 棋盘大小)
+
+    struct Queue {
+        std::vector<Bucket> buckets;
+        size_t size{0};
+        Queue() : buckets(MAX_RATING / BUCKET_WIDTH) {}
+    };
+
+    // 排队中的连接所在的位置, 用于 O(1) 取消
+    struct Location {
+        QueueKey key;
+        int bucket;
+        Bucket::iterator ticket;
+    };
+
+    std::map<QueueKey, Queue> queues;
+    std::unordered_map<int, Location> locations;
+
+    static int clampRating(int rating);
+    static int bucketOf(int rating) { return rating / BUCKET_WIDTH; }
+    static int windowAt(const Ticket& ticket, Clock::time_point now);
+
+    // 在 ticket 的可接受范围内找最接近的对手, 找到时将双方移出队列
+    bool tryMatch(const QueueKey& key, Queue& queue, int clientId, int rating, int window,
+                  Clock::time_point now, int& opponent);
+    void erase(const Location& location);
+
+public:
+    // 加入队列; 立即配对成功时填写 match 并返回 true (双方都不再排队)
+    bool enqueue(int clientId, GameType type, int boardSize, int rating, Match& match,
+                 Clock::time_point now = Clock::now());
+
+    // 取消排队, 返回之前是否在队列中
+    bool cancel(int clientId);
+
+    bool isQueued(int clientId) const { return locations.count(clientId) > 0; }
+
+    // 排队中的连接的设置和等级分, 不在队列中时返回 false
+    bool getTicket(int clientId, GameType& type, int& boardSize, int& rating) const;
+
+    // 放宽等待者的可接受范围后重新配对 (由调用方定期执行)
+    std::vector<Match> tick(Clock::time_point now = Clock::now());
+
+    size_t getQueuedCount() const { return locations.size(); }
+};
+
+} // namespace chessgame::network
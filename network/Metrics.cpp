@@ -0,0 +1,209 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chessgame::network {
+
+namespace {
+
+// 一个线程的全部指标; 只有所属线程写入, 汇总线程只读, 所以用 relaxed 的读写代替原子加
+struct alignas(64) ThreadMetrics {
+    struct Histogram {
+        std::atomic<uint64_t> buckets[Metrics::BUCKET_COUNT];
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+    };
+
+    std::atomic<uint64_t> counters[Metrics::COUNTER_COUNT];
+    Histogram histograms[Metrics::STAGE_COUNT];
+
+    ThreadMetrics() {
+        for (auto& counter : counters) counter.store(0, std::memory_order_relaxed);
+        for (auto& histogram : histograms) {
+            for (auto& bucket : histogram.buckets) bucket.store(0, std::memory_order_relaxed);
+            histogram.sum.store(0, std::memory_order_relaxed);
+            histogram.max.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+inline void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadMetrics>> registry;   // 只增不减, 线程退出后数据仍然计入
+
+ThreadMetrics& local() {
+    thread_local ThreadMetrics* metrics = nullptr;
+    if (!metrics) {
+        auto created = std::make_unique<ThreadMetrics>();
+        metrics = created.get();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::move(created));
+    }
+    return *metrics;
+}
+
+void appendNumber(std::string& out, uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// 纳秒转为微秒, 保留三位小数
+void appendMicros(std::string& out, uint64_t nanos) {
+    appendNumber(out, nanos / 1000);
+    char fraction[4] = {'.', static_cast<char>('0' + nanos / 100 % 10), static_cast<char>('0' + nanos / 10 % 10),
+                        static_cast<char>('0' + nanos % 10)};
+    out.append(fraction, sizeof(fraction));
+}
+
+}
+
+int Metrics::bucketOf(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKETS)) return static_cast<int>(value);
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > MAX_EXPONENT) return BUCKET_COUNT - 1;
+    int sub = static_cast<int>((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t Metrics::bucketUpperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+    int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+    uint64_t width = uint64_t(1) << (exponent - SUB_BUCKET_BITS);
+    return ((SUB_BUCKETS + sub) << (exponent - SUB_BUCKET_BITS)) + width - 1;
+}
+
+uint64_t Metrics::HistogramSnapshot::percentile(double quantile) const {
+    if (count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(count));
+    if (rank >= count) rank = count - 1;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        seen += buckets[bucket];
+        if (seen > rank) return std::min(bucketUpperBound(bucket), max);
+    }
+    return max;
+}
+
+void Metrics::add(Counter counter, uint64_t amount) {
+    bump(local().counters[counter], amount);
+}
+
+void Metrics::record(Stage stage, Clock::duration elapsed) {
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    uint64_t value = nanos > 0 ? static_cast<uint64_t>(nanos) : 0;
+
+    ThreadMetrics::Histogram& histogram = local().histograms[stage];
+    bump(histogram.buckets[bucketOf(value)], 1);
+    bump(histogram.sum, value);
+    if (value > histogram.max.load(std::memory_order_relaxed)) {
+        histogram.max.store(value, std::memory_order_relaxed);
+    }
+}
+
+Metrics::Snapshot Metrics::snapshot() {
+    Snapshot result;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& metrics : registry) {
+        for (int i = 0; i < COUNTER_COUNT; ++i) {
+            result.counters[i] += metrics->counters[i].load(std::memory_order_relaxed);
+        }
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            const ThreadMetrics::Histogram& source = metrics->histograms[stage];
+            HistogramSnapshot& target = result.stages[stage];
+            for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+                uint64_t count = source.buckets[bucket].load(std::memory_order_relaxed);
+                target.buckets[bucket] += count;
+                target.count += count;
+            }
+            target.sum += source.sum.load(std::memory_order_relaxed);
+            target.max = std::max(target.max, source.max.load(std::memory_order_relaxed));
+        }
+    }
+    return result;
+}
+
+void Metrics::render(const Snapshot& snapshot, std::string& out) {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        std::string name = std::string("chess_server_") + counterName(static_cast<Counter>(i)) + "_total";
+        out += "# TYPE " + name + " counter\n" + name + " ";
+        appendNumber(out, snapshot.counters[i]);
+        out += "\n";
+    }
+
+    static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+    static const char* const QUANTILE_LABELS[] = {"0.5", "0.9", "0.99", "0.999"};
+    out += "# TYPE chess_server_stage_latency_microseconds summary\n";
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        const HistogramSnapshot& histogram = snapshot.stages[stage];
+        std::string label = std::string("stage=\"") + stageName(static_cast<Stage>(stage)) + "\"";
+        for (size_t q = 0; q < sizeof(QUANTILES) / sizeof(QUANTILES[0]); ++q) {
+            out += "chess_server_stage_latency_microseconds{" + label + ",quantile=\"" + QUANTILE_LABELS[q] + "\"} ";
+            appendMicros(out, histogram.percentile(QUANTILES[q]));
+            out += "\n";
+        }
+        out += "chess_server_stage_latency_microseconds_sum{" + label + "} ";
+        appendMicros(out, histogram.sum);
+        out += "\nchess_server_stage_latency_microseconds_count{" + label + "} ";
+        appendNumber(out, histogram.count);
+        out += "\n";
+    }
+
+    out += "# TYPE chess_server_stage_latency_max_microseconds gauge\n";
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        out += std::string("chess_server_stage_latency_max_microseconds{stage=\"") +
+               stageName(static_cast<Stage>(stage)) + "\"} ";
+        appendMicros(out, snapshot.stages[stage].max);
+        out += "\n";
+    }
+}
+
+const char* Metrics::counterName(Counter counter) {
+    switch (counter) {
+        case CONNECTIONS_ACCEPTED: return "connections_accepted";
+        case CONNECTIONS_REJECTED: return "connections_rejected";
+        case CONNECTIONS_CLOSED: return "connections_closed";
+        case CONNECTIONS_HANDED_OFF: return "connections_handed_off";
+        case CONNECTIONS_ADOPTED: return "connections_adopted";
+        case LOCAL_CHANNELS: return "local_channels";
+        case FRAMES_RECEIVED: return "frames_received";
+        case BYTES_RECEIVED: return "bytes_received";
+        case FRAMES_QUEUED: return "frames_queued";
+        case BYTES_SENT: return "bytes_sent";
+        case INVALID_FRAMES: return "invalid_frames";
+        case SLOW_CLIENT_DISCONNECTS: return "slow_client_disconnects";
+        case IDLE_DISCONNECTS: return "idle_disconnects";
+        case MOVES_APPLIED: return "moves_applied";
+        case MOVES_REJECTED: return "moves_rejected";
+        case IO_SYSCALLS: return "io_syscalls";
+        case BOT_MOVES: return "bot_moves";
+        case BOT_GAMES_REJECTED: return "bot_games_rejected";
+        case JOURNAL_RECORDS: return "journal_records";
+        case JOURNAL_WRITE_ERRORS: return "journal_write_errors";
+        default: return "unknown";
+    }
+}
+
+const char* Metrics::stageName(Stage stage) {
+    switch (stage) {
+        case ACCEPT: return "accept";
+        case PARSE: return "parse";
+        case VALIDATE: return "validate";
+        case APPLY: return "apply";
+        case BROADCAST: return "broadcast";
+        case BOT_QUEUE: return "bot_queue";
+        case BOT_THINK: return "bot_think";
+        case JOURNAL_COMMIT: return "journal_commit";
+        default: return "unknown";
+    }
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace chessgame::network {
+
+/**
+ * @brief 服务器运行指标: 计数器和各处理阶段的延迟直方图.
+ *
+ * 每个线程第一次记录时分配自己的一份指标 (按缓存行对齐, 线程之间不会伪共享),
+ * 之后只写自己的那一份: 没有锁, 也没有原子读改写. 读取时 (snapshot) 再把所有线程的数据相加;
+ * 线程退出后它的数据仍然保留, 累计值不会倒退.
+ * 直方图按 HDR 的方式分桶: 每个 2 的幂区间再等分为 16 个子桶, 相对误差不超过 1/16, 记录单位为纳秒.
+ */
+class Metrics {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Counter {
+        CONNECTIONS_ACCEPTED,
+        CONNECTIONS_REJECTED,     // 连接数已满或描述符耗尽
+        CONNECTIONS_CLOSED,
+        CONNECTIONS_HANDED_OFF,   // 交给其他分片进程
+        CONNECTIONS_ADOPTED,      // 从其他分片进程接手
+        LOCAL_CHANNELS,           // 改用共享内存通道的同机连接
+        FRAMES_RECEIVED,
+        BYTES_RECEIVED,
+        FRAMES_QUEUED,            // 放入发送队列的帧
+        BYTES_SENT,
+        INVALID_FRAMES,
+        SLOW_CLIENT_DISCONNECTS,  // 发送队列超过上限
+        IDLE_DISCONNECTS,
+        MOVES_APPLIED,
+        MOVES_REJECTED,
+        IO_SYSCALLS,              // I/O 线程和发送路径上的系统调用 (收发、等待、唤醒、提交)
+        BOT_MOVES,                // 机器人算出的着法
+        BOT_GAMES_REJECTED,       // 机器人繁忙时拒绝的对局请求
+        JOURNAL_RECORDS,          // 写入对局日志的记录
+        JOURNAL_WRITE_ERRORS,     // 写日志失败 (之后的记录改写新段)
+        COUNTER_COUNT
+    };
+
+    // 一条消息经过的处理阶段
+    enum Stage {
+        ACCEPT,      // 接受连接到登记完成
+        PARSE,       // 解码一帧
+        VALIDATE,    // 解析落子、检查回合
+        APPLY,       // 规则执行落子并生成增量
+        BROADCAST,   // 编码并放入各连接的发送队列
+        BOT_QUEUE,   // 机器人请求提交到开始计算
+        BOT_THINK,   // 机器人计算一步
+        JOURNAL_COMMIT,   // 对局日志一次成组提交 (写出并 fdatasync)
+        STAGE_COUNT
+    };
+
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 39;   // 约 18 分钟, 更大的值记在最后一个桶
+    static constexpr int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    struct HistogramSnapshot {
+        uint64_t count{0};
+        uint64_t sum{0};   // 纳秒
+        uint64_t max{0};
+        std::array<uint64_t, BUCKET_COUNT> buckets{};
+
+        // 分位数 (纳秒, 取所在桶的上界); 没有记录时为 0
+        uint64_t percentile(double quantile) const;
+    };
+
+    struct Snapshot {
+        std::array<uint64_t, COUNTER_COUNT> counters{};
+        std::array<HistogramSnapshot, STAGE_COUNT> stages{};
+    };
+
+    // 计时一个阶段, 析构时记录
+    class StageTimer {
+    public:
+        explicit StageTimer(Stage stage) : stage(stage), start(Clock::now()) {}
+        ~StageTimer() { record(stage, Clock::now() - start); }
+
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+
+    private:
+        Stage stage;
+        Clock::time_point start;
+    };
+
+    static void add(Counter counter, uint64_t amount = 1);
+    static void record(Stage stage, Clock::duration elapsed);
+
+    // 汇总所有线程的数据
+    static Snapshot snapshot();
+
+    // 以文本格式 (Prometheus exposition) 追加到 out
+    static void render(const Snapshot& snapshot, std::string& out);
+
+    static const char* counterName(Counter counter);
+    static const char* stageName(Stage stage);
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketUpperBound(int bucket);
+};
+
+} // namespace chessgame::network
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+namespace chessgame::network {
+
+/**
+ * @brief 无锁多生产者单消费者队列 (链表, 带哨兵节点).
+ *
+ * push 可在任意线程调用, 只需一次原子交换; pop/empty 只能在唯一的消费者线程调用.
+ * 同一生产者先后放入的元素按顺序取出.
+ */
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    std::atomic<Node*> tail;   // 生产者追加的位置
+    Node* head;                // 哨兵: 它的 next 是队首元素 (只由消费者访问)
+
+public:
+    MpscQueue() : tail(new Node), head(tail.load()) {}
+
+    ~MpscQueue() {
+        while (head) {
+            Node* next = head->next.load();
+            delete head;
+            head = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        // 先抢到队尾, 再挂到前一个节点后面; 两步之间消费者会暂时看不到该节点
+        Node* prev = tail.exchange(node);
+        prev->next.store(node);
+    }
+
+    bool pop(T& value) {
+        Node* next = head->next.load();
+        if (!next) return false;
+        value = std::move(next->value);
+        next->value = T();
+        delete head;
+        head = next;
+        return true;
+    }
+
+    bool empty() const { return head->next.load() == nullptr; }
+};
+
+} // namespace chessgame::network
@@ -5,10 +5,25 @@
 #include <fstream>
 #include <ctime>
 #include <cerrno>
+#include <poll.h>
+#include <sys/un.h>
 
 namespace chessgame::network {
 
-NetworkClient::NetworkClient() : clientSocket(-1), connected(false), running(false), connectResponseReceived(false), heartbeatRunning(false) {
+namespace {
+// 接收缓冲区大小; 剩余空间放不下一个最大帧时把未解码的数据移到开头
+const size_t RECEIVE_BUFFER_SIZE = 64 * 1024;
+const size_t MAX_FRAME_SIZE = NetworkConfig::BUFFER_SIZE + 16;
+
+// 共享内存通道上取空接收环后先轮询多久再等门铃: 同机服务器的应答通常在这段时间内到达
+const auto CHANNEL_SPIN_TIME = std::chrono::microseconds(50);
+
+// 发送环满时最多等待多久 (服务器卡住或已不再读取时放弃)
+const auto CHANNEL_SEND_TIMEOUT = std::chrono::seconds(5);
+}
+
+NetworkClient::NetworkClient() : clientSocket(-1), connected(false), running(false), connectResponseReceived(false),
+    protocolVersion(NetworkConfig::LEGACY_PROTOCOL_VERSION), versionNegotiated(false), heartbeatRunning(false) {
 }
 
 NetworkClient::~NetworkClient() {
@@ -18,6 +33,11 @@ NetworkClient::~NetworkClient() {
 }
 
 bool NetworkClient::connect(const std::string& serverIP, int port) {
+    size_t prefixLength = std::strlen(LOCAL_ADDRESS_PREFIX);
+    if (serverIP.compare(0, prefixLength, LOCAL_ADDRESS_PREFIX) == 0) {
+        return connectLocal(serverIP.substr(prefixLength));
+    }
+    
     // 创建socket
     clientSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (clientSocket < 0) {
@@ -46,25 +66,57 @@ bool NetworkClient::connect(const std::string& serverIP, int port) {
         return false;
     }
     
+    return establish(serverIP + ":" + std::to_string(port), false);
+}
+
+bool NetworkClient::connectLocal(const std::string& path, bool sharedMemory) {
+    sockaddr_un serverAddr{};
+    serverAddr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(serverAddr.sun_path)) {
+        std::cerr << "无效的本地 socket 路径: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(serverAddr.sun_path, path.c_str(), path.size() + 1);
+    
+    clientSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (clientSocket < 0) {
+        std::cerr << "创建客户端socket失败" << std::endl;
+        return false;
+    }
+    if (::connect(clientSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+        std::cerr << "连接服务器失败: " << path << std::endl;
+        close(clientSocket);
+        clientSocket = -1;
+        return false;
+    }
+    
+    return establish(path, sharedMemory);
+}
+
+bool NetworkClient::establish(const std::string& address, bool sharedMemory) {
     // 先设置连接状态和启动接收线程
     // 这样接收线程可以立即开始接收消息（包括CONNECT_RESPONSE和后续消息）
     connectResponseReceived = false;
+    protocolVersion = NetworkConfig::LEGACY_PROTOCOL_VERSION;
+    versionNegotiated = false;
+    channelActive = false;
+    channel.reset();
+    if (!readBuffer) readBuffer.reset(new char[RECEIVE_BUFFER_SIZE]);
+    readStart = readEnd = 0;
     connected = true;
     running = true;
+    nextHeartbeat = std::chrono::steady_clock::now() + std::chrono::seconds(NetworkConfig::HEARTBEAT_INTERVAL);
     
     // 启动接收消息线程（它会接收所有消息，包括CONNECT_RESPONSE）
     receiveThread = std::thread(&NetworkClient::receiveMessages, this);
     
-    // 等待接收线程接收CONNECT_RESPONSE消息
-    // 最多等待2秒
-    int waitCount = 0;
-    const int maxWait = 20; // 20 * 100ms = 2秒
-    
+    // 等待接收线程接收CONNECT_RESPONSE消息, 最多等待2秒
     std::cout << "等待服务器连接确认..." << std::endl;
-    
-    while (waitCount < maxWait && !connectResponseReceived.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        waitCount++;
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        stateChanged.wait_for(lock, std::chrono::seconds(2), [this]() {
+            return connectResponseReceived.load() || !running.load();
+        });
     }
     
     if (!connectResponseReceived.load()) {
@@ -81,10 +133,14 @@ bool NetworkClient::connect(const std::string& serverIP, int port) {
     
     std::cout << "服务器连接确认成功" << std::endl;
     
-    // 启动心跳线程
+    // 协商协议版本、请求共享内存通道 (心跳启动前, 此时没有其他发送)
+    negotiateVersion();
+    if (sharedMemory) openChannel();
+    
+    // 开启心跳 (由接收线程发送)
     startHeartbeat();
     
-    std::cout << "成功连接到服务器: " << serverIP << ":" << port << std::endl;
+    std::cout << "成功连接到服务器: " << address << std::endl;
     
     // 调用连接回调
     if (connectCallback) {
@@ -105,6 +161,7 @@ void NetworkClient::disconnect() {
     bool wasConnected = connected.exchange(false);
     running = false;
     heartbeatRunning = false;
+    notifyStateChanged();
     
     std::cout << "[DEBUG] NetworkClient::disconnect() - Flags set: connected=" << connected.load() 
               << ", running=" << running.load() << ", heartbeatRunning=" << heartbeatRunning.load() << std::endl;
@@ -134,15 +191,6 @@ void NetworkClient::disconnect() {
         std::cout << "[DEBUG] NetworkClient::disconnect() - receiveThread not joinable." << std::endl;
     }
     
-    if (heartbeatThread.joinable()) {
-        std::cout << "[DEBUG] NetworkClient::disconnect() - Joining heartbeatThread." << std::endl;
-        heartbeatThread.join();
-        heartbeatThread = std::thread(); // Reset thread object
-        std::cout << "[DEBUG] NetworkClient::disconnect() - heartbeatThread joined and reset." << std::endl;
-    } else {
-        std::cout << "[DEBUG] NetworkClient::disconnect() - heartbeatThread not joinable." << std::endl;
-    }
-    
     std::cout << "已断开与服务器的连接" << std::endl;
     
 
@@ -150,18 +198,25 @@ void NetworkClient::disconnect() {
 }
 
 void NetworkClient::receiveMessages() {
+    // 消息对象在各帧之间复用, data 的容量不会每帧重新分配
+    NetworkMessage message(MessageType::ERROR, "");
     while (running.load() && connected.load()) {
-        NetworkMessage message = receiveMessage();
-        
-        if (message.type == MessageType::ERROR) {
+        if (!receiveMessage(message)) {
             std::cerr << "接收消息错误，断开连接" << std::endl;
             running = false; // Signal to stop the loop
+            notifyStateChanged();
+            // 主动 disconnect 时 connected 已先被清除, 只有连接意外断开才通知;
+            // 尚未收到连接确认时由 connect 返回失败, 也不通知
+            if (connected.load() && connectResponseReceived.load() && disconnectCallback) {
+                disconnectCallback();
+            }
             break;
         }
         
         // 处理连接确认消息
         if (message.type == MessageType::CONNECT_RESPONSE && message.data == "OK") {
             connectResponseReceived = true;
+            notifyStateChanged();
             // 调用连接回调
             if (connectCallback) {
                 connectCallback();
@@ -174,6 +229,27 @@ void NetworkClient::receiveMessages() {
             continue;
         }
         
+        // 版本协商应答: 之后的帧按新版本收发
+        if (message.type == MessageType::VERSION_NEGOTIATE) {
+            int version = NetworkConfig::LEGACY_PROTOCOL_VERSION;
+            if (!parseInt(message.data, version)) version = NetworkConfig::LEGACY_PROTOCOL_VERSION;
+            if (version >= NetworkConfig::LEGACY_PROTOCOL_VERSION && version <= NetworkConfig::PROTOCOL_VERSION) {
+                protocolVersion = version;
+            }
+            versionNegotiated = true;
+            notifyStateChanged();
+            continue;
+        }
+        
+        // 共享内存通道应答: 服务器在它之前的帧都经 socket 发出, 已按顺序读完; 之后的帧改从环中读取
+        if (message.type == MessageType::LOCAL_CHANNEL) {
+            bool accepted = message.data == "OK" && channel;
+            if (accepted) channelActive = true;
+            channelReply = accepted ? 1 : -1;
+            notifyStateChanged();
+            continue;
+        }
+        
         // 调用消息回调
         if (messageCallback) {
             messageCallback(message);
@@ -184,14 +260,25 @@ void NetworkClient::receiveMessages() {
 bool NetworkClient::sendMessageInternal(const NetworkMessage& message) {
     if (!connected.load()) return false;
     
-    std::string serialized = message.serialize();
-    
-    // 添加长度前缀
-    std::string lengthPrefix = NetworkMessage::createLengthPrefix(serialized.length());
-    std::string fullMessage = lengthPrefix + serialized;
-    
-    ssize_t sent = send(clientSocket, fullMessage.c_str(), fullMessage.length(), 0);
-    return sent == static_cast<ssize_t>(fullMessage.length());
+    std::string frame = message.encodeFrame(protocolVersion.load());
+    if (channelActive.load()) return sendToChannel(frame);
+    ssize_t sent = send(clientSocket, frame.data(), frame.length(), MSG_NOSIGNAL);
+    return sent == static_cast<ssize_t>(frame.length());
+}
+
+bool NetworkClient::sendToChannel(const std::string& frame) {
+    // 门铃由接收线程等待, 环满时发送方只让出 CPU 稍后重试; 服务器取走数据很快, 长时间写不进说明它已卡住
+    std::lock_guard<std::mutex> lock(channelSendMutex);
+    auto deadline = std::chrono::steady_clock::now() + CHANNEL_SEND_TIMEOUT;
+    size_t offset = 0;
+    while (offset < frame.size()) {
+        size_t written = channel->write(frame.data() + offset, frame.size() - offset);
+        offset += written;
+        if (written > 0) continue;
+        if (!connected.load() || std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return true;
 }
 
 bool NetworkClient::sendMessage(const NetworkMessage& message) {
@@ -199,60 +286,158 @@ bool NetworkClient::sendMessage(const NetworkMessage& message) {
     return sendMessageInternal(message);
 }
 
-NetworkMessage NetworkClient::receiveMessage() {
-    // 首先读取长度前缀
-    char lengthBuffer[9] = {0}; // 8位长度 + 1位结束符
-    ssize_t received = recv(clientSocket, lengthBuffer, 8, 0);
-    
-    if (received <= 0) {
-        return NetworkMessage(MessageType::ERROR, "Connection lost");
+bool NetworkClient::sendHeartbeatIfDue(std::chrono::steady_clock::time_point now) {
+    if (now < nextHeartbeat) return true;
+    if (heartbeatRunning.load() && !sendMessage(NetworkMessage(MessageType::HEARTBEAT, "PING"))) return false;
+    nextHeartbeat = now + std::chrono::seconds(NetworkConfig::HEARTBEAT_INTERVAL);
+    return true;
+}
+
+bool NetworkClient::waitReadable() {
+    // 等到有数据可读 (使用共享内存通道时还等门铃); 期间到了心跳时间就先发送心跳
+    while (running.load()) {
+        auto now = std::chrono::steady_clock::now();
+        if (!sendHeartbeatIfDue(now)) return false;
+        
+        auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(nextHeartbeat - now).count() + 1;
+        struct pollfd fds[2] = {{clientSocket, POLLIN, 0}, {channelActive.load() ? channel->getBellFd() : -1, POLLIN, 0}};
+        int ready = poll(fds, 2, static_cast<int>(timeout));
+        if (ready > 0) return true;
+        if (ready < 0 && errno != EINTR) return false;
     }
-    
-    size_t messageLength = NetworkMessage::parseLengthPrefix(std::string(lengthBuffer, 8));
-    if (messageLength == 0 || messageLength > NetworkConfig::BUFFER_SIZE) {
-        return NetworkMessage(MessageType::ERROR, "Invalid message length");
+    return false;
+}
+
+ssize_t NetworkClient::receiveBytes(char* buffer, size_t size) {
+    if (!channelActive.load()) {
+        return waitReadable() ? recv(clientSocket, buffer, size, 0) : -1;
     }
     
-    // 读取消息内容
-    char messageBuffer[NetworkConfig::BUFFER_SIZE] = {0};
-    size_t totalReceived = 0;
-    
-    while (totalReceived < messageLength) {
-        received = recv(clientSocket, messageBuffer + totalReceived, 
-                       messageLength - totalReceived, 0);
+    // 共享内存通道: 取空接收环后先让出 CPU 短暂轮询, 仍没有数据才声明睡眠等门铃.
+    // 改用通道后 socket 只在对端关闭时可读
+    auto spinDeadline = std::chrono::steady_clock::now() + CHANNEL_SPIN_TIME;
+    while (running.load()) {
+        size_t received = channel->read(buffer, size);
+        if (received > 0) return static_cast<ssize_t>(received);
         
-        if (received <= 0) {
-            return NetworkMessage(MessageType::ERROR, "Connection lost");
+        auto now = std::chrono::steady_clock::now();
+        if (!sendHeartbeatIfDue(now)) return -1;
+        if (now < spinDeadline) {
+            std::this_thread::yield();
+            continue;
         }
+        if (!channel->prepareSleep()) continue;
+        if (!waitReadable()) return -1;
+        channel->clearBell();
         
-        totalReceived += received;
+        struct pollfd pfd{clientSocket, POLLIN, 0};
+        if (!channel->hasData() && poll(&pfd, 1, 0) > 0) return 0;
+        spinDeadline = std::chrono::steady_clock::now() + CHANNEL_SPIN_TIME;
     }
+    return -1;
+}
+
+bool NetworkClient::receiveMessage(NetworkMessage& message) {
+    char* buffer = readBuffer.get();
+    while (true) {
+        // 先从已接收的数据中解码, 每帧按当前协议版本解码
+        size_t consumed = 0;
+        FrameStatus status = NetworkMessage::decodeFrame(buffer + readStart, readEnd - readStart,
+                                                         protocolVersion.load(), message, consumed);
+        if (status == FrameStatus::COMPLETE) {
+            readStart += consumed;
+            if (readStart == readEnd) readStart = readEnd = 0;
+            return true;
+        }
+        if (status == FrameStatus::INVALID) {
+            message.type = MessageType::ERROR;
+            message.data = "Invalid message";
+            message.binary = false;
+            return false;
+        }
+        
+        if (RECEIVE_BUFFER_SIZE - readEnd < MAX_FRAME_SIZE) {
+            std::memmove(buffer, buffer + readStart, readEnd - readStart);
+            readEnd -= readStart;
+            readStart = 0;
+        }
+        ssize_t received = receiveBytes(buffer + readEnd, RECEIVE_BUFFER_SIZE - readEnd);
+        if (received <= 0) {
+            message.type = MessageType::ERROR;
+            message.data = "Connection lost";
+            message.binary = false;
+            return false;
+        }
+        readEnd += static_cast<size_t>(received);
+    }
+}
+
+void NetworkClient::negotiateVersion() {
+    NetworkMessage request(MessageType::VERSION_NEGOTIATE, std::to_string(NetworkConfig::PROTOCOL_VERSION));
+    if (!sendMessageInternal(request)) return;
     
-    std::string messageData(messageBuffer, messageLength);
-    return NetworkMessage::deserialize(messageData);
+    // 旧服务器不认识该消息, 超时后继续使用文本协议
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        stateChanged.wait_for(lock, std::chrono::milliseconds(NetworkConfig::VERSION_NEGOTIATE_TIMEOUT_MS), [this]() {
+            return versionNegotiated.load() || !running.load();
+        });
+    }
+    if (versionNegotiated.load()) {
+        std::cout << "通信协议版本: " << protocolVersion.load() << std::endl;
+    }
+}
+
+void NetworkClient::openChannel() {
+    // 环中传输二进制帧; 旧服务器 (没有协商到二进制协议) 或创建失败时继续用 socket
+    auto created = std::make_unique<ShmChannel>();
+    if (protocolVersion.load() < NetworkConfig::BINARY_PROTOCOL_VERSION || !created->create()) return;
+    channel = std::move(created);
+    channelReply = 0;
+    
+    // 请求帧附带共享内存和两个门铃的描述符, 服务器从同一次接收中取出
+    NetworkMessage request(MessageType::LOCAL_CHANNEL, std::to_string(ShmChannel::RING_CAPACITY));
+    std::string frame = request.encodeFrame(protocolVersion.load());
+    int fds[3];
+    channel->getFds(fds);
+    iovec iov{const_cast<char*>(frame.data()), frame.size()};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))];
+    msghdr header{};
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    cmsghdr* rights = CMSG_FIRSTHDR(&header);
+    rights->cmsg_level = SOL_SOCKET;
+    rights->cmsg_type = SCM_RIGHTS;
+    rights->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(rights), fds, sizeof(fds));
+    if (sendmsg(clientSocket, &header, MSG_NOSIGNAL) != static_cast<ssize_t>(frame.size())) return;
+    
+    // 应答之前不再发送: 之后的帧经哪条路走取决于应答. 超时后迟到的 OK 仍会切换 (通道对象一直保留)
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        stateChanged.wait_for(lock, std::chrono::milliseconds(NetworkConfig::VERSION_NEGOTIATE_TIMEOUT_MS), [this]() {
+            return channelReply.load() != 0 || !running.load();
+        });
+    }
+    if (channelActive.load()) {
+        std::cout << "改用共享内存通道" << std::endl;
+    }
 }
 
 void NetworkClient::startHeartbeat() {
     heartbeatRunning = true;
-    heartbeatThread = std::thread([this]() {
-        while (heartbeatRunning.load() && connected.load()) {
-            // 发送心跳
-            NetworkMessage heartbeat(MessageType::HEARTBEAT, "PING");
-            if (!sendMessage(heartbeat)) {
-                break;
-            }
-            
-            // 等待心跳间隔
-            std::this_thread::sleep_for(std::chrono::seconds(NetworkConfig::HEARTBEAT_INTERVAL));
-        }
-    });
 }
 
 void NetworkClient::stopHeartbeat() {
     heartbeatRunning = false;
-    if (heartbeatThread.joinable()) {
-        heartbeatThread.join();
-    }
+}
+
+void NetworkClient::notifyStateChanged() {
+    // 在锁内通知: 等待方检查条件和进入等待之间不会漏掉
+    std::lock_guard<std::mutex> lock(stateMutex);
+    stateChanged.notify_all();
 }
 
 } // namespace chessgame::network
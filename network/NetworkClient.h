@@ -1,16 +1,32 @@
 #pragma once
 #include "NetworkProtocol.h"
+#include "ShmChannel.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 namespace chessgame::network {
 
+/**
+ * @brief 阻塞式客户端: 一个接收线程收取并分发消息, 任意线程可以发送.
+ *
+ * 同机的服务器可以经 Unix socket 连接 (connectLocal, 或 connect 的地址写成 "unix:路径"), 默认随后请求
+ * 共享内存通道 (见 ShmChannel): 服务器同意后帧改在两个环中收发, 接口和回调不变.
+ * 通道上接收线程取空环后先让出 CPU 短暂轮询, 仍没有数据才等门铃, 往返延迟降到微秒级.
+ */
 class NetworkClient {
+public:
+    // connect 的地址以此开头时表示同机服务器的 Unix socket 路径
+    static constexpr const char* LOCAL_ADDRESS_PREFIX = "unix:";
+
 private:
     int clientSocket;
     std::atomic<bool> connected;
@@ -18,6 +34,31 @@ private:
     std::atomic<bool> connectResponseReceived;
     std::thread receiveThread;
     
+    // 协议版本: 连接后以文本协议协商, 旧服务器不应答时保持文本协议
+    std::atomic<int> protocolVersion;
+    std::atomic<bool> versionNegotiated;
+    
+    // 共享内存通道: 收到服务器的 OK 后 channelActive 置位, 之后收发都经过 channel (保留到下次连接或析构)
+    std::unique_ptr<ShmChannel> channel;
+    std::atomic<bool> channelActive{false};
+    std::atomic<int> channelReply{0};    // 服务器的应答: 1 同意, -1 拒绝
+    std::mutex channelSendMutex;         // 发送环只能有一个生产者
+    
+    // 接收缓冲区: recv 直接写到 readEnd 之后, 帧在原处解码; [readStart, readEnd) 为尚未凑成完整帧的数据
+    // (只在接收线程访问)
+    std::unique_ptr<char[]> readBuffer;
+    size_t readStart{0};
+    size_t readEnd{0};
+    
+    // 心跳由接收线程在等待数据的间隙发送, 不再单独占用线程
+    std::atomic<bool> heartbeatRunning;
+    std::chrono::steady_clock::time_point nextHeartbeat;   // 只在接收线程访问 (连接前初始化)
+    
+    // 连接确认、版本协商和断开时通知, 等待方不再轮询
+    std::mutex stateMutex;
+    std::condition_variable stateChanged;
+    void notifyStateChanged();
+    
     // 回调函数
     std::function<void(const NetworkMessage&)> messageCallback;
     std::function<void()> connectCallback;
@@ -26,7 +67,14 @@ private:
     // 私有方法
     void receiveMessages();
     bool sendMessageInternal(const NetworkMessage& message);
-    NetworkMessage receiveMessage();
+    bool receiveMessage(NetworkMessage& message);   // 出错时 message 为 ERROR 并返回 false
+    ssize_t receiveBytes(char* buffer, size_t size);
+    bool sendToChannel(const std::string& frame);
+    bool sendHeartbeatIfDue(std::chrono::steady_clock::time_point now);
+    bool waitReadable();
+    bool establish(const std::string& address, bool sharedMemory);
+    void negotiateVersion();
+    void openChannel();
 
 public:
     NetworkClient();
@@ -34,8 +82,12 @@ public:
     
     // 连接管理
     bool connect(const std::string& serverIP, int port = NetworkConfig::DEFAULT_PORT);
+    // 经 Unix socket 连接同机的服务器; sharedMemory 时再请求共享内存通道, 服务器不同意则继续用 socket
+    bool connectLocal(const std::string& path, bool sharedMemory = true);
     void disconnect();
     bool isConnected() const { return connected.load(); }
+    int getProtocolVersion() const { return protocolVersion.load(); }
+    bool isUsingSharedMemory() const { return channelActive.load(); }
     
     // 消息发送
     bool sendMessage(const NetworkMessage& message);
@@ -49,17 +101,14 @@ public:
         connectCallback = callback;
     }
     
+    // 连接被对端关闭或出错时在接收线程上调用 (主动 disconnect 不调用); 回调中不能销毁本对象
     void setDisconnectCallback(std::function<void()> callback) {
         disconnectCallback = callback;
     }
     
-    // 连接状态检查
+    // 连接状态检查: 开启后每 HEARTBEAT_INTERVAL 秒发送一次心跳
     void startHeartbeat();
     void stopHeartbeat();
-    
-private:
-    std::thread heartbeatThread;
-    std::atomic<bool> heartbeatRunning;
 };
 
 } // namespace chessgame::network
\ No newline at end of file
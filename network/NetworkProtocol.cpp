@@ -1,110 +1,727 @@
 #include "NetworkProtocol.h"
+#include <charconv>
+#include <cstdint>
 #include <sstream>
 #include <iomanip>
+#include <string_view>
 
 namespace chessgame::network {
 
-std::string NetworkMessage::serialize() const {
-    std::ostringstream oss;
-    oss << static_cast<int>(type) << ":" << data;
-    return oss.str();
+namespace {
+
+// 文本协议的长度前缀字节数
+const size_t LENGTH_PREFIX_SIZE = 8;
+
+// 二进制帧类型字节的最高位: 负载为原始文本
+const uint8_t RAW_PAYLOAD_FLAG = 0x80;
+
+// 帧长度不超过 BUFFER_SIZE, varint 最多 2 字节; 多留余量以便识别非法数据
+const size_t MAX_VARINT_BYTES = 4;
+
+// BOARD_SYNC 定长负载的头部: 游戏类型、行棋方、状态、边长
+const size_t BOARD_HEADER_SIZE = 4;
+const int MAX_SYNC_BOARD_SIZE = 19;
+
+// BOARD_DELTA 的头部: 行棋者、下一手、状态
+const size_t DELTA_HEADER_SIZE = 3;
+
+// 序号的 varint 最多字节数 (64 位)
+const size_t MAX_SEQUENCE_VARINT_BYTES = 10;
+
+void appendVarint(std::string& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+FrameStatus readVarint(const char* buffer, size_t size, size_t& value, size_t& used,
+                       size_t maxBytes = MAX_VARINT_BYTES) {
+    value = 0;
+    for (size_t i = 0; i < size && i < maxBytes; ++i) {
+        uint8_t byte = static_cast<uint8_t>(buffer[i]);
+        value |= static_cast<size_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            used = i + 1;
+            return FrameStatus::COMPLETE;
+        }
+    }
+    return size < maxBytes ? FrameStatus::INCOMPLETE : FrameStatus::INVALID;
+}
+
+// 类型字节: 类别 (千位) 放在第 4-6 位, 类别内编号放在低 4 位
+bool toWireType(MessageType type, uint8_t& wireType) {
+    int value = static_cast<int>(type);
+    int category = value / 1000;
+    int index = value % 1000;
+    if (category < 1 || category > 7 || index > 15) return false;
+    wireType = static_cast<uint8_t>((category << 4) | index);
+    return true;
+}
+
+MessageType fromWireType(uint8_t wireType) {
+    return static_cast<MessageType>(((wireType >> 4) & 0x07) * 1000 + (wireType & 0x0F));
 }
 
-NetworkMessage NetworkMessage::deserialize(const std::string& str) {
-    size_t pos1 = str.find(':');
+void appendInt(std::string& out, int value) {
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void appendInt(std::string& out, uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+template <typename T>
+bool parseIntegral(std::string_view text, T& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+// 逐个取出逗号分隔的字段 (只是原文本上的视图)
+class FieldReader {
+public:
+    explicit FieldReader(std::string_view text) : rest(text) {}
+    
+    bool next(std::string_view& field) {
+        if (finished) return false;
+        size_t comma = rest.find(',');
+        field = rest.substr(0, comma);
+        if (comma == std::string_view::npos) {
+            finished = true;
+        } else {
+            rest.remove_prefix(comma + 1);
+        }
+        return true;
+    }
+    
+    template <typename T>
+    bool nextInt(T& value) {
+        std::string_view field;
+        return next(field) && parseInt(field, value);
+    }
     
-    if (pos1 == std::string::npos)
-        return NetworkMessage(MessageType::ERROR, "Invalid message format");
+    // 取值在 [0, maxValue] 内的枚举
+    template <typename E>
+    bool nextEnum(E& value, int maxValue) {
+        int raw;
+        if (!nextInt(raw) || raw < 0 || raw > maxValue) return false;
+        value = static_cast<E>(raw);
+        return true;
+    }
     
-    int type = std::stoi(str.substr(0, pos1));
-    std::string data = str.substr(pos1 + 1);
+    bool atEnd() const { return finished; }
+    std::string_view remaining() const { return finished ? std::string_view() : rest; }
     
-    return NetworkMessage(static_cast<MessageType>(type), data);
+private:
+    std::string_view rest;
+    bool finished{false};
+};
+
+// 解析逗号分隔的小整数 (0-255), 最多 maxCount 个; 全部合法时返回个数, 否则返回 -1
+int parseByteList(std::string_view text, uint8_t* values, int maxCount) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    int count = 0;
+    while (p < end) {
+        if (count == maxCount) return -1;
+        int value = 0;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc() || value < 0 || value > 255) return -1;
+        values[count++] = static_cast<uint8_t>(value);
+        p = result.ptr;
+        if (p < end) {
+            if (*p != ',' || p + 1 == end) return -1;
+            ++p;
+        }
+    }
+    return count;
 }
 
-std::string NetworkMessage::createLengthPrefix(size_t length) {
+// 拆出开头的序号 "seq,..."
+bool parseSequence(std::string_view text, uint64_t& sequence, std::string_view& rest) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), sequence);
+    if (result.ec != std::errc() || result.ptr == text.data() + text.size() || *result.ptr != ',') return false;
+    rest = text.substr(result.ptr - text.data() + 1);
+    return true;
+}
+
+bool fitsByte(int value) {
+    return value >= 0 && value <= 0xFF;
+}
+
+// 棋盘状态 -> 头部 4 字节 (游戏类型、行棋方、状态、边长) + 每格 2 位; 无法表示时返回 false
+bool encodeBoardState(const GameStateInfo& state, std::string& out) {
+    int cells = state.boardSize * state.boardSize;
+    if (state.boardSize < 1 || state.boardSize > MAX_SYNC_BOARD_SIZE || static_cast<int>(state.cells.size()) != cells) {
+        return false;
+    }
+    size_t start = out.size();
+    out.resize(start + BOARD_HEADER_SIZE + (cells + 3) / 4, '\0');
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&out[start]);
+    bytes[0] = static_cast<uint8_t>(state.gameType);
+    bytes[1] = static_cast<uint8_t>(state.currentPlayer);
+    bytes[2] = static_cast<uint8_t>(state.gameStatus);
+    bytes[3] = static_cast<uint8_t>(state.boardSize);
+    // 每 4 格拼成一个字节
+    uint8_t* packed = bytes + BOARD_HEADER_SIZE;
+    const PieceType* cell = state.cells.data();
+    int fullBytes = cells / 4;
+    for (int i = 0; i < fullBytes; ++i, cell += 4) {
+        packed[i] = static_cast<uint8_t>(cell[0] | (cell[1] << 2) | (cell[2] << 4) | (cell[3] << 6));
+    }
+    for (int k = 0; k < cells % 4; ++k) {
+        packed[fullBytes] |= static_cast<uint8_t>(cell[k] << (2 * k));
+    }
+    return true;
+}
+
+// 定长棋盘状态的长度是否与边长相符
+bool isValidBoardState(const uint8_t* bytes, size_t size) {
+    if (size < BOARD_HEADER_SIZE) return false;
+    int boardSize = bytes[3];
+    int cells = boardSize * boardSize;
+    return boardSize >= 1 && boardSize <= MAX_SYNC_BOARD_SIZE && size == BOARD_HEADER_SIZE + (cells + 3) / 4;
+}
+
+bool decodeBoardState(const uint8_t* bytes, size_t size, GameStateInfo& state) {
+    if (!isValidBoardState(bytes, size) || bytes[0] > OTHELLO || bytes[1] > WHITE || bytes[2] > TIED) return false;
+    state.gameType = static_cast<GameType>(bytes[0]);
+    state.currentPlayer = static_cast<PieceType>(bytes[1]);
+    state.gameStatus = static_cast<GameStatus>(bytes[2]);
+    state.boardSize = bytes[3];
+    int cells = state.boardSize * state.boardSize;
+    state.cells.resize(cells);
+    
+    // 按字节解出 4 格; 两位都为 1 (值 3) 的格子非法, 末尾不足 4 格的字节多余的位须为 0
+    const uint8_t* packed = bytes + BOARD_HEADER_SIZE;
+    PieceType* cell = state.cells.data();
+    int fullBytes = cells / 4;
+    for (int i = 0; i < fullBytes; ++i, cell += 4) {
+        uint8_t byte = packed[i];
+        if (byte & (byte >> 1) & 0x55) return false;
+        cell[0] = static_cast<PieceType>(byte & 0x03);
+        cell[1] = static_cast<PieceType>((byte >> 2) & 0x03);
+        cell[2] = static_cast<PieceType>((byte >> 4) & 0x03);
+        cell[3] = static_cast<PieceType>(byte >> 6);
+    }
+    int rest = cells % 4;
+    if (rest > 0) {
+        uint8_t byte = packed[fullBytes];
+        if ((byte & (byte >> 1) & 0x55) || (byte >> (2 * rest))) return false;
+        for (int k = 0; k < rest; ++k) cell[k] = static_cast<PieceType>((byte >> (2 * k)) & 0x03);
+    }
+    return true;
+}
+
+// 定长棋盘状态转为文本 (只用于按文本协议转发)
+void appendBoardStateText(const uint8_t* bytes, std::string& data) {
+    int cells = bytes[3] * bytes[3];
+    for (size_t i = 0; i < 3; ++i) {
+        appendInt(data, bytes[i]);
+        data.push_back(',');
+    }
+    size_t cellStart = data.size();
+    data.resize(cellStart + cells * 2 - 1, ',');
+    char* out = &data[cellStart];
+    for (int i = 0; i < cells; ++i) {
+        int cell = (bytes[BOARD_HEADER_SIZE + i / 4] >> (2 * (i % 4))) & 0x03;
+        out[2 * i] = static_cast<char>('0' + cell);
+    }
+}
+
+// 增量的头部和变化格 (values 为行棋者、下一手、状态之后每格行、列、棋子), 文本与定长负载共用
+bool decodeDeltaValues(const uint8_t* values, size_t count, BoardDeltaInfo& delta) {
+    if (count < DELTA_HEADER_SIZE || (count - DELTA_HEADER_SIZE) % 3 != 0) return false;
+    if (values[0] > WHITE || values[1] > WHITE || values[2] > TIED) return false;
+    
+    delta.player = static_cast<PieceType>(values[0]);
+    delta.currentPlayer = static_cast<PieceType>(values[1]);
+    delta.gameStatus = static_cast<GameStatus>(values[2]);
+    delta.changes.clear();
+    for (size_t i = DELTA_HEADER_SIZE; i < count; i += 3) {
+        if (values[i + 2] > WHITE) return false;
+        delta.changes.push_back(CellChange{values[i], values[i + 1], static_cast<PieceType>(values[i + 2])});
+    }
+    return true;
+}
+
+bool hasFixedPayload(MessageType type) {
+    switch (type) {
+        case MessageType::MOVE:
+        case MessageType::PASS:
+        case MessageType::RESIGN:
+        case MessageType::GAME_END:
+        case MessageType::BOARD_SYNC:
+        case MessageType::BOARD_DELTA:
+        case MessageType::BOARD_SNAPSHOT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 收到的定长负载长度是否与格式相符; 字段取值由各 Info 解码时检查
+bool isValidPayload(MessageType type, const char* payload, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(payload);
+    size_t sequence;
+    size_t used;
+    switch (type) {
+        case MessageType::MOVE:
+            return size == 3;
+        case MessageType::PASS:
+        case MessageType::RESIGN:
+            return size == 0;
+        case MessageType::GAME_END:
+            return size == 1;
+        case MessageType::BOARD_SYNC:
+            return isValidBoardState(bytes, size);
+        case MessageType::BOARD_DELTA:
+            if (readVarint(payload, size, sequence, used, MAX_SEQUENCE_VARINT_BYTES) != FrameStatus::COMPLETE) return false;
+            return size - used >= DELTA_HEADER_SIZE && (size - used - DELTA_HEADER_SIZE) % 3 == 0;
+        case MessageType::BOARD_SNAPSHOT:
+            if (readVarint(payload, size, sequence, used, MAX_SEQUENCE_VARINT_BYTES) != FrameStatus::COMPLETE) return false;
+            return isValidBoardState(bytes + used, size - used);
+        default:
+            return false;
+    }
+}
+
+// 以文本构造的消息 (GAME_END、PASS 等) 按二进制协议发送时转为定长负载, 无法表示时返回 false
+bool encodeFixedPayload(MessageType type, const std::string& data, std::string& out) {
+    switch (type) {
+        case MessageType::MOVE: {
+            MoveInfo move{-1, -1, EMPTY};
+            if (!MoveInfo::parse(data, move)) return false;
+            NetworkMessage message = move.toMessage();
+            out.append(message.payload);
+            return message.binary;
+        }
+        case MessageType::PASS:
+        case MessageType::RESIGN:
+            return data.empty();
+        case MessageType::GAME_END: {
+            uint8_t status;
+            if (parseByteList(data, &status, 1) != 1) return false;
+            out.push_back(static_cast<char>(status));
+            return true;
+        }
+        case MessageType::BOARD_SYNC: {
+            GameStateInfo state{GOMOKU, BLACK, IN_PROGRESS, 0, {}};
+            return GameStateInfo::parse(data, state) && encodeBoardState(state, out);
+        }
+        case MessageType::BOARD_DELTA: {
+            BoardDeltaInfo delta{0, EMPTY, EMPTY, IN_PROGRESS, {}};
+            if (!BoardDeltaInfo::parse(data, delta)) return false;
+            NetworkMessage message = delta.toMessage();
+            out.append(message.payload);
+            return message.binary;
+        }
+        case MessageType::BOARD_SNAPSHOT: {
+            BoardSnapshotInfo snapshot{0, GameStateInfo{GOMOKU, BLACK, IN_PROGRESS, 0, {}}};
+            if (!BoardSnapshotInfo::parse(data, snapshot)) return false;
+            appendVarint(out, snapshot.sequence);
+            return encodeBoardState(snapshot.state, out);
+        }
+        default:
+            return false;
+    }
+}
+
+// 把 (已检查过长度的) 定长负载转为文本 data, 只在按文本协议发送或取 text() 时使用
+void appendPayloadText(MessageType type, const char* payload, size_t size, std::string& data) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(payload);
+    size_t sequence = 0;
+    size_t used = 0;
+    switch (type) {
+        case MessageType::MOVE:
+            appendInt(data, bytes[0]);
+            data.push_back(',');
+            appendInt(data, bytes[1]);
+            data.push_back(',');
+            appendInt(data, bytes[2]);
+            break;
+        case MessageType::GAME_END:
+            appendInt(data, bytes[0]);
+            break;
+        case MessageType::BOARD_SYNC:
+            appendBoardStateText(bytes, data);
+            break;
+        case MessageType::BOARD_DELTA:
+            readVarint(payload, size, sequence, used, MAX_SEQUENCE_VARINT_BYTES);
+            data.reserve(16 + (size - used) * 4);
+            appendInt(data, static_cast<uint64_t>(sequence));
+            for (size_t i = used; i < size; ++i) {
+                data.push_back(',');
+                appendInt(data, bytes[i]);
+            }
+            break;
+        case MessageType::BOARD_SNAPSHOT:
+            readVarint(payload, size, sequence, used, MAX_SEQUENCE_VARINT_BYTES);
+            appendInt(data, static_cast<uint64_t>(sequence));
+            data.push_back(',');
+            appendBoardStateText(bytes + used, data);
+            break;
+        default:
+            break;
+    }
+}
+
+}
+
+bool parseInt(std::string_view text, int& value) {
+    return parseIntegral(text, value);
+}
+
+bool parseInt(std::string_view text, uint64_t& value) {
+    return parseIntegral(text, value);
+}
+
+NetworkMessage NetworkMessage::fromPayload(MessageType t, std::string payload) {
+    NetworkMessage message(t, std::string());
+    message.payload = std::move(payload);
+    message.binary = true;
+    return message;
+}
+
+std::string NetworkMessage::text() const {
+    if (!binary) return data;
+    std::string text;
+    appendPayloadText(type, payload.data(), payload.size(), text);
+    return text;
+}
+
+std::string NetworkMessage::serialize() const {
     std::ostringstream oss;
-    oss << std::setw(8) << std::setfill('0') << length;
+    oss << static_cast<int>(type) << ":" << text();
     return oss.str();
 }
 
-size_t NetworkMessage::parseLengthPrefix(const std::string& prefix) {
-    if (prefix.length() < 8) return 0;
-    try {
-        return std::stoull(prefix);
-    } catch (const std::exception& e) {
-        return 0;
+bool NetworkMessage::parse(std::string_view text, NetworkMessage& message) {
+    size_t colon = text.find(':');
+    int type;
+    uint8_t wireType;
+    // 类型须是二进制协议也能表示的编号, 与二进制帧的检查一致
+    if (colon == std::string_view::npos || !parseInt(text.substr(0, colon), type) ||
+        !toWireType(static_cast<MessageType>(type), wireType)) {
+        return false;
     }
+    message.type = static_cast<MessageType>(type);
+    message.data.assign(text.data() + colon + 1, text.size() - colon - 1);
+    message.binary = false;
+    return true;
 }
 
-std::string MoveInfo::serialize() const {
+std::string NetworkMessage::createLengthPrefix(size_t length) {
     std::ostringstream oss;
-    oss << row << "," << col << "," << static_cast<int>(player);
+    oss << std::setw(8) << std::setfill('0') << length;
     return oss.str();
 }
 
-MoveInfo MoveInfo::deserialize(const std::string& data) {
-    std::istringstream iss(data);
-    std::string token;
+size_t NetworkMessage::parseLengthPrefix(std::string_view prefix) {
+    size_t length;
+    if (prefix.size() < LENGTH_PREFIX_SIZE || !parseIntegral(prefix.substr(0, LENGTH_PREFIX_SIZE), length)) return 0;
+    return length;
+}
+
+std::string NetworkMessage::encodeFrame(int protocolVersion) const {
+    uint8_t wireType;
+    if (protocolVersion < NetworkConfig::BINARY_PROTOCOL_VERSION || !toWireType(type, wireType)) {
+        std::string serialized = serialize();
+        return createLengthPrefix(serialized.length()) + serialized;
+    }
     
-    MoveInfo move;
+    // 定长负载原样写出
+    if (binary) {
+        std::string frame;
+        frame.reserve(MAX_VARINT_BYTES + 1 + payload.size());
+        appendVarint(frame, 1 + payload.size());
+        frame.push_back(static_cast<char>(wireType));
+        frame.append(payload);
+        return frame;
+    }
     
-    if (std::getline(iss, token, ',')) move.row = std::stoi(token);
-    if (std::getline(iss, token, ',')) move.col = std::stoi(token);
-    if (std::getline(iss, token, ',')) move.player = static_cast<PieceType>(std::stoi(token));
+    std::string body;
+    body.reserve(1 + data.size());
+    body.push_back(static_cast<char>(wireType));
+    if (hasFixedPayload(type) && !encodeFixedPayload(type, data, body)) {
+        body.resize(1);
+        body[0] = static_cast<char>(wireType | RAW_PAYLOAD_FLAG);
+        body.append(data);
+    } else if (!hasFixedPayload(type)) {
+        body.append(data);
+    }
     
-    return move;
+    std::string frame;
+    frame.reserve(body.size() + 2);
+    appendVarint(frame, body.size());
+    frame.append(body);
+    return frame;
 }
 
-std::string GameStateInfo::serialize() const {
+FrameStatus NetworkMessage::decodeFrame(const char* buffer, size_t size, int protocolVersion,
+                                        NetworkMessage& message, size_t& consumed) {
+    if (protocolVersion < NetworkConfig::BINARY_PROTOCOL_VERSION) {
+        if (size < LENGTH_PREFIX_SIZE) return FrameStatus::INCOMPLETE;
+        size_t messageLength = 0;
+        for (size_t i = 0; i < LENGTH_PREFIX_SIZE; ++i) {
+            char c = buffer[i];
+            if (c < '0' || c > '9') return FrameStatus::INVALID;
+            messageLength = messageLength * 10 + (c - '0');
+        }
+        if (messageLength == 0 || messageLength > NetworkConfig::BUFFER_SIZE) return FrameStatus::INVALID;
+        if (size - LENGTH_PREFIX_SIZE < messageLength) return FrameStatus::INCOMPLETE;
+        
+        if (!parse(std::string_view(buffer + LENGTH_PREFIX_SIZE, messageLength), message)) return FrameStatus::INVALID;
+        consumed = LENGTH_PREFIX_SIZE + messageLength;
+        return FrameStatus::COMPLETE;
+    }
+    
+    size_t bodyLength;
+    size_t prefixLength;
+    FrameStatus status = readVarint(buffer, size, bodyLength, prefixLength);
+    if (status != FrameStatus::COMPLETE) return status;
+    if (bodyLength == 0 || bodyLength > NetworkConfig::BUFFER_SIZE) return FrameStatus::INVALID;
+    if (size - prefixLength < bodyLength) return FrameStatus::INCOMPLETE;
+    
+    uint8_t wireType = static_cast<uint8_t>(buffer[prefixLength]);
+    if ((wireType & 0x70) == 0) return FrameStatus::INVALID;   // 类别 0 不对应任何消息
+    const char* payload = buffer + prefixLength + 1;
+    size_t payloadLength = bodyLength - 1;
+    
+    message.type = fromWireType(wireType & ~RAW_PAYLOAD_FLAG);
+    message.binary = hasFixedPayload(message.type) && !(wireType & RAW_PAYLOAD_FLAG);
+    if (message.binary) {
+        // 定长负载原样保存, 由各 Info 的 parse 直接解码
+        if (!isValidPayload(message.type, payload, payloadLength)) return FrameStatus::INVALID;
+        message.data.clear();
+        message.payload.assign(payload, payloadLength);
+    } else {
+        message.data.assign(payload, payloadLength);
+    }
+    consumed = prefixLength + bodyLength;
+    return FrameStatus::COMPLETE;
+}
+
+std::string MoveInfo::serialize() const {
     std::ostringstream oss;
-    oss << static_cast<int>(gameType) << ","
-        << static_cast<int>(currentPlayer) << ","
-        << static_cast<int>(gameStatus) << ","
-        << boardState;
+    oss << row << "," << col << "," << static_cast<int>(player);
     return oss.str();
 }
 
-GameStateInfo GameStateInfo::deserialize(const std::string& data) {
-    std::istringstream iss(data);
-    std::string token;
+bool MoveInfo::parse(std::string_view data, MoveInfo& move) {
+    FieldReader fields(data);
+    return fields.nextInt(move.row) && fields.nextInt(move.col) &&
+           fields.nextEnum(move.player, WHITE) && fields.atEnd();
+}
+
+NetworkMessage MoveInfo::toMessage() const {
+    if (!fitsByte(row) || !fitsByte(col)) return NetworkMessage(MessageType::MOVE, serialize());
+    std::string payload(3, '\0');
+    payload[0] = static_cast<char>(row);
+    payload[1] = static_cast<char>(col);
+    payload[2] = static_cast<char>(player);
+    return NetworkMessage::fromPayload(MessageType::MOVE, std::move(payload));
+}
+
+bool MoveInfo::parse(const NetworkMessage& message, MoveInfo& move) {
+    if (!message.binary) return parse(message.data, move);
+    const std::string& payload = message.payload;
+    if (payload.size() != 3 || static_cast<uint8_t>(payload[2]) > WHITE) return false;
+    move.row = static_cast<uint8_t>(payload[0]);
+    move.col = static_cast<uint8_t>(payload[1]);
+    move.player = static_cast<PieceType>(payload[2]);
+    return true;
+}
+
+std::string GameStateInfo::serialize() const {
+    std::string data;
+    data.reserve(8 + cells.size() * 2);
+    appendInt(data, static_cast<int>(gameType));
+    data.push_back(',');
+    appendInt(data, static_cast<int>(currentPlayer));
+    data.push_back(',');
+    appendInt(data, static_cast<int>(gameStatus));
+    data.push_back(',');
+    for (size_t i = 0; i < cells.size(); ++i) {
+        if (i > 0) data.push_back(',');
+        data.push_back(static_cast<char>('0' + cells[i]));
+    }
+    return data;
+}
+
+bool GameStateInfo::parse(std::string_view data, GameStateInfo& state) {
+    FieldReader fields(data);
+    if (!fields.nextEnum(state.gameType, OTHELLO) || !fields.nextEnum(state.currentPlayer, WHITE) ||
+        !fields.nextEnum(state.gameStatus, TIED)) {
+        return false;
+    }
     
-    GameStateInfo state;
+    // 剩余的所有内容都是棋盘: 每格 "c," 两个字符, 最后一格没有逗号, 长度必须恰好是 2 * 格数 - 1
+    std::string_view board = fields.remaining();
+    if (board.size() % 2 == 0) return false;
+    int cells = static_cast<int>((board.size() + 1) / 2);
+    int size = 0;
+    while (size * size < cells) ++size;
+    if (size * size != cells || size > MAX_SYNC_BOARD_SIZE) return false;
     
-    if (std::getline(iss, token, ',')) {
-        state.gameType = static_cast<GameType>(std::stoi(token));
-    }
-    if (std::getline(iss, token, ',')) {
-        state.currentPlayer = static_cast<PieceType>(std::stoi(token));
+    state.boardSize = size;
+    state.cells.resize(cells);
+    for (int i = 0; i < cells; ++i) {
+        char c = board[2 * i];
+        if (c < '0' || c > '2') return false;
+        if (i < cells - 1 && board[2 * i + 1] != ',') return false;
+        state.cells[i] = static_cast<PieceType>(c - '0');
     }
-    if (std::getline(iss, token, ',')) {
-        state.gameStatus = static_cast<GameStatus>(std::stoi(token));
+    return true;
+}
+
+NetworkMessage GameStateInfo::toMessage() const {
+    std::string payload;
+    if (!encodeBoardState(*this, payload)) return NetworkMessage(MessageType::BOARD_SYNC, serialize());
+    return NetworkMessage::fromPayload(MessageType::BOARD_SYNC, std::move(payload));
+}
+
+bool GameStateInfo::parse(const NetworkMessage& message, GameStateInfo& state) {
+    if (!message.binary) return parse(message.data, state);
+    const std::string& payload = message.payload;
+    return decodeBoardState(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), state);
+}
+
+std::string BoardDeltaInfo::serialize() const {
+    std::string data = std::to_string(sequence);
+    data.reserve(data.size() + 8 + changes.size() * 9);
+    data.push_back(',');
+    appendInt(data, player);
+    data.push_back(',');
+    appendInt(data, currentPlayer);
+    data.push_back(',');
+    appendInt(data, gameStatus);
+    for (const CellChange& change : changes) {
+        data.push_back(',');
+        appendInt(data, change.row);
+        data.push_back(',');
+        appendInt(data, change.col);
+        data.push_back(',');
+        appendInt(data, change.piece);
     }
-    // 剩余的所有内容都是棋盘状态
-    std::getline(iss, token);
-    state.boardState = token;
+    return data;
+}
+
+bool BoardDeltaInfo::parse(std::string_view data, BoardDeltaInfo& delta) {
+    std::string_view rest;
+    if (!parseSequence(data, delta.sequence, rest)) return false;
     
-    return state;
+    uint8_t values[DELTA_HEADER_SIZE + 3 * MAX_SYNC_BOARD_SIZE * MAX_SYNC_BOARD_SIZE];
+    int count = parseByteList(rest, values, sizeof(values));
+    return count >= 0 && decodeDeltaValues(values, static_cast<size_t>(count), delta);
+}
+
+NetworkMessage BoardDeltaInfo::toMessage() const {
+    // 序号 varint, 之后行棋者、下一手、状态和每个变化格的 (行, 列, 棋子) 各 1 字节
+    std::string payload;
+    payload.reserve(MAX_SEQUENCE_VARINT_BYTES + DELTA_HEADER_SIZE + 3 * changes.size());
+    appendVarint(payload, sequence);
+    payload.push_back(static_cast<char>(player));
+    payload.push_back(static_cast<char>(currentPlayer));
+    payload.push_back(static_cast<char>(gameStatus));
+    for (const CellChange& change : changes) {
+        if (!fitsByte(change.row) || !fitsByte(change.col)) return NetworkMessage(MessageType::BOARD_DELTA, serialize());
+        payload.push_back(static_cast<char>(change.row));
+        payload.push_back(static_cast<char>(change.col));
+        payload.push_back(static_cast<char>(change.piece));
+    }
+    return NetworkMessage::fromPayload(MessageType::BOARD_DELTA, std::move(payload));
+}
+
+bool BoardDeltaInfo::parse(const NetworkMessage& message, BoardDeltaInfo& delta) {
+    if (!message.binary) return parse(message.data, delta);
+    const std::string& payload = message.payload;
+    size_t sequence;
+    size_t used;
+    if (readVarint(payload.data(), payload.size(), sequence, used, MAX_SEQUENCE_VARINT_BYTES) != FrameStatus::COMPLETE) {
+        return false;
+    }
+    delta.sequence = sequence;
+    return decodeDeltaValues(reinterpret_cast<const uint8_t*>(payload.data()) + used, payload.size() - used, delta);
+}
+
+std::string BoardSnapshotInfo::serialize() const {
+    return std::to_string(sequence) + "," + state.serialize();
+}
+
+bool BoardSnapshotInfo::parse(std::string_view data, BoardSnapshotInfo& snapshot) {
+    std::string_view rest;
+    return parseSequence(data, snapshot.sequence, rest) && GameStateInfo::parse(rest, snapshot.state);
+}
+
+NetworkMessage BoardSnapshotInfo::toMessage() const {
+    std::string payload;
+    appendVarint(payload, sequence);
+    if (!encodeBoardState(state, payload)) return NetworkMessage(MessageType::BOARD_SNAPSHOT, serialize());
+    return NetworkMessage::fromPayload(MessageType::BOARD_SNAPSHOT, std::move(payload));
+}
+
+bool BoardSnapshotInfo::parse(const NetworkMessage& message, BoardSnapshotInfo& snapshot) {
+    if (!message.binary) return parse(message.data, snapshot);
+    const std::string& payload = message.payload;
+    size_t sequence;
+    size_t used;
+    if (readVarint(payload.data(), payload.size(), sequence, used, MAX_SEQUENCE_VARINT_BYTES) != FrameStatus::COMPLETE) {
+        return false;
+    }
+    snapshot.sequence = sequence;
+    return decodeBoardState(reinterpret_cast<const uint8_t*>(payload.data()) + used, payload.size() - used,
+                            snapshot.state);
 }
 
 std::string NotifyInfo::serialize() const {
     return std::to_string(static_cast<int>(notifyType));
 }
 
-NotifyInfo NotifyInfo::deserialize(const std::string& data) {
-    NotifyInfo info;
-    info.notifyType = static_cast<NotifyType>(std::stoi(data));
-    return info;
+bool NotifyInfo::parse(std::string_view data, NotifyInfo& info) {
+    int value;
+    if (!parseInt(data, value) || value < 0 || value > static_cast<int>(NotifyType::QLOAD)) return false;
+    info.notifyType = static_cast<NotifyType>(value);
+    return true;
 }
 
 std::string TimeCountInfo::serialize() const {
     return std::to_string(timeCount);
 }
 
-TimeCountInfo TimeCountInfo::deserialize(const std::string& data) {
-    TimeCountInfo info;
-    info.timeCount = std::stoi(data);
-    return info;
+bool TimeCountInfo::parse(std::string_view data, TimeCountInfo& info) {
+    return parseInt(data, info.timeCount);
+}
+
+EncodedMessage::Frame EncodedMessage::getFrame(int protocolVersion) const {
+    std::lock_guard<std::mutex> lock(frameMutex);
+    Frame& frame = frames[protocolVersion];
+    if (!frame) frame = std::make_shared<const std::string>(message.encodeFrame(protocolVersion));
+    return frame;
+}
+
+std::string RoomInfo::serialize() const {
+    std::ostringstream oss;
+    oss << roomId << "," << static_cast<int>(gameType) << "," << boardSize << "," << playerCount;
+    if (spectatorCount > 0) oss << "," << spectatorCount;
+    return oss.str();
+}
+
+bool RoomInfo::parse(std::string_view data, RoomInfo& info) {
+    FieldReader fields(data);
+    if (!fields.nextInt(info.roomId) || !fields.nextEnum(info.gameType, OTHELLO) ||
+        !fields.nextInt(info.boardSize) || !fields.nextInt(info.playerCount)) {
+        return false;
+    }
+    // 观众数为 0 时省略
+    info.spectatorCount = 0;
+    return fields.atEnd() || (fields.nextInt(info.spectatorCount) && fields.atEnd());
 }
 
 } // namespace chessgame::network
\ No newline at end of file
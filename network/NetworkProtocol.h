@@ -1,5 +1,9 @@
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "../utils/Type.h"
 
@@ -11,6 +15,10 @@ enum class MessageType {
     CONNECT_REQUEST = 1001,
     CONNECT_RESPONSE = 1002,
     DISCONNECT = 1003,
+    VERSION_NEGOTIATE = 1004,   // 协议版本协商 (始终以文本协议收发)
+    SESSION_TOKEN = 1005,       // 服务器在开局时发给玩家的会话令牌 (协议版本 3)
+    SESSION_RESUME = 1006,      // 断线重连: 客户端发送 "令牌,已确认序号", 补发完成后服务器回复执子颜色
+    LOCAL_CHANNEL = 1007,       // 同机连接改用共享内存通道: 经 Unix socket 发送并附带描述符, 服务器回复 OK 或 NO
     
     // 游戏设置
     GAME_START = 2001,
@@ -28,6 +36,9 @@ enum class MessageType {
     BOARD_SYNC = 4001,
     CURRENT_PLAYER_SYNC = 4002,
     GAME_STATUS_SYNC = 4003,
+    BOARD_DELTA = 4004,         // 增量同步: 序号 + 变化的格子 (协议版本 3)
+    BOARD_SNAPSHOT = 4005,      // 带序号的完整局面 (协议版本 3)
+    SYNC_REQUEST = 4006,        // 客户端发现序号断档时请求完整局面
     
     // 通知消息（参考 GoBang）
     NOTIFY = 5001,
@@ -37,7 +48,15 @@ enum class MessageType {
     
     // 错误处理
     ERROR = 6001,
-    HEARTBEAT = 6002
+    HEARTBEAT = 6002,
+    
+    // 房间管理 (独立服务器)
+    ROOM_CREATE = 7001,
+    ROOM_JOIN = 7002,
+    ROOM_LEAVE = 7003,
+    ROOM_INFO = 7004,
+    ROOM_WATCH = 7005,          // 观战
+    ROOM_BOT = 7006             // 与服务器托管的机器人对局
 };
 
 // 通知类型（参考 GoBang）
@@ -51,26 +70,106 @@ enum class NotifyType {
     QLOAD = 6       // 请求加载
 };
 
+// 网络配置
+struct NetworkConfig {
+    static const int DEFAULT_PORT = 12346;
+    static const int MAX_CONNECTIONS = 2;             // 局域网对战主机的连接数
+    static const int MAX_SERVER_CONNECTIONS = 100000; // 独立服务器的连接数上限
+    static const int LISTEN_BACKLOG = 4096;
+    static const int BUFFER_SIZE = 4096;
+    static const int HEARTBEAT_INTERVAL = 30; // 秒
+    static const int CONNECTION_TIMEOUT = 60; // 秒
+    
+    // 协议版本: 1 为文本协议 (8 位 ASCII 长度前缀 + "type:data"), 2 起为二进制帧,
+    // 3 起服务器以 BOARD_DELTA/BOARD_SNAPSHOT 同步棋盘
+    static const int LEGACY_PROTOCOL_VERSION = 1;
+    static const int BINARY_PROTOCOL_VERSION = 2;
+    static const int DELTA_SYNC_PROTOCOL_VERSION = 3;
+    static const int PROTOCOL_VERSION = 3;
+    static const int VERSION_NEGOTIATE_TIMEOUT_MS = 500;
+    static const int SESSION_GRACE_PERIOD = 30;   // 断线玩家的座位保留时间 (秒)
+};
+
+// 帧解码结果
+enum class FrameStatus {
+    COMPLETE,     // 解出一帧
+    INCOMPLETE,   // 数据不足, 需要继续接收
+    INVALID       // 数据非法, 应断开连接
+};
+
+// 把整段文本解析为十进制整数: 为空、带多余字符或溢出时返回 false.
+// 接收路径上的解析 (包括下面各消息的 parse) 都不抛异常、不另外分配内存, 格式非法时返回 false 由调用方处理
+bool parseInt(std::string_view text, int& value);
+bool parseInt(std::string_view text, uint64_t& value);
+
 // 网络消息结构
+//
+// 二进制帧 (协议版本 2): varint 长度 | 1 字节类型 | 负载
+//   类型字节: 第 4-6 位为消息类别 (MessageType / 1000), 低 4 位为类别内编号,
+//            最高位表示负载是原始文本 (定长格式无法表示时使用)
+//   定长负载: MOVE 为行、列、玩家各 1 字节; PASS/RESIGN 无负载; GAME_END 为 1 字节状态;
+//            BOARD_SYNC 为游戏类型、行棋方、状态、边长各 1 字节, 之后每格 2 位;
+//            BOARD_DELTA 为 varint 序号 + 行棋者、下一手、状态各 1 字节 + 每个变化格 3 字节;
+//            BOARD_SNAPSHOT 为 varint 序号 + BOARD_SYNC 的格式
+//   其他消息的负载与文本协议的 data 相同
+//
+// 落子、棋盘同步等消息由各 Info 的 toMessage() 直接编码为定长负载 (binary 为 true), 收到的定长负载也原样保存,
+// 由各 Info 的 parse(message, ...) 直接解码; 只有按文本协议发送或调用 text() 时才转换为文本
 struct NetworkMessage {
     MessageType type;
-    std::string data;
+    std::string data;      // 文本负载 (binary 为 true 时为空)
+    std::string payload;   // 定长负载 (binary 为 true 时有效)
+    bool binary{false};
     
     NetworkMessage(MessageType t, const std::string& d) : type(t), data(d) {}
     
+    // 由定长负载构造
+    static NetworkMessage fromPayload(MessageType t, std::string payload);
+    
+    // 文本形式的负载: 定长负载在这里转换
+    std::string text() const;
+    
     // 序列化为字符串
     std::string serialize() const;
     
-    // 从字符串反序列化
-    static NetworkMessage deserialize(const std::string& str);
+    // 从 "type:data" 文本解析 (复用 message.data 的容量); 格式或类型非法时返回 false
+    static bool parse(std::string_view text, NetworkMessage& message);
     
     // 获取消息长度前缀
     static std::string createLengthPrefix(size_t length);
     
-    // 解析消息长度
-    static size_t parseLengthPrefix(const std::string& prefix);
+    // 解析消息长度, 非法时返回 0
+    static size_t parseLengthPrefix(std::string_view prefix);
+    
+    // 按协议版本编码为完整的帧
+    std::string encodeFrame(int protocolVersion = NetworkConfig::LEGACY_PROTOCOL_VERSION) const;
+    
+    // 从缓冲区头部解码一帧, 成功时 consumed 为该帧占用的字节数
+    static FrameStatus decodeFrame(const char* buffer, size_t size, int protocolVersion,
+                                   NetworkMessage& message, size_t& consumed);
+};
+
+// 只读消息及其按协议版本缓存的编码结果.
+// 同一事件发给多个连接时只编码一次, 各连接的发送队列共享同一个帧缓冲区; 可在多个线程间共享
+class EncodedMessage {
+public:
+    using Frame = std::shared_ptr<const std::string>;
+    
+    explicit EncodedMessage(NetworkMessage msg) : message(std::move(msg)) {}
+    
+    const NetworkMessage& getMessage() const { return message; }
+    
+    // 按协议版本编码后的帧 (首次请求时编码)
+    Frame getFrame(int protocolVersion) const;
+    
+private:
+    NetworkMessage message;
+    mutable std::mutex frameMutex;
+    mutable Frame frames[NetworkConfig::PROTOCOL_VERSION + 1];
 };
 
+using SharedMessage = std::shared_ptr<const EncodedMessage>;
+
 // 游戏移动信息
 struct MoveInfo {
     int row;
@@ -78,18 +177,64 @@ struct MoveInfo {
     PieceType player;
     
     std::string serialize() const;
-    static MoveInfo deserialize(const std::string& data);
+    static bool parse(std::string_view data, MoveInfo& move);
+    
+    // 编码为 MOVE 消息 / 从 MOVE 消息解析 (定长负载不经过文本)
+    NetworkMessage toMessage() const;
+    static bool parse(const NetworkMessage& message, MoveInfo& move);
 };
 
-// 游戏状态信息
+// 游戏状态信息: 文本格式 "type,player,status,c,c,...", 每格一个数字, 格数须是边长的平方
 struct GameStateInfo {
     GameType gameType;
     PieceType currentPlayer;
     GameStatus gameStatus;
-    std::string boardState;
+    int boardSize;
+    std::vector<PieceType> cells;   // 逐行排列, 共 boardSize * boardSize 格
     
     std::string serialize() const;
-    static GameStateInfo deserialize(const std::string& data);
+    static bool parse(std::string_view data, GameStateInfo& state);
+    
+    // 编码为 BOARD_SYNC 消息 / 从 BOARD_SYNC 消息解析
+    NetworkMessage toMessage() const;
+    static bool parse(const NetworkMessage& message, GameStateInfo& state);
+};
+
+// 棋盘中的一个变化格
+struct CellChange {
+    int row;
+    int col;
+    PieceType piece;   // 变化后的棋子
+};
+
+// 增量同步: 一次落子造成的全部变化 (落子、提子、翻转); 虚着、认输、超时是不含变化格的增量
+// 文本格式 "seq,player,current,status,r,c,p,r,c,p,..."
+struct BoardDeltaInfo {
+    uint64_t sequence;           // 每个房间从 1 开始连续递增
+    PieceType player;            // 落子方 (或虚着、认输、超时的一方)
+    PieceType currentPlayer;     // 落子后轮到的一方
+    GameStatus gameStatus;
+    std::vector<CellChange> changes;
+    
+    std::string serialize() const;
+    static bool parse(std::string_view data, BoardDeltaInfo& delta);
+    
+    // 编码为 BOARD_DELTA 消息 / 从 BOARD_DELTA 消息解析
+    NetworkMessage toMessage() const;
+    static bool parse(const NetworkMessage& message, BoardDeltaInfo& delta);
+};
+
+// 带序号的完整局面: 加入房间或序号断档时发送, 文本格式 "seq," + GameStateInfo
+struct BoardSnapshotInfo {
+    uint64_t sequence;           // 该局面之后的第一个增量序号为 sequence + 1
+    GameStateInfo state;
+    
+    std::string serialize() const;
+    static bool parse(std::string_view data, BoardSnapshotInfo& snapshot);
+    
+    // 编码为 BOARD_SNAPSHOT 消息 / 从 BOARD_SNAPSHOT 消息解析
+    NetworkMessage toMessage() const;
+    static bool parse(const NetworkMessage& message, BoardSnapshotInfo& snapshot);
 };
 
 // 通知消息信息
@@ -97,7 +242,7 @@ struct NotifyInfo {
     NotifyType notifyType;
     
     std::string serialize() const;
-    static NotifyInfo deserialize(const std::string& data);
+    static bool parse(std::string_view data, NotifyInfo& info);
 };
 
 // 时间计数信息
@@ -105,16 +250,19 @@ struct TimeCountInfo {
     int timeCount;  // 使用的时间（秒）
     
     std::string serialize() const;
-    static TimeCountInfo deserialize(const std::string& data);
+    static bool parse(std::string_view data, TimeCountInfo& info);
 };
 
-// 网络配置
-struct NetworkConfig {
-    static const int DEFAULT_PORT = 12346;
-    static const int MAX_CONNECTIONS = 2;
-    static const int BUFFER_SIZE = 4096;
-    static const int HEARTBEAT_INTERVAL = 30; // 秒
-    static const int CONNECTION_TIMEOUT = 60; // 秒
+// 房间信息: ROOM_INFO 消息中每个房间一项, 多项以 ';' 分隔
+struct RoomInfo {
+    int roomId;
+    GameType gameType;
+    int boardSize;
+    int playerCount;
+    int spectatorCount{0};   // 观众数 (为 0 时不序列化, 与旧格式相同)
+    
+    std::string serialize() const;
+    static bool parse(std::string_view data, RoomInfo& info);
 };
 
 // 错误代码
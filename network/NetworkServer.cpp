@@ -1,29 +1,178 @@
 #include "NetworkServer.h"
+#include "AsyncLogger.h"
+#include "Metrics.h"
 #include <iostream>
 #include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <charconv>
+#include <fcntl.h>
 #include <ifaddrs.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
-#include <fstream>
-#include <ctime>
-#include <chrono>
 
 namespace chessgame::network {
 
-NetworkServer::NetworkServer() : serverSocket(-1), running(false) {
-    for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-        clientSockets[i] = -1;
-    }
+namespace {
+
+// 单次 recv 的缓冲区大小
+const size_t READ_CHUNK_SIZE = 64 * 1024;
+
+// 发送队列的高低水位: 超过高水位暂停读取该连接, 降到低水位恢复
+const size_t SEND_HIGH_WATER_MARK = 256 * 1024;
+const size_t SEND_LOW_WATER_MARK = 64 * 1024;
+
+// 发送队列上限: 对端长期不读时断开, 避免内存无限增长
+const size_t MAX_SEND_QUEUE = 4 * 1024 * 1024;
+
+// 单次 writev 最多合并的帧数
+const int MAX_IOV_PER_WRITE = 64;
+
+const uint32_t READ_EVENTS = EPOLLIN | EPOLLRDHUP;
+
+// 同机连接一次最多暂存的对端描述符 (LOCAL_CHANNEL 请求附带三个)
+const size_t MAX_PASSED_FDS = 3;
+
+std::string formatAddress(const sockaddr_in& address) {
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &address.sin_addr, ip, INET_ADDRSTRLEN);
+    return std::string(ip) + ":" + std::to_string(ntohs(address.sin_port));
+}
+
+bool isUnixSocket(int fd) {
+    int domain = 0;
+    socklen_t length = sizeof(domain);
+    return getsockopt(fd, SOL_SOCKET, SO_DOMAIN, &domain, &length) == 0 && domain == AF_UNIX;
+}
+
+// 预留一个空闲描述符: 描述符耗尽时用它接受并立即关闭新连接, 否则监听 socket 会一直可读
+int reserveFd() {
+    return open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+// 描述符耗尽: 借用预留描述符接受后立即关闭, 让对端尽快得知
+void rejectWithSpareFd(int listenFd) {
+    static int spareFd = reserveFd();
+    if (spareFd < 0) return;
+    close(spareFd);
+    int rejected = accept(listenFd, nullptr, nullptr);
+    if (rejected >= 0) close(rejected);
+    spareFd = reserveFd();
+}
+
+// io_uring 请求的 user_data: 高位为连接编号, 低 8 位为请求类型
+enum UringOp : uint64_t { OP_ACCEPT = 1, OP_RECV, OP_SEND, OP_CANCEL };
+
+uint64_t uringTag(int clientId, UringOp op) {
+    return (static_cast<uint64_t>(clientId) << 8) | op;
+}
+
+// io_uring 提交队列长度和接收缓冲区 (provided buffer) 的数量、大小
+const unsigned URING_ENTRIES = 4096;
+const unsigned URING_BUFFER_COUNT = 2048;
+const unsigned URING_BUFFER_SIZE = 4096;
+
+// 多次触发的 accept 因出错结束后, 隔多久重新提交 (毫秒)
+const int ACCEPT_RETRY_MS = 100;
+
+}
+
+NetworkServer::NetworkServer(int maxConnections)
+    : serverSocket(-1), maxConnections(maxConnections), running(false) {
 }
 
 NetworkServer::~NetworkServer() {
     stop();
+    if (ioThread.joinable()) {
+        // 在 I/O 线程上析构时无法 join 自己
+        if (ioThread.get_id() == std::this_thread::get_id()) ioThread.detach();
+        else ioThread.join();
+    }
 }
 
 bool NetworkServer::start(int port) {
-    // 创建socket
-    serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (running.load()) return true;
+    if (ioThread.joinable()) ioThread.join();
+    
+    loop = std::make_unique<EventLoop>();
+    if (!loop->isValid()) {
+        loop.reset();
+        return false;
+    }
+    
+    // 沿用交来的监听 socket 时跳过创建和绑定, 新连接一直在它的 backlog 中排队
+    bool inherited = inheritedSocket >= 0;
+    if (inherited) {
+        serverSocket = inheritedSocket;
+        inheritedSocket = -1;
+    } else if (!listenTcp(port)) {
+        return false;
+    }
+    
+    // 端口为 0 时由系统分配, 读回实际端口
+    struct sockaddr_in serverAddr;
+    socklen_t addrLen = sizeof(serverAddr);
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    getsockname(serverSocket, (struct sockaddr*)&serverAddr, &addrLen);
+    listenPort = ntohs(serverAddr.sin_port);
+    
+    if (inheritedLocalSocket >= 0) {
+        localSocket = inheritedLocalSocket;
+        inheritedLocalSocket = -1;
+    } else if (!localSocketPath.empty() && !listenLocal()) {
+        close(serverSocket);
+        serverSocket = -1;
+        return false;
+    }
+    
+    if (backend == Backend::IO_URING && !startUring()) {
+        std::cerr << "io_uring 不可用 (" << strerror(errno) << ")，改用 epoll" << std::endl;
+        backend = Backend::EPOLL;
+    }
+    if (!inherited) startAccepting();
+    
+    running = true;
+    
+    // 启动 I/O 线程
+    ioThread = std::thread([this]() {
+        loop->run();
+        
+        // 事件循环退出后在本线程上释放所有连接
+        closeAllConnections();
+        if (uring) stopUring();
+        // 监听 socket 已交给其他进程时为 -1
+        if (serverSocket >= 0) {
+            loop->remove(serverSocket);
+            close(serverSocket);
+            serverSocket = -1;
+        }
+        if (localSocket >= 0) {
+            loop->remove(localSocket);
+            close(localSocket);
+            if (!localSocketPath.empty()) unlink(localSocketPath.c_str());
+            localSocket = -1;
+        }
+        AsyncLogger::instance().flush();
+        std::cout << "服务器已停止" << std::endl;
+    });
+    
+    std::cout << "服务器启动成功，监听端口: " << listenPort
+              << (backend == Backend::IO_URING ? " (io_uring)" : "")
+              << (inherited ? " (沿用交来的监听 socket)" : "") << std::endl;
+    std::cout << "本地IP地址: " << getLocalIPAddress() << std::endl;
+    if (localSocket >= 0) std::cout << "本地 socket: " << localSocketPath << std::endl;
+    
+    return true;
+}
+
+bool NetworkServer::listenTcp(int port) {
+    // 创建非阻塞socket
+    serverSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (serverSocket < 0) {
         std::cerr << "创建服务器socket失败" << std::endl;
         return false;
@@ -34,6 +183,13 @@ bool NetworkServer::start(int port) {
     if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
         std::cerr << "设置socket选项失败" << std::endl;
         close(serverSocket);
+        serverSocket = -1;
+        return false;
+    }
+    if (reusePort && setsockopt(serverSocket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        std::cerr << "设置 SO_REUSEPORT 失败: " << strerror(errno) << std::endl;
+        close(serverSocket);
+        serverSocket = -1;
         return false;
     }
     
@@ -47,253 +203,1089 @@ bool NetworkServer::start(int port) {
     if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
         std::cerr << "绑定地址失败" << std::endl;
         close(serverSocket);
+        serverSocket = -1;
         return false;
     }
     
-    // 开始监听
-    if (listen(serverSocket, NetworkConfig::MAX_CONNECTIONS) < 0) {
+    // 开始监听: backlog 与连接数上限无关
+    if (listen(serverSocket, NetworkConfig::LISTEN_BACKLOG) < 0) {
         std::cerr << "监听失败" << std::endl;
         close(serverSocket);
+        serverSocket = -1;
         return false;
     }
+    return true;
+}
+
+void NetworkServer::startAccepting() {
+    if (accepting) return;
+    accepting = true;
+    if (uring) {
+        armAccept();
+    } else {
+        loop->add(serverSocket, EPOLLIN, [this](uint32_t) { handleAccept(serverSocket); });
+    }
+    // 同机连接不论后端都经 epoll 收发
+    if (localSocket >= 0) {
+        loop->add(localSocket, EPOLLIN, [this](uint32_t) { handleAccept(localSocket); });
+    }
+}
+
+std::vector<int> NetworkServer::getListenFds() const {
+    std::vector<int> fds{serverSocket};
+    if (localSocket >= 0) fds.push_back(localSocket);
+    return fds;
+}
+
+void NetworkServer::releaseListeners() {
+    // io_uring 的 accept 取消之前完成的连接照常登记, 由调用方一并交出
+    if (accepting && uring) {
+        uring->prepareCancel(uringTag(0, OP_ACCEPT), uringTag(0, OP_CANCEL));
+    } else if (accepting) {
+        loop->remove(serverSocket);
+    }
+    if (accepting && localSocket >= 0) loop->remove(localSocket);
+    accepting = false;
     
-    running = true;
-    
-    // 启动接受连接的线程
-    acceptThread = std::thread(&NetworkServer::acceptConnections, this);
-    
-    std::cout << "服务器启动成功，监听端口: " << port << std::endl;
-    std::cout << "本地IP地址: " << getLocalIPAddress() << std::endl;
+    // 不能 shutdown: 打开的文件与接手的进程共享. 路径也已归接手的进程所有, 不删除
+    close(serverSocket);
+    serverSocket = -1;
+    if (localSocket >= 0) close(localSocket);
+    localSocket = -1;
+    localSocketPath.clear();
+}
+
+bool NetworkServer::listenLocal() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (localSocketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "本地 socket 路径无效: " << localSocketPath << std::endl;
+        return false;
+    }
+    memcpy(address.sun_path, localSocketPath.c_str(), localSocketPath.size() + 1);
     
+    localSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (localSocket < 0) {
+        std::cerr << "创建本地 socket 失败: " << strerror(errno) << std::endl;
+        return false;
+    }
+    unlink(localSocketPath.c_str());
+    if (bind(localSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(localSocket, NetworkConfig::LISTEN_BACKLOG) < 0) {
+        std::cerr << "本地 socket 监听失败: " << strerror(errno) << std::endl;
+        close(localSocket);
+        localSocket = -1;
+        return false;
+    }
     return true;
 }
 
 void NetworkServer::stop() {
-    if (!running.load()) return;
+    if (!running.exchange(false)) return;
     
-    running = false;
+    loop->stop();
     
-    // 关闭所有客户端连接
-    for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-        if (clientSockets[i] >= 0) {
-            close(clientSockets[i]);
-            clientSockets[i] = -1;
+    // 在回调中 (I/O 线程上) 调用时只发出停止请求, 由析构或下次 start 回收线程
+    if (ioThread.joinable() && ioThread.get_id() != std::this_thread::get_id()) {
+        ioThread.join();
+    }
+}
+
+void NetworkServer::handleAccept(int listenFd) {
+    bool local = listenFd == localSocket;
+    while (true) {
+        struct sockaddr_in clientAddr;
+        socklen_t clientAddrLen = sizeof(clientAddr);
+        
+        int clientSocket = accept4(listenFd, local ? nullptr : (struct sockaddr*)&clientAddr,
+                                   local ? nullptr : &clientAddrLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        Metrics::add(Metrics::IO_SYSCALLS);
+        if (clientSocket < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                AsyncLogger::instance().warn("文件描述符耗尽，拒绝连接");
+                Metrics::add(Metrics::CONNECTIONS_REJECTED);
+                rejectWithSpareFd(listenFd);
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && running.load()) {
+                AsyncLogger::instance().warn("接受连接失败: ", strerror(errno));
+            }
+            return;
         }
+        acceptConnection(clientSocket, local ? "local" : formatAddress(clientAddr), local);
     }
+}
+
+void NetworkServer::acceptConnection(int clientSocket, const std::string& peerAddress, bool local) {
+    Metrics::StageTimer acceptTimer(Metrics::ACCEPT);
     
-    // 关闭服务器socket
-    if (serverSocket >= 0) {
-        close(serverSocket);
-        serverSocket = -1;
+    if (connectionCount.load() >= maxConnections) {
+        AsyncLogger::instance().warn("服务器已满，拒绝连接");
+        Metrics::add(Metrics::CONNECTIONS_REJECTED);
+        close(clientSocket);
+        return;
     }
     
-    // 等待线程结束
-    if (acceptThread.joinable()) {
-        acceptThread.join();
+    if (!local) {
+        int noDelay = 1;
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
     }
     
-    for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-        if (clientThreads[i].joinable()) {
-            clientThreads[i].join();
+    auto conn = std::make_shared<Connection>();
+    conn->id = nextConnectionId++;
+    conn->fd = clientSocket;
+    conn->local = local;
+    conn->peerAddress = peerAddress;
+    if (!registerConnection(conn)) {
+        close(clientSocket);
+        return;
+    }
+    
+    Metrics::add(Metrics::CONNECTIONS_ACCEPTED);
+    AsyncLogger::instance().info("客户端连接: ", conn->peerAddress, " (连接号: ", conn->id, ")");
+    
+    // 发送连接确认 (文本协议, 旧客户端依赖它)
+    NetworkMessage response(MessageType::CONNECT_RESPONSE, "OK");
+    sendMessage(conn->id, EncodedMessage(response));
+    
+    // 调用连接回调
+    if (connectCallback) connectCallback(conn->id);
+}
+
+bool NetworkServer::registerConnection(const std::shared_ptr<Connection>& conn) {
+    conn->registeredEvents = READ_EVENTS;
+    conn->viaUring = uring && !conn->local;
+    if (conn->viaUring) {
+        armRecv(*conn);
+    } else if (!loop->add(conn->fd, READ_EVENTS, [this, conn](uint32_t events) {
+                   handleConnectionEvent(conn, events);
+               })) {
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(clientMutex);
+        connections[conn->id] = conn;
+    }
+    connectionCount++;
+    
+    conn->lastActivity = EventLoop::Clock::now();
+    if (idleTimeout.count() > 0) scheduleIdleCheck(*conn, idleTimeout);
+    return true;
+}
+
+bool NetworkServer::detachClient(int clientId, std::function<void(Handoff&)> done) {
+    std::shared_ptr<Connection> conn = findConnection(clientId);
+    if (!conn || conn->detaching) return false;
+    {
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        conn->detaching = true;
+    }
+    conn->onDetached = std::move(done);
+    
+    // 可能正在 dispatchFrames 中: 其余的帧留在读缓冲区, 稍后再交出.
+    // io_uring 后端先取消 recv, 等在途的请求都结束 (见 handleRecvResult、handleSendCompletion)
+    if (uring && conn->recvArmed) {
+        uring->prepareCancel(uringTag(clientId, OP_RECV), uringTag(clientId, OP_CANCEL));
+    }
+    post([this, conn]() { if (conn->pendingOps == 0) finishDetach(conn); });
+    return true;
+}
+
+void NetworkServer::finishDetach(const std::shared_ptr<Connection>& conn) {
+    {
+        std::lock_guard<std::mutex> lock(clientMutex);
+        if (connections.erase(conn->id) == 0) return;  // 期间已被对端关闭
+    }
+    connectionCount--;
+    loop->cancelTimer(conn->idleTimer);
+    if (!conn->viaUring) loop->remove(conn->fd);
+    if (conn->channel) loop->remove(conn->channel->getBellFd());
+    
+    Handoff handoff;
+    {
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        conn->closed = true;
+        handoff.fd = conn->fd;
+        handoff.protocolVersion = conn->protocolVersion;
+        // 没写出的帧 (包括写了一半的) 由接手方接着发送
+        for (size_t i = 0; i < conn->sendQueue.size(); ++i) {
+            const Frame& frame = conn->sendQueue[i];
+            size_t offset = i == 0 ? conn->sendOffset : 0;
+            handoff.unsent.append(frame->data() + offset, frame->size() - offset);
         }
+        conn->sendQueue.clear();
+        conn->fd = -1;
     }
+    // 通道的描述符随连接一起转交 (本进程的一份随连接释放); 环中尚未取走的数据由接手方继续读取
+    if (conn->channel) conn->channel->getFds(handoff.channelFds);
+    handoff.peerAddress = conn->peerAddress;
+    handoff.pending.swap(conn->readBuffer);
     
-    std::cout << "服务器已停止" << std::endl;
+    Metrics::add(Metrics::CONNECTIONS_HANDED_OFF);
+    AsyncLogger::instance().info("连接交给其他进程 (连接号: ", conn->id, ")");
+    auto done = std::move(conn->onDetached);
+    done(handoff);
 }
 
-void NetworkServer::acceptConnections() {
-    while (running.load()) {
-        struct sockaddr_in clientAddr;
-        socklen_t clientAddrLen = sizeof(clientAddr);
-        
-        int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientAddrLen);
-        if (clientSocket < 0) {
-            if (running.load()) {
-                std::cerr << "接受连接失败" << std::endl;
-            }
-            continue;
+int NetworkServer::adoptClient(Handoff& handoff, const std::function<void(int)>& attach) {
+    // 通道的描述符先交给 ShmChannel, 之后无论成败都由它关闭
+    std::unique_ptr<ShmChannel> channel;
+    if (handoff.channelFds[0] >= 0) {
+        channel = std::make_unique<ShmChannel>();
+        if (!channel->attach(handoff.channelFds[0], handoff.channelFds[1], handoff.channelFds[2])) {
+            AsyncLogger::instance().warn("交来的共享内存通道无效，断开连接");
+            close(handoff.fd);
+            return -1;
         }
-        
-        // 查找空闲的客户端槽位
-        int slot = -1;
+    }
+    if (connectionCount.load() >= maxConnections) {
+        AsyncLogger::instance().warn("服务器已满，拒绝交来的连接");
+        Metrics::add(Metrics::CONNECTIONS_REJECTED);
+        close(handoff.fd);
+        return -1;
+    }
+    
+    // 描述符的阻塞模式随打开的文件共享: 按本进程的后端重新设置 (与 accept 时一致, 同机连接总是经 epoll)
+    bool local = isUnixSocket(handoff.fd);
+    int flags = fcntl(handoff.fd, F_GETFL);
+    fcntl(handoff.fd, F_SETFL, uring && !local ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK));
+    
+    auto conn = std::make_shared<Connection>();
+    conn->id = nextConnectionId++;
+    conn->fd = handoff.fd;
+    conn->local = local;
+    conn->peerAddress = handoff.peerAddress;
+    conn->protocolVersion = handoff.protocolVersion;
+    conn->channel = std::move(channel);
+    if (!registerConnection(conn)) {
+        close(handoff.fd);
+        return -1;
+    }
+    if (conn->channel && !watchChannel(conn)) {
+        cleanupClient(conn);
+        return -1;
+    }
+    
+    Metrics::add(Metrics::CONNECTIONS_ADOPTED);
+    AsyncLogger::instance().info("接手其他进程的连接: ", conn->peerAddress, " (连接号: ", conn->id, ")");
+    if (!handoff.unsent.empty()) {
+        bool ok;
         {
-            std::lock_guard<std::mutex> lock(clientMutex);
-            for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-                if (clientSockets[i] < 0) {
-                    slot = i;
-                    clientSockets[i] = clientSocket;
-                    break;
-                }
+            std::lock_guard<std::mutex> lock(conn->writeMutex);
+            ok = enqueueFrame(*conn, std::make_shared<const std::string>(std::move(handoff.unsent)));
+        }
+        if (!ok) {
+            cleanupClient(conn);
+            return -1;
+        }
+    }
+    
+    if (attach) attach(conn->id);
+    else if (connectCallback) connectCallback(conn->id);
+    
+    // 交接时还没处理的帧 (包括触发交接的那一条) 按原顺序处理
+    conn->readBuffer = std::move(handoff.pending);
+    if (!conn->readBuffer.empty() && !processFrames(conn)) {
+        cleanupClient(conn);
+        return -1;
+    }
+    // 环中尚未取走的数据由 I/O 线程接着读
+    if (conn->channel) conn->channel->notifySelf();
+    return conn->id;
+}
+
+bool NetworkServer::watchReadable(int fd, std::function<void()> onReadable) {
+    return loop->add(fd, EPOLLIN, [callback = std::move(onReadable)](uint32_t) { callback(); });
+}
+
+void NetworkServer::unwatch(int fd) {
+    loop->remove(fd);
+}
+
+void NetworkServer::handleConnectionEvent(const std::shared_ptr<Connection>& conn, uint32_t events) {
+    // Unix socket 的对端关闭时 EPOLLHUP 与 EPOLLIN 一起报告: 先读完剩下的数据, 读到结尾时再清理
+    if ((events & EPOLLERR) || ((events & EPOLLHUP) && !(events & EPOLLIN))) {
+        cleanupClient(conn);
+        return;
+    }
+    
+    if (events & EPOLLOUT) {
+        bool resumed;
+        {
+            std::lock_guard<std::mutex> lock(conn->writeMutex);
+            bool wasPaused = conn->readPaused;
+            if (!flushSendQueue(*conn)) {
+                conn->closed = true;
             }
+            resumed = wasPaused && !conn->readPaused;
+        }
+        // 恢复读取后先处理暂停期间留下的帧
+        if (resumed && !conn->closed && !processFrames(conn)) {
+            cleanupClient(conn);
+            return;
+        }
+    }
+    if (conn->closed) {
+        cleanupClient(conn);
+        return;
+    }
+    
+    if (events & (EPOLLIN | EPOLLRDHUP)) {
+        if (!readFromConnection(conn)) {
+            cleanupClient(conn);
+        }
+    }
+}
+
+bool NetworkServer::readFromConnection(const std::shared_ptr<Connection>& conn) {
+    if (conn->channel) {
+        // 改用共享内存通道后 socket 只在对端关闭时可读: 先取完环中剩下的帧 (例如 DISCONNECT) 再断开
+        readFromChannel(conn);
+        return false;
+    }
+    
+    // 每次事件只读一块: 水平触发下剩余数据会再次通知, 也不会让一个连接独占 I/O 线程
+    char buffer[READ_CHUNK_SIZE];
+    ssize_t received;
+    do {
+        received = conn->local ? receiveWithFds(*conn, buffer, sizeof(buffer)) : recv(conn->fd, buffer, sizeof(buffer), 0);
+        Metrics::add(Metrics::IO_SYSCALLS);
+    } while (received < 0 && errno == EINTR);
+    
+    if (received < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    if (received == 0) return false;
+    Metrics::add(Metrics::BYTES_RECEIVED, static_cast<uint64_t>(received));
+    conn->lastActivity = EventLoop::Clock::now();
+    return receiveData(conn, buffer, static_cast<size_t>(received));
+}
+
+ssize_t NetworkServer::receiveWithFds(Connection& conn, char* buffer, size_t size) {
+    // 同机连接的对端可能随数据附带描述符 (LOCAL_CHANNEL): 暂存到取用时, 超出一次请求所需的直接关闭
+    iovec iov{buffer, size};
+    alignas(cmsghdr) char control[CMSG_SPACE(MAX_PASSED_FDS * sizeof(int))];
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t received = recvmsg(conn.fd, &message, MSG_CMSG_CLOEXEC);
+    if (received < 0) return received;
+    
+    for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) continue;
+        size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; ++i) {
+            int fd;
+            memcpy(&fd, CMSG_DATA(header) + i * sizeof(int), sizeof(int));
+            if (conn.passedFds.size() < MAX_PASSED_FDS) conn.passedFds.push_back(fd);
+            else close(fd);
         }
+    }
+    return received;
+}
+
+bool NetworkServer::receiveData(const std::shared_ptr<Connection>& conn, const char* data, size_t size) {
+    if (!conn->readBuffer.empty()) {
+        conn->readBuffer.append(data, size);
+        return processFrames(conn);
+    }
+    // 读缓冲区为空时直接在收到的数据上解码, 只把不完整的尾帧 (或暂停读取后剩下的帧) 复制到读缓冲区
+    bool ok = true;
+    size_t used = dispatchFrames(conn, data, size, ok);
+    if (ok && used < size) conn->readBuffer.assign(data + used, size - used);
+    return ok;
+}
+
+bool NetworkServer::processFrames(const std::shared_ptr<Connection>& conn) {
+    bool ok = true;
+    size_t used = dispatchFrames(conn, conn->readBuffer.data(), conn->readBuffer.size(), ok);
+    if (ok) conn->readBuffer.erase(0, used);
+    return ok;
+}
+
+size_t NetworkServer::dispatchFrames(const std::shared_ptr<Connection>& conn, const char* data, size_t size, bool& ok) {
+    // 拆出所有完整的帧 (协商版本后, 后续的帧按新版本解码); 暂停读取时剩余的帧留到恢复后处理.
+    // 返回已处理的字节数; 帧非法或回调中断开了连接时 ok 为 false
+    size_t pos = 0;
+    NetworkMessage& message = frameMessage;
+    while (pos < size && !conn->readPaused && !conn->detaching && !inputSuspended) {
+        size_t consumed = 0;
+        auto parseStart = Metrics::Clock::now();
+        FrameStatus status = NetworkMessage::decodeFrame(data + pos, size - pos,
+                                                         conn->protocolVersion, message, consumed);
+        if (status == FrameStatus::INCOMPLETE) break;
+        if (status == FrameStatus::INVALID) {
+            Metrics::add(Metrics::INVALID_FRAMES);
+            AsyncLogger::instance().warn("消息格式无效，断开客户端连接 (连接号: ", conn->id, ")");
+            ok = false;
+            return pos;
+        }
+        Metrics::record(Metrics::PARSE, Metrics::Clock::now() - parseStart);
+        Metrics::add(Metrics::FRAMES_RECEIVED);
+        pos += consumed;
         
-        if (slot == -1) {
-            std::cerr << "服务器已满，拒绝连接" << std::endl;
-            close(clientSocket);
+        // 处理心跳
+        if (message.type == MessageType::HEARTBEAT) {
+            NetworkMessage response(MessageType::HEARTBEAT, "PONG");
+            sendMessage(conn->id, EncodedMessage(response));
             continue;
         }
         
-        char clientIP[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
-        std::cout << "客户端连接: " << clientIP << ":" << ntohs(clientAddr.sin_port) 
-                  << " (槽位: " << slot << ")" << std::endl;
+        if (message.type == MessageType::VERSION_NEGOTIATE) {
+            negotiateVersion(conn, message.data);
+            continue;
+        }
         
-        // 发送连接确认
-        NetworkMessage response(MessageType::CONNECT_RESPONSE, "OK");
-        bool sendSuccess = sendMessage(clientSocket, response);
+        if (message.type == MessageType::LOCAL_CHANNEL) {
+            attachChannel(conn, message.data);
+            if (conn->closed) {
+                ok = false;
+                return pos;
+            }
+            continue;
+        }
         
-        // 调用连接回调
-        if (connectCallback) connectCallback(clientSocket);
+        // 调用消息回调（在回调中处理消息转发和游戏逻辑）
+        if (messageCallback) messageCallback(conn->id, message);
         
-        // 启动客户端处理线程
-        clientThreads[slot] = std::thread(&NetworkServer::handleClient, this, clientSocket);
+        // 回调中可能已经断开该连接
+        if (conn->closed) {
+            ok = false;
+            return pos;
+        }
     }
+    return pos;
 }
 
-void NetworkServer::handleClient(int clientSocket) {
-    while (running.load()) {
-        NetworkMessage message = receiveMessage(clientSocket);
-        
-        if (message.type == MessageType::ERROR) {
-            std::cerr << "接收消息错误，断开客户端连接" << std::endl;
-            break;
+bool NetworkServer::flushSendQueue(Connection& conn) {
+    if (conn.channel) writeToChannel(conn);
+    
+    // 把队列中的帧合并成一次 writev, 直到写完或 socket 缓冲区满
+    while (!conn.channel && !conn.sendQueue.empty()) {
+        struct iovec iov[MAX_IOV_PER_WRITE];
+        int count = 0;
+        for (auto it = conn.sendQueue.begin(); it != conn.sendQueue.end() && count < MAX_IOV_PER_WRITE; ++it, ++count) {
+            size_t offset = (count == 0) ? conn.sendOffset : 0;
+            iov[count].iov_base = const_cast<char*>((*it)->data() + offset);
+            iov[count].iov_len = (*it)->size() - offset;
         }
         
-        // 处理心跳
-        if (message.type == MessageType::HEARTBEAT) {
-            NetworkMessage response(MessageType::HEARTBEAT, "PONG");
-            sendMessage(clientSocket, response);
-            continue;
+        ssize_t sent = writev(conn.fd, iov, count);
+        Metrics::add(Metrics::IO_SYSCALLS);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
         }
         
-        // 调用消息回调（在回调中处理消息转发和游戏逻辑）
-        if (messageCallback) {
-            messageCallback(clientSocket, message);
+        conn.queuedBytes -= sent;
+        Metrics::add(Metrics::BYTES_SENT, static_cast<uint64_t>(sent));
+        size_t remaining = sent;
+        while (remaining > 0) {
+            size_t frontLeft = conn.sendQueue.front()->size() - conn.sendOffset;
+            if (remaining < frontLeft) {
+                conn.sendOffset += remaining;
+                break;
+            }
+            remaining -= frontLeft;
+            conn.sendQueue.pop_front();
+            conn.sendOffset = 0;
         }
     }
     
-    cleanupClient(clientSocket);
+    // 降到低水位后恢复读取
+    if (conn.readPaused && conn.queuedBytes <= SEND_LOW_WATER_MARK) {
+        conn.readPaused = false;
+    }
+    updateEvents(conn);
+    return true;
 }
 
-bool NetworkServer::sendMessage(int clientSocket, const NetworkMessage& message) {
-    std::string serialized = message.serialize();
+void NetworkServer::updateEvents(Connection& conn) {
+    // io_uring 后端由 I/O 线程在收到数据时检查暂停标志 (见 handleRecvCompletion)
+    if (conn.viaUring) return;
     
-    // 添加长度前缀
-    std::string lengthPrefix = NetworkMessage::createLengthPrefix(serialized.length());
-    std::string fullMessage = lengthPrefix + serialized;
+    if (conn.channel) {
+        // 共享内存通道没有事件可改 (socket 一直只等对端关闭): 恢复读取时敲本端的门铃,
+        // 由 I/O 线程取走暂停期间留在环中的数据
+        uint32_t events = conn.readPaused ? 0 : READ_EVENTS;
+        if (events != conn.registeredEvents && !conn.readPaused) conn.channel->notifySelf();
+        conn.registeredEvents = events;
+        return;
+    }
     
-    ssize_t sent = send(clientSocket, fullMessage.c_str(), fullMessage.length(), 0);
+    // 暂停读取时不关注任何读事件 (EPOLLERR/EPOLLHUP 总会通知)
+    uint32_t events = conn.readPaused ? 0 : READ_EVENTS;
+    if (!conn.sendQueue.empty()) events |= EPOLLOUT;   // 写不完: 等待 socket 可写
+    if (events != conn.registeredEvents) {
+        loop->modify(conn.fd, events);
+        Metrics::add(Metrics::IO_SYSCALLS);
+        conn.registeredEvents = events;
+    }
+}
+
+bool NetworkServer::enqueueFrame(Connection& conn, const Frame& frame) {
+    bool wasEmpty = conn.sendQueue.empty();
+    conn.sendQueue.push_back(frame);
+    conn.queuedBytes += frame->size();
+    Metrics::add(Metrics::FRAMES_QUEUED);
     
-    if (sent != static_cast<ssize_t>(fullMessage.length())) {
-        std::cerr << "发送数据失败，期望 " << fullMessage.length() << " 实际 " << sent << std::endl;
+    if (conn.queuedBytes > MAX_SEND_QUEUE) {
+        // 标记为关闭, 在 I/O 线程清理之前丢弃后续发送
+        Metrics::add(Metrics::SLOW_CLIENT_DISCONNECTS);
+        AsyncLogger::instance().warn("客户端接收过慢，断开连接 (连接号: ", conn.id, ")");
+        conn.closed = true;
         return false;
     }
+    if (conn.queuedBytes > SEND_HIGH_WATER_MARK && !conn.readPaused) {
+        conn.readPaused = true;
+        updateEvents(conn);
+    }
     
-    return true;
+    if (conn.viaUring) {
+        // 登记后由 I/O 线程批量提交; 已登记或有发送在途时只入队
+        if (!conn.sendScheduled) {
+            conn.sendScheduled = true;
+            scheduleSend(conn.id);
+        }
+        return true;
+    }
+    
+    // 之前的数据还在等待 EPOLLOUT 时只入队, 由 I/O 线程合并写出
+    return !wasEmpty || flushSendQueue(conn);
 }
 
-NetworkMessage NetworkServer::receiveMessage(int clientSocket) {
-    // 首先读取长度前缀
-    char lengthBuffer[9] = {0}; // 8位长度 + 1位结束符
-    ssize_t received = recv(clientSocket, lengthBuffer, 8, 0);
+void NetworkServer::negotiateVersion(const std::shared_ptr<Connection>& conn, const std::string& requested) {
+    // 取双方都支持的最高版本
+    int version = NetworkConfig::LEGACY_PROTOCOL_VERSION;
+    std::from_chars(requested.data(), requested.data() + requested.size(), version);
+    version = std::max(NetworkConfig::LEGACY_PROTOCOL_VERSION, std::min(version, NetworkConfig::PROTOCOL_VERSION));
     
-    if (received <= 0) {
-        return NetworkMessage(MessageType::ERROR, "Connection lost");
+    // 应答仍按旧版本编码, 之后的帧改用新版本; 在写锁内切换, 保证其他线程的发送不会夹在中间
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        if (conn->closed) return;
+        NetworkMessage response(MessageType::VERSION_NEGOTIATE, std::to_string(version));
+        ok = enqueueFrame(*conn, std::make_shared<const std::string>(response.encodeFrame(conn->protocolVersion)));
+        conn->protocolVersion = version;
     }
-    
-    size_t messageLength = NetworkMessage::parseLengthPrefix(std::string(lengthBuffer, 8));
-    if (messageLength == 0 || messageLength > NetworkConfig::BUFFER_SIZE) {
-        return NetworkMessage(MessageType::ERROR, "Invalid message length");
+    if (!ok) disconnectClient(conn->id);
+}
+
+// 共享内存通道: 发送队列照旧, 写出时复制进环而不是 writev; 本端的门铃代替可读、可写事件.
+// 通道随连接交接时一起转交, 环中尚未取走的数据由接手方继续读取
+void NetworkServer::attachChannel(const std::shared_ptr<Connection>& conn, const std::string& request) {
+    // 只接受 Unix socket 上附带了三个描述符、容量一致的请求; 否则回复 NO, 客户端继续用 socket 收发
+    std::unique_ptr<ShmChannel> channel;
+    if (conn->local && conn->passedFds.size() == MAX_PASSED_FDS &&
+        request == std::to_string(ShmChannel::RING_CAPACITY)) {
+        channel = std::make_unique<ShmChannel>();
+        if (!channel->attach(conn->passedFds[0], conn->passedFds[1], conn->passedFds[2])) channel.reset();
+        conn->passedFds.clear();
     }
     
-    // 读取消息内容
-    char messageBuffer[NetworkConfig::BUFFER_SIZE] = {0};
-    size_t totalReceived = 0;
+    // 应答经 socket 写出, 之后的帧写入环: 在写锁内切换, 其他线程的发送不会夹在中间.
+    // 切换之前 socket 上的帧必须已经写完 (对端读完应答才改读环), 否则不启用通道
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        if (conn->closed) return;
+        if (!conn->sendQueue.empty()) channel.reset();
+        NetworkMessage response(MessageType::LOCAL_CHANNEL, channel ? "OK" : "NO");
+        ok = enqueueFrame(*conn, std::make_shared<const std::string>(response.encodeFrame(conn->protocolVersion)));
+        if (ok && channel) {
+            // 刚建立的 socket 不会写不下这一帧; 真写不完时对端已无法衔接, 只能断开
+            if (conn->sendQueue.empty()) conn->channel = std::move(channel);
+            else ok = false;
+        }
+    }
+    if (!ok || (conn->channel && !watchChannel(conn))) {
+        disconnectClient(conn->id);
+        return;
+    }
+    if (conn->channel) {
+        // 先走一遍读取流程: 取空 (此时为空) 后声明睡眠, 之后对端写入时才会敲门铃
+        conn->channel->notifySelf();
+        Metrics::add(Metrics::LOCAL_CHANNELS);
+        AsyncLogger::instance().info("改用共享内存通道 (连接号: ", conn->id, ")");
+    }
+}
+
+bool NetworkServer::watchChannel(const std::shared_ptr<Connection>& conn) {
+    return loop->add(conn->channel->getBellFd(), EPOLLIN, [this, conn](uint32_t) { handleChannelEvent(conn); });
+}
+
+void NetworkServer::handleChannelEvent(const std::shared_ptr<Connection>& conn) {
+    // 门铃表示接收环有了数据, 或发送环有了空间: 先写出积压的帧, 再取走收到的数据
+    conn->channel->clearBell();
+    Metrics::add(Metrics::IO_SYSCALLS);
+    {
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        if (!conn->closed && !conn->sendQueue.empty()) flushSendQueue(*conn);
+    }
+    if (conn->closed) {
+        cleanupClient(conn);
+        return;
+    }
+    if (conn->detaching) return;
     
-    while (totalReceived < messageLength) {
-        received = recv(clientSocket, messageBuffer + totalReceived, 
-                       messageLength - totalReceived, 0);
-        
-        if (received <= 0) {
-            return NetworkMessage(MessageType::ERROR, "Connection lost");
+    // 恢复读取后先处理暂停期间留下的帧
+    if (!conn->readPaused && !conn->readBuffer.empty() && !processFrames(conn)) {
+        cleanupClient(conn);
+        return;
+    }
+    if (!readFromChannel(conn)) cleanupClient(conn);
+}
+
+bool NetworkServer::readFromChannel(const std::shared_ptr<Connection>& conn) {
+    // 取空接收环后声明睡眠, 复查时又有数据就接着取. 每次事件至多取一个环的容量, 剩下的敲门铃留到下一轮,
+    // 不让一个连接独占 I/O 线程; 暂停读取或交接时停下且不声明睡眠, 恢复时由 updateEvents 敲门铃
+    char buffer[READ_CHUNK_SIZE];
+    size_t budget = ShmChannel::RING_CAPACITY;
+    while (!conn->readPaused && !conn->detaching && !conn->closed && !inputSuspended) {
+        if (budget == 0) {
+            conn->channel->notifySelf();
+            return true;
         }
-        
-        totalReceived += received;
+        size_t received = conn->channel->read(buffer, std::min(sizeof(buffer), budget));
+        if (received == 0) {
+            if (conn->channel->prepareSleep()) return true;
+            continue;
+        }
+        budget -= received;
+        Metrics::add(Metrics::BYTES_RECEIVED, static_cast<uint64_t>(received));
+        conn->lastActivity = EventLoop::Clock::now();
+        if (!receiveData(conn, buffer, received)) return false;
+    }
+    return !conn->closed;
+}
+
+void NetworkServer::writeToChannel(Connection& conn) {
+    // 帧按顺序复制进发送环; 环满时声明等待, 对端取走数据后敲门铃, 由 handleChannelEvent 接着写
+    while (!conn.sendQueue.empty()) {
+        const Frame& frame = conn.sendQueue.front();
+        size_t written = conn.channel->write(frame->data() + conn.sendOffset, frame->size() - conn.sendOffset);
+        if (written == 0) {
+            if (conn.channel->prepareBlock()) return;
+            continue;
+        }
+        conn.queuedBytes -= written;
+        Metrics::add(Metrics::BYTES_SENT, static_cast<uint64_t>(written));
+        conn.sendOffset += written;
+        if (conn.sendOffset == frame->size()) {
+            conn.sendQueue.pop_front();
+            conn.sendOffset = 0;
+        }
+    }
+}
+
+void NetworkServer::scheduleIdleCheck(Connection& conn, EventLoop::Clock::duration delay) {
+    int clientId = conn.id;
+    auto delayMs = std::chrono::duration_cast<std::chrono::milliseconds>(delay) + std::chrono::milliseconds(1);
+    conn.idleTimer = loop->runAfter(delayMs, [this, clientId]() { checkIdle(clientId); });
+}
+
+void NetworkServer::checkIdle(int clientId) {
+    std::shared_ptr<Connection> conn = findConnection(clientId);
+    if (!conn) return;
+    conn->idleTimer = TimerWheel::INVALID_TIMER;
+    
+    // 暂停读取期间收不到对端的数据, 不算空闲
+    auto now = EventLoop::Clock::now();
+    auto deadline = conn->lastActivity + idleTimeout;
+    if (now < deadline || conn->readPaused) {
+        scheduleIdleCheck(*conn, conn->readPaused ? EventLoop::Clock::duration(idleTimeout) : deadline - now);
+        return;
     }
     
-    std::string messageData(messageBuffer, messageLength);
-    // std::cout << "[DEBUG] 收到原始数据: " << messageData << std::endl;
-    return NetworkMessage::deserialize(messageData);
+    Metrics::add(Metrics::IDLE_DISCONNECTS);
+    AsyncLogger::instance().warn("客户端心跳超时，断开连接 (连接号: ", clientId, ")");
+    cleanupClient(conn);
 }
 
-void NetworkServer::cleanupClient(int clientSocket) {
+bool NetworkServer::sendMessage(int clientId, const EncodedMessage& message) {
+    std::shared_ptr<Connection> conn = findConnection(clientId);
+    if (!conn) return false;
+    
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        if (conn->closed) return false;
+        ok = enqueueFrame(*conn, message.getFrame(conn->protocolVersion));
+    }
+    
+    if (!ok) disconnectClient(clientId);
+    return ok;
+}
+
+std::shared_ptr<NetworkServer::Connection> NetworkServer::findConnection(int clientId) const {
+    std::lock_guard<std::mutex> lock(clientMutex);
+    auto it = connections.find(clientId);
+    return it == connections.end() ? nullptr : it->second;
+}
+
+void NetworkServer::cleanupClient(const std::shared_ptr<Connection>& conn) {
     {
         std::lock_guard<std::mutex> lock(clientMutex);
-        for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-            if (clientSockets[i] == clientSocket) {
-                clientSockets[i] = -1;
-                break;
-            }
-        }
+        if (connections.erase(conn->id) == 0) return;  // 已经清理过
     }
+    connectionCount--;
     
-    close(clientSocket);
+    loop->cancelTimer(conn->idleTimer);
+    if (!conn->viaUring) loop->remove(conn->fd);
+    if (conn->channel) loop->remove(conn->channel->getBellFd());
+    {
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        conn->closed = true;
+        // 在途的 io_uring 请求持有 socket, 只 close 不会结束它们; shutdown 让它们立即完成
+        if (conn->viaUring) shutdown(conn->fd, SHUT_RDWR);
+        close(conn->fd);
+        conn->fd = -1;
+    }
+    if (conn->pendingOps > 0) retiring[conn->id] = conn;
     
-    // 向其他客户端广播断开连接消息，同步玩家退出状态
-    NetworkMessage disconnectMsg(MessageType::DISCONNECT, std::to_string(clientSocket));
-    broadcastMessageExcept(disconnectMsg, clientSocket);
+    Metrics::add(Metrics::CONNECTIONS_CLOSED);
+    AsyncLogger::instance().info("客户端断开连接 (连接号: ", conn->id, ")");
     
     // 调用断开连接回调
     if (disconnectCallback) {
-        disconnectCallback(clientSocket);
+        disconnectCallback(conn->id);
     }
+}
+
+void NetworkServer::closeAllConnections() {
+    std::unordered_map<int, std::shared_ptr<Connection>> all;
+    {
+        std::lock_guard<std::mutex> lock(clientMutex);
+        all.swap(connections);
+    }
+    for (auto& entry : all) {
+        auto& conn = entry.second;
+        if (!conn->viaUring) loop->remove(conn->fd);
+        if (conn->channel) loop->remove(conn->channel->getBellFd());
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        conn->closed = true;
+        if (conn->viaUring) shutdown(conn->fd, SHUT_RDWR);
+        close(conn->fd);
+        conn->fd = -1;
+        if (conn->pendingOps > 0) retiring[conn->id] = conn;
+    }
+    connectionCount = 0;
+}
+
+// io_uring 后端: epoll 只负责定时器、跨线程任务和 io_uring 自身的完成通知. 监听 socket 用多次触发的 accept,
+// 每个连接挂一个多次触发的 recv (数据在内核挑选的 provided buffer 中, 复制进读缓冲区后立即归还);
+// 发送时把队列中的帧作为一串链接的 send 请求提交, 同一连接同时只有一串在途. 暂停读取时取消该连接的 recv
+bool NetworkServer::startUring() {
+    auto ring = std::make_unique<IoUring>();
+    if (!ring->init(URING_ENTRIES, URING_BUFFER_COUNT, URING_BUFFER_SIZE)) return false;
+    if (!loop->add(ring->getFd(), EPOLLIN, [this](uint32_t) { handleCompletions(); })) return false;
     
-    std::cout << "客户端断开连接" << std::endl;
+    uring = std::move(ring);
+    // 每轮等待之前提交这一轮积累的全部请求: 一次 io_uring_enter 覆盖所有连接
+    loop->setBeforeWait([this]() {
+        flushPendingSends();
+        uring->submit();
+    });
+    return true;
 }
 
-void NetworkServer::broadcastMessage(const NetworkMessage& message) {
-    std::lock_guard<std::mutex> lock(clientMutex);
-    int sentCount = 0;
-    for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-        if (clientSockets[i] >= 0) {
-            bool success = sendMessage(clientSockets[i], message);
-            if (success) sentCount++;
-        }
+void NetworkServer::stopUring() {
+    // 让 accept 结束, 再等已关闭连接的请求结束 (最多约 100 毫秒), 之后才能释放它们引用的发送缓冲
+    if (serverSocket >= 0) shutdown(serverSocket, SHUT_RDWR);
+    for (int attempt = 0; attempt < 100 && !retiring.empty(); ++attempt) {
+        uring->submit();
+        if (handleCompletions(), retiring.empty()) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
-    std::cout << "Broadcast sent to " << sentCount << " clients" << std::endl;
+    loop->remove(uring->getFd());
+    loop->setBeforeWait(nullptr);
+    uring.reset();
+    retiring.clear();
+    pendingSends.clear();
 }
 
-void NetworkServer::broadcastMessageExcept(const NetworkMessage& message, int excludeSocket) {
-    std::lock_guard<std::mutex> lock(clientMutex);
-    for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-        if (clientSockets[i] >= 0 && clientSockets[i] != excludeSocket) {
-            sendMessage(clientSockets[i], message);
+void NetworkServer::handleCompletions() {
+    uring->forEachCompletion([this](uint64_t userData, int result, uint32_t flags) {
+        int clientId = static_cast<int>(userData >> 8);
+        switch (userData & 0xff) {
+            case OP_ACCEPT: handleAcceptCompletion(result, flags); break;
+            case OP_RECV: handleRecvCompletion(clientId, result, flags); break;
+            case OP_SEND: handleSendCompletion(clientId, result); break;
+            default: break;   // 取消请求本身的结果
+        }
+    });
+}
+
+void NetworkServer::armAccept() {
+    // 没有 SOCK_NONBLOCK: 连接只通过 io_uring 收发, 阻塞模式下请求在内核中等待就绪
+    uring->prepareMultishotAccept(serverSocket, SOCK_CLOEXEC, uringTag(0, OP_ACCEPT));
+}
+
+void NetworkServer::handleAcceptCompletion(int result, uint32_t flags) {
+    if (result >= 0 && !running.load()) {
+        close(result);   // 停止过程中接受的连接
+    } else if (result >= 0) {
+        struct sockaddr_in clientAddr;
+        socklen_t clientAddrLen = sizeof(clientAddr);
+        if (getpeername(result, (struct sockaddr*)&clientAddr, &clientAddrLen) < 0) {
+            memset(&clientAddr, 0, sizeof(clientAddr));
         }
+        acceptConnection(result, formatAddress(clientAddr), false);
+    } else if (result == -EMFILE || result == -ENFILE) {
+        AsyncLogger::instance().warn("文件描述符耗尽，拒绝连接");
+        Metrics::add(Metrics::CONNECTIONS_REJECTED);
+        rejectWithSpareFd(serverSocket);
+    } else if (running.load() && accepting) {
+        AsyncLogger::instance().warn("接受连接失败: ", strerror(-result));
+    }
+    
+    // 出错时多次触发的 accept 随之结束; 稍后重新提交, 避免持续出错时空转. 监听 socket 已交出时不再提交
+    if (!(flags & IORING_CQE_F_MORE) && running.load() && accepting) {
+        if (result >= 0) armAccept();
+        else loop->runAfter(std::chrono::milliseconds(ACCEPT_RETRY_MS), [this]() { if (uring && accepting) armAccept(); });
     }
 }
 
-void NetworkServer::sendToClient(int clientSocket, const NetworkMessage& message) {
-    sendMessage(clientSocket, message);
+void NetworkServer::armRecv(Connection& conn) {
+    uring->prepareMultishotRecv(conn.fd, uringTag(conn.id, OP_RECV));
+    conn.recvArmed = true;
+    conn.pendingOps++;
 }
 
-int NetworkServer::getConnectedClientCount() const {
-    int count = 0;
-    std::lock_guard<std::mutex> lock(clientMutex);
-    for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-        if (clientSockets[i] >= 0) {
-            count++;
+void NetworkServer::handleRecvCompletion(int clientId, int result, uint32_t flags) {
+    // 数据直接在内核选中的接收缓冲区上解码, 处理完再归还
+    const char* data = result > 0 && IoUring::hasBuffer(flags) ? uring->getBuffer(IoUring::bufferId(flags)) : nullptr;
+    std::shared_ptr<Connection> conn = findUringConnection(clientId);
+    if (conn) handleRecvResult(conn, result, flags, data);
+    if (IoUring::hasBuffer(flags)) uring->recycleBuffer(IoUring::bufferId(flags));
+}
+
+void NetworkServer::handleRecvResult(const std::shared_ptr<Connection>& conn, int result, uint32_t flags, const char* data) {
+    int clientId = conn->id;
+    if (data && conn->fd >= 0) {
+        Metrics::add(Metrics::BYTES_RECEIVED, static_cast<uint64_t>(result));
+        conn->lastActivity = EventLoop::Clock::now();
+    }
+    
+    if (!(flags & IORING_CQE_F_MORE)) {
+        conn->recvArmed = false;
+        finishUringOp(conn);
+    }
+    if (conn->fd < 0) return;
+    
+    if (conn->detaching) {
+        // 交接中: 取消生效之前收到的数据留给接手方
+        if (data) conn->readBuffer.append(data, static_cast<size_t>(result));
+        if (conn->pendingOps == 0) finishDetach(conn);
+        return;
+    }
+    
+    // 对端关闭或出错; 缓冲区用完 (ENOBUFS) 和暂停时的取消 (ECANCELED) 只需在之后重新提交
+    if (result == 0 || (result < 0 && result != -ENOBUFS && result != -ECANCELED)) {
+        cleanupClient(conn);
+        return;
+    }
+    if (conn->readPaused) {
+        // 暂停读取: 取消 recv, 让数据留在内核中形成 TCP 背压; 已收到的部分留在读缓冲区
+        if (data) conn->readBuffer.append(data, static_cast<size_t>(result));
+        if (conn->recvArmed) uring->prepareCancel(uringTag(clientId, OP_RECV), uringTag(clientId, OP_CANCEL));
+        return;
+    }
+    if (data && !receiveData(conn, data, static_cast<size_t>(result))) {
+        cleanupClient(conn);
+        return;
+    }
+    if (conn->recvArmed || conn->readPaused || conn->fd < 0) return;
+    if (result == -ENOBUFS) {
+        // 接收缓冲区暂时用完: 隔一个时间轮刻度再挂 recv, 避免空转
+        loop->runAfter(std::chrono::milliseconds(EventLoop::TIMER_TICK_MS), [this, clientId]() {
+            std::shared_ptr<Connection> retry = findConnection(clientId);
+            if (retry && uring && !retry->recvArmed && !retry->readPaused) armRecv(*retry);
+        });
+        return;
+    }
+    armRecv(*conn);
+}
+
+void NetworkServer::scheduleSend(int clientId) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(sendListMutex);
+        wake = pendingSends.empty();
+        pendingSends.push_back(clientId);
+    }
+    // 一批只唤醒一次; 在 I/O 线程上登记的会在这一轮等待之前提交
+    if (wake && !loop->isInLoopThread()) loop->wakeup();
+}
+
+void NetworkServer::flushPendingSends() {
+    sendBatch.clear();
+    {
+        std::lock_guard<std::mutex> lock(sendListMutex);
+        sendBatch.swap(pendingSends);
+    }
+    for (int clientId : sendBatch) {
+        std::shared_ptr<Connection> conn = findConnection(clientId);
+        if (conn) submitSends(*conn);
+    }
+}
+
+void NetworkServer::submitSends(Connection& conn) {
+    // 把队列前部的帧作为一串链接的 send 提交: 按顺序执行, 前一个失败时后面的随之取消
+    std::lock_guard<std::mutex> lock(conn.writeMutex);
+    if (conn.closed || conn.detaching || conn.sendInFlight > 0) return;
+    if (conn.sendQueue.empty()) {
+        conn.sendScheduled = false;
+        return;
+    }
+    
+    size_t count = std::min(conn.sendQueue.size(), static_cast<size_t>(MAX_IOV_PER_WRITE));
+    for (size_t i = 0; i < count; ++i) {
+        const Frame& frame = conn.sendQueue[i];
+        uring->prepareSend(conn.fd, frame->data(), frame->size(), uringTag(conn.id, OP_SEND), i + 1 < count);
+    }
+    conn.sendInFlight = count;
+    conn.pendingOps += static_cast<int>(count);
+}
+
+void NetworkServer::handleSendCompletion(int clientId, int result) {
+    std::shared_ptr<Connection> conn = findUringConnection(clientId);
+    if (!conn) return;
+    
+    bool failed = false;
+    bool resumed = false;
+    bool more = false;
+    {
+        std::lock_guard<std::mutex> lock(conn->writeMutex);
+        conn->sendInFlight--;
+        // 帧留在队列中直到发送完成, 在途期间缓冲区一直有效
+        if (!conn->sendQueue.empty() && result == static_cast<int>(conn->sendQueue.front()->size())) {
+            Metrics::add(Metrics::BYTES_SENT, static_cast<uint64_t>(result));
+            conn->queuedBytes -= result;
+            conn->sendQueue.pop_front();
+        } else {
+            failed = true;
+        }
+        
+        if (conn->sendInFlight == 0 && !conn->closed && !failed) {
+            if (conn->readPaused && conn->queuedBytes <= SEND_LOW_WATER_MARK) {
+                conn->readPaused = false;
+                resumed = true;
+            }
+            if (conn->sendQueue.empty()) conn->sendScheduled = false;
+            else more = true;
         }
     }
-    return count;
+    finishUringOp(conn);
+    if (conn->fd < 0) return;
+    
+    if (conn->detaching) {
+        // 发送失败说明对端已经断开, 交出去由接手方发现
+        if (conn->pendingOps == 0) finishDetach(conn);
+        return;
+    }
+    if (failed) {
+        cleanupClient(conn);
+        return;
+    }
+    if (more) submitSends(*conn);
+    // 恢复读取后先处理暂停期间留下的帧, 再重新挂上 recv
+    if (resumed) {
+        if (!processFrames(conn)) {
+            cleanupClient(conn);
+            return;
+        }
+        if (!conn->recvArmed && !conn->readPaused) armRecv(*conn);
+    }
+}
+
+std::shared_ptr<NetworkServer::Connection> NetworkServer::findUringConnection(int clientId) const {
+    std::shared_ptr<Connection> conn = findConnection(clientId);
+    if (conn) return conn;
+    auto it = retiring.find(clientId);
+    return it == retiring.end() ? nullptr : it->second;
+}
+
+void NetworkServer::finishUringOp(const std::shared_ptr<Connection>& conn) {
+    if (--conn->pendingOps == 0 && conn->fd < 0) retiring.erase(conn->id);
+}
+
+void NetworkServer::broadcastMessage(const NetworkMessage& message) {
+    // 每个协议版本只编码一次
+    multicastMessage(getConnectedClients(), EncodedMessage(message));
+}
+
+void NetworkServer::broadcastMessageExcept(const NetworkMessage& message, int excludeClient) {
+    EncodedMessage encoded(message);
+    for (int clientId : getConnectedClients()) {
+        if (clientId != excludeClient) sendMessage(clientId, encoded);
+    }
+}
+
+void NetworkServer::sendToClient(int clientId, const NetworkMessage& message) {
+    sendMessage(clientId, EncodedMessage(message));
+}
+
+void NetworkServer::sendToClient(int clientId, const EncodedMessage& message) {
+    sendMessage(clientId, message);
+}
+
+void NetworkServer::multicastMessage(const std::vector<int>& clientIds, const EncodedMessage& message) {
+    for (int clientId : clientIds) {
+        sendMessage(clientId, message);
+    }
+}
+
+int NetworkServer::getProtocolVersion(int clientId) const {
+    std::shared_ptr<Connection> conn = findConnection(clientId);
+    if (!conn) return NetworkConfig::LEGACY_PROTOCOL_VERSION;
+    std::lock_guard<std::mutex> lock(conn->writeMutex);
+    return conn->protocolVersion;
+}
+
+bool NetworkServer::isBackpressured(int clientId) const {
+    std::shared_ptr<Connection> conn = findConnection(clientId);
+    if (!conn) return false;
+    std::lock_guard<std::mutex> lock(conn->writeMutex);
+    return conn->readPaused;
+}
+
+void NetworkServer::disconnectClient(int clientId) {
+    if (!running.load()) return;
+    post([this, clientId]() {
+        std::shared_ptr<Connection> conn = findConnection(clientId);
+        if (conn) cleanupClient(conn);
+    });
+}
+
+void NetworkServer::post(std::function<void()> task) {
+    if (loop) loop->post(std::move(task));
+}
+
+EventLoop::TimerId NetworkServer::runAfter(std::chrono::milliseconds delay, std::function<void()> task) {
+    return loop->runAfter(delay, std::move(task));
+}
+
+void NetworkServer::cancelTimer(EventLoop::TimerId id) {
+    loop->cancelTimer(id);
+}
+
+int NetworkServer::getConnectedClientCount() const {
+    return connectionCount.load();
 }
 
 std::vector<int> NetworkServer::getConnectedClients() const {
     std::vector<int> clients;
     std::lock_guard<std::mutex> lock(clientMutex);
-    for (int i = 0; i < NetworkConfig::MAX_CONNECTIONS; ++i) {
-        if (clientSockets[i] >= 0) {
-            clients.push_back(clientSockets[i]);
-        }
+    clients.reserve(connections.size());
+    for (const auto& entry : connections) {
+        clients.push_back(entry.first);
     }
     return clients;
 }
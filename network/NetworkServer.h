@@ -1,5 +1,8 @@
 #pragma once
 #include "NetworkProtocol.h"
+#include "EventLoop.h"
+#include "IoUring.h"
+#include "ShmChannel.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -8,64 +11,262 @@
 #include <vector>
 #include <functional>
 #include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace chessgame::network {
 
+/**
+ * @brief 事件驱动的服务器核心.
+ *
+ * 单个 I/O 线程管理监听 socket 和全部非阻塞连接, 回调都在 I/O 线程上执行, 发送接口可在任意线程调用.
+ */
 class NetworkServer {
+public:
+    // 交给其他进程的连接
+    struct Handoff {
+        int fd{-1};
+        int protocolVersion{NetworkConfig::LEGACY_PROTOCOL_VERSION};
+        std::string peerAddress;
+        std::string unsent;    // 已编码、尚未写出的数据, 接手方先发送
+        std::string pending;   // 已收到、尚未处理的数据, 接手方先处理
+        int channelFds[3]{-1, -1, -1};   // 共享内存通道的描述符 (见 ShmChannel::getFds), 没有通道时为 -1
+    };
+
 private:
+    using Frame = EncodedMessage::Frame;
+
+    // 单个连接的状态
+    struct Connection {
+        int id;  // 单调递增, 不复用文件描述符
+        int fd;  // 关闭后为 -1
+        bool local{false};              // Unix socket 连接: 不经 io_uring, 可以收到对端附带的描述符
+        bool viaUring{false};           // 经 io_uring 收发 (登记时确定)
+        std::string peerAddress;
+        std::string readBuffer;         // 尚未凑成完整帧的数据 (只在 I/O 线程访问)
+        std::mutex writeMutex;          // 保护下面的发送状态
+        std::deque<Frame> sendQueue;    // 待发送的帧
+        size_t sendOffset{0};           // 队首帧已发送的字节数
+        size_t queuedBytes{0};          // 队列中尚未发送的字节数
+        uint32_t registeredEvents{0};   // 当前注册的 epoll 事件
+        std::atomic<bool> readPaused{false};  // 发送队列超过高水位时暂停读取该连接
+        std::atomic<bool> closed{false};
+        int protocolVersion{NetworkConfig::LEGACY_PROTOCOL_VERSION};  // 只在持有 writeMutex 时修改
+        EventLoop::Clock::time_point lastActivity;  // 最后一次收到数据的时间 (只在 I/O 线程访问)
+        EventLoop::TimerId idleTimer{TimerWheel::INVALID_TIMER};
+
+        // 以下只用于 io_uring 后端
+        bool sendScheduled{false};      // 已登记待提交或有发送在途 (持有 writeMutex 时访问)
+        size_t sendInFlight{0};         // 在途的 send 请求数 (持有 writeMutex 时访问)
+        int pendingOps{0};              // 尚未结束的请求数, 归零前连接不能释放 (只在 I/O 线程访问)
+        bool recvArmed{false};          // 是否挂着 recv (只在 I/O 线程访问)
+
+        // 交接给其他进程 (只在 I/O 线程访问; detaching 在持有 writeMutex 时设置)
+        bool detaching{false};
+        std::function<void(Handoff&)> onDetached;
+
+        // 同机连接 (只在 I/O 线程修改; channel 在持有 writeMutex 时设置)
+        std::unique_ptr<ShmChannel> channel;   // 改用共享内存通道后非空
+        std::vector<int> passedFds;            // 对端附带、尚未取用的描述符
+
+        ~Connection() {
+            for (int passed : passedFds) close(passed);
+        }
+    };
+
+public:
+    enum class Backend { EPOLL, IO_URING };
+
+private:
+
     int serverSocket;
-    int clientSockets[NetworkConfig::MAX_CONNECTIONS];
+    int listenPort{0};
+    int localSocket{-1};
+    std::string localSocketPath;
+    int inheritedSocket{-1};          // 其他进程交来的监听 socket (setListeners)
+    int inheritedLocalSocket{-1};
+    bool accepting{false};            // 正在接受新连接 (只在 I/O 线程访问)
+    bool inputSuspended{false};       // 不再处理任何连接的消息 (只在 I/O 线程访问)
+    int maxConnections;
     std::atomic<bool> running;
-    std::thread acceptThread;
-    std::thread clientThreads[NetworkConfig::MAX_CONNECTIONS];
-    mutable std::mutex clientMutex;
-    
+    std::unique_ptr<EventLoop> loop;
+    std::thread ioThread;
+
+    mutable std::mutex clientMutex;   // 保护 connections
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+    std::atomic<int> connectionCount{0};
+    int nextConnectionId{1};
+    std::chrono::seconds idleTimeout{NetworkConfig::CONNECTION_TIMEOUT};
+    Backend backend{Backend::EPOLL};
+    bool reusePort{false};
+    NetworkMessage frameMessage{MessageType::ERROR, ""};   // 解码用的消息, 各帧复用 (只在 I/O 线程访问)
+
+    // io_uring 后端
+    std::unordered_map<int, std::shared_ptr<Connection>> retiring;   // 已关闭但还有请求未结束的连接
+    std::unique_ptr<IoUring> uring;       // 在 retiring 之后析构: 先结束请求, 再释放其引用的发送缓冲
+    std::mutex sendListMutex;
+    std::vector<int> pendingSends;        // 有新帧待提交的连接 (sendListMutex 保护)
+    std::vector<int> sendBatch;
+
     // 回调函数
     std::function<void(int, const NetworkMessage&)> messageCallback;
     std::function<void(int)> connectCallback;
     std::function<void(int)> disconnectCallback;
-    
-    // 私有方法
-    void acceptConnections();
-    void handleClient(int clientSocket);
-    bool sendMessage(int clientSocket, const NetworkMessage& message);
-    NetworkMessage receiveMessage(int clientSocket);
-    void cleanupClient(int clientSocket);
+
+    // 私有方法 (除 sendMessage 外只在 I/O 线程调用)
+    void handleAccept(int listenFd);
+    void acceptConnection(int clientSocket, const std::string& peerAddress, bool local);
+    bool listenTcp(int port);
+    bool listenLocal();
+    bool registerConnection(const std::shared_ptr<Connection>& conn);
+    void finishDetach(const std::shared_ptr<Connection>& conn);
+    void handleConnectionEvent(const std::shared_ptr<Connection>& conn, uint32_t events);
+    bool readFromConnection(const std::shared_ptr<Connection>& conn);
+    ssize_t receiveWithFds(Connection& conn, char* buffer, size_t size);
+    bool receiveData(const std::shared_ptr<Connection>& conn, const char* data, size_t size);
+    size_t dispatchFrames(const std::shared_ptr<Connection>& conn, const char* data, size_t size, bool& ok);
+    bool processFrames(const std::shared_ptr<Connection>& conn);
+    bool enqueueFrame(Connection& conn, const Frame& frame);
+    bool flushSendQueue(Connection& conn);
+    void updateEvents(Connection& conn);
+    bool sendMessage(int clientId, const EncodedMessage& message);
+    void negotiateVersion(const std::shared_ptr<Connection>& conn, const std::string& requested);
+    void attachChannel(const std::shared_ptr<Connection>& conn, const std::string& request);
+    bool watchChannel(const std::shared_ptr<Connection>& conn);
+    void handleChannelEvent(const std::shared_ptr<Connection>& conn);
+    bool readFromChannel(const std::shared_ptr<Connection>& conn);
+    void writeToChannel(Connection& conn);
+    void scheduleIdleCheck(Connection& conn, EventLoop::Clock::duration delay);
+    void checkIdle(int clientId);
+    std::shared_ptr<Connection> findConnection(int clientId) const;
+    void cleanupClient(const std::shared_ptr<Connection>& conn);
+    void closeAllConnections();
+
+    // io_uring 后端 (除 scheduleSend 外只在 I/O 线程调用)
+    bool startUring();
+    void stopUring();
+    void handleCompletions();
+    void handleAcceptCompletion(int result, uint32_t flags);
+    void handleRecvCompletion(int clientId, int result, uint32_t flags);
+    void handleRecvResult(const std::shared_ptr<Connection>& conn, int result, uint32_t flags, const char* data);
+    void handleSendCompletion(int clientId, int result);
+    void armAccept();
+    void armRecv(Connection& conn);
+    void scheduleSend(int clientId);
+    void flushPendingSends();
+    void submitSends(Connection& conn);
+    std::shared_ptr<Connection> findUringConnection(int clientId) const;
+    void finishUringOp(const std::shared_ptr<Connection>& conn);
 
 public:
-    NetworkServer();
+    explicit NetworkServer(int maxConnections = NetworkConfig::MAX_CONNECTIONS);
     ~NetworkServer();
-    
+
     // 服务器控制
     bool start(int port = NetworkConfig::DEFAULT_PORT);
     void stop();
     bool isRunning() const { return running.load(); }
-    
-    // 消息处理
+    int getPort() const { return listenPort; }
+
+    // 消息处理: 帧进入连接的发送队列后立即合并写出, 写不完的部分等可写事件.
+    // 发送队列超过高水位时暂停读取该连接, 降到低水位后恢复; 超过上限则断开
     void broadcastMessage(const NetworkMessage& message);
-    void broadcastMessageExcept(const NetworkMessage& message, int excludeSocket);
-    void sendToClient(int clientSocket, const NetworkMessage& message);
+    void broadcastMessageExcept(const NetworkMessage& message, int excludeClient);
+    void sendToClient(int clientId, const NetworkMessage& message);
     
-    // 回调设置
+    // 发送已编码的消息: 多个连接共享同一份编码结果, 不再重新编码或复制
+    void sendToClient(int clientId, const EncodedMessage& message);
+    void multicastMessage(const std::vector<int>& clientIds, const EncodedMessage& message);
+
+    // 连接协商出的协议版本: 默认文本协议, 客户端发送 VERSION_NEGOTIATE 后改用协商出的版本 (连接不存在时为文本协议)
+    int getProtocolVersion(int clientId) const;
+
+    // 发送队列是否超过高水位 (对端接收过慢); 调用方可据此丢弃可补发的数据
+    bool isBackpressured(int clientId) const;
+
+    // 主动断开某个连接 (线程安全)
+    void disconnectClient(int clientId);
+
+    // 取一个不属于任何连接、之后也不会分配给连接的编号, 例如恢复出的对局中尚未重连的玩家座位
+    // (需在 start 之前或在 I/O 线程上调用)
+    int reserveClientId() { return nextConnectionId++; }
+
+    // 把连接摘下交给其他进程 (只能在 I/O 线程上调用, 例如在消息回调中): 之后不再处理它的消息,
+    // 在途的请求结束后在 I/O 线程上调用 done, 交出描述符、协议版本、尚未写出和尚未处理的数据 (Handoff),
+    // 由 done 负责转交并关闭其中的描述符; 接手方用 adoptClient 登记, 对端感觉不到切换. 不调用断开回调.
+    // 期间连接被对端关闭时照常清理 (调用断开回调), 不调用 done.
+    // 连接不存在或已在交接中时返回 false (也不会调用 done)
+    bool detachClient(int clientId, std::function<void(Handoff&)> done);
+
+    // 接手其他进程交来的连接 (只能在 I/O 线程上调用): 调用连接回调 (attach 非空时改为调用 attach),
+    // 再处理其中尚未处理的数据. 返回连接编号, 连接数已满时关闭描述符并返回 -1
+    int adoptClient(Handoff& handoff, const std::function<void(int)>& attach = nullptr);
+
+    // 沿用其他进程交来的监听 socket (localFd 为 -1 时按 setLocalSocket 自行监听), 需在 start 之前设置.
+    // 这时 start 之后暂不接受新连接: 调用方先接手交来的连接, 再调用 startAccepting (期间的新连接在 backlog 中等待)
+    void setListeners(int tcpFd, int localFd) { inheritedSocket = tcpFd; inheritedLocalSocket = localFd; }
+    void startAccepting();
+
+    // 监听 socket (TCP, 开启了同机连接时还有 Unix socket), 供交给其他进程 (仍归本对象所有)
+    std::vector<int> getListenFds() const;
+
+    // 停止接受新连接并关闭本进程的监听 socket (已交给其他进程): 之后停止时不再关闭或删除它们
+    // (只能在 I/O 线程上调用)
+    void releaseListeners();
+
+    // 不再处理任何连接的消息: 收到的数据留在读缓冲区 (共享内存通道的留在环中), 随连接交出
+    // (只能在 I/O 线程上调用, 之后不能恢复)
+    void suspendInput() { inputSuspended = true; }
+
+    // 在 I/O 线程上监视其他描述符的可读事件 (只能在 I/O 线程上调用)
+    bool watchReadable(int fd, std::function<void()> onReadable);
+    void unwatch(int fd);
+
+    // 在 I/O 线程上执行任务
+    void post(std::function<void()> task);
+
+    // 延迟执行, 返回的编号可用于取消 (都只能在 I/O 线程上调用, 例如在回调中)
+    EventLoop::TimerId runAfter(std::chrono::milliseconds delay, std::function<void()> task);
+    void cancelTimer(EventLoop::TimerId id);
+
+    // 传输后端 (需在 start 之前设置, 默认 epoll); io_uring 后端的收发不再是每条消息一次系统调用.
+    // io_uring 不可用 (内核不支持或被容器禁止) 时 start 会回退到 epoll, 之后 getBackend 返回实际使用的后端
+    void setBackend(Backend value) { backend = value; }
+    Backend getBackend() const { return backend; }
+
+    // 监听 socket 设置 SO_REUSEPORT, 多个进程共享端口 (需在 start 之前设置)
+    void setReusePort(bool value) { reusePort = value; }
+
+    // 另外在该路径上监听 Unix socket, 供同机的客户端 (例如机器人) 连接 (需在 start 之前设置); 这些连接总是经 epoll 收发,
+    // 可以随 LOCAL_CHANNEL 附带共享内存通道 (见 ShmChannel), 之后帧改在环中收发, socket 只用来发现对端关闭
+    void setLocalSocket(const std::string& path) { localSocketPath = path; }
+
+    // 空闲超时, 0 表示不断开空闲连接 (需在 start 之前设置). 每个连接只有一个检查定时器, 收到数据时只记录时间,
+    // 到期时再按最后活动时间决定断开或顺延
+    void setIdleTimeout(std::chrono::seconds timeout) { idleTimeout = timeout; }
+
+    // 回调设置 (需在 start 之前设置)
     void setMessageCallback(std::function<void(int, const NetworkMessage&)> callback) {
         messageCallback = callback;
     }
-    
+
     void setConnectCallback(std::function<void(int)> callback) {
         connectCallback = callback;
     }
-    
+
     void setDisconnectCallback(std::function<void(int)> callback) {
         disconnectCallback = callback;
     }
-    
+
     // 客户端管理
     int getConnectedClientCount() const;
     std::vector<int> getConnectedClients() const;
-    
+
     // 获取本地IP地址
     std::string getLocalIPAddress() const;
 };
 
-} // namespace chessgame::network
\ No newline at end of file
+} // namespace chessgame::network
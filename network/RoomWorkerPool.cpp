@@ -0,0 +1,69 @@
+#include "RoomWorkerPool.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace chessgame::network {
+
+RoomWorkerPool::RoomWorkerPool(int threadCount) {
+    if (threadCount <= 0) threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (auto& worker : workers) {
+        worker->thread = std::thread(&RoomWorkerPool::workerLoop, this, std::ref(*worker));
+    }
+}
+
+RoomWorkerPool::~RoomWorkerPool() {
+    stop();
+}
+
+int RoomWorkerPool::workerOf(int roomId) const {
+    // 房间编号是递增的, 先打散再取模, 避免相邻房间的负载规律性地落到同一线程
+    uint32_t hash = static_cast<uint32_t>(roomId) * 2654435761u;
+    return static_cast<int>(hash % workers.size());
+}
+
+void RoomWorkerPool::submit(int roomId, Task task) {
+    if (stopping.load()) return;
+    Worker& worker = *workers[workerOf(roomId)];
+    worker.tasks.push(std::move(task));
+
+    // 工作线程已声明空闲才需要唤醒; 与 workerLoop 中先置 idle 再检查队列配对, 不会漏掉唤醒
+    if (worker.idle.load()) {
+        std::lock_guard<std::mutex> lock(worker.sleepMutex);
+        worker.wakeup.notify_one();
+    }
+}
+
+void RoomWorkerPool::stop() {
+    if (stopping.exchange(true)) return;
+    for (auto& worker : workers) {
+        std::lock_guard<std::mutex> lock(worker->sleepMutex);
+        worker->wakeup.notify_one();
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void RoomWorkerPool::workerLoop(Worker& worker) {
+    Task task;
+    while (!stopping.load()) {
+        if (worker.tasks.pop(task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        worker.idle.store(true);
+        {
+            std::unique_lock<std::mutex> lock(worker.sleepMutex);
+            worker.wakeup.wait(lock, [&]() { return stopping.load() || !worker.tasks.empty(); });
+        }
+        worker.idle.store(false);
+    }
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,56 @@
+#pragma once
+#include "MpscQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 房间工作线程池.
+ *
+ * 每个房间按编号散列固定到一个工作线程, 该房间的对局逻辑都在这个线程上按提交顺序执行,
+ * 因此房间状态不需要加锁. I/O 线程通过各工作线程的无锁 MPSC 队列提交任务;
+ * 工作线程空闲时在条件变量上等待, 只有它声明空闲后提交者才需要加锁唤醒.
+ */
+class RoomWorkerPool {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Worker {
+        MpscQueue<Task> tasks;
+        std::mutex sleepMutex;
+        std::condition_variable wakeup;
+        std::atomic<bool> idle{false};
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> stopping{false};
+
+    void workerLoop(Worker& worker);
+
+public:
+    // threadCount <= 0 时使用 CPU 核数
+    explicit RoomWorkerPool(int threadCount = 0);
+    ~RoomWorkerPool();
+
+    RoomWorkerPool(const RoomWorkerPool&) = delete;
+    RoomWorkerPool& operator=(const RoomWorkerPool&) = delete;
+
+    // 在房间所属的工作线程上执行任务 (线程安全)
+    void submit(int roomId, Task task);
+
+    // 停止并等待全部工作线程退出, 尚未执行的任务被丢弃
+    void stop();
+
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+    int workerOf(int roomId) const;
+};
+
+} // namespace chessgame::network
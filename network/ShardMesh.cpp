@@ -0,0 +1,173 @@
+#include "ShardMesh.h"
+#include "AsyncLogger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace chessgame::network {
+
+namespace {
+
+// 正文: 协议版本, 再依次是对端地址、未写出、未处理三段, 每段以 4 字节长度开头
+const size_t HEADER_SIZE = 4 * sizeof(uint32_t);
+
+// 一次交接携带的描述符: 连接本身, 有共享内存通道时再加上通道的三个
+const size_t MAX_HANDOFF_FDS = 4;
+
+void appendField(std::string& out, const std::string& field) {
+    uint32_t length = static_cast<uint32_t>(field.size());
+    out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.append(field);
+}
+
+bool readField(const char*& cursor, const char* end, std::string& field) {
+    uint32_t length;
+    if (static_cast<size_t>(end - cursor) < sizeof(length)) return false;
+    memcpy(&length, cursor, sizeof(length));
+    cursor += sizeof(length);
+    if (static_cast<size_t>(end - cursor) < length) return false;
+    field.assign(cursor, length);
+    cursor += length;
+    return true;
+}
+
+}
+
+ShardMesh::~ShardMesh() {
+    closeAll();
+}
+
+void ShardMesh::closeAll() {
+    for (int fd : inboxes) {
+        if (fd >= 0) close(fd);
+    }
+    for (int fd : outboxes) {
+        if (fd >= 0) close(fd);
+    }
+    inboxes.clear();
+    outboxes.clear();
+}
+
+bool ShardMesh::create(int shardCount) {
+    closeAll();
+    for (int i = 0; i < shardCount; ++i) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, pair) < 0) {
+            std::cerr << "创建分片通道失败: " << strerror(errno) << std::endl;
+            closeAll();
+            return false;
+        }
+        timeval timeout{0, SEND_TIMEOUT_MS * 1000};
+        setsockopt(pair[1], SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        inboxes.push_back(pair[0]);
+        outboxes.push_back(pair[1]);
+    }
+    return true;
+}
+
+void ShardMesh::bindShard(int index) {
+    shardIndex = index;
+    for (int i = 0; i < getShardCount(); ++i) {
+        if (i == index) {
+            close(outboxes[i]);
+            outboxes[i] = -1;
+        } else {
+            close(inboxes[i]);
+            inboxes[i] = -1;
+        }
+    }
+}
+
+bool ShardMesh::send(int target, const NetworkServer::Handoff& handoff) {
+    if (target < 0 || target >= getShardCount() || outboxes[target] < 0) return false;
+
+    std::string body;
+    uint32_t version = static_cast<uint32_t>(handoff.protocolVersion);
+    body.append(reinterpret_cast<const char*>(&version), sizeof(version));
+    appendField(body, handoff.peerAddress);
+    appendField(body, handoff.unsent);
+    appendField(body, handoff.pending);
+    if (body.size() > MAX_HANDOFF_SIZE + HEADER_SIZE) {
+        AsyncLogger::instance().warn("待转交的数据过多, 放弃转交");
+        return false;
+    }
+
+    int fds[MAX_HANDOFF_FDS] = {handoff.fd, handoff.channelFds[0], handoff.channelFds[1], handoff.channelFds[2]};
+    size_t fdCount = handoff.channelFds[0] >= 0 ? MAX_HANDOFF_FDS : 1;
+
+    iovec iov{const_cast<char*>(body.data()), body.size()};
+    alignas(cmsghdr) char control[CMSG_SPACE(MAX_HANDOFF_FDS * sizeof(int))];
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = CMSG_SPACE(fdCount * sizeof(int));
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(fdCount * sizeof(int));
+    memcpy(CMSG_DATA(header), fds, fdCount * sizeof(int));
+
+    while (true) {
+        ssize_t sent = sendmsg(outboxes[target], &message, MSG_NOSIGNAL);
+        if (sent >= 0) return true;
+        if (errno == EINTR) continue;
+        AsyncLogger::instance().warn("转交连接到分片 ", target, " 失败: ", strerror(errno));
+        return false;
+    }
+}
+
+bool ShardMesh::receive(NetworkServer::Handoff& handoff) {
+    receiveBuffer.resize(MAX_HANDOFF_SIZE + HEADER_SIZE + 256);
+    iovec iov{receiveBuffer.data(), receiveBuffer.size()};
+    alignas(cmsghdr) char control[CMSG_SPACE(MAX_HANDOFF_FDS * sizeof(int))];
+
+    while (true) {
+        msghdr message{};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        ssize_t received = recvmsg(getInboxFd(), &message, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0) return false;
+
+        // 只有一个描述符时是普通连接, 四个时后三个是共享内存通道
+        int fds[MAX_HANDOFF_FDS] = {-1, -1, -1, -1};
+        size_t fdCount = 0;
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        if (header && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+            fdCount = std::min((header->cmsg_len - CMSG_LEN(0)) / sizeof(int), MAX_HANDOFF_FDS);
+            memcpy(fds, CMSG_DATA(header), fdCount * sizeof(int));
+        }
+        int fd = fds[0];
+
+        const char* cursor = receiveBuffer.data();
+        const char* end = cursor + received;
+        uint32_t version = 0;
+        bool ok = fd >= 0 && (fdCount == 1 || fdCount == MAX_HANDOFF_FDS) &&
+                  !(message.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) &&
+                  static_cast<size_t>(received) >= sizeof(version);
+        if (ok) {
+            memcpy(&version, cursor, sizeof(version));
+            cursor += sizeof(version);
+            ok = readField(cursor, end, handoff.peerAddress) && readField(cursor, end, handoff.unsent) &&
+                 readField(cursor, end, handoff.pending);
+        }
+        if (!ok) {
+            // 格式不对的交接直接丢弃, 继续取下一个
+            AsyncLogger::instance().warn("收到无效的连接转交");
+            for (size_t i = 0; i < fdCount; ++i) close(fds[i]);
+            continue;
+        }
+        handoff.fd = fd;
+        for (size_t i = 1; i < MAX_HANDOFF_FDS; ++i) handoff.channelFds[i - 1] = fds[i];
+        handoff.protocolVersion = static_cast<int>(version);
+        return true;
+    }
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,57 @@
+#pragma once
+#include "NetworkServer.h"
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 多进程分片之间转交连接的通道.
+ *
+ * 主进程在 fork 之前为每个分片创建一对 Unix 数据报 socket: 一端是该分片的收件箱,
+ * 另一端由其他分片共用, 用来向它投递. 一个数据报就是一次完整的交接:
+ * SCM_RIGHTS 携带连接的描述符 (连接改用了共享内存通道时还有通道的三个), 正文是协议版本、对端地址、
+ * 尚未写出和尚未处理的数据.
+ * 数据报整条收发, 多个进程同时投递也不会交错; 收件箱满时最多等待 SEND_TIMEOUT_MS, 仍投递不了则失败,
+ * 由调用方断开该连接.
+ * 子进程调用 bindShard 后只保留自己的收件箱和投递到其他分片的一端. 不加锁, 只在 I/O 线程上使用.
+ */
+class ShardMesh {
+private:
+    int shardIndex{0};
+    std::vector<int> inboxes;    // [i]: 分片 i 的收件箱
+    std::vector<int> outboxes;   // [i]: 投递到分片 i
+    std::vector<char> receiveBuffer;
+
+    void closeAll();
+
+public:
+    // 一次交接的正文上限: 超过时 (对端堆积了大量未处理的数据) 不转交
+    static constexpr size_t MAX_HANDOFF_SIZE = 64 * 1024;
+
+    // 收件箱满时投递方最多等待的时间 (接收方的 I/O 线程每次都会取空收件箱)
+    static constexpr int SEND_TIMEOUT_MS = 100;
+
+    ShardMesh() = default;
+    ~ShardMesh();
+
+    ShardMesh(const ShardMesh&) = delete;
+    ShardMesh& operator=(const ShardMesh&) = delete;
+
+    // 在 fork 之前创建 shardCount 个分片的通道
+    bool create(int shardCount);
+
+    // fork 之后在子进程中调用: 关闭其他分片的收件箱和投递到自己的一端
+    void bindShard(int index);
+
+    int getShardCount() const { return static_cast<int>(inboxes.size()); }
+    int getShardIndex() const { return shardIndex; }
+    int getInboxFd() const { return inboxes[shardIndex]; }
+
+    // 把连接交给分片 target, 成功后描述符已复制到对方, 调用方仍需关闭自己的一份 (通道的描述符随连接释放)
+    bool send(int target, const NetworkServer::Handoff& handoff);
+
+    // 取出一个交来的连接 (非阻塞), 没有时返回 false
+    bool receive(NetworkServer::Handoff& handoff);
+};
+
+} // namespace chessgame::network
@@ -0,0 +1,161 @@
+#include "ShmChannel.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chessgame::network {
+
+ShmChannel::~ShmChannel() {
+    reset();
+}
+
+void ShmChannel::reset() {
+    if (region) munmap(region, REGION_SIZE);
+    region = nullptr;
+    sendRing = Ring();
+    receiveRing = Ring();
+    for (int* fd : {&memoryFd, &localBell, &peerBell}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+}
+
+bool ShmChannel::create() {
+    reset();
+    serverSide = false;
+    memoryFd = memfd_create("chess-channel", MFD_CLOEXEC);
+    localBell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    peerBell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (memoryFd < 0 || localBell < 0 || peerBell < 0 ||
+        ftruncate(memoryFd, static_cast<off_t>(REGION_SIZE)) < 0 || !map()) {
+        reset();
+        return false;
+    }
+    // 新建的共享内存全为 0, 这里只是正式构造两个环的头部
+    new (receiveRing.header) RingHeader();
+    new (sendRing.header) RingHeader();
+    return true;
+}
+
+bool ShmChannel::attach(int memory, int serverBell, int clientBell) {
+    reset();
+    serverSide = true;
+    memoryFd = memory;
+    localBell = serverBell;
+    peerBell = clientBell;
+
+    // 大小不对 (对端的版本不同或不是 memfd) 时不映射, 避免越界访问
+    struct stat info;
+    if (memoryFd < 0 || localBell < 0 || peerBell < 0 || fstat(memoryFd, &info) < 0 ||
+        static_cast<size_t>(info.st_size) != REGION_SIZE || !map()) {
+        reset();
+        return false;
+    }
+    return true;
+}
+
+bool ShmChannel::map() {
+    void* address = mmap(nullptr, REGION_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+    if (address == MAP_FAILED) return false;
+    region = address;
+
+    char* base = static_cast<char*>(region);
+    Ring toServer{reinterpret_cast<RingHeader*>(base), base + sizeof(RingHeader)};
+    Ring toClient{reinterpret_cast<RingHeader*>(base + RING_BYTES), base + RING_BYTES + sizeof(RingHeader)};
+    sendRing = serverSide ? toClient : toServer;
+    receiveRing = serverSide ? toServer : toClient;
+    return true;
+}
+
+void ShmChannel::getFds(int fds[3]) const {
+    fds[0] = memoryFd;
+    fds[1] = serverSide ? localBell : peerBell;
+    fds[2] = serverSide ? peerBell : localBell;
+}
+
+void ShmChannel::ring(int bell) {
+    uint64_t one = 1;
+    ssize_t written = ::write(bell, &one, sizeof(one));
+    (void)written;
+}
+
+size_t ShmChannel::write(const char* data, size_t size) {
+    RingHeader* header = sendRing.header;
+    uint64_t tail = header->tail.load(std::memory_order_relaxed);
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    // 位置来自共享内存, 对端写坏时也不能越界: 可写字节数按容量截断
+    uint64_t used = tail - head;
+    size_t space = used < RING_CAPACITY ? RING_CAPACITY - static_cast<size_t>(used) : 0;
+    size_t count = std::min(size, space);
+    if (count == 0) return 0;
+
+    size_t offset = static_cast<size_t>(tail) & (RING_CAPACITY - 1);
+    size_t first = std::min(count, RING_CAPACITY - offset);
+    std::memcpy(sendRing.data + offset, data, first);
+    std::memcpy(sendRing.data, data + first, count - first);
+    header->tail.store(tail + count, std::memory_order_release);
+
+    // 与消费者的 "声明睡眠后复查" 配对: 先发布数据再看对方是否已声明
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header->readerSleeping.load(std::memory_order_relaxed) && header->readerSleeping.exchange(0)) {
+        ring(peerBell);
+    }
+    return count;
+}
+
+size_t ShmChannel::read(char* buffer, size_t size) {
+    RingHeader* header = receiveRing.header;
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    uint64_t tail = header->tail.load(std::memory_order_acquire);
+    uint64_t available = std::min<uint64_t>(tail - head, RING_CAPACITY);
+    size_t count = std::min(size, static_cast<size_t>(available));
+    if (count == 0) return 0;
+
+    size_t offset = static_cast<size_t>(head) & (RING_CAPACITY - 1);
+    size_t first = std::min(count, RING_CAPACITY - offset);
+    std::memcpy(buffer, receiveRing.data + offset, first);
+    std::memcpy(buffer + first, receiveRing.data, count - first);
+    header->head.store(head + count, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header->writerBlocked.load(std::memory_order_relaxed) && header->writerBlocked.exchange(0)) {
+        ring(peerBell);
+    }
+    return count;
+}
+
+bool ShmChannel::hasData() const {
+    RingHeader* header = receiveRing.header;
+    return header->tail.load(std::memory_order_acquire) != header->head.load(std::memory_order_relaxed);
+}
+
+bool ShmChannel::prepareSleep() {
+    RingHeader* header = receiveRing.header;
+    header->readerSleeping.store(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!hasData()) return true;
+    header->readerSleeping.store(0, std::memory_order_relaxed);
+    return false;
+}
+
+bool ShmChannel::prepareBlock() {
+    RingHeader* header = sendRing.header;
+    header->writerBlocked.store(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t used = header->tail.load(std::memory_order_relaxed) - header->head.load(std::memory_order_acquire);
+    if (used >= RING_CAPACITY) return true;
+    header->writerBlocked.store(0, std::memory_order_relaxed);
+    return false;
+}
+
+void ShmChannel::clearBell() {
+    uint64_t count;
+    ssize_t received = ::read(localBell, &count, sizeof(count));
+    (void)received;
+}
+
+} // namespace chessgame::network
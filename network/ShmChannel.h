@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace chessgame::network {
+
+/**
+ * @brief 同机连接的共享内存通道: 每个方向一个单生产者单消费者的字节环.
+ *
+ * 客户端创建一块 memfd 共享内存 (两个方向的环) 和双方各一个 eventfd 门铃, 经 Unix socket 以 SCM_RIGHTS 交给服务器.
+ * 环中传输的仍是协议帧的字节流, 两端的分帧和解码与 socket 完全相同, 只是收发不再经过内核.
+ * 唤醒按 Dekker 式握手: 消费者取空环后先声明要睡眠 (readerSleeping) 再复查, 生产者写入后只在对方已声明时敲门铃;
+ * 环满时生产者声明等待空间 (writerBlocked) 再复查, 消费者取走数据后敲门铃. 声明与复查之间有全屏障,
+ * 双方不会同时错过对方. 两边都在忙时收发不进入内核.
+ * 每个方向只能有一个生产者和一个消费者: 同一端的多个发送线程须自行互斥.
+ */
+class ShmChannel {
+public:
+    // 每个方向的容量 (2 的幂); 客户端在请求中带上, 双方不一致时不启用通道
+    static constexpr size_t RING_CAPACITY = 256 * 1024;
+
+private:
+    struct RingHeader {
+        alignas(64) std::atomic<uint64_t> head;           // 消费者已读到的位置 (单调递增)
+        alignas(64) std::atomic<uint64_t> tail;           // 生产者已写到的位置
+        alignas(64) std::atomic<uint32_t> readerSleeping; // 消费者取空后准备等门铃
+        std::atomic<uint32_t> writerBlocked;              // 生产者因环满等待空间
+    };
+
+    struct Ring {
+        RingHeader* header{nullptr};
+        char* data{nullptr};
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "共享内存中的原子变量必须无锁");
+
+    // 共享内存布局: [客户端 -> 服务器的环][服务器 -> 客户端的环], 每个环是头部加 RING_CAPACITY 字节
+    static constexpr size_t RING_BYTES = sizeof(RingHeader) + RING_CAPACITY;
+    static constexpr size_t REGION_SIZE = 2 * RING_BYTES;
+
+    int memoryFd{-1};
+    int localBell{-1};    // 本端等待的门铃
+    int peerBell{-1};     // 对端等待的门铃
+    bool serverSide{false};
+    void* region{nullptr};
+    Ring sendRing;
+    Ring receiveRing;
+
+    bool map();
+    void reset();
+    static void ring(int bell);
+
+public:
+    ShmChannel() = default;
+    ~ShmChannel();
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    // 客户端: 创建共享内存和两个门铃
+    bool create();
+
+    // 服务器: 接过客户端交来的描述符 (共享内存、服务器的门铃、客户端的门铃), 无论成功与否都由本对象关闭
+    bool attach(int memory, int serverBell, int clientBell);
+
+    // 交给对端或其他进程的描述符, 顺序与 attach 的参数相同 (仍归本对象所有)
+    void getFds(int fds[3]) const;
+
+    // 本端的门铃: 可读表示接收环有了新数据, 或发送环有了空间
+    int getBellFd() const { return localBell; }
+
+    // 写入发送环, 返回写入的字节数 (环满时可能少于 size); 对端在睡眠时敲它的门铃
+    size_t write(const char* data, size_t size);
+
+    // 从接收环取出至多 size 字节; 对端在等待空间时敲它的门铃
+    size_t read(char* buffer, size_t size);
+
+    bool hasData() const;
+
+    // 接收环已取空, 准备等待门铃: 返回 false 表示复查时已有数据, 应继续读取而不是等待
+    bool prepareSleep();
+
+    // 发送环已满, 准备等待门铃: 返回 false 表示复查时已有空间, 应继续写入而不是等待
+    bool prepareBlock();
+
+    // 清除本端门铃的计数 (等到门铃之后调用)
+    void clearBell();
+
+    // 敲本端的门铃, 让等待它的线程醒来重新检查 (例如恢复读取时取走暂停期间积累的数据)
+    void notifySelf() { ring(localBell); }
+};
+
+} // namespace chessgame::network
@@ -0,0 +1,143 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+namespace chessgame::network {
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, Clock::time_point start)
+    : tickLength(std::max<Clock::duration>(tick, std::chrono::milliseconds(1))), origin(start) {
+    std::fill(std::begin(heads), std::end(heads), -1);
+}
+
+uint64_t TimerWheel::tickCeil(Clock::time_point when) const {
+    if (when <= origin) return 0;
+    auto elapsed = when - origin;
+    return static_cast<uint64_t>((elapsed + tickLength - Clock::duration(1)) / tickLength);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Clock::time_point deadline, Task task) {
+    int32_t index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = static_cast<int32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    Node& node = nodes[index];
+    // 当前刻度已处理过, 最早在下一个刻度执行
+    node.expiry = std::max(tickCeil(deadline), currentTick + 1);
+    node.task = std::move(task);
+    place(index);
+    activeCount++;
+    return (static_cast<uint64_t>(node.generation) << 32) | static_cast<uint32_t>(index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    int64_t index = static_cast<int64_t>(id & 0xffffffffu) - 1;
+    if (index < 0 || index >= static_cast<int64_t>(nodes.size())) return false;
+    Node& node = nodes[index];
+    if (node.list < 0 || node.generation != static_cast<uint32_t>(id >> 32)) return false;
+    unlink(static_cast<int32_t>(index));
+    release(static_cast<int32_t>(index));
+    return true;
+}
+
+void TimerWheel::advance(Clock::time_point now) {
+    uint64_t target = now <= origin ? 0 : static_cast<uint64_t>((now - origin) / tickLength);
+    while (currentTick < target) {
+        if (activeCount == 0) {
+            // 没有定时器时直接跳到目标刻度
+            currentTick = target;
+            break;
+        }
+        ++currentTick;
+
+        // 从高层到低层级联: 上层分下来的定时器可能正好落在下层当前要级联的槽里
+        if ((currentTick & ((uint64_t(1) << (SLOT_BITS * LEVELS)) - 1)) == 0) cascade(OVERFLOW_LIST);
+        for (int level = LEVELS - 1; level >= 1; --level) {
+            if ((currentTick & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) != 0) continue;
+            cascade(level * SLOTS + static_cast<int>((currentTick >> (SLOT_BITS * level)) & SLOT_MASK));
+        }
+        runSlot(static_cast<int>(currentTick & SLOT_MASK));
+    }
+}
+
+bool TimerWheel::nextWakeup(Clock::time_point& when) const {
+    if (activeCount == 0) return false;
+
+    // 各层的范围逐层嵌套, 低层找到的一定比高层早; 上层的槽在级联时刻需要处理
+    for (int level = 0; level < LEVELS; ++level) {
+        uint64_t base = currentTick >> (SLOT_BITS * level);
+        uint64_t end = ((base >> SLOT_BITS) + 1) << SLOT_BITS;
+        for (uint64_t slot = base + 1; slot < end; ++slot) {
+            if (heads[level * SLOTS + (slot & SLOT_MASK)] >= 0) {
+                when = timeOf(slot << (SLOT_BITS * level));
+                return true;
+            }
+        }
+    }
+    when = timeOf(((currentTick >> (SLOT_BITS * LEVELS)) + 1) << (SLOT_BITS * LEVELS));
+    return true;
+}
+
+void TimerWheel::place(int32_t index) {
+    uint64_t expiry = nodes[index].expiry;
+    for (int level = 0; level < LEVELS; ++level) {
+        int shift = SLOT_BITS * (level + 1);
+        if ((expiry >> shift) == (currentTick >> shift)) {
+            link(index, level * SLOTS + static_cast<int>((expiry >> (SLOT_BITS * level)) & SLOT_MASK));
+            return;
+        }
+    }
+    link(index, OVERFLOW_LIST);
+}
+
+void TimerWheel::link(int32_t index, int list) {
+    Node& node = nodes[index];
+    node.list = list;
+    node.prev = -1;
+    node.next = heads[list];
+    if (node.next >= 0) nodes[node.next].prev = index;
+    heads[list] = index;
+}
+
+void TimerWheel::unlink(int32_t index) {
+    Node& node = nodes[index];
+    if (node.prev >= 0) nodes[node.prev].next = node.next;
+    else heads[node.list] = node.next;
+    if (node.next >= 0) nodes[node.next].prev = node.prev;
+    node.prev = node.next = -1;
+    node.list = -1;
+}
+
+void TimerWheel::release(int32_t index) {
+    Node& node = nodes[index];
+    node.task = nullptr;
+    node.generation++;
+    freeNodes.push_back(index);
+    activeCount--;
+}
+
+void TimerWheel::cascade(int list) {
+    int32_t index = heads[list];
+    heads[list] = -1;
+    while (index >= 0) {
+        int32_t next = nodes[index].next;
+        place(index);
+        index = next;
+    }
+}
+
+void TimerWheel::runSlot(int list) {
+    // 逐个取下再执行: 任务中取消同一槽的其他定时器也是安全的
+    while (heads[list] >= 0) {
+        int32_t index = heads[list];
+        unlink(index);
+        Task task = std::move(nodes[index].task);
+        release(index);
+        task();
+    }
+}
+
+} // namespace chessgame::network
@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace chessgame::network {
+
+/**
+ * @brief 分层时间轮.
+ *
+ * 4 层, 每层 64 个槽, 第 0 层每槽一个刻度, 上一层每槽覆盖下一层一整圈; 超出 64^4 个刻度的
+ * 定时器放在溢出链表中. 定时器按到期刻度与当前刻度的最高不同位所在层挂到对应槽上,
+ * 当前刻度进位到某一层时把该层当前槽的定时器重新分配到下层 (级联).
+ * 节点存放在数组中并以下标组成双向链表, 插入和取消都是 O(1); 编号带代数, 过期的编号取消时无效果.
+ * 不加锁, 只能在一个线程上使用.
+ */
+class TimerWheel {
+public:
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+
+    static constexpr TimerId INVALID_TIMER = 0;
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr int OVERFLOW_LIST = LEVELS * SLOTS;
+
+    struct Node {
+        uint64_t expiry{0};       // 到期刻度
+        Task task;
+        int32_t prev{-1};
+        int32_t next{-1};
+        int32_t list{-1};         // 所在链表, -1 表示空闲
+        uint32_t generation{0};   // 每次释放后递增, 使旧编号失效
+    };
+
+    const Clock::duration tickLength;
+    const Clock::time_point origin;
+    uint64_t currentTick{0};    // 已处理到的刻度
+    size_t activeCount{0};
+
+    std::vector<Node> nodes;
+    std::vector<int32_t> freeNodes;
+    int32_t heads[LEVELS * SLOTS + 1];
+
+    void place(int32_t index);
+    void link(int32_t index, int list);
+    void unlink(int32_t index);
+    void release(int32_t index);
+    void cascade(int list);
+    void runSlot(int list);
+    uint64_t tickCeil(Clock::time_point when) const;
+    Clock::time_point timeOf(uint64_t tick) const { return origin + tickLength * static_cast<int64_t>(tick); }
+
+public:
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10),
+                        Clock::time_point start = Clock::now());
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 在 deadline 之后的第一个刻度执行 task
+    TimerId schedule(Clock::time_point deadline, Task task);
+
+    // 取消尚未执行的定时器, 编号已执行或已取消时返回 false
+    bool cancel(TimerId id);
+
+    // 执行 now 之前到期的全部定时器 (任务中可以继续添加或取消定时器)
+    void advance(Clock::time_point now);
+
+    // 下一次需要调用 advance 的时刻 (最早到期或需要级联的刻度); 没有定时器时返回 false
+    bool nextWakeup(Clock::time_point& when) const;
+
+    size_t size() const { return activeCount; }
+    bool empty() const { return activeCount == 0; }
+};
+
+} // namespace chessgame::network
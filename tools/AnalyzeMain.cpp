@@ -0,0 +1,109 @@
+#include "../ai/AnalysisService.h"
+#include "../model/Board.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace chessgame;
+
+namespace {
+
+void printUsage() {
+    std::cout << "用法: analyze [选项]\n"
+              << "  --game gomoku|go|othello   游戏类型 (默认 go)\n"
+              << "  --size N                   空棋盘大小 (默认 9, 黑白棋固定 8)\n"
+              << "  --board FILE               从文件读取局面 (Board::serialize 格式, '-' 为标准输入)\n"
+              << "  --player black|white       行棋方 (默认 black)\n"
+              << "  --top K                    输出前 K 个候选 (默认 3)\n"
+              << "  --cpu X                    最多占用的核数, 可为小数 (默认 1)\n"
+              << "  --seconds N                分析时长 (默认 5)\n";
+}
+
+void printAnalysis(const ai::AnalysisResult& result, bool winRate) {
+    std::cout << "[" << result.nodes << "]";
+    for (size_t i = 0; i < result.lines.size(); ++i) {
+        const ai::ScoredMove& line = result.lines[i];
+        std::cout << "  " << i + 1 << ". ";
+        if (line.move.isPass) std::cout << "pass";
+        else std::cout << "(" << line.move.x + 1 << "," << line.move.y + 1 << ")";
+        if (winRate) std::cout << std::fixed << std::setprecision(1) << " " << line.evaluation * 100 << "%";
+        else std::cout << " " << static_cast<int>(line.evaluation);
+    }
+    std::cout << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    GameType gameType = GO;
+    int size = 9;
+    std::string boardFile;
+    PieceType player = BLACK;
+    int topK = 3;
+    double cpuCores = 1.0;
+    int seconds = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : ""; };
+
+        if (arg == "--game") {
+            std::string game = next();
+            if (game == "gomoku") gameType = GOMOKU;
+            else if (game == "othello") gameType = OTHELLO;
+            else gameType = GO;
+        } else if (arg == "--size") size = std::atoi(next().c_str());
+        else if (arg == "--board") boardFile = next();
+        else if (arg == "--player") player = (next() == "white") ? WHITE : BLACK;
+        else if (arg == "--top") topK = std::atoi(next().c_str());
+        else if (arg == "--cpu") cpuCores = std::atof(next().c_str());
+        else if (arg == "--seconds") seconds = std::atoi(next().c_str());
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (gameType == OTHELLO) size = 8;
+    model::Board board(size);
+    if (!boardFile.empty()) {
+        std::stringstream ss;
+        if (boardFile == "-") {
+            ss << std::cin.rdbuf();
+        } else {
+            std::ifstream file(boardFile);
+            if (!file) {
+                std::cerr << "无法打开局面文件: " << boardFile << std::endl;
+                return 1;
+            }
+            ss << file.rdbuf();
+        }
+        board.deserialize(ss);
+    } else if (gameType == OTHELLO) {
+        board.setPiece(3, 3, WHITE);
+        board.setPiece(3, 4, BLACK);
+        board.setPiece(4, 3, BLACK);
+        board.setPiece(4, 4, WHITE);
+    }
+    if (board.getSize() < 5 || board.getSize() > 19) {
+        std::cerr << "棋盘大小必须在 5-19 之间" << std::endl;
+        return 1;
+    }
+
+    ai::AnalysisService service(ai::AIFactory::aiTypeForGame(gameType), topK, cpuCores);
+    std::cout << "分析线程 " << service.getThreadCount() << ", CPU 上限 " << cpuCores << " 核" << std::endl;
+    service.setPosition(board, player);
+
+    bool winRate = gameType == GO;
+    ai::AnalysisResult result;
+    for (int s = 0; s < seconds; ++s) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (service.getAnalysis(result)) printAnalysis(result, winRate);
+    }
+    return 0;
+}
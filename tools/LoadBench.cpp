@@ -0,0 +1,575 @@
+#include "../network/GameServer.h"
+#include "../network/Metrics.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief 对战服务器负载基准.
+ *
+ * 在回环地址上启动 N 个模拟客户端, 用真实的线路协议 (协商到增量同步版本) 排队匹配,
+ * 两两在服务器上随机落子对弈, 一局结束后重新排队. 统计落子吞吐量、落子往返延迟
+ * (发出 MOVE 到收到自己这一步的 BOARD_DELTA) 的 p50/p99/p999 和每局 CPU 时间.
+ * 默认在进程内启动服务器, 同时报告服务器侧每步的 I/O 系统调用数; --io-backend both 依次用 epoll 和 io_uring
+ * 两种后端各跑一轮, 便于在同一内核上对比. 指定 --connect 时压测已有的服务器, 只统计客户端 CPU.
+ * --vs-bot 时每个客户端各自与服务器托管的机器人对局 (ROOM_BOT), 另外统计机器人的应着延迟
+ * (自己这一步确认后到收到机器人的增量) 和被准入控制拒绝的次数.
+ * 没有完成任何落子时以非零状态退出, 可直接用于 CI.
+ */
+
+using namespace chessgame;
+using namespace chessgame::network;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int BENCH_PORT = 23460;
+const int MAX_EVENTS = 256;
+const int EPOLL_TIMEOUT_MS = 100;
+
+struct Options {
+    int clients = 100;
+    int threads = 4;
+    int durationSeconds = 10;
+    int boardSize = 15;
+    int maxMoves = 60;       // 每局最多落子数, 到达后执黑方离开房间结束对局
+    int thinkMs = 0;         // 轮到自己后等待多久再落子
+    int serverWorkers = 0;
+    int botLevel = 0;        // 大于 0 时与服务器托管的该级别机器人对局
+    unsigned seed = 1;
+    std::string host = "127.0.0.1";
+    int port = BENCH_PORT;
+    bool embedded = true;
+    std::vector<NetworkServer::Backend> backends{NetworkServer::Backend::EPOLL};
+};
+
+struct BotStats {
+    uint64_t moves = 0;           // 收到确认的落子数
+    uint64_t gameEnds = 0;        // 每局两个客户端各记一次
+    uint64_t errors = 0;
+    uint64_t rejected = 0;        // 人机对局请求被拒绝的次数
+    std::vector<uint32_t> rttMicros;
+    std::vector<uint32_t> botReplyMicros;
+    double cpuSeconds = 0.0;
+};
+
+double threadCpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double processCpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/**
+ * @brief 一个模拟客户端: 非阻塞连接上的协议状态机, 只在所属的压测线程上访问.
+ */
+class Bot {
+public:
+    enum class State { HANDSHAKE, NEGOTIATING, QUEUED, PLAYING };
+
+    int fd = -1;
+    bool closed = false;
+    std::chrono::milliseconds thinkTime{0};
+    Clock::time_point moveDue{};     // 思考时间到期后落子 (PLAYING 且 movePending 时有效)
+
+private:
+    const Options& options;
+    BotStats& stats;
+    std::mt19937 rng;
+
+    State state = State::HANDSHAKE;
+    int version = NetworkConfig::LEGACY_PROTOCOL_VERSION;
+    std::string readBuffer;
+    std::string writeBuffer;
+
+    PieceType color = EMPTY;
+    std::vector<PieceType> cells;
+    uint64_t expectedSequence = 0;   // 下一个应收到的增量序号, 0 表示还没有快照
+    BoardSnapshotInfo parsedSnapshot{0, GameStateInfo{GOMOKU, BLACK, IN_PROGRESS, 0, {}}};   // 解析用, 各消息复用
+    BoardDeltaInfo parsedDelta{0, EMPTY, EMPTY, IN_PROGRESS, {}};
+    int movesThisGame = 0;
+    bool awaitingAck = false;
+    bool movePending = false;
+    bool awaitingBot = false;
+    Clock::time_point moveSentAt;
+    Clock::time_point ackedAt;
+
+    void send(const NetworkMessage& message) {
+        writeBuffer += message.encodeFrame(version);
+    }
+
+    void requeue(bool leaveRoom) {
+        if (leaveRoom) send(NetworkMessage(MessageType::ROOM_LEAVE, ""));
+        std::string setting = std::to_string(GOMOKU) + "," + std::to_string(options.boardSize);
+        if (options.botLevel > 0) {
+            send(NetworkMessage(MessageType::ROOM_BOT, setting + "," + std::to_string(options.botLevel)));
+        } else {
+            send(NetworkMessage(MessageType::ROOM_JOIN, setting));
+        }
+        state = State::QUEUED;
+        awaitingAck = false;
+        awaitingBot = false;
+        movePending = false;
+        expectedSequence = 0;
+    }
+
+    void finishGame(bool leaveRoom) {
+        stats.gameEnds++;
+        requeue(leaveRoom);
+    }
+
+    void scheduleMove() {
+        movePending = true;
+        moveDue = Clock::now() + thinkTime;
+    }
+
+    void loadSnapshot(const BoardSnapshotInfo& snapshot) {
+        cells = snapshot.state.cells;
+        cells.resize(options.boardSize * options.boardSize, EMPTY);
+        expectedSequence = snapshot.sequence + 1;
+        awaitingAck = false;
+        if (snapshot.state.gameStatus != IN_PROGRESS) {
+            finishGame(true);
+        } else if (snapshot.state.currentPlayer == color) {
+            scheduleMove();
+        }
+    }
+
+    void applyDelta(const BoardDeltaInfo& delta) {
+        if (expectedSequence == 0 || delta.sequence < expectedSequence) return;   // 旧房间或重复的增量
+        if (delta.sequence > expectedSequence) {
+            send(NetworkMessage(MessageType::SYNC_REQUEST, ""));
+            expectedSequence = 0;
+            return;
+        }
+        expectedSequence++;
+        for (const CellChange& change : delta.changes) {
+            cells[change.row * options.boardSize + change.col] = change.piece;
+        }
+
+        if (delta.player == color && awaitingAck) {
+            ackedAt = Clock::now();
+            auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(ackedAt - moveSentAt).count();
+            stats.rttMicros.push_back(static_cast<uint32_t>(rtt));
+            stats.moves++;
+            awaitingAck = false;
+            awaitingBot = options.botLevel > 0;
+        } else if (delta.player != color && awaitingBot) {
+            auto reply = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - ackedAt).count();
+            stats.botReplyMicros.push_back(static_cast<uint32_t>(reply));
+            awaitingBot = false;
+        }
+        movesThisGame++;
+
+        if (delta.gameStatus != IN_PROGRESS) {
+            finishGame(true);
+        } else if (color == BLACK && movesThisGame >= options.maxMoves) {
+            // 随机对局很少分出胜负, 到达上限后执黑方离开, 对手会收到 DISCONNECT
+            finishGame(true);
+        } else if (delta.currentPlayer == color) {
+            scheduleMove();
+        }
+    }
+
+public:
+    Bot(const Options& options, BotStats& stats, unsigned seed) : options(options), stats(stats), rng(seed) {}
+
+    ~Bot() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool connectTo(const sockaddr_in& address) {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) return false;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        return true;
+    }
+
+    bool hasPendingWrite() const { return !writeBuffer.empty(); }
+    bool isMoveDue(Clock::time_point now) const { return state == State::PLAYING && movePending && now >= moveDue; }
+
+    void makeMove() {
+        movePending = false;
+        std::vector<int> empty;
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (cells[i] == EMPTY) empty.push_back(static_cast<int>(i));
+        }
+        if (empty.empty()) {
+            finishGame(true);
+            return;
+        }
+        int index = empty[std::uniform_int_distribution<size_t>(0, empty.size() - 1)(rng)];
+        MoveInfo move{index / options.boardSize, index % options.boardSize, color};
+        send(move.toMessage());
+        moveSentAt = Clock::now();
+        awaitingAck = true;
+    }
+
+    void handleMessage(const NetworkMessage& message) {
+        switch (message.type) {
+            case MessageType::CONNECT_RESPONSE:
+                if (state == State::HANDSHAKE) {
+                    send(NetworkMessage(MessageType::VERSION_NEGOTIATE, std::to_string(NetworkConfig::PROTOCOL_VERSION)));
+                    state = State::NEGOTIATING;
+                }
+                return;
+            case MessageType::VERSION_NEGOTIATE:
+                // 应答本身仍是文本帧, 之后的帧按协商的版本收发
+                version = std::atoi(message.data.c_str());
+                if (version < NetworkConfig::DELTA_SYNC_PROTOCOL_VERSION) {
+                    std::cerr << "服务器不支持增量同步协议" << std::endl;
+                    closed = true;
+                    return;
+                }
+                requeue(false);
+                return;
+            case MessageType::GAME_START:
+                color = (message.data == "BLACK") ? BLACK : WHITE;
+                state = State::PLAYING;
+                movesThisGame = 0;
+                expectedSequence = 0;
+                return;
+            case MessageType::BOARD_SNAPSHOT:
+                if (state != State::PLAYING) return;
+                if (!BoardSnapshotInfo::parse(message, parsedSnapshot)) {
+                    stats.errors++;
+                    return;
+                }
+                loadSnapshot(parsedSnapshot);
+                return;
+            case MessageType::BOARD_DELTA:
+                if (state != State::PLAYING) return;
+                if (!BoardDeltaInfo::parse(message, parsedDelta)) {
+                    stats.errors++;
+                    return;
+                }
+                applyDelta(parsedDelta);
+                return;
+            case MessageType::DISCONNECT:
+                // 对手离开, 房间已解散, 已回到大厅
+                if (state == State::PLAYING) finishGame(false);
+                return;
+            case MessageType::ERROR:
+                if (state == State::QUEUED && options.botLevel > 0) {
+                    // 机器人繁忙, 本客户端不再重试
+                    stats.rejected++;
+                    return;
+                }
+                stats.errors++;
+                if (state == State::PLAYING && awaitingAck) {
+                    // 本地局面与服务器不一致, 重新同步
+                    awaitingAck = false;
+                    expectedSequence = 0;
+                    send(NetworkMessage(MessageType::SYNC_REQUEST, ""));
+                }
+                return;
+            default:
+                return;
+        }
+    }
+
+    void onReadable() {
+        char buffer[NetworkConfig::BUFFER_SIZE];
+        while (true) {
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                readBuffer.append(buffer, received);
+                continue;
+            }
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (received < 0 && errno == EINTR) continue;
+            closed = true;
+            return;
+        }
+
+        size_t offset = 0;
+        NetworkMessage message(MessageType::ERROR, "");
+        while (!closed) {
+            size_t consumed = 0;
+            FrameStatus status = NetworkMessage::decodeFrame(readBuffer.data() + offset, readBuffer.size() - offset,
+                                                             version, message, consumed);
+            if (status == FrameStatus::INCOMPLETE) break;
+            if (status == FrameStatus::INVALID) {
+                closed = true;
+                return;
+            }
+            offset += consumed;
+            handleMessage(message);
+        }
+        readBuffer.erase(0, offset);
+    }
+
+    void flush() {
+        while (!writeBuffer.empty()) {
+            ssize_t sent = ::send(fd, writeBuffer.data(), writeBuffer.size(), MSG_NOSIGNAL);
+            if (sent > 0) {
+                writeBuffer.erase(0, sent);
+                continue;
+            }
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            if (sent < 0 && errno == EINTR) continue;
+            closed = true;
+            return;
+        }
+    }
+};
+
+// 一个压测线程驱动一组客户端, 用 epoll 等待读写, 思考时间由超时检查
+void runBots(const Options& options, int count, unsigned seed, const std::atomic<bool>& stopping,
+             std::atomic<int>& connectedBots, BotStats& stats) {
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    inet_pton(AF_INET, options.host.c_str(), &address.sin_addr);
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<std::unique_ptr<Bot>> bots;
+    for (int i = 0; i < count; ++i) {
+        auto bot = std::make_unique<Bot>(options, stats, seed * 7919u + i);
+        bot->thinkTime = std::chrono::milliseconds(options.thinkMs);
+        if (!bot->connectTo(address)) {
+            std::cerr << "连接服务器失败: " << strerror(errno) << std::endl;
+            break;
+        }
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = bot.get();
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, bot->fd, &ev);
+        bots.push_back(std::move(bot));
+        connectedBots++;
+    }
+
+    // 有思考时间时每轮检查全部客户端的落子时间, 否则只处理本轮有事件的客户端
+    auto service = [&](Bot& bot, Clock::time_point now) {
+        if (bot.closed) return;
+        if (bot.isMoveDue(now)) bot.makeMove();
+        bool wasBlocked = bot.hasPendingWrite();
+        bot.flush();
+        if (bot.closed) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, bot.fd, nullptr);
+            return;
+        }
+        // 写不完时等可写, 写完后取消
+        if (wasBlocked != bot.hasPendingWrite() || bot.hasPendingWrite()) {
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN | (bot.hasPendingWrite() ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+            ev.data.ptr = &bot;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, bot.fd, &ev);
+        }
+    };
+    for (auto& bot : bots) service(*bot, Clock::now());
+
+    struct epoll_event events[MAX_EVENTS];
+    while (!stopping.load()) {
+        int timeout = options.thinkMs > 0 ? std::min(options.thinkMs, EPOLL_TIMEOUT_MS) : EPOLL_TIMEOUT_MS;
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, timeout);
+        for (int i = 0; i < ready; ++i) {
+            Bot* bot = static_cast<Bot*>(events[i].data.ptr);
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) bot->onReadable();
+        }
+
+        auto now = Clock::now();
+        if (options.thinkMs > 0) {
+            for (auto& bot : bots) service(*bot, now);
+        } else {
+            for (int i = 0; i < ready; ++i) service(*static_cast<Bot*>(events[i].data.ptr), now);
+        }
+    }
+
+    stats.cpuSeconds = threadCpuSeconds();
+    bots.clear();
+    close(epollFd);
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+    return sorted[index];
+}
+
+void printUsage() {
+    std::cout << "用法: load_bench [选项]\n"
+              << "  --clients N        模拟客户端数 (默认 100, 取偶数)\n"
+              << "  --threads N        压测线程数 (默认 4)\n"
+              << "  --duration S       压测秒数 (默认 10)\n"
+              << "  --size N           五子棋棋盘大小 (默认 15)\n"
+              << "  --max-moves N      每局最多落子数 (默认 60)\n"
+              << "  --think-ms N       每步思考时间 (默认 0)\n"
+              << "  --seed N           随机种子 (默认 1)\n"
+              << "  --workers N        进程内服务器的房间工作线程数 (默认 CPU 核数)\n"
+              << "  --vs-bot LEVEL     每个客户端与服务器的机器人对局 (级别 1-3), 不再两两配对\n"
+              << "  --port N           端口 (默认 " << BENCH_PORT << ")\n"
+              << "  --io-backend B     进程内服务器的传输后端: epoll, io_uring 或 both (默认 epoll)\n"
+              << "  --connect HOST     压测已运行的服务器, 不在进程内启动\n";
+}
+
+// 按当前设置压测一轮并输出结果; 没有完成任何落子时返回 false
+bool runBenchmark(const Options& options, NetworkServer::Backend backend) {
+    // 进程内服务器的日志会淹没结果, 压测期间丢弃标准输出
+    std::unique_ptr<GameServer> server;
+    std::streambuf* savedOutput = nullptr;
+    if (options.embedded) {
+        server = std::make_unique<GameServer>(GOMOKU, options.boardSize, options.clients + 16, options.serverWorkers);
+        server->setBackend(backend);
+        savedOutput = std::cout.rdbuf(nullptr);
+        if (!server->start(options.port)) {
+            std::cout.rdbuf(savedOutput);
+            std::cerr << "启动服务器失败" << std::endl;
+            return false;
+        }
+        std::cout.rdbuf(savedOutput);
+        std::cout << "后端: " << (server->getBackend() == NetworkServer::Backend::IO_URING ? "io_uring" : "epoll")
+                  << std::endl;
+        savedOutput = std::cout.rdbuf(nullptr);
+    }
+    uint64_t syscallsBefore = Metrics::snapshot().counters[Metrics::IO_SYSCALLS];
+
+    double cpuBefore = processCpuSeconds();
+    auto start = Clock::now();
+    std::atomic<bool> stopping{false};
+    std::atomic<int> connectedBots{0};
+    std::vector<BotStats> stats(options.threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < options.threads; ++t) {
+        int count = options.clients / options.threads + (t < options.clients % options.threads ? 1 : 0);
+        threads.emplace_back(runBots, std::cref(options), count, options.seed + t, std::cref(stopping),
+                             std::ref(connectedBots), std::ref(stats[t]));
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.durationSeconds));
+    stopping = true;
+    for (auto& thread : threads) thread.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    double processCpu = processCpuSeconds() - cpuBefore;
+    uint64_t syscalls = Metrics::snapshot().counters[Metrics::IO_SYSCALLS] - syscallsBefore;
+
+    if (server) {
+        server->stop();
+        std::cout.rdbuf(savedOutput);
+    }
+
+    BotStats total;
+    for (const BotStats& part : stats) {
+        total.moves += part.moves;
+        total.gameEnds += part.gameEnds;
+        total.errors += part.errors;
+        total.rejected += part.rejected;
+        total.cpuSeconds += part.cpuSeconds;
+        total.rttMicros.insert(total.rttMicros.end(), part.rttMicros.begin(), part.rttMicros.end());
+        total.botReplyMicros.insert(total.botReplyMicros.end(), part.botReplyMicros.begin(),
+                                    part.botReplyMicros.end());
+    }
+    std::sort(total.rttMicros.begin(), total.rttMicros.end());
+    std::sort(total.botReplyMicros.begin(), total.botReplyMicros.end());
+    // 人机对局只有一个客户端记录结束
+    double games = options.botLevel > 0 ? total.gameEnds : total.gameEnds / 2.0;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "客户端 " << connectedBots.load() << "/" << options.clients << ", 线程 " << options.threads
+              << ", 用时 " << elapsed << " 秒" << std::endl
+              << "落子 " << total.moves << " (" << total.moves / elapsed << " 步/秒), 对局 " << games
+              << ", 错误 " << total.errors << std::endl
+              << "往返延迟 (微秒): p50 " << percentile(total.rttMicros, 0.5)
+              << ", p99 " << percentile(total.rttMicros, 0.99)
+              << ", p999 " << percentile(total.rttMicros, 0.999)
+              << ", 最大 " << (total.rttMicros.empty() ? 0 : total.rttMicros.back()) << std::endl;
+    if (options.botLevel > 0) {
+        std::cout << "机器人应着延迟 (微秒): p50 " << percentile(total.botReplyMicros, 0.5)
+                  << ", p99 " << percentile(total.botReplyMicros, 0.99)
+                  << ", p999 " << percentile(total.botReplyMicros, 0.999)
+                  << ", 最大 " << (total.botReplyMicros.empty() ? 0 : total.botReplyMicros.back())
+                  << "; 拒绝 " << total.rejected << std::endl;
+    }
+    if (games > 0) {
+        std::cout << std::setprecision(3) << "每局 CPU (毫秒): 客户端 " << total.cpuSeconds * 1000 / games;
+        if (options.embedded) {
+            // 进程 CPU 减去压测线程的部分即服务器的 I/O 线程和工作线程
+            std::cout << ", 服务器 " << std::max(0.0, processCpu - total.cpuSeconds) * 1000 / games;
+        }
+        std::cout << std::endl;
+    }
+    if (options.embedded && total.moves > 0) {
+        // 压测客户端不计入, 只统计服务器的收发、等待、唤醒和 io_uring 提交
+        std::cout << std::setprecision(2) << "服务器 I/O 系统调用: " << syscalls << " (每步 "
+                  << static_cast<double>(syscalls) / total.moves << ")" << std::endl;
+    }
+    return total.moves > 0;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : ""; };
+
+        if (arg == "--clients") options.clients = std::atoi(next().c_str());
+        else if (arg == "--threads") options.threads = std::atoi(next().c_str());
+        else if (arg == "--duration") options.durationSeconds = std::atoi(next().c_str());
+        else if (arg == "--size") options.boardSize = std::atoi(next().c_str());
+        else if (arg == "--max-moves") options.maxMoves = std::atoi(next().c_str());
+        else if (arg == "--think-ms") options.thinkMs = std::atoi(next().c_str());
+        else if (arg == "--seed") options.seed = static_cast<unsigned>(std::atoi(next().c_str()));
+        else if (arg == "--workers") options.serverWorkers = std::atoi(next().c_str());
+        else if (arg == "--vs-bot") options.botLevel = std::atoi(next().c_str());
+        else if (arg == "--port") options.port = std::atoi(next().c_str());
+        else if (arg == "--io-backend") {
+            std::string backend = next();
+            options.backends.clear();
+            if (backend != "io_uring") options.backends.push_back(NetworkServer::Backend::EPOLL);
+            if (backend != "epoll") options.backends.push_back(NetworkServer::Backend::IO_URING);
+        }
+        else if (arg == "--connect") {
+            options.host = next();
+            options.embedded = false;
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    options.clients = std::max(2, options.clients - options.clients % 2);
+    options.threads = std::max(1, std::min(options.threads, options.clients));
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (!options.embedded) return runBenchmark(options, NetworkServer::Backend::EPOLL) ? 0 : 1;
+    bool ok = true;
+    for (NetworkServer::Backend backend : options.backends) {
+        ok = runBenchmark(options, backend) && ok;
+    }
+    return ok ? 0 : 1;
+}
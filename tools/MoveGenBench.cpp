@@ -0,0 +1,202 @@
+#include "../model/Board.h"
+#include "../model/OthelloRule.h"
+#include "../model/GoRule.h"
+#include "../ai/RandomAI.h"
+#include "../ai/HeuristicAI.h"
+#include "../utils/MoveList.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 走法生成基准测试.
+ *
+ * 替换全局 operator new 统计堆分配次数, 在计时区间内要求分配数为 0;
+ * 任何热路径上出现堆分配时以非零状态退出, 可直接挂在 CI 上做回归检查.
+ */
+
+namespace {
+
+std::atomic<long long> allocationCount{0};
+
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace chessgame;
+using chessgame::model::Board;
+
+namespace {
+
+// 单项测试结果
+struct BenchResult {
+    std::string name;
+    long long calls;
+    double nsPerCall;
+    long long allocations;
+};
+
+// 在每个局面上重复执行 body, 返回平均耗时与计时区间内的分配次数
+template <typename Body>
+BenchResult runBench(const std::string& name, int positions, int rounds, Body body) {
+    // 预热一轮, 让静态数据等一次性初始化落在计时区间之外
+    for (int i = 0; i < positions; ++i) body(i);
+
+    long long before = allocationCount.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        for (int i = 0; i < positions; ++i) body(i);
+    auto end = std::chrono::steady_clock::now();
+    long long after = allocationCount.load(std::memory_order_relaxed);
+
+    long long calls = static_cast<long long>(positions) * rounds;
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return {name, calls, ns / calls, after - before};
+}
+
+// 生成一组随机的黑白棋中盘局面
+std::vector<std::shared_ptr<Board>> makeOthelloPositions(int count, std::mt19937& rng) {
+    std::vector<std::shared_ptr<Board>> boards;
+    MoveList moves;
+    PointList flipped;
+    while (static_cast<int>(boards.size()) < count) {
+        auto board = std::make_shared<Board>(8);
+        board->setPiece(3, 3, WHITE);
+        board->setPiece(3, 4, BLACK);
+        board->setPiece(4, 3, BLACK);
+        board->setPiece(4, 4, WHITE);
+        model::OthelloRule rule(board.get());
+
+        PieceType player = BLACK;
+        int plies = 10 + static_cast<int>(rng() % 40);
+        for (int i = 0; i < plies; ++i) {
+            rule.getValidMoves(player, moves);
+            if (moves.empty()) break;
+            Point p = moves[rng() % moves.size()];
+            rule.makeMove(p.x, p.y, player);
+            player = (player == BLACK) ? WHITE : BLACK;
+        }
+        boards.push_back(board);
+    }
+    return boards;
+}
+
+// 生成一组随机散落棋子的五子棋/围棋局面
+std::vector<std::shared_ptr<Board>> makeScatteredPositions(int count, int size, int stones, std::mt19937& rng) {
+    std::vector<std::shared_ptr<Board>> boards;
+    for (int n = 0; n < count; ++n) {
+        auto board = std::make_shared<Board>(size);
+        for (int i = 0; i < stones; ++i) {
+            board->setPiece(rng() % size, rng() % size, (i % 2 == 0) ? BLACK : WHITE);
+        }
+        boards.push_back(board);
+    }
+    return boards;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int positions = 64;
+    int rounds = 2000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--rounds" && i + 1 < argc) rounds = std::atoi(argv[++i]);
+        else if (arg == "--positions" && i + 1 < argc) positions = std::atoi(argv[++i]);
+        else {
+            std::cout << "用法: movegen_bench [--rounds N] [--positions N]\n";
+            return 0;
+        }
+    }
+
+    std::mt19937 rng(20240601);
+    auto othelloBoards = makeOthelloPositions(positions, rng);
+    auto gomokuBoards = makeScatteredPositions(positions, 15, 40, rng);
+    auto goBoards = makeScatteredPositions(positions, 9, 20, rng);
+
+    std::vector<BenchResult> results;
+    MoveList moves;
+    PointList flipped;
+    long long sink = 0;
+
+    results.push_back(runBench("OthelloRule::getValidMoves", positions, rounds, [&](int i) {
+        model::OthelloRule rule(othelloBoards[i].get());
+        rule.getValidMoves(BLACK, moves);
+        sink += moves.size();
+    }));
+
+    results.push_back(runBench("OthelloRule::getFlippedPieces", positions, rounds, [&](int i) {
+        model::OthelloRule rule(othelloBoards[i].get());
+        rule.getValidMoves(WHITE, moves);
+        for (const auto& p : moves) {
+            rule.getFlippedPieces(p.x, p.y, WHITE, flipped);
+            sink += flipped.size();
+        }
+    }));
+
+    results.push_back(runBench("GoRule::isValidMove (9x9 全盘)", positions, rounds / 10, [&](int i) {
+        model::GoRule rule(goBoards[i].get());
+        for (int x = 0; x < 9; ++x)
+            for (int y = 0; y < 9; ++y) sink += rule.isValidMove(x, y, BLACK);
+    }));
+
+    // AI 的走法生成是私有方法, 通过完整的 calculateMove 覆盖
+    ai::RandomAI randomOthello(ai::AIType::OTHELLO);
+    ai::RandomAI randomGomoku(ai::AIType::GOMOKU);
+    ai::HeuristicAI heuristicOthello(ai::AIType::OTHELLO);
+    ai::HeuristicAI heuristicGomoku(ai::AIType::GOMOKU);
+
+    results.push_back(runBench("RandomAI::calculateMove (黑白棋)", positions, rounds, [&](int i) {
+        sink += randomOthello.calculateMove(othelloBoards[i], BLACK).x;
+    }));
+    results.push_back(runBench("RandomAI::calculateMove (五子棋)", positions, rounds, [&](int i) {
+        sink += randomGomoku.calculateMove(gomokuBoards[i], BLACK).x;
+    }));
+    results.push_back(runBench("HeuristicAI::calculateMove (黑白棋)", positions, rounds, [&](int i) {
+        sink += heuristicOthello.calculateMove(othelloBoards[i], BLACK).x;
+    }));
+    results.push_back(runBench("HeuristicAI::calculateMove (五子棋)", positions, rounds / 10, [&](int i) {
+        sink += heuristicGomoku.calculateMove(gomokuBoards[i], BLACK).x;
+    }));
+
+    bool clean = true;
+    std::cout << std::left << std::setw(40) << "测试项" << std::right
+              << std::setw(12) << "调用次数" << std::setw(14) << "ns/次" << std::setw(12) << "堆分配" << "\n";
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(40) << r.name << std::right
+                  << std::setw(12) << r.calls
+                  << std::setw(14) << std::fixed << std::setprecision(1) << r.nsPerCall
+                  << std::setw(12) << r.allocations << "\n";
+        if (r.allocations != 0) clean = false;
+    }
+    std::cout << "(校验和 " << sink << ")\n";
+
+    if (!clean) {
+        std::cout << "错误: 走法生成热路径上出现了堆分配\n";
+        return 1;
+    }
+    std::cout << "走法生成热路径无堆分配\n";
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "../network/NetworkProtocol.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 线路协议基准测试.
+ *
+ * 对比文本协议 (版本 1) 和二进制协议 (版本 2) 每条消息的字节数和编解码耗时,
+ * 同时检查往返编解码结果与原消息一致, 不一致时以非零状态退出.
+ * 落子、棋盘同步等消息从结构体出发、解析回结构体: 文本协议经 serialize/parse, 二进制协议经 toMessage/定长负载.
+ */
+
+using namespace chessgame;
+using namespace chessgame::network;
+
+namespace {
+
+const int ITERATIONS = 200000;
+
+struct BenchResult {
+    size_t bytes;
+    double nsPerMessage;
+    bool roundTrip;
+};
+
+// 编码一帧并立即解码, 与收发两端的开销相当 (没有结构体的消息)
+BenchResult measure(const NetworkMessage& message, int version) {
+    BenchResult result{message.encodeFrame(version).size(), 0.0, true};
+
+    NetworkMessage decoded(MessageType::ERROR, "");
+    size_t consumed = 0;
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        std::string frame = message.encodeFrame(version);
+        if (NetworkMessage::decodeFrame(frame.data(), frame.size(), version, decoded, consumed) != FrameStatus::COMPLETE) {
+            result.roundTrip = false;
+            break;
+        }
+        checksum += consumed + decoded.data.size();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    result.nsPerMessage = std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS;
+
+    result.roundTrip = result.roundTrip && decoded.type == message.type && decoded.data == message.data
+                       && checksum > 0;
+    return result;
+}
+
+// 从结构体构造消息、编码一帧、解码并解析回结构体
+template <typename Info>
+BenchResult measure(const Info& info, MessageType type, int version) {
+    auto build = [&]() {
+        return version < NetworkConfig::BINARY_PROTOCOL_VERSION ? NetworkMessage(type, info.serialize()) : info.toMessage();
+    };
+    BenchResult result{build().encodeFrame(version).size(), 0.0, true};
+
+    NetworkMessage decoded(MessageType::ERROR, "");
+    Info parsed = info;
+    size_t consumed = 0;
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        std::string frame = build().encodeFrame(version);
+        if (NetworkMessage::decodeFrame(frame.data(), frame.size(), version, decoded, consumed) != FrameStatus::COMPLETE ||
+            !Info::parse(decoded, parsed)) {
+            result.roundTrip = false;
+            break;
+        }
+        checksum += consumed;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    result.nsPerMessage = std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS;
+
+    result.roundTrip = result.roundTrip && decoded.type == type && parsed.serialize() == info.serialize() && checksum > 0;
+    return result;
+}
+
+GameStateInfo boardState(int size) {
+    GameStateInfo state{GO, WHITE, IN_PROGRESS, size, {}};
+    for (int i = 0; i < size * size; ++i) {
+        state.cells.push_back(i * 7 % 5 == 0 ? BLACK : (i * 3 % 7 == 0 ? WHITE : EMPTY));
+    }
+    return state;
+}
+
+}
+
+int main() {
+    MoveInfo move{9, 10, BLACK};
+    // 落子并提掉两子
+    BoardDeltaInfo delta{57, BLACK, WHITE, IN_PROGRESS, {{9, 10, BLACK}, {9, 11, EMPTY}, {10, 11, EMPTY}}};
+    BoardSnapshotInfo snapshot{57, boardState(19)};
+    NetworkMessage pass(MessageType::PASS, "");
+    NetworkMessage heartbeat(MessageType::HEARTBEAT, "PING");
+    const int v1 = NetworkConfig::LEGACY_PROTOCOL_VERSION;
+    const int v2 = NetworkConfig::PROTOCOL_VERSION;
+    std::vector<std::pair<std::string, std::pair<BenchResult, BenchResult>>> results = {
+        {"MOVE", {measure(move, MessageType::MOVE, v1), measure(move, MessageType::MOVE, v2)}},
+        {"PASS", {measure(pass, v1), measure(pass, v2)}},
+        {"HEARTBEAT", {measure(heartbeat, v1), measure(heartbeat, v2)}},
+        {"BOARD_SYNC 9x9", {measure(boardState(9), MessageType::BOARD_SYNC, v1),
+                            measure(boardState(9), MessageType::BOARD_SYNC, v2)}},
+        {"BOARD_SYNC 19x19", {measure(boardState(19), MessageType::BOARD_SYNC, v1),
+                              measure(boardState(19), MessageType::BOARD_SYNC, v2)}},
+        {"BOARD_SNAPSHOT", {measure(snapshot, MessageType::BOARD_SNAPSHOT, v1),
+                            measure(snapshot, MessageType::BOARD_SNAPSHOT, v2)}},
+        {"BOARD_DELTA", {measure(delta, MessageType::BOARD_DELTA, v1), measure(delta, MessageType::BOARD_DELTA, v2)}},
+    };
+
+    bool ok = true;
+    std::cout << std::left << std::setw(18) << "消息"
+              << std::right << std::setw(10) << "v1 字节" << std::setw(10) << "v2 字节"
+              << std::setw(12) << "v1 ns" << std::setw(12) << "v2 ns" << std::setw(10) << "加速" << std::endl;
+    for (const auto& entry : results) {
+        const BenchResult& legacy = entry.second.first;
+        const BenchResult& binary = entry.second.second;
+        ok = ok && legacy.roundTrip && binary.roundTrip;
+
+        std::cout << std::left << std::setw(18) << entry.first << std::right
+                  << std::setw(10) << legacy.bytes << std::setw(10) << binary.bytes
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << legacy.nsPerMessage << std::setw(12) << binary.nsPerMessage
+                  << std::setw(9) << legacy.nsPerMessage / binary.nsPerMessage << "x"
+                  << (legacy.roundTrip && binary.roundTrip ? "" : "  往返不一致!") << std::endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+#include "../network/AdminServer.h"
+#include "../network/GameServer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace chessgame;
+
+namespace {
+
+std::atomic<bool> stopRequested{false};
+
+// 分片进程已交给新进程时的退出码: 主进程不把它当作异常, 也不因此停止其他分片
+const int HANDED_OVER_EXIT = 3;
+
+void handleSignal(int) {
+    stopRequested = true;
+}
+
+void printUsage() {
+    std::cout << "用法: game_server [选项]\n"
+              << "  --port N                   监听端口 (默认 " << network::NetworkConfig::DEFAULT_PORT << ")\n"
+              << "  --game gomoku|go|othello   自动匹配的游戏类型 (默认 gomoku)\n"
+              << "  --size N                   自动匹配的棋盘大小 (默认 15, 黑白棋固定 8)\n"
+              << "  --max-connections N        连接数上限 (默认 " << network::NetworkConfig::MAX_SERVER_CONNECTIONS << ")\n"
+              << "  --workers N                房间工作线程数 (默认 CPU 核数)\n"
+              << "  --bot-threads N            机器人计算线程数 (默认 CPU 核数)\n"
+              << "  --max-bot-games N          人机对局数上限 (默认 10000)\n"
+              << "  --bot-budget MS            机器人每步的时间预算毫秒数 (默认 500)\n"
+              << "  --turn-timeout S           服务器判定回合超时的秒数, 0 表示不判定 (默认 35)\n"
+              << "  --idle-timeout S           断开空闲连接的秒数, 0 表示不断开 (默认 " << network::NetworkConfig::CONNECTION_TIMEOUT << ")\n"
+              << "  --session-grace S          断线玩家的座位保留秒数, 0 表示断线即离开 (默认 " << network::NetworkConfig::SESSION_GRACE_PERIOD << ")\n"
+              << "  --io-backend epoll|io_uring 传输后端, io_uring 不可用时回退到 epoll (默认 epoll)\n"
+              << "  --journal DIR              在该目录记录对局日志, 重启后恢复进行中的对局 (默认不开启, 分片时为 DIR.<分片号>)\n"
+              << "  --processes N              分片进程数, 共用端口, 每个进程一份完整的服务 (默认 1)\n"
+              << "  --local-socket PATH        另外在该 Unix 域 socket 上接受同机连接 (默认不开启, 分片时为 PATH.<分片号>)\n"
+              << "  --admin-socket PATH        在该 Unix 域 socket 上输出运行指标 (默认不开启, 分片时为 PATH.<分片号>)\n"
+              << "  --upgrade-socket PATH      在该 Unix 域 socket 上等待新版本的进程接管 (默认不开启, 分片时为 PATH.<分片号>)\n"
+              << "  --takeover PATH            启动时连接旧进程的升级 socket, 接管它的端口、房间和连接 (分片数须与旧进程相同)\n";
+}
+
+// 把文件描述符软上限提到硬上限, 否则默认的 1024 远不够用
+void raiseFileLimit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        std::cout << "文件描述符上限: " << limit.rlim_cur << std::endl;
+    }
+}
+
+struct Options {
+    int port = network::NetworkConfig::DEFAULT_PORT;
+    GameType gameType = GOMOKU;
+    int size = 15;
+    int maxConnections = network::NetworkConfig::MAX_SERVER_CONNECTIONS;
+    int workers = 0;
+    int botThreads = 0;
+    int maxBotGames = -1;
+    int botBudget = -1;
+    int turnTimeout = -1;
+    int idleTimeout = -1;
+    int sessionGrace = -1;
+    int processes = 1;
+    std::string adminSocket;
+    std::string localSocket;
+    std::string journal;
+    std::string upgradeSocket;
+    std::string takeover;
+    network::NetworkServer::Backend backend = network::NetworkServer::Backend::EPOLL;
+};
+
+// 分片进程绑定到可用 CPU 中属于自己的一段, 返回分到的核数;
+// 房间状态由本进程的线程首次写入, 内存随之分配在这些核所在的 NUMA 节点上
+int pinShard(int index, int count) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return 0;
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+    if (static_cast<int>(cpus.size()) < count) return 0;   // 核数不够分时不绑定
+
+    size_t begin = cpus.size() * index / count;
+    size_t end = cpus.size() * (index + 1) / count;
+    cpu_set_t mine;
+    CPU_ZERO(&mine);
+    for (size_t i = begin; i < end; ++i) CPU_SET(cpus[i], &mine);
+    if (sched_setaffinity(0, sizeof(mine), &mine) != 0) return 0;
+    return static_cast<int>(end - begin);
+}
+
+int runServer(const Options& options, network::ShardMesh* mesh) {
+    int workers = options.workers;
+    int botThreads = options.botThreads;
+    std::string adminSocket = options.adminSocket;
+    std::string journal = options.journal;
+    std::string localSocket = options.localSocket;
+    std::string upgradeSocket = options.upgradeSocket;
+    std::string takeover = options.takeover;
+    if (mesh) {
+        int cpus = pinShard(mesh->getShardIndex(), mesh->getShardCount());
+        if (workers <= 0) workers = cpus;
+        if (botThreads <= 0) botThreads = cpus;
+        if (!adminSocket.empty()) adminSocket += "." + std::to_string(mesh->getShardIndex());
+        if (!journal.empty()) journal += "." + std::to_string(mesh->getShardIndex());
+        if (!localSocket.empty()) localSocket += "." + std::to_string(mesh->getShardIndex());
+        if (!upgradeSocket.empty()) upgradeSocket += "." + std::to_string(mesh->getShardIndex());
+        if (!takeover.empty()) takeover += "." + std::to_string(mesh->getShardIndex());
+    }
+
+    network::GameServer server(options.gameType, options.size, options.maxConnections, workers, botThreads);
+    if (options.maxBotGames >= 0) server.setMaxBotGames(options.maxBotGames);
+    if (options.botBudget > 0) server.setBotBudget(std::chrono::milliseconds(options.botBudget));
+    if (options.turnTimeout >= 0) server.setTurnTimeout(std::chrono::seconds(options.turnTimeout));
+    if (options.idleTimeout >= 0) server.setIdleTimeout(std::chrono::seconds(options.idleTimeout));
+    if (options.sessionGrace >= 0) server.setSessionGrace(std::chrono::seconds(options.sessionGrace));
+    server.setBackend(options.backend);
+    if (!journal.empty()) server.setJournal(journal);
+    if (!localSocket.empty()) server.setLocalSocket(localSocket);
+    if (mesh) server.setShards(mesh);
+    if (!upgradeSocket.empty()) server.setUpgradeSocket(upgradeSocket);
+    if (!takeover.empty()) server.setTakeover(takeover);
+    if (!server.start(options.port)) {
+        std::cerr << "启动服务器失败" << std::endl;
+        return 1;
+    }
+
+    network::AdminServer admin;
+    if (!adminSocket.empty() && !admin.start(adminSocket, [&server]() { return server.renderMetrics(); })) {
+        server.stop();
+        return 1;
+    }
+
+    // 每 10 秒输出一次连接数和房间数
+    std::string prefix = mesh ? "[分片 " + std::to_string(mesh->getShardIndex()) + "] " : "";
+    int ticks = 0;
+    while (!stopRequested.load() && server.isRunning()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (++ticks % 50 == 0) {
+            std::cout << prefix << "连接 " << server.getConnectionCount()
+                      << ", 房间 " << server.getRoomCount()
+                      << ", 排队 " << server.getQueuedCount()
+                      << ", 人机对局 " << server.getBotGameCount() << std::endl;
+        }
+    }
+
+    admin.stop();
+    server.stop();
+    if (server.hasHandedOver()) {
+        std::cout << prefix << "已交给新进程, 退出" << std::endl;
+        return mesh ? HANDED_OVER_EXIT : 0;
+    }
+    return 0;
+}
+
+// 主进程: 创建分片通道, fork 出各分片进程, 把停止信号转发给它们并等待退出.
+// 主进程自己不启动任何线程 (包括日志线程), fork 出的子进程才是干净的
+int runShards(const Options& options) {
+    network::ShardMesh mesh;
+    if (!mesh.create(options.processes)) return 1;
+
+    std::cout.flush();
+    std::vector<pid_t> children;
+    for (int i = 0; i < options.processes; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::cerr << "创建分片进程失败" << std::endl;
+            stopRequested = true;
+            break;
+        }
+        if (pid == 0) {
+            mesh.bindShard(i);
+            std::_Exit(runServer(options, &mesh));
+        }
+        children.push_back(pid);
+    }
+
+    // 任一分片退出时停止全部分片: 少了一个分片, 交到它的连接都会失败.
+    // 交给了新进程的分片除外: 各分片分别由新进程的对应分片接管, 全部交出后主进程退出
+    int result = 0;
+    size_t running = children.size();
+    bool signalled = false;
+    while (running > 0) {
+        if (stopRequested.load() && !signalled) {
+            for (pid_t pid : children) kill(pid, SIGTERM);
+            signalled = true;
+        }
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid > 0) {
+            --running;
+            int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            if (code == HANDED_OVER_EXIT) continue;
+            if (code != 0) {
+                std::cerr << "分片进程 " << pid << " 异常退出: " << code << std::endl;
+                result = 1;
+            }
+            stopRequested = true;
+        } else if (pid < 0) {
+            break;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : ""; };
+
+        if (arg == "--port") options.port = std::atoi(next().c_str());
+        else if (arg == "--game") {
+            std::string game = next();
+            if (game == "go") options.gameType = GO;
+            else if (game == "othello") options.gameType = OTHELLO;
+            else options.gameType = GOMOKU;
+        } else if (arg == "--size") options.size = std::atoi(next().c_str());
+        else if (arg == "--max-connections") options.maxConnections = std::atoi(next().c_str());
+        else if (arg == "--workers") options.workers = std::atoi(next().c_str());
+        else if (arg == "--bot-threads") options.botThreads = std::atoi(next().c_str());
+        else if (arg == "--max-bot-games") options.maxBotGames = std::atoi(next().c_str());
+        else if (arg == "--bot-budget") options.botBudget = std::atoi(next().c_str());
+        else if (arg == "--turn-timeout") options.turnTimeout = std::atoi(next().c_str());
+        else if (arg == "--idle-timeout") options.idleTimeout = std::atoi(next().c_str());
+        else if (arg == "--session-grace") options.sessionGrace = std::atoi(next().c_str());
+        else if (arg == "--processes") options.processes = std::max(1, std::atoi(next().c_str()));
+        else if (arg == "--admin-socket") options.adminSocket = next();
+        else if (arg == "--local-socket") options.localSocket = next();
+        else if (arg == "--journal") options.journal = next();
+        else if (arg == "--upgrade-socket") options.upgradeSocket = next();
+        else if (arg == "--takeover") options.takeover = next();
+        else if (arg == "--io-backend") {
+            if (next() == "io_uring") options.backend = network::NetworkServer::Backend::IO_URING;
+        }
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (options.gameType == OTHELLO) options.size = 8;
+
+    raiseFileLimit();
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    return options.processes > 1 ? runShards(options) : runServer(options, nullptr);
+}
@@ -0,0 +1,132 @@
+#include "../tournament/Tournament.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace chessgame;
+using namespace chessgame::tournament;
+
+namespace {
+
+void printUsage() {
+    std::cout << "用法: tournament [选项]\n"
+              << "  --game gomoku|go|othello   游戏类型 (默认 gomoku)\n"
+              << "  --size N                   棋盘大小 (默认 15, 黑白棋固定 8)\n"
+              << "  --a LEVEL --b LEVEL        引擎 A/B 的 AI 级别 1-3 (默认 2 对 1)\n"
+              << "  --games N                  最大对局数 (默认 1000)\n"
+              << "  --threads N                并发线程数 (默认 CPU 核数)\n"
+              << "  --opening-plies N          开局库随机步数 (默认 4)\n"
+              << "  --seed N                   开局库随机种子\n"
+              << "  --max-plies N              超过该步数判和\n"
+              << "  --sprt                     启用 SPRT 提前终止\n"
+              << "  --elo0 X --elo1 X          SPRT 假设 (默认 0 / 10)\n"
+              << "  --alpha X --beta X         SPRT 错误率 (默认 0.05 / 0.05)\n";
+}
+
+ai::AILevel parseLevel(const std::string& str) {
+    if (str == "3") return ai::AILevel::LEVEL3;
+    if (str == "2") return ai::AILevel::LEVEL2;
+    return ai::AILevel::LEVEL1;
+}
+
+const char* decisionName(SprtDecision decision) {
+    switch (decision) {
+        case SprtDecision::ACCEPT_H0: return "接受 H0 (改动无提升)";
+        case SprtDecision::ACCEPT_H1: return "接受 H1 (改动有提升)";
+        default: return "未定";
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    TournamentConfig config;
+    config.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string aLevel = "2", bLevel = "1";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string { return (i + 1 < argc) ? argv[++i] : ""; };
+
+        if (arg == "--game") {
+            std::string game = next();
+            if (game == "go") config.gameType = GO;
+            else if (game == "othello") config.gameType = OTHELLO;
+            else config.gameType = GOMOKU;
+        } else if (arg == "--size") config.boardSize = std::atoi(next().c_str());
+        else if (arg == "--a") aLevel = next();
+        else if (arg == "--b") bLevel = next();
+        else if (arg == "--games") config.games = std::atoi(next().c_str());
+        else if (arg == "--threads") config.threads = std::atoi(next().c_str());
+        else if (arg == "--opening-plies") config.openingPlies = std::atoi(next().c_str());
+        else if (arg == "--seed") config.seed = static_cast<unsigned int>(std::strtoul(next().c_str(), nullptr, 10));
+        else if (arg == "--max-plies") config.maxPlies = std::atoi(next().c_str());
+        else if (arg == "--sprt") config.sprt = true;
+        else if (arg == "--elo0") config.elo0 = std::atof(next().c_str());
+        else if (arg == "--elo1") config.elo1 = std::atof(next().c_str());
+        else if (arg == "--alpha") config.alpha = std::atof(next().c_str());
+        else if (arg == "--beta") config.beta = std::atof(next().c_str());
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (config.gameType == OTHELLO) config.boardSize = 8;
+    if (config.boardSize < 8 || config.boardSize > 19) {
+        std::cerr << "棋盘大小必须在 8-19 之间" << std::endl;
+        return 1;
+    }
+
+    config.engineA = {"L" + aLevel, parseLevel(aLevel)};
+    config.engineB = {"L" + bLevel, parseLevel(bLevel)};
+
+    Tournament tournament(config);
+    const TournamentConfig& cfg = tournament.getConfig();
+
+    std::cout << "锦标赛: " << cfg.engineA.name << " vs " << cfg.engineB.name
+              << ", 对局数 " << cfg.games << ", 线程数 " << cfg.threads << std::endl;
+    if (cfg.sprt) {
+        std::cout << "SPRT: elo0=" << cfg.elo0 << " elo1=" << cfg.elo1
+                  << " alpha=" << cfg.alpha << " beta=" << cfg.beta
+                  << " LLR 边界 [" << tournament.sprtLowerBound() << ", "
+                  << tournament.sprtUpperBound() << "]" << std::endl;
+    }
+
+    int reportInterval = std::max(2, cfg.games / 20);
+    tournament.setProgressCallback([&](const GameResult&, const EloStats& stats) {
+        if (stats.getGames() % reportInterval != 0) return;
+        std::cout << std::fixed << std::setprecision(1)
+                  << "[" << stats.getGames() << "/" << cfg.games << "] "
+                  << "+" << stats.getWins() << " =" << stats.getDraws() << " -" << stats.getLosses()
+                  << "  Elo " << stats.eloDifference() << " ± " << stats.eloErrorMargin();
+        if (cfg.sprt) {
+            std::cout << std::setprecision(2) << "  LLR " << stats.logLikelihoodRatio(cfg.elo0, cfg.elo1);
+        }
+        std::cout << std::endl;
+    });
+
+    tournament.run();
+
+    EloStats stats = tournament.getStats();
+    int forfeits = 0;
+    for (const auto& result : tournament.getResults()) {
+        if (result.forfeit) forfeits++;
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\n===== 结果 =====\n"
+              << "对局: " << stats.getGames()
+              << "  胜 " << stats.getWins() << " 和 " << stats.getDraws() << " 负 " << stats.getLosses()
+              << "  (非法着法判负 " << forfeits << ")\n"
+              << "得分率: " << stats.score() * 100.0 << "%\n"
+              << "Elo 差: " << stats.eloDifference() << " ± " << stats.eloErrorMargin() << " (95%)\n";
+    if (cfg.sprt) {
+        std::cout << std::setprecision(2)
+                  << "LLR: " << stats.logLikelihoodRatio(cfg.elo0, cfg.elo1)
+                  << "  SPRT: " << decisionName(tournament.getDecision()) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include "Tournament.h"
+#include "../facade/GameFacade.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace chessgame::tournament {
+
+namespace {
+
+// 开局库随机落子的范围: 五子棋/围棋仅在中央区域, 避免开局过于离谱
+const int OPENING_RADIUS = 2;
+
+}
+
+// ==================== OpeningBook ====================
+
+OpeningBook::OpeningBook(GameType type, int boardSize, int plies, int count, unsigned int seed) {
+    std::mt19937 rng(seed);
+    facade::GameFacade game;
+
+    for (int n = 0; n < count; ++n) {
+        game.initGame(type, boardSize);
+        std::vector<Move> opening;
+
+        for (int ply = 0; ply < plies && game.getGameStatus() == IN_PROGRESS; ++ply) {
+            PieceType player = game.getCurrentPlayer();
+            std::vector<Point> candidates;
+
+            int low = 0, high = boardSize - 1;
+            if (type != OTHELLO) {
+                low = std::max(0, boardSize / 2 - OPENING_RADIUS);
+                high = std::min(boardSize - 1, boardSize / 2 + OPENING_RADIUS);
+            }
+            for (int i = low; i <= high; ++i)
+                for (int j = low; j <= high; ++j)
+                    if (game.isValidMove(i, j, player)) candidates.push_back({i, j});
+
+            if (candidates.empty()) break;
+
+            std::uniform_int_distribution<size_t> dist(0, candidates.size() - 1);
+            Point p = candidates[dist(rng)];
+            game.makeMove(p.x, p.y, player);
+            opening.push_back(Move(p.x, p.y, player));
+        }
+
+        openings.push_back(std::move(opening));
+    }
+}
+
+const std::vector<Move>& OpeningBook::get(int index) const {
+    return openings[index % openings.size()];
+}
+
+// ==================== EloStats ====================
+
+void EloStats::add(Outcome outcome) {
+    switch (outcome) {
+        case Outcome::WIN: wins++; break;
+        case Outcome::DRAW: draws++; break;
+        case Outcome::LOSS: losses++; break;
+    }
+}
+
+double EloStats::score() const {
+    int games = getGames();
+    if (games == 0) return 0.5;
+    return (wins + 0.5 * draws) / games;
+}
+
+double EloStats::perGameVariance() const {
+    int games = getGames();
+    if (games == 0) return 0.0;
+    double s = score();
+    return (wins * (1.0 - s) * (1.0 - s) +
+            draws * (0.5 - s) * (0.5 - s) +
+            losses * s * s) / games;
+}
+
+double EloStats::eloToScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+double EloStats::scoreToElo(double s) {
+    // 全胜/全负时 Elo 无穷大, 截断到有限值
+    s = std::clamp(s, 1e-6, 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / s - 1.0);
+}
+
+double EloStats::eloDifference() const {
+    return scoreToElo(score());
+}
+
+double EloStats::eloErrorMargin() const {
+    int games = getGames();
+    if (games < 2) return 0.0;
+    double stderrScore = std::sqrt(perGameVariance() / games);
+    double s = score();
+    double high = scoreToElo(s + 1.96 * stderrScore);
+    double low = scoreToElo(s - 1.96 * stderrScore);
+    return (high - low) / 2.0;
+}
+
+double EloStats::logLikelihoodRatio(double elo0, double elo1) const {
+    int games = getGames();
+    double variance = perGameVariance();
+    if (games == 0 || variance <= 0.0) return 0.0;
+
+    double s0 = eloToScore(elo0);
+    double s1 = eloToScore(elo1);
+    return games * (s1 - s0) * (2.0 * score() - s0 - s1) / (2.0 * variance);
+}
+
+// ==================== Tournament ====================
+
+Tournament::Tournament(const TournamentConfig& cfg)
+    : config(cfg),
+      openingBook(cfg.gameType, cfg.boardSize, cfg.openingPlies, (cfg.games + 1) / 2, cfg.seed) {
+    if (config.maxPlies <= 0) config.maxPlies = config.boardSize * config.boardSize * 2;
+    if (config.threads <= 0) config.threads = 1;
+    // 成对对局: 每个开局交换先后手
+    if (config.games % 2 != 0) config.games++;
+}
+
+void Tournament::run() {
+    nextGame = 0;
+    stopRequested = false;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < config.threads; ++i) {
+        workers.emplace_back(&Tournament::workerLoop, this);
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+void Tournament::workerLoop() {
+    while (!stopRequested.load()) {
+        int gameIndex = nextGame.fetch_add(1);
+        if (gameIndex >= config.games) break;
+
+        GameResult result = playGame(gameIndex);
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        results.push_back(result);
+        stats.add(result.outcome);
+        if (progressCallback) progressCallback(result, stats);
+
+        if (config.sprt && decision == SprtDecision::CONTINUE) {
+            decision = checkSprt();
+            if (decision != SprtDecision::CONTINUE) stopRequested = true;
+        }
+    }
+}
+
+GameResult Tournament::playGame(int gameIndex) const {
+    // 偶数局 A 执黑, 奇数局交换颜色, 两局共用同一开局
+    bool engineAIsBlack = (gameIndex % 2 == 0);
+    const std::vector<Move>& opening = openingBook.get(gameIndex / 2);
+
+    facade::GameFacade game;
+    game.initGame(config.gameType, config.boardSize);
+    for (const auto& move : opening) {
+        game.makeMove(move.x, move.y, game.getCurrentPlayer());
+    }
+
+    ai::AIType aiType = ai::AIFactory::aiTypeForGame(config.gameType);
+    const EngineConfig& blackEngine = engineAIsBlack ? config.engineA : config.engineB;
+    const EngineConfig& whiteEngine = engineAIsBlack ? config.engineB : config.engineA;
+    auto blackAI = ai::AIFactory::createAIPlayer(BLACK, aiType, blackEngine.level);
+    auto whiteAI = ai::AIFactory::createAIPlayer(WHITE, aiType, whiteEngine.level);
+
+    // AIStrategy 接口需要 shared_ptr, 这里不转移所有权
+    auto boardPtr = std::shared_ptr<model::Board>(&game.getBoard(), [](model::Board*){});
+
+    int plies = static_cast<int>(opening.size());
+    bool forfeit = false;
+    GameStatus status = game.getGameStatus();
+
+    while (status == IN_PROGRESS && plies < config.maxPlies) {
+        PieceType player = game.getCurrentPlayer();
+        ai::AIPlayer* current = (player == BLACK) ? blackAI.get() : whiteAI.get();
+        Move move = current->makeMove(boardPtr);
+
+        bool ok = move.isPass ? game.passMove(player) : game.makeMove(move.x, move.y, player);
+        if (!ok) {
+            // 非法着法 (或不支持虚着时虚着) 判负
+            forfeit = true;
+            status = (player == BLACK) ? WHITE_WIN : BLACK_WIN;
+            break;
+        }
+        plies++;
+        status = game.getGameStatus();
+    }
+
+    if (status == IN_PROGRESS) status = TIED;   // 超过步数上限判和
+
+    Outcome outcome = Outcome::DRAW;
+    if (status == BLACK_WIN) outcome = engineAIsBlack ? Outcome::WIN : Outcome::LOSS;
+    else if (status == WHITE_WIN) outcome = engineAIsBlack ? Outcome::LOSS : Outcome::WIN;
+
+    return GameResult{gameIndex, engineAIsBlack, status, outcome, plies, forfeit};
+}
+
+double Tournament::sprtLowerBound() const {
+    return std::log(config.beta / (1.0 - config.alpha));
+}
+
+double Tournament::sprtUpperBound() const {
+    return std::log((1.0 - config.beta) / config.alpha);
+}
+
+SprtDecision Tournament::checkSprt() const {
+    double llr = stats.logLikelihoodRatio(config.elo0, config.elo1);
+    if (llr >= sprtUpperBound()) return SprtDecision::ACCEPT_H1;
+    if (llr <= sprtLowerBound()) return SprtDecision::ACCEPT_H0;
+    return SprtDecision::CONTINUE;
+}
+
+EloStats Tournament::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+SprtDecision Tournament::getDecision() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return decision;
+}
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+#include "../utils/Type.h"
+#include "../ai/AI.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 无界面的 AI 自对弈锦标赛: 在线程池上并发对局, 统计 Elo 差及置信区间, 支持 SPRT 提前终止.
+ */
+
+namespace chessgame::tournament {
+
+// 参赛引擎配置: 由 AIFactory 创建
+struct EngineConfig {
+    std::string name;
+    ai::AILevel level{ai::AILevel::LEVEL1};
+};
+
+// 锦标赛配置
+struct TournamentConfig {
+    GameType gameType{GOMOKU};
+    int boardSize{15};
+    EngineConfig engineA{"A", ai::AILevel::LEVEL2};
+    EngineConfig engineB{"B", ai::AILevel::LEVEL1};
+    int games{1000};            // 最大对局数 (按开局成对进行, 自动取偶数)
+    int threads{1};             // 工作线程数
+    int openingPlies{4};        // 开局库每个开局的随机步数
+    unsigned int seed{20240601};
+    int maxPlies{0};            // 超过该步数判和, 0 表示 boardSize*boardSize*2
+
+    // SPRT 参数 (Elo 假设 H0: elo0, H1: elo1)
+    bool sprt{false};
+    double elo0{0.0};
+    double elo1{10.0};
+    double alpha{0.05};
+    double beta{0.05};
+};
+
+// 单局结果 (站在引擎 A 的角度)
+enum class Outcome { WIN, DRAW, LOSS };
+
+struct GameResult {
+    int gameIndex;
+    bool engineAIsBlack;
+    GameStatus status;
+    Outcome outcome;
+    int plies;
+    bool forfeit;   // 某方给出非法着法被判负
+};
+
+// 开局库: 由随机合法着法生成, 每个开局交换先后手各下一局
+class OpeningBook {
+private:
+    std::vector<std::vector<Move>> openings;
+
+public:
+    OpeningBook(GameType type, int boardSize, int plies, int count, unsigned int seed);
+
+    const std::vector<Move>& get(int index) const;
+    int size() const { return static_cast<int>(openings.size()); }
+};
+
+// 胜/和/负 统计与 Elo 计算
+class EloStats {
+private:
+    int wins{0};
+    int draws{0};
+    int losses{0};
+
+    // 单局得分的方差
+    double perGameVariance() const;
+
+public:
+    void add(Outcome outcome);
+
+    int getWins() const { return wins; }
+    int getDraws() const { return draws; }
+    int getLosses() const { return losses; }
+    int getGames() const { return wins + draws + losses; }
+
+    // 平均得分 (胜 1, 和 0.5, 负 0)
+    double score() const;
+
+    // Elo 差 (正值表示 A 更强)
+    double eloDifference() const;
+
+    // 95% 置信区间对应的 Elo 误差 (±)
+    double eloErrorMargin() const;
+
+    // 广义 SPRT 的对数似然比 (正态近似)
+    double logLikelihoodRatio(double elo0, double elo1) const;
+
+    // 得分与 Elo 互相换算
+    static double eloToScore(double elo);
+    static double scoreToElo(double score);
+};
+
+// SPRT 判定结果
+enum class SprtDecision { CONTINUE, ACCEPT_H0, ACCEPT_H1 };
+
+class Tournament {
+private:
+    TournamentConfig config;
+    OpeningBook openingBook;
+    EloStats stats;
+    std::vector<GameResult> results;
+    SprtDecision decision{SprtDecision::CONTINUE};
+
+    std::atomic<int> nextGame{0};
+    std::atomic<bool> stopRequested{false};
+    mutable std::mutex statsMutex;
+
+    // 进度回调: 每局结束后调用 (持有 statsMutex)
+    std::function<void(const GameResult&, const EloStats&)> progressCallback;
+
+    // 工作线程主循环
+    void workerLoop();
+
+    // 进行一局对局
+    GameResult playGame(int gameIndex) const;
+
+    // 根据 SPRT 边界判定
+    SprtDecision checkSprt() const;
+
+public:
+    explicit Tournament(const TournamentConfig& cfg);
+
+    // 运行整个锦标赛 (阻塞直到完成或 SPRT 终止)
+    void run();
+
+    // 请求提前停止
+    void stop() { stopRequested = true; }
+
+    void setProgressCallback(std::function<void(const GameResult&, const EloStats&)> callback) {
+        progressCallback = callback;
+    }
+
+    EloStats getStats() const;
+    SprtDecision getDecision() const;
+    const std::vector<GameResult>& getResults() const { return results; }
+    const TournamentConfig& getConfig() const { return config; }
+
+    // SPRT 的上下界 (对数似然比)
+    double sprtLowerBound() const;
+    double sprtUpperBound() const;
+};
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Type.h"
+#include <cstddef>
+
+namespace chessgame {
+
+// 棋盘最大边长: 所有棋盘上的点都能放进定长列表
+constexpr int MAX_BOARD_SIZE = 19;
+constexpr int MAX_BOARD_POINTS = MAX_BOARD_SIZE * MAX_BOARD_SIZE;
+
+// 定长列表: 元素直接放在对象内部 (通常位于栈上), 走法生成的热路径不做堆分配
+template <typename T, int Capacity>
+class FixedList {
+private:
+    T items[Capacity];
+    int count{0};
+
+public:
+    FixedList() = default;
+
+    void push_back(const T& item) { items[count++] = item; }
+    void pop_back() { --count; }
+    void clear() { count = 0; }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == Capacity; }
+    static constexpr int capacity() { return Capacity; }
+
+    T& operator[](int index) { return items[index]; }
+    const T& operator[](int index) const { return items[index]; }
+    T& back() { return items[count - 1]; }
+    const T& back() const { return items[count - 1]; }
+
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+};
+
+// 点列表 (合法着法、翻转的棋子、棋串等), 容量为棋盘点数上限
+using PointList = FixedList<Point, MAX_BOARD_POINTS>;
+
+// 走法列表
+using MoveList = PointList;
+
+}
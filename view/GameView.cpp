@@ -2,6 +2,9 @@
 #include <iostream>
 #include <iomanip>
 #include <cstdlib>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
 
 using namespace chessgame::view;
 
@@ -105,13 +108,53 @@ void ConsoleView::displayBoard(const model::Board& board, PieceType currentPlaye
     if (showHints) std::cout << "输入 'help' 查看指令" << std::endl;
 }
 
+bool ConsoleView::takeBufferedLine(std::string& line) {
+    size_t end = inputBuffer.find('\n');
+    if (end == std::string::npos) {
+        if (!inputClosed || inputBuffer.empty()) return false;
+        end = inputBuffer.size();
+    }
+    line.assign(inputBuffer, 0, end);
+    inputBuffer.erase(0, end + 1);
+    return true;
+}
+
+bool ConsoleView::readInput() {
+    char buffer[4096];
+    ssize_t count;
+    do {
+        count = read(STDIN_FILENO, buffer, sizeof(buffer));
+    } while (count < 0 && errno == EINTR);
+    if (count <= 0) {
+        inputClosed = true;
+        return false;
+    }
+    inputBuffer.append(buffer, static_cast<size_t>(count));
+    return true;
+}
+
 std::string ConsoleView::getUserInput(const std::string& prompt) {
-    std::cout << prompt;
+    // 不再经过 std::cin, 提示要自己刷新
+    std::cout << prompt << std::flush;
     std::string input;
-    std::getline(std::cin, input);
+    while (!takeBufferedLine(input)) {
+        if (inputClosed) return "";
+        readInput();
+    }
     return input;
 }
 
+bool ConsoleView::pollUserInput(std::string& line) {
+    if (takeBufferedLine(line)) return true;
+    if (inputClosed) return false;
+    
+    // 至多读一次, 只有半行时留到下次
+    struct pollfd pfd{STDIN_FILENO, POLLIN, 0};
+    if (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & (POLLIN | POLLHUP))) return false;
+    readInput();
+    return takeBufferedLine(line);
+}
+
 void ConsoleView::showHelp() {
     clearScreen();
     std::cout << "===== 指令说明 =====" << std::endl;
@@ -122,12 +165,11 @@ void ConsoleView::showHelp() {
     std::cout << "  save [文件名] : 保存游戏" << std::endl;
     std::cout << "  load [文件名] : 加载游戏" << std::endl;
     std::cout << "  restart  : 重新开始" << std::endl;
-    std::cout << "  hint     : 切换提示显示" << std::endl;
+    std::cout << "  hint     : 切换提示显示 (开启时后台分析局面)" << std::endl;
+    std::cout << "  best     : 显示分析出的推荐着法" << std::endl;
     std::cout << "  quit     : 退出游戏" << std::endl;
     std::cout << "====================" << std::endl;
-    std::cout << "按回车键继续...";
-    std::string dummy;
-    std::getline(std::cin, dummy);
+    getUserInput("按回车键继续...");
 }
 
 void ConsoleView::showError(const std::string& error) {
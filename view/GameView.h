@@ -18,6 +18,13 @@ public:
     
     virtual std::string getUserInput(const std::string& prompt) = 0;
     
+    // 不阻塞地取一行已到达的输入, 没有完整的一行时返回 false; 与 getUserInput 共用同一个行缓冲,
+    // 读到但还没取走的行留给之后的 getUserInput
+    virtual bool pollUserInput(std::string& line) = 0;
+    
+    // 输入是否已关闭 (读到文件尾)
+    virtual bool isInputClosed() const = 0;
+    
     virtual void showHelp() = 0;
     
     virtual void showGameResult(GameStatus status, PieceType winner = BLACK);
@@ -46,6 +53,15 @@ class ConsoleView : public GameView {
 private:
     bool showHints;
     
+    // 标准输入直接按描述符读取并自行分行: 经 stdio 读取时, 已读进其缓冲区的后续行 poll 看不到
+    std::string inputBuffer;
+    bool inputClosed{false};
+    
+    // 从缓冲区取出一行 (输入已关闭时最后不带换行符的部分也算一行)
+    bool takeBufferedLine(std::string& line);
+    // 读一次标准输入追加到缓冲区, 读到文件尾或出错时返回 false
+    bool readInput();
+    
     void clearScreen();
     char getPieceChar(PieceType piece) const;
     std::string getPlayerName(PieceType player) const;
@@ -63,6 +79,10 @@ public:
     
     std::string getUserInput(const std::string& prompt) override;
     
+    bool pollUserInput(std::string& line) override;
+    
+    bool isInputClosed() const override { return inputClosed && inputBuffer.empty(); }
+    
     void showHelp() override;
     
     void showError(const std::string& error) override;